@@ -0,0 +1,504 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#include <Common/QuickFASTPch.h>
+#include "ChannelManager.h"
+#include <Application/DecoderConnection.h>
+#include <Communication/AsynchReceiver.h>
+#include <Codecs/Decoder.h>
+#include <Common/MonotonicClock.h>
+#include <Common/ThreadPlacement.h>
+#include <Common/Exceptions.h>
+
+using namespace QuickFAST;
+using namespace Application;
+
+namespace
+{
+  /// After spinning, an idle worker yields this many times before it sleeps.
+  const size_t yieldCount = 100;
+
+  /// How often the supervisor checks for stopped channels.
+  const size_t supervisorPeriod = 10; // milliseconds
+
+  bool heavierFirst(const std::pair<uint64, size_t> & lhs, const std::pair<uint64, size_t> & rhs)
+  {
+    return lhs.first > rhs.first;
+  }
+
+  /// @brief A channel's statistics, copied while no worker is decoding it.
+  struct ChannelStatistics
+  {
+    size_t worker_;
+    uint64 decodeTime_;
+    size_t buffers_;
+    size_t bytes_;
+    size_t noBufferAvailable_;
+    size_t contextBytes_;
+    size_t allocatedEntries_;
+    size_t dictionaryEntries_;
+  };
+}
+
+/// @brief One channel and its decoding statistics.
+struct ChannelManager::Channel
+{
+  Channel(const std::string & name, const DecoderConfiguration & configuration)
+    : name_(name)
+    , configuration_(configuration)
+    , receiver_(0)
+    , worker_(0)
+    , decodeTime_(0)
+    , balancedTime_(0)
+    , load_(0)
+    , buffers_(0)
+  {
+  }
+
+  std::string name_;
+  DecoderConfiguration configuration_;
+  DecoderConnection connection_;
+  Communication::AsynchReceiver * receiver_;
+  /// Held by the worker while it decodes this channel.
+  boost::mutex decodeMutex_;
+  /// The worker assigned to this channel.
+  volatile size_t worker_;
+  /// Total time spent decoding (nanoseconds)
+  uint64 decodeTime_;
+  /// decodeTime_ at the last rebalance
+  uint64 balancedTime_;
+  /// decoding time between the last two rebalances
+  uint64 load_;
+  size_t buffers_;
+};
+
+ChannelManager::ChannelManager(size_t workerCount)
+  : workerCount_(workerCount > 0 ? workerCount : 1)
+  , ioThreads_(1)
+  , waitStrategy_(DecoderConfiguration::PARK_WAIT)
+  , spinCount_(1000)
+  , rebalanceInterval_(0)
+  , stopping_(false)
+  , started_(false)
+  , migrations_(0)
+  , rebalances_(0)
+  , startTime_(0)
+  , stopTime_(0)
+{
+}
+
+ChannelManager::~ChannelManager()
+{
+  if(started_)
+  {
+    stop();
+    join();
+  }
+}
+
+void
+ChannelManager::setTemplateRegistry(Codecs::TemplateRegistryPtr registry)
+{
+  registry_ = registry;
+}
+
+void
+ChannelManager::setIoThreads(size_t ioThreads)
+{
+  ioThreads_ = ioThreads > 0 ? ioThreads : 1;
+}
+
+void
+ChannelManager::setWorkerCpus(const std::vector<int> & cpus)
+{
+  workerCpus_ = cpus;
+}
+
+void
+ChannelManager::setThreadName(const std::string & name)
+{
+  threadName_ = name;
+}
+
+void
+ChannelManager::setWaitStrategy(DecoderConfiguration::WaitStrategy strategy, size_t spinCount)
+{
+  waitStrategy_ = strategy;
+  spinCount_ = spinCount;
+}
+
+void
+ChannelManager::setRebalanceInterval(size_t milliseconds)
+{
+  rebalanceInterval_ = milliseconds;
+}
+
+size_t
+ChannelManager::addChannel(
+  const std::string & name,
+  Messages::ValueMessageBuilder & builder,
+  const DecoderConfiguration & configuration)
+{
+  if(started_)
+  {
+    throw UsageError("Coding Error", "ChannelManager: Channels must be added before start().");
+  }
+  ChannelPtr channel(new Channel(name, configuration));
+  // The manager's workers take the place of the decoding stage.
+  channel->configuration_.setPipelineTopology(DecoderConfiguration::TWO_STAGE_PIPELINE);
+  if(registry_)
+  {
+    channel->connection_.setTemplateRegistry(registry_);
+  }
+  channel->connection_.configure(builder, channel->configuration_);
+  if(!registry_)
+  {
+    registry_ = channel->connection_.registry();
+  }
+  // configure() has already insisted on an AsynchReceiver.
+  channel->receiver_ = dynamic_cast<Communication::AsynchReceiver *>(&channel->connection_.receiver());
+  channel->worker_ = channels_.size() % workerCount_;
+  channels_.push_back(channel);
+  return channels_.size() - 1;
+}
+
+void
+ChannelManager::start()
+{
+  if(channels_.empty())
+  {
+    throw UsageError("Coding Error", "ChannelManager: No channels to start.");
+  }
+  started_ = true;
+  stopping_ = false;
+  startTime_ = Common::monotonicNanoseconds();
+  stopTime_ = 0;
+
+  bool sharedServiceRunning = false;
+  for(size_t nChannel = 0; nChannel < channels_.size(); ++nChannel)
+  {
+    Channel & channel = *channels_[nChannel];
+    if(channel.configuration_.privateIOService())
+    {
+      channel.receiver_->runThreads(1, false);
+    }
+    else if(!sharedServiceRunning)
+    {
+      channel.receiver_->runThreads(ioThreads_, false);
+      sharedServiceRunning = true;
+    }
+  }
+  for(size_t nWorker = 0; nWorker < workerCount_; ++nWorker)
+  {
+    workers_.create_thread(boost::bind(&ChannelManager::runWorker, this, nWorker));
+  }
+  supervisor_.reset(new boost::thread(boost::bind(&ChannelManager::runSupervisor, this)));
+}
+
+void
+ChannelManager::stop()
+{
+  stopping_ = true;
+  for(size_t nChannel = 0; nChannel < channels_.size(); ++nChannel)
+  {
+    channels_[nChannel]->receiver_->stop();
+  }
+}
+
+void
+ChannelManager::join()
+{
+  if(supervisor_)
+  {
+    supervisor_->join();
+    supervisor_.reset();
+  }
+  workers_.join_all();
+  for(size_t nChannel = 0; nChannel < channels_.size(); ++nChannel)
+  {
+    channels_[nChannel]->receiver_->joinThreads();
+  }
+  if(stopTime_ == 0)
+  {
+    stopTime_ = Common::monotonicNanoseconds();
+  }
+  started_ = false;
+}
+
+void
+ChannelManager::rebalance()
+{
+  boost::mutex::scoped_lock lock(assignmentMutex_);
+  ++rebalances_;
+  std::vector<std::pair<uint64, size_t> > loads;
+  loads.reserve(channels_.size());
+  uint64 totalLoad = 0;
+  for(size_t nChannel = 0; nChannel < channels_.size(); ++nChannel)
+  {
+    Channel & channel = *channels_[nChannel];
+    uint64 decodeTime;
+    {
+      boost::mutex::scoped_lock decodeLock(channel.decodeMutex_);
+      decodeTime = channel.decodeTime_;
+    }
+    channel.load_ = decodeTime - channel.balancedTime_;
+    channel.balancedTime_ = decodeTime;
+    totalLoad += channel.load_;
+    loads.push_back(std::make_pair(channel.load_, nChannel));
+  }
+  if(totalLoad == 0)
+  {
+    // Nothing measured; nothing to balance.
+    return;
+  }
+
+  // Heaviest channel first, each to the least loaded worker.
+  std::stable_sort(loads.begin(), loads.end(), heavierFirst);
+  std::vector<uint64> workerLoads(workerCount_, 0);
+  // Moving a channel costs a little; don't do it for less than 5% of a worker's fair share.
+  uint64 tolerance = totalLoad / workerCount_ / 20;
+  for(size_t nLoad = 0; nLoad < loads.size(); ++nLoad)
+  {
+    Channel & channel = *channels_[loads[nLoad].second];
+    size_t current = channel.worker_;
+    size_t best = 0;
+    for(size_t nWorker = 1; nWorker < workerCount_; ++nWorker)
+    {
+      if(workerLoads[nWorker] < workerLoads[best])
+      {
+        best = nWorker;
+      }
+    }
+    if(workerLoads[current] <= workerLoads[best] + tolerance)
+    {
+      best = current;
+    }
+    workerLoads[best] += loads[nLoad].first;
+    if(best != current)
+    {
+      channel.worker_ = best;
+      ++migrations_;
+    }
+  }
+}
+
+size_t
+ChannelManager::channelCount()const
+{
+  return channels_.size();
+}
+
+DecoderConnection &
+ChannelManager::connection(size_t channel)const
+{
+  return channels_.at(channel)->connection_;
+}
+
+size_t
+ChannelManager::workerOf(size_t channel)const
+{
+  return channels_.at(channel)->worker_;
+}
+
+void
+ChannelManager::runWorker(size_t worker)
+{
+  if(!threadName_.empty())
+  {
+    std::stringstream name;
+    name << threadName_ << "/w" << worker;
+    Common::ThreadPlacement::nameThread(name.str());
+  }
+  if(!workerCpus_.empty())
+  {
+    Common::ThreadPlacement::pinThread(workerCpus_[worker % workerCpus_.size()]);
+  }
+
+  size_t idlePasses = 0;
+  while(!stopping_)
+  {
+    bool busy = false;
+    for(size_t nChannel = 0; nChannel < channels_.size(); ++nChannel)
+    {
+      Channel & channel = *channels_[nChannel];
+      if(channel.worker_ != worker)
+      {
+        continue;
+      }
+      // Fails only while the previous worker finishes with a channel that just moved.
+      boost::mutex::scoped_try_lock lock(channel.decodeMutex_);
+      if(!lock.owns_lock())
+      {
+        continue;
+      }
+      uint64 start = Common::monotonicNanoseconds();
+      size_t decoded = channel.receiver_->pollDecoder();
+      if(decoded != 0)
+      {
+        channel.decodeTime_ += Common::monotonicNanoseconds() - start;
+        channel.buffers_ += decoded;
+        busy = true;
+      }
+    }
+    if(busy)
+    {
+      idlePasses = 0;
+    }
+    else
+    {
+      idle(idlePasses);
+    }
+  }
+}
+
+void
+ChannelManager::idle(size_t & idlePasses)
+{
+  ++idlePasses;
+  if(idlePasses <= spinCount_ || waitStrategy_ == DecoderConfiguration::SPIN_WAIT)
+  {
+    return;
+  }
+  if(waitStrategy_ == DecoderConfiguration::YIELD_WAIT || idlePasses <= spinCount_ + yieldCount)
+  {
+    boost::thread::yield();
+    return;
+  }
+  boost::this_thread::sleep(boost::posix_time::microseconds(50));
+}
+
+void
+ChannelManager::runSupervisor()
+{
+  if(!threadName_.empty())
+  {
+    Common::ThreadPlacement::nameThread(threadName_ + "/sup");
+  }
+  uint64 lastRebalance = Common::monotonicNanoseconds();
+  while(!stopping_)
+  {
+    boost::this_thread::sleep(boost::posix_time::milliseconds(supervisorPeriod));
+    if(allStopped())
+    {
+      stopTime_ = Common::monotonicNanoseconds();
+      stop();
+    }
+    else if(rebalanceInterval_ > 0)
+    {
+      uint64 now = Common::monotonicNanoseconds();
+      if(now - lastRebalance >= uint64(rebalanceInterval_) * 1000000)
+      {
+        rebalance();
+        lastRebalance = now;
+      }
+    }
+  }
+}
+
+bool
+ChannelManager::allStopped()const
+{
+  for(size_t nChannel = 0; nChannel < channels_.size(); ++nChannel)
+  {
+    if(!channels_[nChannel]->receiver_->stopping())
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+void
+ChannelManager::report(std::ostream & out)const
+{
+  uint64 end = stopTime_ != 0 ? stopTime_ : Common::monotonicNanoseconds();
+  double seconds = startTime_ == 0 ? 0.0 : double(end - startTime_) / 1e9;
+
+  // The workers update the statistics and the dictionaries as they decode,
+  // so take each channel's lock the way rebalance() does.
+  std::vector<ChannelStatistics> statistics(channels_.size());
+  size_t migrations = 0;
+  size_t rebalances = 0;
+  {
+    boost::mutex::scoped_lock lock(assignmentMutex_);
+    migrations = migrations_;
+    rebalances = rebalances_;
+    for(size_t nChannel = 0; nChannel < channels_.size(); ++nChannel)
+    {
+      Channel & channel = *channels_[nChannel];
+      ChannelStatistics & copy = statistics[nChannel];
+      boost::mutex::scoped_lock decodeLock(channel.decodeMutex_);
+      const Codecs::Decoder & decoder = channel.connection_.decoder();
+      copy.worker_ = channel.worker_;
+      copy.decodeTime_ = channel.decodeTime_;
+      copy.buffers_ = channel.buffers_;
+      copy.bytes_ = channel.receiver_->bytesProcessed();
+      copy.noBufferAvailable_ = channel.receiver_->noBufferAvailable();
+      copy.contextBytes_ = decoder.memoryUsed();
+      copy.allocatedEntries_ = decoder.dictionary().allocatedEntries();
+      copy.dictionaryEntries_ = decoder.dictionary().size();
+    }
+  }
+
+  std::vector<uint64> workerTimes(workerCount_, 0);
+  std::vector<size_t> workerChannels(workerCount_, 0);
+  size_t totalBuffers = 0;
+  size_t totalBytes = 0;
+  size_t contextBytes = 0;
+  for(size_t nChannel = 0; nChannel < statistics.size(); ++nChannel)
+  {
+    const ChannelStatistics & channel = statistics[nChannel];
+    workerTimes[channel.worker_] += channel.decodeTime_;
+    ++workerChannels[channel.worker_];
+    totalBuffers += channel.buffers_;
+    totalBytes += channel.bytes_;
+    contextBytes += channel.contextBytes_;
+  }
+
+  out << "Channel manager: " << channels_.size() << " channels on " << workerCount_ << " workers: "
+    << totalBuffers << " buffers; " << totalBytes << " bytes in " << seconds << " seconds";
+  if(seconds > 0.0)
+  {
+    out << " (" << double(totalBuffers) / seconds << " buffers/second; "
+      << double(totalBytes) / seconds / (1024. * 1024.) << " MB/second)";
+  }
+  out << '.' << std::endl;
+  out << "Channel manager: " << migrations << " channel moves in " << rebalances << " rebalances." << std::endl;
+  out << "Channel manager: decoder contexts use " << contextBytes << " bytes";
+  if(!channels_.empty())
+  {
+    out << " (" << contextBytes / channels_.size() << " per channel)";
+  }
+  out << '.' << std::endl;
+  for(size_t nWorker = 0; nWorker < workerCount_; ++nWorker)
+  {
+    out << "Worker " << nWorker << ": " << workerChannels[nWorker] << " channels";
+    if(seconds > 0.0)
+    {
+      // Decoding time of the channels it holds now; approximate after channels move.
+      std::streamsize precision = out.precision();
+      out << "; busy " << std::fixed << std::setprecision(1)
+        << 100.0 * double(workerTimes[nWorker]) / 1e9 / seconds << '%'
+        << std::resetiosflags(std::ios::fixed) << std::setprecision(precision);
+    }
+    out << '.' << std::endl;
+  }
+  for(size_t nChannel = 0; nChannel < statistics.size(); ++nChannel)
+  {
+    const ChannelStatistics & channel = statistics[nChannel];
+    const std::string & name = channels_[nChannel]->name_;
+    out << "Channel " << (name.empty() ? boost::lexical_cast<std::string>(nChannel) : name)
+      << ": worker " << channel.worker_
+      << "; " << channel.buffers_ << " buffers; "
+      << channel.bytes_ << " bytes; decoding "
+      << double(channel.decodeTime_) / 1e6 << " ms";
+    if(channel.buffers_ != 0)
+    {
+      out << " (" << channel.decodeTime_ / channel.buffers_ << " ns/buffer)";
+    }
+    out << "; all buffers busy " << channel.noBufferAvailable_ << " times"
+      << "; context " << channel.contextBytes_ << " bytes ("
+      << channel.allocatedEntries_ << " of " << channel.dictionaryEntries_ << " dictionary entries)." << std::endl;
+  }
+}
@@ -0,0 +1,172 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef CHANNELMANAGER_H
+#define CHANNELMANAGER_H
+#include "ChannelManager_fwd.h"
+#include <Common/QuickFAST_Export.h>
+#include <Application/DecoderConfiguration.h>
+#include <Application/DecoderConnection_fwd.h>
+#include <Codecs/TemplateRegistry_fwd.h>
+#include <Messages/ValueMessageBuilder_fwd.h>
+
+namespace QuickFAST{
+  namespace Application{
+    /// @brief Decode many channels with a fixed pool of worker threads.
+    ///
+    /// Each channel is a DecoderConnection configured from its own DecoderConfiguration.
+    /// All channels share one TemplateRegistry, parsed once (or supplied with
+    /// setTemplateRegistry()), which is not modified while decoding.
+    ///
+    /// The receivers run on the I/O threads (see setIoThreads()) and hand each
+    /// filled buffer to the decoding side through a lock-free handoff.
+    /// Each channel is assigned to one worker thread, which decodes all of that
+    /// channel's buffers, so the channel's dictionary sees the messages in order.
+    /// A worker polls its channels in turn; when none has work it spins, then
+    /// yields or sleeps, as selected by setWaitStrategy().
+    ///
+    /// The manager measures the time each channel spends decoding.  Every
+    /// rebalance interval the channels are reassigned so the workers' loads are
+    /// as even as possible (heaviest channel first, to the least loaded worker.)
+    /// A channel moves only between buffers: the new worker waits until the old
+    /// one has finished with it.
+    ///
+    /// Channels must use a receiver that supports a lock-free handoff
+    /// (-multicast, -tcp or -afile) and an assembler that never waits for
+    /// input in the middle of a buffer (packet assemblers, or streaming with
+    /// framed messages.)
+    ///
+    /// A channel whose builder asks to stop stops its receiver, which also
+    /// stops the I/O service if it is shared.  The manager stops when every
+    /// channel has stopped, or when stop() is called.
+    class QuickFAST_Export ChannelManager
+    {
+    public:
+      /// @brief Construct
+      /// @param workerCount how many threads decode.
+      explicit ChannelManager(size_t workerCount = 1);
+      ~ChannelManager();
+
+      /// @brief Share a prebuilt template registry among the channels.
+      ///
+      /// If this is not called the registry is parsed from the first
+      /// channel's template file.  Call before addChannel().
+      /// @param registry the registry to use
+      void setTemplateRegistry(Codecs::TemplateRegistryPtr registry);
+
+      /// @brief How many threads run the I/O service shared by the channels (default 1.)
+      ///
+      /// A channel configured with a private I/O service gets one more thread of its own.
+      void setIoThreads(size_t ioThreads);
+
+      /// @brief Pin worker n to cpus[n % cpus.size()]
+      void setWorkerCpus(const std::vector<int> & cpus);
+
+      /// @brief Name the threads (name/io/n and name/wn) so they are easy to find in top, perf, etc.
+      void setThreadName(const std::string & name);
+
+      /// @brief What an idle worker does.
+      /// @param strategy SPIN_WAIT, YIELD_WAIT or PARK_WAIT (sleep briefly)
+      /// @param spinCount how many idle passes before yielding or sleeping.
+      void setWaitStrategy(DecoderConfiguration::WaitStrategy strategy, size_t spinCount = 1000);
+
+      /// @brief How often to rebalance the channels among the workers.
+      /// @param milliseconds zero means never; the channels stay where they start (round robin.)
+      void setRebalanceInterval(size_t milliseconds);
+
+      /// @brief Add a channel.
+      ///
+      /// The channel starts receiving immediately, but nothing is decoded
+      /// until start() is called.
+      /// @param name identifies the channel in reports.
+      /// @param builder receives the channel's decoded messages, on the channel's worker thread.
+      /// @param configuration describes the channel.  The pipeline topology is ignored.
+      /// @returns the channel's index.
+      size_t addChannel(
+        const std::string & name,
+        Messages::ValueMessageBuilder & builder,
+        const DecoderConfiguration & configuration);
+
+      /// @brief Start the I/O, worker and supervisor threads.
+      void start();
+
+      /// @brief Stop all channels.  Returns immediately; use join() to wait.
+      void stop();
+
+      /// @brief Wait for all threads to finish after stop() is called, or every channel stops.
+      void join();
+
+      /// @brief start() then join().
+      void run()
+      {
+        start();
+        join();
+      }
+
+      /// @brief Reassign the channels to even out the workers' loads.
+      ///
+      /// Called periodically if a rebalance interval is set.
+      /// Uses the decoding time measured since the previous call.
+      void rebalance();
+
+      /// @brief How many channels are there?
+      size_t channelCount()const;
+
+      /// @brief Access the connection for a channel.
+      DecoderConnection & connection(size_t channel)const;
+
+      /// @brief Which worker is decoding a channel?
+      size_t workerOf(size_t channel)const;
+
+      /// @brief Statistic: How many times has a channel moved to another worker?
+      size_t migrations()const
+      {
+        return migrations_;
+      }
+
+      /// @brief Write aggregate and per-channel statistics in human readable form.
+      /// @param out is the destination
+      void report(std::ostream & out)const;
+
+    private:
+      struct Channel;
+      typedef boost::shared_ptr<Channel> ChannelPtr;
+      typedef std::vector<ChannelPtr> Channels;
+
+      void runWorker(size_t worker);
+      void runSupervisor();
+      void idle(size_t & idlePasses);
+      bool allStopped()const;
+
+    private:
+      ChannelManager(const ChannelManager &);
+      ChannelManager & operator=(const ChannelManager &);
+
+    private:
+      size_t workerCount_;
+      size_t ioThreads_;
+      std::vector<int> workerCpus_;
+      std::string threadName_;
+      DecoderConfiguration::WaitStrategy waitStrategy_;
+      size_t spinCount_;
+      size_t rebalanceInterval_;
+      Codecs::TemplateRegistryPtr registry_;
+      Channels channels_;
+      /// Protects the channel assignments.
+      mutable boost::mutex assignmentMutex_;
+      volatile bool stopping_;
+      bool started_;
+      size_t migrations_;
+      size_t rebalances_;
+      uint64 startTime_;
+      uint64 stopTime_;
+      boost::thread_group workers_;
+      boost::scoped_ptr<boost::thread> supervisor_;
+    };
+  }
+}
+#endif // CHANNELMANAGER_H
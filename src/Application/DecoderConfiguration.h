@@ -31,7 +31,8 @@ namespace QuickFAST{
       enum AssemblerType{
         MESSAGE_PER_PACKET_ASSEMBLER = DecoderConfigurationEnums::MESSAGE_PER_PACKET_ASSEMBLER,
         STREAMING_ASSEMBLER = DecoderConfigurationEnums::STREAMING_ASSEMBLER,
-        UNSPECIFIED_ASSEMBLER = DecoderConfigurationEnums::UNSPECIFIED_ASSEMBLER
+        UNSPECIFIED_ASSEMBLER = DecoderConfigurationEnums::UNSPECIFIED_ASSEMBLER,
+        SEQUENCING_ASSEMBLER = DecoderConfigurationEnums::SEQUENCING_ASSEMBLER
       };
 
       /// @brief What type of receiver supplies incoming buffers.
@@ -44,7 +45,28 @@ namespace QuickFAST{
         PCAPFILE_RECEIVER = DecoderConfigurationEnums::PCAPFILE_RECEIVER,
         ASYNCHRONOUS_FILE_RECEIVER = DecoderConfigurationEnums::ASYNCHRONOUS_FILE_RECEIVER,
         BUFFER_RECEIVER = DecoderConfigurationEnums::BUFFER_RECEIVER,
-        UNSPECIFIED_RECEIVER = DecoderConfigurationEnums::UNSPECIFIED_RECEIVER
+        UNSPECIFIED_RECEIVER = DecoderConfigurationEnums::UNSPECIFIED_RECEIVER,
+        BUSYPOLL_RECEIVER = DecoderConfigurationEnums::BUSYPOLL_RECEIVER,
+        MMAPFILE_RECEIVER = DecoderConfigurationEnums::MMAPFILE_RECEIVER,
+        EPOLL_RECEIVER = DecoderConfigurationEnums::EPOLL_RECEIVER,
+        PACKET_RING_RECEIVER = DecoderConfigurationEnums::PACKET_RING_RECEIVER
+      };
+
+      /// @brief How receiving, decoding and delivering messages are divided among threads.
+      enum PipelineTopology
+      {
+        SHARED_PIPELINE = DecoderConfigurationEnums::SHARED_PIPELINE,
+        INLINE_PIPELINE = DecoderConfigurationEnums::INLINE_PIPELINE,
+        TWO_STAGE_PIPELINE = DecoderConfigurationEnums::TWO_STAGE_PIPELINE,
+        THREE_STAGE_PIPELINE = DecoderConfigurationEnums::THREE_STAGE_PIPELINE
+      };
+
+      /// @brief What a pipeline stage does when it has no work.
+      enum WaitStrategy
+      {
+        SPIN_WAIT = DecoderConfigurationEnums::SPIN_WAIT,
+        YIELD_WAIT = DecoderConfigurationEnums::YIELD_WAIT,
+        PARK_WAIT = DecoderConfigurationEnums::PARK_WAIT
       };
 
     public:
@@ -101,21 +123,50 @@ namespace QuickFAST{
         , echoMessage_(true)
         , echoField_(false)
         , pcapWordSize_(0)
+        , pcapFilterPort_(0)
         , packetHeaderType_(NO_HEADER)
         , packetHeaderMessageSizeBytes_(0)
         , packetHeaderBigEndian_(true)
         , packetHeaderPrefixCount_(0)
         , packetHeaderSuffixCount_(0)
+        , packetHeaderSequenceOffset_(0)
+        , packetHeaderSequenceLength_(4)
         , messageHeaderType_(NO_HEADER)
         , messageHeaderMessageSizeBytes_(0)
         , messageHeaderBigEndian_(true)
         , messageHeaderPrefixCount_(0)
         , messageHeaderSuffixCount_(0)
         , assemblerType_(UNSPECIFIED_ASSEMBLER)
-        , waitForCompleteMessage_(false)
+        , lookAheadCount_(100)
+        , arbitrationWindow_(4096)
+        , waitForCompleteMessage_(true)
         , receiverType_(UNSPECIFIED_RECEIVER)
         , bufferSize_(1500)
         , bufferCount_(2)
+        , receiveBatch_(1)
+        , readsInFlight_(4)
+        , directIO_(false)
+        , busyPoll_(0)
+        , receiverCpu_(-1)
+        , ringBlocks_(16)
+        , ringBlockSize_(1024 * 1024)
+        , dictionaryPerFeed_(false)
+        , tcpBufferSize_(65536)
+        , tcpReadBuffers_(1)
+        , tcpNoDelay_(false)
+        , socketReceiveBuffer_(0)
+        , socketReceiveLowWater_(0)
+        , slabBuffers_(false)
+        , hugePages_(false)
+        , receiveTimestamps_(false)
+        , pipelineTopology_(SHARED_PIPELINE)
+        , waitStrategy_(PARK_WAIT)
+        , spinCount_(1000)
+        , messageQueueSize_(1024)
+        , decoderCpu_(-1)
+        , consumerCpu_(-1)
+        , stageLatency_(false)
+        , numaPlacement_(false)
         , nonstandard_(0)
         , privateIOService_(false)
         , testSkip_(0)
@@ -137,23 +188,57 @@ namespace QuickFAST{
         , echoMessage_(rhs.echoMessage_)
         , echoField_(rhs.echoField_)
         , pcapWordSize_(rhs.pcapWordSize_)
+        , pcapFilterIP_(rhs.pcapFilterIP_)
+        , pcapFilterPort_(rhs.pcapFilterPort_)
         , packetHeaderType_(rhs.packetHeaderType_)
         , packetHeaderMessageSizeBytes_(rhs.packetHeaderMessageSizeBytes_)
         , packetHeaderBigEndian_(rhs.packetHeaderBigEndian_)
         , packetHeaderPrefixCount_(rhs.packetHeaderPrefixCount_)
         , packetHeaderSuffixCount_(rhs.packetHeaderSuffixCount_)
+        , packetHeaderSequenceOffset_(rhs.packetHeaderSequenceOffset_)
+        , packetHeaderSequenceLength_(rhs.packetHeaderSequenceLength_)
         , messageHeaderType_(rhs.messageHeaderType_)
         , messageHeaderMessageSizeBytes_(rhs.messageHeaderMessageSizeBytes_)
         , messageHeaderBigEndian_(rhs.messageHeaderBigEndian_)
         , messageHeaderPrefixCount_(rhs.messageHeaderPrefixCount_)
         , messageHeaderSuffixCount_(rhs.messageHeaderSuffixCount_)
         , assemblerType_(rhs.assemblerType_)
+        , lookAheadCount_(rhs.lookAheadCount_)
+        , arbitrationWindow_(rhs.arbitrationWindow_)
         , waitForCompleteMessage_(rhs.waitForCompleteMessage_)
         , receiverType_(rhs.receiverType_)
+        , multicastFeeds_(rhs.multicastFeeds_)
         , hostName_(rhs.hostName_)
         , portName_(rhs.portName_)
         , bufferSize_(rhs.bufferSize_)
         , bufferCount_(rhs.bufferCount_)
+        , receiveBatch_(rhs.receiveBatch_)
+        , readsInFlight_(rhs.readsInFlight_)
+        , directIO_(rhs.directIO_)
+        , busyPoll_(rhs.busyPoll_)
+        , receiverCpu_(rhs.receiverCpu_)
+        , ringInterface_(rhs.ringInterface_)
+        , ringBlocks_(rhs.ringBlocks_)
+        , ringBlockSize_(rhs.ringBlockSize_)
+        , dictionaryPerFeed_(rhs.dictionaryPerFeed_)
+        , tcpBufferSize_(rhs.tcpBufferSize_)
+        , tcpReadBuffers_(rhs.tcpReadBuffers_)
+        , tcpNoDelay_(rhs.tcpNoDelay_)
+        , socketReceiveBuffer_(rhs.socketReceiveBuffer_)
+        , socketReceiveLowWater_(rhs.socketReceiveLowWater_)
+        , slabBuffers_(rhs.slabBuffers_)
+        , hugePages_(rhs.hugePages_)
+        , receiveTimestamps_(rhs.receiveTimestamps_)
+        , pipelineTopology_(rhs.pipelineTopology_)
+        , waitStrategy_(rhs.waitStrategy_)
+        , spinCount_(rhs.spinCount_)
+        , messageQueueSize_(rhs.messageQueueSize_)
+        , decoderCpu_(rhs.decoderCpu_)
+        , consumerCpu_(rhs.consumerCpu_)
+        , stageLatency_(rhs.stageLatency_)
+        , ioCpus_(rhs.ioCpus_)
+        , threadName_(rhs.threadName_)
+        , numaPlacement_(rhs.numaPlacement_)
         , nonstandard_(rhs.nonstandard_)
         , privateIOService_(rhs.privateIOService_)
         , testSkip_(rhs.testSkip_)
@@ -240,6 +325,18 @@ namespace QuickFAST{
         return pcapWordSize_;
       }
 
+      /// @brief Deliver only PCap packets sent to this address (empty means any address).
+      const std::string & pcapFilterIP()const
+      {
+        return pcapFilterIP_;
+      }
+
+      /// @brief Deliver only PCap packets sent to this port (zero means any port).
+      unsigned short pcapFilterPort()const
+      {
+        return pcapFilterPort_;
+      }
+
       /// @brief What type of header is expected for each packet
       HeaderType packetHeaderType()const
       {
@@ -270,6 +367,18 @@ namespace QuickFAST{
         return packetHeaderSuffixCount_;
       }
 
+      /// @brief For FIXED_HEADER offset of the sequence number within the header.
+      size_t packetHeaderSequenceOffset()const
+      {
+        return packetHeaderSequenceOffset_;
+      }
+
+      /// @brief For FIXED_HEADER how many bytes in the sequence number.
+      size_t packetHeaderSequenceLength()const
+      {
+        return packetHeaderSequenceLength_;
+      }
+
       /// @brief What type of header is expected for each message.
       HeaderType messageHeaderType()const
       {
@@ -319,6 +428,18 @@ namespace QuickFAST{
         return assemblerType_;
       }
 
+      /// @brief For SEQUENCING_ASSEMBLER how many out-of-order packets can be held.
+      size_t lookAheadCount()const
+      {
+        return lookAheadCount_;
+      }
+
+      /// @brief For SEQUENCING_ASSEMBLER how many sequence numbers the line arbitrator remembers.
+      size_t arbitrationWindow()const
+      {
+        return arbitrationWindow_;
+      }
+
       /// @brief How many multicast feeds are configured?
       size_t multicastCount()const
       {
@@ -362,9 +483,14 @@ namespace QuickFAST{
       }
 
       /// @brief For MulticastReceiver selects the NIC on which to subscribe/listen
+      /// Feeds that do not specify a NIC use the first feed's.
       const std::string & listenInterfaceIP(size_t index = 0)const
       {
         needMulticastFeed();
+        if(multicastFeeds_[index].listenInterfaceIP_.empty())
+        {
+          return multicastFeeds_[0].listenInterfaceIP_;
+        }
         return multicastFeeds_[index].listenInterfaceIP_;
       }
 
@@ -374,6 +500,10 @@ namespace QuickFAST{
         needMulticastFeed();
         if(multicastFeeds_[index].bindIP_.empty())
         {
+          if(multicastFeeds_[index].listenInterfaceIP_.empty())
+          {
+            return multicastBindIP(0);
+          }
           return multicastFeeds_[index].listenInterfaceIP_;
         }
         return multicastFeeds_[index].bindIP_;
@@ -401,13 +531,193 @@ namespace QuickFAST{
       }
 
       /// @brief How many communication buffers to allocate.
-      /// For StreamingAssembler with waitForCompleteMessage_ specified,
-      /// bufferCount_ * bufferSize_ must equal or exceed maximum message size.
       size_t bufferCount()const
       {
         return bufferCount_;
       }
 
+      /// @brief For MulticastReceiver, the maximum number of datagrams per receive call.
+      /// Values greater than one enable batched receives (recvmmsg) on Linux.
+      /// Batches are limited by the number of idle buffers, so bufferCount()
+      /// should be larger than this.
+      size_t receiveBatch()const
+      {
+        return receiveBatch_;
+      }
+
+      /// @brief For AsynchFileReceiver, how many reads may be in flight at once.
+      /// On Linux the reads are queued to io_uring.
+      /// Limited by the number of idle buffers.
+      size_t readsInFlight()const
+      {
+        return readsInFlight_;
+      }
+
+      /// @brief For AsynchFileReceiver, bypass the page cache (O_DIRECT or FILE_FLAG_NO_BUFFERING).
+      bool directIO()const
+      {
+        return directIO_;
+      }
+
+      /// @brief For BusyPollReceiver, microseconds the kernel may busy poll (SO_BUSY_POLL).
+      /// Zero means don't ask.
+      int busyPoll()const
+      {
+        return busyPoll_;
+      }
+
+      /// @brief For BusyPollReceiver or a pipeline, the CPU to which the receiving thread is pinned.
+      /// Negative means don't pin.
+      int receiverCpu()const
+      {
+        return receiverCpu_;
+      }
+
+      /// @brief For PacketRingReceiver, the network interface to read.
+      /// Empty means every interface.
+      const std::string & ringInterface()const
+      {
+        return ringInterface_;
+      }
+
+      /// @brief For PacketRingReceiver, the number of blocks in the ring.
+      size_t ringBlocks()const
+      {
+        return ringBlocks_;
+      }
+
+      /// @brief For PacketRingReceiver, the size of each block in the ring.
+      /// A block is handed over when it is full or after a short timeout.
+      size_t ringBlockSize()const
+      {
+        return ringBlockSize_;
+      }
+
+      /// @brief For EpollMulticastReceiver, decode each feed with its own dictionary.
+      bool dictionaryPerFeed()const
+      {
+        return dictionaryPerFeed_;
+      }
+
+      /// @brief For TCPReceiver, the size of each communication buffer.
+      /// Used instead of bufferSize() so a busy stream is read in large pieces.
+      size_t tcpBufferSize()const
+      {
+        return tcpBufferSize_;
+      }
+
+      /// @brief For TCPReceiver, the maximum number of buffers filled by one read.
+      /// Values greater than one enable scatter reads (readv) on Linux.
+      size_t tcpReadBuffers()const
+      {
+        return tcpReadBuffers_;
+      }
+
+      /// @brief For TCPReceiver, disable the Nagle algorithm (TCP_NODELAY)?
+      bool tcpNoDelay()const
+      {
+        return tcpNoDelay_;
+      }
+
+      /// @brief For TCPReceiver, the kernel receive buffer size (SO_RCVBUF).
+      /// Zero means use the system default.
+      int socketReceiveBuffer()const
+      {
+        return socketReceiveBuffer_;
+      }
+
+      /// @brief For TCPReceiver, the minimum number of bytes for a read to complete (SO_RCVLOWAT).
+      /// Zero means use the system default.
+      int socketReceiveLowWater()const
+      {
+        return socketReceiveLowWater_;
+      }
+
+      /// @brief Allocate the communication buffers from one cache-aligned region.
+      bool slabBuffers()const
+      {
+        return slabBuffers_;
+      }
+
+      /// @brief Back the communication buffers with huge pages (implies slabBuffers)
+      bool hugePages()const
+      {
+        return hugePages_;
+      }
+
+      /// @brief Record the time each packet was received and report it to the builder.
+      bool receiveTimestamps()const
+      {
+        return receiveTimestamps_;
+      }
+
+      /// @brief How receiving, decoding and delivering are divided among threads.
+      PipelineTopology pipelineTopology()const
+      {
+        return pipelineTopology_;
+      }
+
+      /// @brief What the downstream stage of a pipeline does when it has no work.
+      WaitStrategy waitStrategy()const
+      {
+        return waitStrategy_;
+      }
+
+      /// @brief How many times a pipeline stage checks for work before it yields or parks.
+      size_t spinCount()const
+      {
+        return spinCount_;
+      }
+
+      /// @brief For THREE_STAGE_PIPELINE, how many decoded messages may wait for the consumer.
+      size_t messageQueueSize()const
+      {
+        return messageQueueSize_;
+      }
+
+      /// @brief For TWO_STAGE_PIPELINE or THREE_STAGE_PIPELINE, the CPU to which the decoding thread is pinned.
+      /// Negative means don't pin.
+      int decoderCpu()const
+      {
+        return decoderCpu_;
+      }
+
+      /// @brief For THREE_STAGE_PIPELINE, the CPU to which the consumer thread is pinned.
+      /// Negative means don't pin.
+      int consumerCpu()const
+      {
+        return consumerCpu_;
+      }
+
+      /// @brief Measure how long buffers and messages wait between pipeline stages.
+      bool stageLatency()const
+      {
+        return stageLatency_;
+      }
+
+      /// @brief The CPUs to which the threads running the I/O service are pinned.
+      ///
+      /// A CPU list such as "0-3,8".  Thread n is pinned to the n'th CPU in the list.
+      /// Empty means don't pin.
+      const std::string & ioCpus()const
+      {
+        return ioCpus_;
+      }
+
+      /// @brief The base name for the threads that receive, decode and deliver.
+      /// Empty means don't name the threads.
+      const std::string & threadName()const
+      {
+        return threadName_;
+      }
+
+      /// @brief Place the buffers and the decoder's dictionary on the NUMA
+      /// node of the CPUs that use them.
+      bool numaPlacement()const
+      {
+        return numaPlacement_;
+      }
+
       /// @brief Support (nonstandard) presence attribute on length instruction
       unsigned long nonstandard() const
       {
@@ -510,6 +820,18 @@ namespace QuickFAST{
         pcapWordSize_ = pcapWordSize;
       }
 
+      /// @brief Deliver only PCap packets sent to this address (empty means any address).
+      void setPcapFilterIP(const std::string & pcapFilterIP)
+      {
+        pcapFilterIP_ = pcapFilterIP;
+      }
+
+      /// @brief Deliver only PCap packets sent to this port (zero means any port).
+      void setPcapFilterPort(unsigned short pcapFilterPort)
+      {
+        pcapFilterPort_ = pcapFilterPort;
+      }
+
       ////////////////////////////////////////////
       // HEADER BACKWARD COMPATIBILITY (DEPRECATED)
 
@@ -582,6 +904,16 @@ namespace QuickFAST{
         packetHeaderSuffixCount_ = headerSuffixCount;
 
       }
+
+      /// @brief For packet FIXED_HEADER where to find the sequence number
+      /// @param sequenceOffset is the byte offset of the sequence number within the header.
+      /// @param sequenceLength is the size of the sequence number in bytes.
+      void setPacketHeaderSequence(size_t sequenceOffset, size_t sequenceLength)
+      {
+        packetHeaderSequenceOffset_ = sequenceOffset;
+        packetHeaderSequenceLength_ = sequenceLength;
+      }
+
       /// @brief What type of header is expected for each message.
       void setMessageHeaderType(HeaderType headerType)
       {
@@ -633,6 +965,18 @@ namespace QuickFAST{
         assemblerType_ = assemblerType;
       }
 
+      /// @brief For SEQUENCING_ASSEMBLER how many out-of-order packets can be held.
+      void setLookAheadCount(size_t lookAheadCount)
+      {
+        lookAheadCount_ = lookAheadCount;
+      }
+
+      /// @brief For SEQUENCING_ASSEMBLER how many sequence numbers the line arbitrator remembers.
+      void setArbitrationWindow(size_t arbitrationWindow)
+      {
+        arbitrationWindow_ = arbitrationWindow;
+      }
+
       /// @brief For MulticastReceiver the dotted IP of the multicast group
       void setMulticastGroupIP(const std::string & multicastGroupIP)
       {
@@ -647,6 +991,28 @@ namespace QuickFAST{
         multicastFeeds_[0].portNumber_ = portNumber;
       }
 
+      /// @brief Add a multicast feed.
+      ///
+      /// The first feed added replaces the default feed.  Later feeds
+      /// listen on the first feed's NIC and bind address.
+      /// @param name identifies the feed
+      /// @param multicastGroupIP the dotted IP of the multicast group
+      /// @param portNumber the port number of the multicast group
+      void addMulticastFeed(const std::string & name, const std::string & multicastGroupIP, unsigned short portNumber)
+      {
+        needMulticastFeed();
+        if(multicastFeeds_.size() == 1 && multicastFeeds_[0].name_ == DEFAULT_MULTICAST_NAME)
+        {
+          multicastFeeds_[0].name_ = name;
+          multicastFeeds_[0].groupIP_ = multicastGroupIP;
+        }
+        else
+        {
+          multicastFeeds_.push_back(MulticastFeed(name, multicastGroupIP, portNumber, "", ""));
+        }
+        multicastFeeds_.back().portNumber_ = portNumber;
+      }
+
       /// @brief For MulticastReceiver selects the NIC on which to subscribe/listen
       void setListenInterfaceIP(const std::string & listenInterfaceIP)
       {
@@ -682,13 +1048,180 @@ namespace QuickFAST{
       }
 
       /// @brief How many communication buffers to allocate.
-      /// For StreamingAssembler with waitForCompleteMessage_ specified,
-      /// bufferCount_ * bufferSize_ must equal or exceed maximum message size.
       void setBufferCount(size_t bufferCount)
       {
         bufferCount_ = bufferCount;
       }
 
+      /// @brief For MulticastReceiver, the maximum number of datagrams per receive call.
+      /// Values greater than one enable batched receives (recvmmsg) on Linux.
+      void setReceiveBatch(size_t receiveBatch)
+      {
+        receiveBatch_ = receiveBatch;
+      }
+
+      /// @brief For AsynchFileReceiver, how many reads may be in flight at once.
+      void setReadsInFlight(size_t readsInFlight)
+      {
+        readsInFlight_ = readsInFlight;
+      }
+
+      /// @brief For AsynchFileReceiver, bypass the page cache.
+      void setDirectIO(bool directIO)
+      {
+        directIO_ = directIO;
+      }
+
+      /// @brief For BusyPollReceiver, microseconds the kernel may busy poll (SO_BUSY_POLL).
+      void setBusyPoll(int busyPoll)
+      {
+        busyPoll_ = busyPoll;
+      }
+
+      /// @brief For BusyPollReceiver or a pipeline, the CPU to which the receiving thread is pinned.
+      void setReceiverCpu(int receiverCpu)
+      {
+        receiverCpu_ = receiverCpu;
+      }
+
+      /// @brief For PacketRingReceiver, the network interface to read.
+      void setRingInterface(const std::string & ringInterface)
+      {
+        ringInterface_ = ringInterface;
+      }
+
+      /// @brief For PacketRingReceiver, the number of blocks in the ring.
+      void setRingBlocks(size_t ringBlocks)
+      {
+        ringBlocks_ = ringBlocks;
+      }
+
+      /// @brief For PacketRingReceiver, the size of each block in the ring.
+      void setRingBlockSize(size_t ringBlockSize)
+      {
+        ringBlockSize_ = ringBlockSize;
+      }
+
+      /// @brief For EpollMulticastReceiver, decode each feed with its own dictionary.
+      void setDictionaryPerFeed(bool dictionaryPerFeed)
+      {
+        dictionaryPerFeed_ = dictionaryPerFeed;
+      }
+
+      /// @brief For TCPReceiver, the size of each communication buffer.
+      void setTcpBufferSize(size_t tcpBufferSize)
+      {
+        tcpBufferSize_ = tcpBufferSize;
+      }
+
+      /// @brief For TCPReceiver, the maximum number of buffers filled by one read.
+      void setTcpReadBuffers(size_t tcpReadBuffers)
+      {
+        tcpReadBuffers_ = tcpReadBuffers;
+      }
+
+      /// @brief For TCPReceiver, disable the Nagle algorithm (TCP_NODELAY)?
+      void setTcpNoDelay(bool tcpNoDelay)
+      {
+        tcpNoDelay_ = tcpNoDelay;
+      }
+
+      /// @brief For TCPReceiver, the kernel receive buffer size (SO_RCVBUF).
+      void setSocketReceiveBuffer(int socketReceiveBuffer)
+      {
+        socketReceiveBuffer_ = socketReceiveBuffer;
+      }
+
+      /// @brief For TCPReceiver, the minimum number of bytes for a read to complete (SO_RCVLOWAT).
+      void setSocketReceiveLowWater(int socketReceiveLowWater)
+      {
+        socketReceiveLowWater_ = socketReceiveLowWater;
+      }
+
+      /// @brief Allocate the communication buffers from one cache-aligned region.
+      void setSlabBuffers(bool slabBuffers)
+      {
+        slabBuffers_ = slabBuffers;
+      }
+
+      /// @brief Back the communication buffers with huge pages if possible.
+      void setHugePages(bool hugePages)
+      {
+        hugePages_ = hugePages;
+        if(hugePages)
+        {
+          slabBuffers_ = true;
+        }
+      }
+
+      /// @brief Record the time each packet was received and report it to the builder.
+      void setReceiveTimestamps(bool receiveTimestamps)
+      {
+        receiveTimestamps_ = receiveTimestamps;
+      }
+
+      /// @brief How receiving, decoding and delivering are divided among threads.
+      void setPipelineTopology(PipelineTopology pipelineTopology)
+      {
+        pipelineTopology_ = pipelineTopology;
+      }
+
+      /// @brief What the downstream stage of a pipeline does when it has no work.
+      void setWaitStrategy(WaitStrategy waitStrategy)
+      {
+        waitStrategy_ = waitStrategy;
+      }
+
+      /// @brief How many times a pipeline stage checks for work before it yields or parks.
+      void setSpinCount(size_t spinCount)
+      {
+        spinCount_ = spinCount;
+      }
+
+      /// @brief For THREE_STAGE_PIPELINE, how many decoded messages may wait for the consumer.
+      void setMessageQueueSize(size_t messageQueueSize)
+      {
+        messageQueueSize_ = messageQueueSize;
+      }
+
+      /// @brief For TWO_STAGE_PIPELINE or THREE_STAGE_PIPELINE, the CPU to which the decoding thread is pinned.
+      void setDecoderCpu(int decoderCpu)
+      {
+        decoderCpu_ = decoderCpu;
+      }
+
+      /// @brief For THREE_STAGE_PIPELINE, the CPU to which the consumer thread is pinned.
+      void setConsumerCpu(int consumerCpu)
+      {
+        consumerCpu_ = consumerCpu;
+      }
+
+      /// @brief Measure how long buffers and messages wait between pipeline stages.
+      void setStageLatency(bool stageLatency)
+      {
+        stageLatency_ = stageLatency;
+      }
+
+      /// @brief The CPUs to which the threads running the I/O service are pinned.
+      /// @param ioCpus a CPU list such as "0-3,8"
+      void setIoCpus(const std::string & ioCpus)
+      {
+        ioCpus_ = ioCpus;
+      }
+
+      /// @brief The base name for the threads that receive, decode and deliver.
+      void setThreadName(const std::string & threadName)
+      {
+        threadName_ = threadName;
+      }
+
+      /// @brief Place the buffers and the decoder's dictionary on the NUMA
+      /// node of the CPUs that use them.
+      void setNumaPlacement(bool numaPlacement)
+      {
+        numaPlacement_ = numaPlacement;
+      }
+
       /// @brief Support nonstandard FAST featurs
       /// @param nonstandard is an 'or' of the nonstandard features that will be allowed
       ///      1:  if the presence attribute is allowed on length instructoin
@@ -753,10 +1286,18 @@ namespace QuickFAST{
         out << std::endl;
         out << "  -file file           : Input from FAST message file." << std::endl;
         out << "  -afile file          : Use asynchronous reads from FAST message file." << std::endl;
+        out << "                         (Windows overlapped I/O or Linux io_uring)." << std::endl;
+        out << "  -afilereads count    : With -afile, how many reads may be in flight" << std::endl;
+        out << "                         (default " << readsInFlight() << "; Linux only)." << std::endl;
+        out << "  -directio            : With -afile, bypass the operating system's file cache." << std::endl;
+        out << "                         Use -slab and a -buffersize that is a multiple of 4096." << std::endl;
         out << "  -bfile file          : Buffer entire FAST message file in memory." << std::endl;
-        out << "  -pcap file           : Input from PCap FAST message file." << std::endl;
+        out << "  -mfile file          : Map FAST message file into memory (no copying)." << std::endl;
+        out << "  -pcap file           : Input from PCap or PCapNG FAST message file." << std::endl;
         out << "  -pcapsource [64|32]    : Word size of the machine where the PCap data was captured." << std::endl;
-        out << "                           Defaults to the current platform." << std::endl;
+        out << "                           Defaults to 32 (standard pcap format)." << std::endl;
+        out << "  -pcapfilter ip:port  : Use only PCap packets sent to this group and/or port." << std::endl;
+        out << "                           Either part may be empty: \"224.1.2.3\" or \":30001\"" << std::endl;
         out << "  -mname name          : Declare a new multicast feed with the given name." << std::endl;
         out << "                         May appear multiple times. The first occurrence names the default feed." << std::endl;
         out << "                         Each subsequent occurrence starts and names a new feed." << std::endl;
@@ -769,12 +1310,52 @@ namespace QuickFAST{
         out << "                           on which to subscribe and listen." << std::endl;
         out << "                           0.0.0.0 means pick any NIC." << std::endl;
         out << "  -mbind ip            : Multicast bind address.  Defaults to listenIP. Override if you dare." << std::endl;
+        out << "  -busypoll ip:port    : Input from Multicast using a busy polling receiver." << std::endl;
+        out << "                         One thread spins on the socket and decodes each packet" << std::endl;
+        out << "                         as it arrives.  Uses -mlisten and -mbind." << std::endl;
+        out << "  -sobusypoll usec     : With -busypoll ask the kernel to busy poll the NIC (Linux only)." << std::endl;
+        out << "  -epoll ip:port[/n],... : Input from many multicast groups read by one thread (Linux only)." << std::endl;
+        out << "                         ip:port/n subscribes to n consecutive groups on the same port." << std::endl;
+        out << "                         Uses -mlisten, -mbind, -receivebatch and -rcpu." << std::endl;
+        out << "  -feeddict            : With -epoll or -ring decode each feed with its own dictionary." << std::endl;
+        out << "  -ring ip:port[/n],... : Input from UDP feeds read from a memory mapped packet ring" << std::endl;
+        out << "                         by one thread (Linux only; needs CAP_NET_RAW)." << std::endl;
+        out << "                         ip may be multicast or unicast.  Uses -mlisten and -rcpu." << std::endl;
+        out << "  -ringif name         : With -ring, the network interface to read (default all)." << std::endl;
+        out << "  -ringblocks n        : With -ring, blocks in the ring (default " << ringBlocks() << ")." << std::endl;
+        out << "  -ringblocksize bytes : With -ring, size of each block (default " << ringBlockSize() << ")." << std::endl;
+        out << "  -rcpu n              : With -busypoll, -epoll, -ring or -pipeline pin the receiving thread to CPU n (Linux only)." << std::endl;
         out << "  -tcp host:port       : Input from TCP/IP.  Connect to \"host\" name or" << std::endl;
         out << "                         dotted IP on named or numbered port." << std::endl;
+        out << "  -tcpbuffer size      : With -tcp, size of each receive buffer (default " << tcpBufferSize() << ")." << std::endl;
+        out << "                         Replaces -buffersize for TCP; 64K to 1M is typical." << std::endl;
+        out << "  -tcpreadv count      : With -tcp, fill up to count buffers per read (Linux only)." << std::endl;
+        out << "                         Use more -buffers than count." << std::endl;
+        out << "  -tcpnodelay          : With -tcp, disable the Nagle algorithm (TCP_NODELAY)." << std::endl;
+        out << "  -sorcvbuf bytes      : With -tcp, kernel receive buffer size (SO_RCVBUF)." << std::endl;
+        out << "  -sorcvlowat bytes    : With -tcp, don't complete a read until this many bytes" << std::endl;
+        out << "                         have arrived (SO_RCVLOWAT)." << std::endl;
         out << std::endl;
         out << "  -threads n           : Number of threads to service incoming messages." << std::endl;
         out << "                         Valid for multicast or tcp" << std::endl;
         out << "                         Must be >= 1.   Default is 1." << std::endl;
+        out << "  -pipeline topology   : Divide the work among threads (default shared):" << std::endl;
+        out << "                           shared: any thread running the I/O service may decode." << std::endl;
+        out << "                           inline: one thread receives, decodes and delivers." << std::endl;
+        out << "                           two:    receive thread -> decode and deliver thread." << std::endl;
+        out << "                           three:  receive thread -> decode thread -> deliver thread." << std::endl;
+        out << "                         two and three require -multicast, -tcp or -afile." << std::endl;
+        out << "  -wait spin|yield|park: What an idle pipeline stage does after spinning (default park)." << std::endl;
+        out << "  -spincount n         : Checks for work before an idle stage yields or parks (default " << spinCount() << ")." << std::endl;
+        out << "  -msgqueue n          : With -pipeline three, decoded messages waiting for delivery (default " << messageQueueSize() << ")." << std::endl;
+        out << "  -dcpu n              : With -pipeline two or three, pin the decoding thread to CPU n (Linux only)." << std::endl;
+        out << "  -ccpu n              : With -pipeline three, pin the delivering thread to CPU n (Linux only)." << std::endl;
+        out << "  -stagelatency        : Measure how long data waits between pipeline stages." << std::endl;
+        out << "  -iocpus list         : Pin the threads running the I/O service to CPUs (Linux only)." << std::endl;
+        out << "                         Thread n uses the n'th CPU in the list, e.g. 0-3,8." << std::endl;
+        out << "  -threadname name     : Name the threads so they can be found in top, perf, etc." << std::endl;
+        out << "  -numa                : Place buffers and the decoder's dictionary on the NUMA node" << std::endl;
+        out << "                         of the receiving (-rcpu or -iocpus) and decoding (-dcpu) CPUs." << std::endl;
         out << "  -privateioservice    : Create a separate I/O service for the receiver." << std::endl;
         out << "                         This doesn't do much for this program, but it helps with testing." << std::endl;
         out << "                         The option would be used when you need multiple independent connections in the" << std::endl;
@@ -782,14 +1363,23 @@ namespace QuickFAST{
         out << std::endl;
         out << "  -streaming [no]block : Message boundaries do not match packet" << std::endl;
         out << "                         boundaries (default if TCP/IP or raw file)." << std::endl;
-        out << "                         noblock means decoding doesn't start until" << std::endl;
+        out << "                         noblock (the default) means decoding doesn't start until" << std::endl;
         out << "                           a complete message has arrived." << std::endl;
         out << "                           No thread will be blocked waiting" << std::endl;
         out << "                           input if this option is used." << std::endl;
+        out << "                           Requires a message header with the message size (-hfix)." << std::endl;
         out << "                         block means the decoding starts immediately" << std::endl;
         out << "                           The decoding thread may block for more data." << std::endl;
         out << "  -datagram            : Message boundaries match packet boundaries" << std::endl;
         out << "                         (default if Multicast or PCap file)." << std::endl;
+        out << "  -arbitrate n         : Like -datagram, but packets are put in sequence" << std::endl;
+        out << "                         and duplicates from redundant (A/B) feeds are" << std::endl;
+        out << "                         discarded.  Up to n packets may arrive early" << std::endl;
+        out << "                         (rounded up to a power of two)." << std::endl;
+        out << "                         Requires -pfix with -pseq." << std::endl;
+        out << "  -arbwindow n         : With -arbitrate, remember n sequence numbers when" << std::endl;
+        out << "                         discarding duplicates (default " << arbitrationWindow() << ")." << std::endl;
+        out << "                         Should exceed the largest gap between the lines." << std::endl;
         out << std::endl;
         out << "                       MESSAGE HEADER OPTIONS" << std::endl;
         out << "  -hnone               : No header(preamble) before each FAST message (default)." << std::endl;
@@ -812,6 +1402,8 @@ namespace QuickFAST{
         out << "                         block size." << std::endl;
         out << "  -psuffix n           : 'n' bytes (fixed) or fields (FAST) follow" << std::endl;
         out << "                         block size." << std::endl;
+        out << "  -pseq offset length  : fixed size header contains a sequence number of" << std::endl;
+        out << "                         'length' bytes starting 'offset' bytes into the header." << std::endl;
         out << std::endl;
         out << "  -buffersize size     : Size of communication buffers." << std::endl;
         out << "                         For \"-datagram\" largest expected message." << std::endl;
@@ -819,6 +1411,13 @@ namespace QuickFAST{
         out << "  -buffers count       : Number of buffers. (default " << bufferCount() << ")." << std::endl;
         out << "                         For \"-streaming block\" buffersize * buffers must" << std::endl;
         out << "                         exceed largest expected message." << std::endl;
+        out << "  -slab                : Allocate all buffers from one cache-aligned block of memory." << std::endl;
+        out << "  -hugepages           : Like -slab, but use 2MB pages if available (Linux only)." << std::endl;
+        out << "  -timestamps          : Report when each packet arrived to the message builder." << std::endl;
+        out << "                         Kernel timestamps for sockets (Linux only); capture time for PCap." << std::endl;
+        out << "  -mbatch count        : Receive up to count multicast packets per system call" << std::endl;
+        out << "                         (Linux only; default " << receiveBatch() << ")." << std::endl;
+        out << "                         Use more -buffers than count." << std::endl;
         out << std::endl;
         out << "  -e file              : Echo input to file:" << std::endl;
         out << "    -ehex                : Echo as hexadecimal (default)." << std::endl;
@@ -921,12 +1520,28 @@ namespace QuickFAST{
           setAsynchReads(true);
           consumed = 2;
         }
+        else if(opt == "-afilereads" && argc > 1)
+        {
+          setReadsInFlight(boost::lexical_cast<size_t>(argv[1]));
+          consumed = 2;
+        }
+        else if(opt == "-directio")
+        {
+          setDirectIO(true);
+          consumed = 1;
+        }
         else if(opt == "-bfile" && argc > 1)
         {
           setReceiverType(BUFFERED_RAWFILE_RECEIVER);
           setFastFileName(argv[1]);
           consumed = 2;
         }
+        else if(opt == "-mfile" && argc > 1)
+        {
+          setReceiverType(MMAPFILE_RECEIVER);
+          setFastFileName(argv[1]);
+          consumed = 2;
+        }
         else if(opt == "-pcap" && argc > 1)
         {
           setReceiverType(PCAPFILE_RECEIVER);
@@ -947,6 +1562,18 @@ namespace QuickFAST{
             consumed = 2;
           }
         }
+        else if(opt == "-pcapfilter" && argc > 1)
+        {
+          std::string address = argv[1];
+          std::string::size_type colon = address.find(':');
+          setPcapFilterIP(address.substr(0, colon));
+          if(colon != std::string::npos)
+          {
+            setPcapFilterPort(boost::lexical_cast<unsigned short>(
+              address.substr(colon+1)));
+          }
+          consumed = 2;
+        }
         else if(opt == "-mname" && argc > 1)
         {
           setMulticastName(argv[1]);
@@ -965,6 +1592,86 @@ namespace QuickFAST{
           }
           consumed = 2;
         }
+        else if(opt == "-busypoll" && argc > 1)
+        {
+          setReceiverType(BUSYPOLL_RECEIVER);
+          std::string address = argv[1];
+          std::string::size_type colon = address.find(':');
+          setMulticastGroupIP(address.substr(0, colon));
+          if(colon != std::string::npos)
+          {
+            setPortNumber(boost::lexical_cast<unsigned short>(
+              address.substr(colon+1)));
+          }
+          consumed = 2;
+        }
+        else if(opt == "-epoll" && argc > 1)
+        {
+          setReceiverType(EPOLL_RECEIVER);
+          addMulticastFeeds(opt, argv[1]);
+          consumed = 2;
+        }
+        else if(opt == "-ring" && argc > 1)
+        {
+          setReceiverType(PACKET_RING_RECEIVER);
+          addMulticastFeeds(opt, argv[1]);
+          consumed = 2;
+        }
+        else if(opt == "-ringif" && argc > 1)
+        {
+          setRingInterface(argv[1]);
+          consumed = 2;
+        }
+        else if(opt == "-ringblocks" && argc > 1)
+        {
+          setRingBlocks(boost::lexical_cast<size_t>(argv[1]));
+          consumed = 2;
+        }
+        else if(opt == "-ringblocksize" && argc > 1)
+        {
+          setRingBlockSize(boost::lexical_cast<size_t>(argv[1]));
+          consumed = 2;
+        }
+        else if(opt == "-feeddict")
+        {
+          setDictionaryPerFeed(true);
+          consumed = 1;
+        }
+        else if(opt == "-sobusypoll" && argc > 1)
+        {
+          setBusyPoll(boost::lexical_cast<int>(argv[1]));
+          consumed = 2;
+        }
+        else if(opt == "-tcpbuffer" && argc > 1)
+        {
+          setTcpBufferSize(boost::lexical_cast<size_t>(argv[1]));
+          consumed = 2;
+        }
+        else if(opt == "-tcpreadv" && argc > 1)
+        {
+          setTcpReadBuffers(boost::lexical_cast<size_t>(argv[1]));
+          consumed = 2;
+        }
+        else if(opt == "-tcpnodelay")
+        {
+          setTcpNoDelay(true);
+          consumed = 1;
+        }
+        else if(opt == "-sorcvbuf" && argc > 1)
+        {
+          setSocketReceiveBuffer(boost::lexical_cast<int>(argv[1]));
+          consumed = 2;
+        }
+        else if(opt == "-sorcvlowat" && argc > 1)
+        {
+          setSocketReceiveLowWater(boost::lexical_cast<int>(argv[1]));
+          consumed = 2;
+        }
+        else if(opt == "-rcpu" && argc > 1)
+        {
+          setReceiverCpu(boost::lexical_cast<int>(argv[1]));
+          consumed = 2;
+        }
         else if(opt == "-mlisten" && argc > 1)
         {
           setListenInterfaceIP(argv[1]);
@@ -991,13 +1698,13 @@ namespace QuickFAST{
         {
           setAssemblerType(STREAMING_ASSEMBLER);
           consumed = 1;
-          setWaitForCompleteMessage(false);
+          setWaitForCompleteMessage(true);
           if(argc > 1)
           {
             if(std::string(argv[1]) == "block")
             {
               consumed = 2;
-              setWaitForCompleteMessage(true);
+              setWaitForCompleteMessage(false);
             }
             else if(std::string(argv[1]) == "noblock")
             {
@@ -1010,6 +1717,17 @@ namespace QuickFAST{
           setAssemblerType(MESSAGE_PER_PACKET_ASSEMBLER);
           consumed = 1;
         }
+        else if(opt == "-arbitrate" && argc > 1)
+        {
+          setAssemblerType(SEQUENCING_ASSEMBLER);
+          setLookAheadCount(boost::lexical_cast<size_t>(argv[1]));
+          consumed = 2;
+        }
+        else if(opt == "-arbwindow" && argc > 1)
+        {
+          setArbitrationWindow(boost::lexical_cast<size_t>(argv[1]));
+          consumed = 2;
+        }
         else if(opt == "-hnone" ) //              : No header
         {
           setMessageHeaderType(NO_HEADER);
@@ -1080,6 +1798,13 @@ namespace QuickFAST{
           setPacketHeaderSuffixCount(boost::lexical_cast<size_t>(argv[1]));
           consumed = 2;
         }
+        else if(opt == "-pseq" && argc > 2)
+        {
+          setPacketHeaderSequence(
+            boost::lexical_cast<size_t>(argv[1]),
+            boost::lexical_cast<size_t>(argv[2]));
+          consumed = 3;
+        }
         else if(opt == "-pbig" ) //                 : fixed size header is big-endian" << std::endl;
         {
           setPacketHeaderBigEndian(true);
@@ -1098,6 +1823,89 @@ namespace QuickFAST{
             }
           }
         }
+        else if(opt == "-pipeline" && argc > 1)
+        {
+          std::string topology = argv[1];
+          if(topology == "shared")
+          {
+            setPipelineTopology(SHARED_PIPELINE);
+            consumed = 2;
+          }
+          else if(topology == "inline")
+          {
+            setPipelineTopology(INLINE_PIPELINE);
+            consumed = 2;
+          }
+          else if(topology == "two")
+          {
+            setPipelineTopology(TWO_STAGE_PIPELINE);
+            consumed = 2;
+          }
+          else if(topology == "three")
+          {
+            setPipelineTopology(THREE_STAGE_PIPELINE);
+            consumed = 2;
+          }
+        }
+        else if(opt == "-wait" && argc > 1)
+        {
+          std::string strategy = argv[1];
+          if(strategy == "spin")
+          {
+            setWaitStrategy(SPIN_WAIT);
+            consumed = 2;
+          }
+          else if(strategy == "yield")
+          {
+            setWaitStrategy(YIELD_WAIT);
+            consumed = 2;
+          }
+          else if(strategy == "park")
+          {
+            setWaitStrategy(PARK_WAIT);
+            consumed = 2;
+          }
+        }
+        else if(opt == "-spincount" && argc > 1)
+        {
+          setSpinCount(boost::lexical_cast<size_t>(argv[1]));
+          consumed = 2;
+        }
+        else if(opt == "-msgqueue" && argc > 1)
+        {
+          setMessageQueueSize(boost::lexical_cast<size_t>(argv[1]));
+          consumed = 2;
+        }
+        else if(opt == "-dcpu" && argc > 1)
+        {
+          setDecoderCpu(boost::lexical_cast<int>(argv[1]));
+          consumed = 2;
+        }
+        else if(opt == "-ccpu" && argc > 1)
+        {
+          setConsumerCpu(boost::lexical_cast<int>(argv[1]));
+          consumed = 2;
+        }
+        else if(opt == "-stagelatency")
+        {
+          setStageLatency(true);
+          consumed = 1;
+        }
+        else if(opt == "-iocpus" && argc > 1)
+        {
+          setIoCpus(argv[1]);
+          consumed = 2;
+        }
+        else if(opt == "-threadname" && argc > 1)
+        {
+          setThreadName(argv[1]);
+          consumed = 2;
+        }
+        else if(opt == "-numa")
+        {
+          setNumaPlacement(true);
+          consumed = 1;
+        }
         else if(opt == "-privateioservice")
         {
           setPrivateIOService(true);
@@ -1118,6 +1926,26 @@ namespace QuickFAST{
           setBufferCount(boost::lexical_cast<size_t>(argv[1]));
           consumed = 2;
         }
+        else if(opt == "-slab")
+        {
+          setSlabBuffers(true);
+          consumed = 1;
+        }
+        else if(opt == "-hugepages")
+        {
+          setHugePages(true);
+          consumed = 1;
+        }
+        else if(opt == "-timestamps")
+        {
+          setReceiveTimestamps(true);
+          consumed = 1;
+        }
+        else if(opt == "-mbatch" && argc > 1)
+        {
+          setReceiveBatch(boost::lexical_cast<size_t>(argv[1]));
+          consumed = 2;
+        }
         else if(opt == "-nonstandard" && argc > 1)
         {
           setNonstandard(boost::lexical_cast<unsigned long>(argv[1]));
@@ -1127,6 +1955,53 @@ namespace QuickFAST{
 
       }
 
+    private:
+      /// @brief Add the feeds listed in a -epoll or -ring argument.
+      /// @param option the option, for error messages.
+      /// @param groups ip:port[/n],...  ip:port/n means n consecutive addresses on the same port.
+      void addMulticastFeeds(const std::string & option, const std::string & groups)
+      {
+        std::string::size_type start = 0;
+        while(start < groups.size())
+        {
+          std::string::size_type comma = groups.find(',', start);
+          if(comma == std::string::npos)
+          {
+            comma = groups.size();
+          }
+          std::string address = groups.substr(start, comma - start);
+          start = comma + 1;
+          size_t count = 1;
+          std::string::size_type slash = address.find('/');
+          if(slash != std::string::npos)
+          {
+            count = boost::lexical_cast<size_t>(address.substr(slash + 1));
+            address = address.substr(0, slash);
+          }
+          std::string::size_type colon = address.find(':');
+          unsigned short port = portNumber();
+          if(colon != std::string::npos)
+          {
+            port = boost::lexical_cast<unsigned short>(address.substr(colon+1));
+          }
+          unsigned int a = 0, b = 0, c = 0, d = 0;
+          if(sscanf(address.substr(0, colon).c_str(), "%u.%u.%u.%u", &a, &b, &c, &d) != 4)
+          {
+            throw std::invalid_argument(option + ": group must be a dotted IP: " + address);
+          }
+          unsigned long group = (a << 24) | (b << 16) | (c << 8) | d;
+          for(size_t nGroup = 0; nGroup < count; ++nGroup, ++group)
+          {
+            std::stringstream name;
+            name << ((group >> 24) & 0xFF) << '.' << ((group >> 16) & 0xFF) << '.'
+              << ((group >> 8) & 0xFF) << '.' << (group & 0xFF);
+            std::string groupIP = name.str();
+            name << ':' << port;
+            addMulticastFeed(name.str(), groupIP, port);
+          }
+        }
+      }
+
     private:
       void needMulticastFeed() const
       {
@@ -1171,6 +2046,10 @@ namespace QuickFAST{
 
       /// @brief What word size is used in the PCAP file.
       size_t pcapWordSize_;
+      /// @brief Deliver only PCap packets sent to this address
+      std::string pcapFilterIP_;
+      /// @brief Deliver only PCap packets sent to this port
+      unsigned short pcapFilterPort_;
 
       /// @brief What type of header is expected for each packet
       HeaderType packetHeaderType_;
@@ -1182,6 +2061,10 @@ namespace QuickFAST{
       size_t packetHeaderPrefixCount_;
       /// @brief For FIXED_HEADER byte count after size; for FAST_HEADER field count after size
       size_t packetHeaderSuffixCount_;
+      /// @brief For FIXED_HEADER offset of the sequence number
+      size_t packetHeaderSequenceOffset_;
+      /// @brief For FIXED_HEADER size of the sequence number
+      size_t packetHeaderSequenceLength_;
 
       /// @brief What type of header is expected for each message
       HeaderType messageHeaderType_;
@@ -1197,6 +2080,12 @@ namespace QuickFAST{
       /// @brief What type of assembler processes incoming buffers
       AssemblerType assemblerType_;
 
+      /// @brief For SEQUENCING_ASSEMBLER how many out-of-order packets can be held.
+      size_t lookAheadCount_;
+
+      /// @brief For SEQUENCING_ASSEMBLER how many sequence numbers the line arbitrator remembers.
+      size_t arbitrationWindow_;
+
       /// @brief Should StreamingAssembler wait for a complete message
       /// before decoding starts.
       bool waitForCompleteMessage_;
@@ -1218,6 +2107,87 @@ namespace QuickFAST{
       /// bufferCount_ * bufferSize_ must equal or exceed maximum message size.
       size_t bufferCount_;
 
+      /// @brief For MulticastReceiver, the maximum number of datagrams per receive call.
+      size_t receiveBatch_;
+
+      /// @brief For AsynchFileReceiver, the number of reads in flight
+      size_t readsInFlight_;
+
+      /// @brief For AsynchFileReceiver, bypass the file cache
+      bool directIO_;
+
+      /// @brief For BusyPollReceiver, SO_BUSY_POLL microseconds
+      int busyPoll_;
+
+      /// @brief For BusyPollReceiver or a pipeline, the CPU for the receiving thread
+      int receiverCpu_;
+
+      /// @brief For PacketRingReceiver, the interface name
+      std::string ringInterface_;
+
+      /// @brief For PacketRingReceiver, blocks in the ring
+      size_t ringBlocks_;
+
+      /// @brief For PacketRingReceiver, bytes per block
+      size_t ringBlockSize_;
+
+      /// @brief For EpollMulticastReceiver, a dictionary per feed
+      bool dictionaryPerFeed_;
+
+      /// @brief For TCPReceiver, the size of each buffer
+      size_t tcpBufferSize_;
+
+      /// @brief For TCPReceiver, the maximum number of buffers per read
+      size_t tcpReadBuffers_;
+
+      /// @brief For TCPReceiver, TCP_NODELAY
+      bool tcpNoDelay_;
+
+      /// @brief For TCPReceiver, SO_RCVBUF bytes
+      int socketReceiveBuffer_;
+
+      /// @brief For TCPReceiver, SO_RCVLOWAT bytes
+      int socketReceiveLowWater_;
+
+      /// @brief Allocate buffers from a BufferPool
+      bool slabBuffers_;
+
+      /// @brief Back the BufferPool with huge pages
+      bool hugePages_;
+
+      /// @brief Record receive times
+      bool receiveTimestamps_;
+
+      /// @brief Division of work among threads
+      PipelineTopology pipelineTopology_;
+
+      /// @brief What an idle pipeline stage does
+      WaitStrategy waitStrategy_;
+
+      /// @brief Checks for work before yielding or parking
+      size_t spinCount_;
+
+      /// @brief For THREE_STAGE_PIPELINE, decoded messages in flight
+      size_t messageQueueSize_;
+
+      /// @brief For pipelines, the CPU for the decoding thread
+      int decoderCpu_;
+
+      /// @brief For THREE_STAGE_PIPELINE, the CPU for the consumer thread
+      int consumerCpu_;
+
+      /// @brief Measure time between pipeline stages
+      bool stageLatency_;
+
+      /// @brief CPU list for the I/O service threads
+      std::string ioCpus_;
+
+      /// @brief Base name for threads
+      std::string threadName_;
+
+      /// @brief Place memory on the NUMA node of the CPUs that use it
+      bool numaPlacement_;
+
       /// @brief Allow nonstandard presence attribute on length instruction
       /// If true, allow presence= attribute on sequence length instruction
       unsigned long nonstandard_;
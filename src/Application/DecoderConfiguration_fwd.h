@@ -29,7 +29,8 @@ namespace QuickFAST{
       enum AssemblerType{
         MESSAGE_PER_PACKET_ASSEMBLER, /// Message boundaries on packet boundaries.
         STREAMING_ASSEMBLER,          /// Transport layer doesn't know about message boundaries.
-        UNSPECIFIED_ASSEMBLER         /// Assembler has not yet been specified.
+        UNSPECIFIED_ASSEMBLER,        /// Assembler has not yet been specified.
+        SEQUENCING_ASSEMBLER          /// Message per packet; packets sequenced and deduplicated.
       };
       /// @brief What type of receiver supplies incoming buffers.
       enum ReceiverType
@@ -39,9 +40,30 @@ namespace QuickFAST{
         RAWFILE_RECEIVER,             /// File containing FAST encoded records
         BUFFERED_RAWFILE_RECEIVER,    /// File containing FAST encoded records read entirely into memory.
         PCAPFILE_RECEIVER,            /// File captured from network in PCAP format
-        ASYNCHRONOUS_FILE_RECEIVER,   /// File read using asynchronous I/O (not in core QuickFAST)
+        ASYNCHRONOUS_FILE_RECEIVER,   /// File read using asynchronous I/O (Windows overlapped I/O or Linux io_uring)
         BUFFER_RECEIVER,              /// Decode from in-memory buffer.
-        UNSPECIFIED_RECEIVER          /// Receiver has not yet been specified.
+        UNSPECIFIED_RECEIVER,         /// Receiver has not yet been specified.
+        BUSYPOLL_RECEIVER,            /// Multicast: spin on a non-blocking socket, decode inline.
+        MMAPFILE_RECEIVER,            /// File containing FAST encoded records mapped into memory.
+        EPOLL_RECEIVER,               /// Multicast: many groups read by one thread using epoll.
+        PACKET_RING_RECEIVER          /// UDP: many feeds read from an AF_PACKET ring by one thread (Linux).
+      };
+
+      /// @brief How receiving, decoding and delivering messages are divided among threads.
+      enum PipelineTopology
+      {
+        SHARED_PIPELINE,        /// Any thread running the I/O service may decode and deliver.
+        INLINE_PIPELINE,        /// One (pinned) thread receives, decodes and delivers.
+        TWO_STAGE_PIPELINE,     /// Receive thread -> decode and deliver thread.
+        THREE_STAGE_PIPELINE    /// Receive thread -> decode thread -> deliver thread.
+      };
+
+      /// @brief What a pipeline stage does when it has no work.
+      enum WaitStrategy
+      {
+        SPIN_WAIT,    /// Keep checking. Uses all of a CPU.
+        YIELD_WAIT,   /// Spin then yield the CPU between checks.
+        PARK_WAIT     /// Spin, yield, then sleep until work arrives.
       };
 
       /// @brief How should incoming data be echoed.
@@ -5,9 +5,11 @@
 #include <Common/QuickFASTPch.h>
 #include "DecoderConnection.h"
 #include <Application/DecoderConfiguration_fwd.h>
+#include <Application/MessageHandoff.h>
 #include <Codecs/XMLTemplateParser.h>
 #include <Codecs/MessagePerPacketAssembler.h>
 #include <Codecs/StreamingAssembler.h>
+#include <Codecs/PacketSequencingAssembler.h>
 #include <Codecs/NoHeaderAnalyzer.h>
 #include <Codecs/FixedSizeHeaderAnalyzer.h>
 #include <Codecs/FastEncodedHeaderAnalyzer.h>
@@ -18,10 +20,15 @@
 #include <Communication/TCPReceiver.h>
 #include <Communication/RawFileReceiver.h>
 #include <Communication/BufferedRawFileReceiver.h>
+#include <Communication/MMapFileReceiver.h>
 #include <Communication/PCapFileReceiver.h>
 #include <Communication/AsynchFileReceiver.h>
 #include <Communication/BufferReceiver.h>
+#include <Communication/BusyPollReceiver.h>
+#include <Communication/EpollMulticastReceiver.h>
+#include <Communication/PacketRingReceiver.h>
 #include <Communication/AsioService.h>
+#include <Common/ThreadPlacement.h>
 
 using namespace QuickFAST;
 using namespace Application;
@@ -33,6 +40,19 @@ namespace
 #else
   const std::ios::openmode binaryMode = static_cast<std::ios::openmode>(0);
 #endif
+
+  Communication::BufferHandoff::WaitStrategy handoffStrategy(DecoderConfiguration::WaitStrategy strategy)
+  {
+    switch(strategy)
+    {
+    case DecoderConfiguration::SPIN_WAIT:
+      return Communication::BufferHandoff::SPIN_WAIT;
+    case DecoderConfiguration::YIELD_WAIT:
+      return Communication::BufferHandoff::YIELD_WAIT;
+    default:
+      return Communication::BufferHandoff::PARK_WAIT;
+    }
+  }
 }
 
 
@@ -42,6 +62,11 @@ DecoderConnection::DecoderConnection()
 , verboseFile_(0)
 , ownEchoFile_(false)
 , ownVerboseFile_(false)
+, topology_(DecoderConfiguration::SHARED_PIPELINE)
+, receiverCpu_(-1)
+, decoderCpu_(-1)
+, consumerCpu_(-1)
+, asynchReceiver_(0)
 {
 }
 
@@ -185,7 +210,9 @@ DecoderConnection::configure(
         configuration.packetHeaderMessageSizeBytes(),
         configuration.packetHeaderBigEndian(),
         configuration.packetHeaderPrefixCount(),
-        configuration.packetHeaderSuffixCount());
+        configuration.packetHeaderSuffixCount(),
+        configuration.packetHeaderSequenceOffset(),
+        configuration.packetHeaderSequenceLength());
       fixedSizeHeaderAnalyzer->setTestSkip(configuration.testSkip());
       packetHeaderAnalyzer_.reset(fixedSizeHeaderAnalyzer);
       break;
@@ -230,6 +257,21 @@ DecoderConnection::configure(
     }
   }
 
+  // The decoder delivers messages to the application's builder unless
+  // a separate thread delivers them.
+  Messages::ValueMessageBuilder * decodedMessages = &builder;
+  topology_ = configuration.pipelineTopology();
+  if(topology_ == DecoderConfiguration::THREE_STAGE_PIPELINE)
+  {
+    messageHandoff_.reset(new MessageHandoff(
+      builder,
+      configuration.messageQueueSize(),
+      configuration.spinCount(),
+      handoffStrategy(configuration.waitStrategy()),
+      configuration.stageLatency()));
+    decodedMessages = messageHandoff_.get();
+  }
+
   switch(configuration.assemblerType())
   {
   case Application::DecoderConfiguration::MESSAGE_PER_PACKET_ASSEMBLER:
@@ -238,7 +280,30 @@ DecoderConnection::configure(
         registry_,
         *packetHeaderAnalyzer_,
         *messageHeaderAnalyzer_,
-        builder);
+        *decodedMessages);
+      assembler_.reset(pAssembler);
+      pAssembler->setEcho(
+        *echoFile_,
+        static_cast<Codecs::DataSource::EchoType>(configuration.echoType()),
+        configuration.echoMessage(),
+        configuration.echoField());
+      pAssembler->setMessageLimit(configuration.head());
+      break;
+    }
+  case Application::DecoderConfiguration::SEQUENCING_ASSEMBLER:
+    {
+      if(!packetHeaderAnalyzer_->supportsSequenceNumber())
+      {
+        throw std::invalid_argument("DecoderConnection: -arbitrate requires a packet header with a sequence number.");
+      }
+      Codecs::PacketSequencingAssembler * pAssembler = new Codecs::PacketSequencingAssembler(
+        registry_,
+        *packetHeaderAnalyzer_,
+        *messageHeaderAnalyzer_,
+        *decodedMessages,
+        configuration.lookAheadCount(),
+        Communication::RecoveryFeedPtr(),
+        configuration.arbitrationWindow());
       assembler_.reset(pAssembler);
       pAssembler->setEcho(
         *echoFile_,
@@ -253,7 +318,7 @@ DecoderConnection::configure(
       Codecs::StreamingAssembler * pAssembler = new Codecs::StreamingAssembler(
         registry_,
         *messageHeaderAnalyzer_,
-        builder,
+        *decodedMessages,
         configuration.waitForCompleteMessage());
       assembler_.reset(pAssembler);
       pAssembler->setEcho(
@@ -272,12 +337,15 @@ DecoderConnection::configure(
       case Application::DecoderConfiguration::MULTICAST_RECEIVER:
       case Application::DecoderConfiguration::PCAPFILE_RECEIVER:
       case Application::DecoderConfiguration::BUFFER_RECEIVER:
+      case Application::DecoderConfiguration::BUSYPOLL_RECEIVER:
+      case Application::DecoderConfiguration::EPOLL_RECEIVER:
+      case Application::DecoderConfiguration::PACKET_RING_RECEIVER:
         {
           Codecs::MessagePerPacketAssembler * pAssembler = new Codecs::MessagePerPacketAssembler(
             registry_,
             *messageHeaderAnalyzer_,
             *packetHeaderAnalyzer_,
-            builder);
+            *decodedMessages);
           assembler_.reset(pAssembler);
           pAssembler->setEcho(
             *echoFile_,
@@ -290,12 +358,13 @@ DecoderConnection::configure(
       case Application::DecoderConfiguration::TCP_RECEIVER:
       case Application::DecoderConfiguration::RAWFILE_RECEIVER:
       case Application::DecoderConfiguration::BUFFERED_RAWFILE_RECEIVER:
+      case Application::DecoderConfiguration::MMAPFILE_RECEIVER:
       case Application::DecoderConfiguration::ASYNCHRONOUS_FILE_RECEIVER:
         {
           Codecs::StreamingAssembler * pAssembler = new Codecs::StreamingAssembler(
             registry_,
             *messageHeaderAnalyzer_,
-            builder,
+            *decodedMessages,
             configuration.waitForCompleteMessage());
           assembler_.reset(pAssembler);
           pAssembler->setEcho(
@@ -318,6 +387,15 @@ DecoderConnection::configure(
 
   assembler_->setReset(configuration.reset());
   assembler_->setStrict(configuration.strict());
+  if(configuration.dictionaryPerFeed())
+  {
+    Codecs::BasePacketAssembler * packetAssembler = dynamic_cast<Codecs::BasePacketAssembler *>(assembler_.get());
+    if(packetAssembler == 0)
+    {
+      throw std::invalid_argument("A dictionary per feed requires a packet assembler.");
+    }
+    packetAssembler->setDictionaryPerSource(true);
+  }
 
   switch(configuration.receiverType())
   {
@@ -352,24 +430,79 @@ DecoderConnection::configure(
           configuration.portNumber(nFeed)
           );
       }
+      receiver->setReceiveBatch(configuration.receiveBatch());
+      break;
+    }
+  case Application::DecoderConfiguration::BUSYPOLL_RECEIVER:
+    {
+      Communication::BusyPollReceiver * receiver = new Communication::BusyPollReceiver(
+        configuration.multicastGroupIP(),
+        configuration.listenInterfaceIP(),
+        configuration.multicastBindIP(),
+        configuration.portNumber());
+      receiver_.reset(receiver);
+      receiver->setBusyPoll(configuration.busyPoll());
+      receiver->setCpu(configuration.receiverCpu());
+      break;
+    }
+  case Application::DecoderConfiguration::EPOLL_RECEIVER:
+    {
+      Communication::EpollMulticastReceiver * receiver = new Communication::EpollMulticastReceiver;
+      receiver_.reset(receiver);
+      for(size_t nFeed = 0; nFeed < configuration.multicastCount(); ++nFeed)
+      {
+        receiver->addFeed(
+          configuration.multicastName(nFeed),
+          configuration.multicastGroupIP(nFeed),
+          configuration.listenInterfaceIP(nFeed),
+          configuration.multicastBindIP(nFeed),
+          configuration.portNumber(nFeed)
+          );
+      }
+      receiver->setReceiveBatch(configuration.receiveBatch());
+      receiver->setCpu(configuration.receiverCpu());
+      break;
+    }
+  case Application::DecoderConfiguration::PACKET_RING_RECEIVER:
+    {
+      Communication::PacketRingReceiver * receiver =
+        new Communication::PacketRingReceiver(configuration.ringInterface());
+      receiver_.reset(receiver);
+      for(size_t nFeed = 0; nFeed < configuration.multicastCount(); ++nFeed)
+      {
+        receiver->addFeed(
+          configuration.multicastName(nFeed),
+          configuration.multicastGroupIP(nFeed),
+          configuration.listenInterfaceIP(nFeed),
+          configuration.portNumber(nFeed)
+          );
+      }
+      receiver->setRing(configuration.ringBlockSize(), configuration.ringBlocks());
+      receiver->setCpu(configuration.receiverCpu());
       break;
     }
   case Application::DecoderConfiguration::TCP_RECEIVER:
     {
+      Communication::TCPReceiver * receiver;
       if(configuration.privateIOService())
       {
         ioService_.reset(new boost::asio::io_service);
-          receiver_.reset(new Communication::TCPReceiver(
-            *ioService_,
-            configuration.hostName(),
-            configuration.portName()));
+        receiver = new Communication::TCPReceiver(
+          *ioService_,
+          configuration.hostName(),
+          configuration.portName());
       }
       else
       {
-        receiver_.reset(new Communication::TCPReceiver(
+        receiver = new Communication::TCPReceiver(
           configuration.hostName(),
-          configuration.portName()));
+          configuration.portName());
       }
+      receiver_.reset(receiver);
+      receiver->setNoDelay(configuration.tcpNoDelay());
+      receiver->setReceiveBufferSize(configuration.socketReceiveBuffer());
+      receiver->setReceiveLowWater(configuration.socketReceiveLowWater());
+      receiver->setReadBuffers(configuration.tcpReadBuffers());
       break;
     }
   case Application::DecoderConfiguration::RAWFILE_RECEIVER:
@@ -384,11 +517,19 @@ DecoderConnection::configure(
         *fastFile_));
       break;
     }
+  case Application::DecoderConfiguration::MMAPFILE_RECEIVER:
+    {
+      receiver_.reset(new Communication::MMapFileReceiver(
+        configuration.fastFileName()));
+      break;
+    }
   case Application::DecoderConfiguration::PCAPFILE_RECEIVER:
     {
-      receiver_.reset(new Communication::PCapFileReceiver(
+      Communication::PCapFileReceiver * receiver = new Communication::PCapFileReceiver(
         configuration.pcapFileName(),
-        configuration.pcapWordSize()));
+        configuration.pcapWordSize());
+      receiver_.reset(receiver);
+      receiver->setFilter(configuration.pcapFilterIP(), configuration.pcapFilterPort());
       break;
     }
   case Application::DecoderConfiguration::ASYNCHRONOUS_FILE_RECEIVER:
@@ -408,9 +549,12 @@ DecoderConnection::configure(
         ; // for now ignore this
       }
 
-      receiver_.reset(new Communication::AsynchFileReceiver(
+      Communication::AsynchFileReceiver * receiver = new Communication::AsynchFileReceiver(
         configuration.fastFileName(),
-        attributes));
+        attributes);
+      receiver_.reset(receiver);
+      receiver->setReadsInFlight(configuration.readsInFlight());
+      receiver->setDirectIO(configuration.directIO());
       break;
     }
   case Application::DecoderConfiguration::BUFFER_RECEIVER:
@@ -426,7 +570,79 @@ DecoderConnection::configure(
     }
   }
 
-  receiver_->start(*assembler_, configuration.bufferSize(), configuration.bufferCount());
+  if(configuration.slabBuffers())
+  {
+    receiver_->setSlabBuffers(configuration.hugePages());
+  }
+  receiver_->setReceiveTimestamps(configuration.receiveTimestamps());
+
+  receiverCpu_ = configuration.receiverCpu();
+  decoderCpu_ = configuration.decoderCpu();
+  consumerCpu_ = configuration.consumerCpu();
+  threadName_ = configuration.threadName();
+
+  std::vector<int> ioCpus;
+  if(!configuration.ioCpus().empty()
+    && !Common::ThreadPlacement::parseCpuList(configuration.ioCpus(), ioCpus))
+  {
+    throw std::invalid_argument("DecoderConnection: -iocpus expects a CPU list such as 0-3,8.");
+  }
+  Communication::AsynchReceiver * ioReceiver = dynamic_cast<Communication::AsynchReceiver *>(receiver_.get());
+  if(ioReceiver != 0)
+  {
+    ioReceiver->asioService().setThreadCpus(ioCpus);
+    if(!threadName_.empty())
+    {
+      ioReceiver->asioService().setThreadName(threadName_ + "/io");
+    }
+  }
+
+  if(topology_ == DecoderConfiguration::TWO_STAGE_PIPELINE
+    || topology_ == DecoderConfiguration::THREE_STAGE_PIPELINE)
+  {
+    asynchReceiver_ = ioReceiver;
+    if(asynchReceiver_ == 0)
+    {
+      throw std::invalid_argument("DecoderConnection: -pipeline two or three requires -multicast, -tcp or -afile.");
+    }
+    asynchReceiver_->setLockFreeHandoff(
+      configuration.spinCount(),
+      handoffStrategy(configuration.waitStrategy()),
+      configuration.stageLatency());
+  }
+
+  if(configuration.numaPlacement())
+  {
+    // Buffers belong with the thread that fills them; the dictionary with the thread that decodes.
+    int receivingCpu = receiverCpu_;
+    if(receivingCpu < 0 && !ioCpus.empty())
+    {
+      receivingCpu = ioCpus[0];
+    }
+    int bufferNode = receivingCpu >= 0
+      ? Common::ThreadPlacement::nodeOfCpu(receivingCpu)
+      : Common::ThreadPlacement::currentNode();
+    int dictionaryNode = bufferNode;
+    if(asynchReceiver_ != 0 && decoderCpu_ >= 0)
+    {
+      dictionaryNode = Common::ThreadPlacement::nodeOfCpu(decoderCpu_);
+    }
+    receiver_->setNumaNode(bufferNode);
+    if(dictionaryNode >= 0 && !assembler_->decoder().placeDictionary(dictionaryNode))
+    {
+      std::stringstream msg;
+      msg << "DecoderConnection: Cannot place the dictionary on NUMA node " << dictionaryNode << '.';
+      assembler_->logMessage(Common::Logger::QF_LOG_WARNING, msg.str());
+    }
+  }
+
+  size_t bufferSize = configuration.bufferSize();
+  if(configuration.receiverType() == Application::DecoderConfiguration::TCP_RECEIVER)
+  {
+    // A stream has no packet boundaries; large reads mean fewer system calls.
+    bufferSize = configuration.tcpBufferSize();
+  }
+  receiver_->start(*assembler_, bufferSize, configuration.bufferCount());
 
 }
 
@@ -440,3 +656,125 @@ DecoderConnection::decoder() const
   return assembler_->decoder();
 }
 
+
+void
+DecoderConnection::run()
+{
+  if(topology_ == DecoderConfiguration::SHARED_PIPELINE)
+  {
+    receiver_->run();
+  }
+  else
+  {
+    runThreads(0, true);
+  }
+}
+
+void
+DecoderConnection::runThreads(size_t threadCount, bool useThisThread)
+{
+  if(topology_ == DecoderConfiguration::SHARED_PIPELINE)
+  {
+    receiver_->runThreads(threadCount, useThisThread);
+    return;
+  }
+  if(messageHandoff_)
+  {
+    stageThreads_.create_thread(boost::bind(&DecoderConnection::runDeliverStage, this));
+  }
+  if(asynchReceiver_ != 0)
+  {
+    stageThreads_.create_thread(boost::bind(&DecoderConnection::runDecodeStage, this));
+  }
+  if(useThisThread)
+  {
+    runReceiveStage();
+    joinThreads();
+  }
+  else
+  {
+    stageThreads_.create_thread(boost::bind(&DecoderConnection::runReceiveStage, this));
+  }
+}
+
+void
+DecoderConnection::joinThreads()
+{
+  if(topology_ == DecoderConfiguration::SHARED_PIPELINE)
+  {
+    receiver_->joinThreads();
+  }
+  else
+  {
+    stageThreads_.join_all();
+  }
+}
+
+void
+DecoderConnection::runReceiveStage()
+{
+  placeThread(receiverCpu_, "recv");
+  receiver_->run();
+}
+
+void
+DecoderConnection::runDecodeStage()
+{
+  placeThread(decoderCpu_, "decode");
+  asynchReceiver_->runDecoder();
+  if(messageHandoff_)
+  {
+    messageHandoff_->finish();
+  }
+}
+
+void
+DecoderConnection::runDeliverStage()
+{
+  placeThread(consumerCpu_, "deliver");
+  if(!messageHandoff_->run())
+  {
+    receiver_->stop();
+  }
+}
+
+void
+DecoderConnection::placeThread(int cpu, const char * stage)
+{
+  if(!threadName_.empty())
+  {
+    Common::ThreadPlacement::nameThread(threadName_ + '/' + stage);
+  }
+  if(cpu >= 0 && !Common::ThreadPlacement::pinThread(cpu))
+  {
+    std::stringstream msg;
+    msg << "DecoderConnection: Cannot pin the " << stage << " thread to CPU " << cpu << '.';
+    assembler_->logMessage(Common::Logger::QF_LOG_WARNING, msg.str());
+  }
+}
+
+void
+DecoderConnection::reportPipeline(std::ostream & out) const
+{
+  const Communication::BufferHandoff * handoff = receiver_ ? receiver_->handoff() : 0;
+  if(handoff != 0)
+  {
+    handoff->report(out, "Receive->decode");
+  }
+  if(messageHandoff_)
+  {
+    messageHandoff_->report(out);
+  }
+  const Communication::EpollMulticastReceiver * epoll =
+    dynamic_cast<const Communication::EpollMulticastReceiver *>(receiver_.get());
+  if(epoll != 0)
+  {
+    epoll->report(out);
+  }
+  const Communication::PacketRingReceiver * ring =
+    dynamic_cast<const Communication::PacketRingReceiver *>(receiver_.get());
+  if(ring != 0)
+  {
+    ring->report(out);
+  }
+}
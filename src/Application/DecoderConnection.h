@@ -17,7 +17,9 @@
 #include <Communication/Assembler_fwd.h>
 #include <Communication/Receiver.h>
 #include <Communication/AsioService_fwd.h>
+#include <Communication/AsynchReceiver_fwd.h>
 #include <Application/DecoderConfiguration.h>
+#include <Application/MessageHandoff_fwd.h>
 
 namespace QuickFAST{
   namespace Application{
@@ -25,6 +27,21 @@ namespace QuickFAST{
     ///
     /// Each source of FAST encoded data should be supported by a separate instance of DecoderConnection.
     /// Examples of sources include a single multicast group; a FAST encoded data file; etc.
+    ///
+    /// The configured pipeline topology (DecoderConfiguration::pipelineTopology()) decides
+    /// which threads receive, decode and deliver messages:
+    ///  - SHARED_PIPELINE: any thread running the I/O service may decode and deliver.
+    ///  - INLINE_PIPELINE: one thread does everything.
+    ///  - TWO_STAGE_PIPELINE: one thread receives; another decodes and delivers.
+    ///    Buffers pass between them through a lock-free Communication::BufferHandoff.
+    ///  - THREE_STAGE_PIPELINE: like two stage, but a third thread delivers the decoded
+    ///    messages, which pass to it through a lock-free MessageHandoff.
+    /// Each thread may be pinned to a CPU and named.  For the pipelines run(), runThreads()
+    /// and joinThreads() manage the stage threads; the thread count is ignored.
+    ///
+    /// With DecoderConfiguration::numaPlacement() the receive buffers are placed on
+    /// the NUMA node of the receiving CPU and the decoder's dictionary on the node
+    /// of the decoding CPU.
     class QuickFAST_Export DecoderConnection
     {
     public:
@@ -46,10 +63,8 @@ namespace QuickFAST{
       /// @brief run the event loop in this thread
       ///
       /// Exceptions are caught, logged, and ignored.  The event loop continues.
-      void run()
-      {
-        receiver_->run();
-      }
+      /// For a pipeline, this thread receives and the other stages get their own threads.
+      void run();
 
       /// @brief run the event loop until one event is handled.
       void run_one()
@@ -70,18 +85,16 @@ namespace QuickFAST{
       }
 
       /// @brief create additional threads to run the event loop
-      void runThreads(size_t threadCount = 0, bool useThisThread = true)
-      {
-        receiver_->runThreads(threadCount, useThisThread);
-      }
+      ///
+      /// For a pipeline, start one thread per stage (threadCount is ignored).
+      /// If useThisThread is true this thread receives, and the call returns
+      /// after the receiver is stopped and the other stages have finished.
+      void runThreads(size_t threadCount = 0, bool useThisThread = true);
 
       /// @brief join all additional threads after calling stopService()
       ///
       /// If stop() has not been called, this will block "forever".
-      void joinThreads()
-      {
-        receiver_->joinThreads();
-      }
+      void joinThreads();
 
       /// @brief Reuse AsioService after calling stop and joinThreads
       ///
@@ -163,6 +176,24 @@ namespace QuickFAST{
       /// @brief Access the decoder.
       Codecs::Decoder & decoder() const;
 
+      /// @brief Access the handoff from the decoding thread to the delivering thread.
+      /// @returns the handoff, or zero unless the topology is THREE_STAGE_PIPELINE.
+      const MessageHandoff * messageHandoff() const
+      {
+        return messageHandoff_.get();
+      }
+
+      /// @brief Write the queue depth and latency statistics for each stage of the pipeline.
+      /// With an EPOLL_RECEIVER or PACKET_RING_RECEIVER also write the receiving statistics per feed.
+      /// @param out is the destination
+      void reportPipeline(std::ostream & out) const;
+
+    private:
+      void runReceiveStage();
+      void runDecodeStage();
+      void runDeliverStage();
+      void placeThread(int cpu, const char * stage);
+
     private:
       std::istream * fastFile_;
       std::ostream * echoFile_;
@@ -176,6 +207,17 @@ namespace QuickFAST{
       boost::scoped_ptr<Codecs::HeaderAnalyzer> messageHeaderAnalyzer_;
       boost::scoped_ptr<Communication::Assembler> assembler_;
       boost::scoped_ptr<Communication::Receiver> receiver_;
+      DecoderConfiguration::PipelineTopology topology_;
+      int receiverCpu_;
+      int decoderCpu_;
+      int consumerCpu_;
+      /// Base name for the stage threads
+      std::string threadName_;
+      /// For TWO_STAGE_PIPELINE and THREE_STAGE_PIPELINE, the receiver as an AsynchReceiver
+      Communication::AsynchReceiver * asynchReceiver_;
+      /// For THREE_STAGE_PIPELINE, the decoder's builder
+      boost::scoped_ptr<MessageHandoff> messageHandoff_;
+      boost::thread_group stageThreads_;
 
     };
   }
@@ -0,0 +1,380 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#include <Common/QuickFASTPch.h>
+#include "MessageHandoff.h"
+#include <Messages/MessageRecorder.h>
+
+using namespace QuickFAST;
+using namespace Application;
+
+namespace
+{
+  const std::string noApplicationType;
+
+  Messages::MessageRecorder & recorderIn(Communication::LinkedBuffer * shell)
+  {
+    return *static_cast<Messages::MessageRecorder *>(shell->extra());
+  }
+}
+
+MessageHandoff::MessageHandoff(
+  Messages::ValueMessageBuilder & consumer,
+  size_t capacity,
+  size_t spinCount,
+  Communication::BufferHandoff::WaitStrategy strategy,
+  bool measureLatency)
+  : consumer_(consumer)
+  , handoff_(capacity > 0 ? capacity : 1, spinCount, strategy)
+  , shells_(new Communication::LinkedBuffer[capacity > 0 ? capacity : 1])
+  , current_(0)
+  , receiveTime_(0)
+  , newReceiveTime_(false)
+  , source_(0)
+  , newSource_(false)
+  , stalls_(0)
+  , inMessage_(false)
+  , logPending_(false)
+  , finished_(0)
+  , stopped_(0)
+{
+  handoff_.setMeasureLatency(measureLatency);
+  size_t count = capacity > 0 ? capacity : 1;
+  recorders_.reserve(count + 1);
+  for(size_t nShell = 0; nShell < count; ++nShell)
+  {
+    Messages::MessageRecorderPtr recorder(new Messages::MessageRecorder(consumer_));
+    recorders_.push_back(recorder);
+    shells_[nShell].setExtra(recorder.get());
+    // The consumer thread does not exist yet, so it is safe to act on its behalf.
+    handoff_.recycle(&shells_[nShell]);
+  }
+  Messages::MessageRecorderPtr discard(new Messages::MessageRecorder(consumer_));
+  recorders_.push_back(discard);
+  discard_.setExtra(discard.get());
+}
+
+MessageHandoff::~MessageHandoff()
+{
+}
+
+bool
+MessageHandoff::run()
+{
+  while(true)
+  {
+    Communication::LinkedBuffer * shell = handoff_.next();
+    if(shell == 0)
+    {
+      if(atomic_load_acquire_long(&finished_) != 0 && handoff_.peek(0) == 0)
+      {
+        return true;
+      }
+      handoff_.wait(finished_);
+    }
+    else
+    {
+      Messages::MessageRecorder & recorder = recorderIn(shell);
+      bool more = recorder.replay(consumer_);
+      recorder.clear();
+      handoff_.recycle(shell);
+      if(!more)
+      {
+        atomic_store_release_long(&stopped_, 1);
+        return false;
+      }
+    }
+  }
+}
+
+void
+MessageHandoff::finish()
+{
+  atomic_store_release_long(&finished_, 1);
+  handoff_.wakeup();
+}
+
+void
+MessageHandoff::report(std::ostream & out)const
+{
+  handoff_.report(out, "Decode->deliver");
+  out << "Decode->deliver: decoder waited for the consumer " << stalls_ << " times." << std::endl;
+}
+
+Messages::MessageRecorder &
+MessageHandoff::acquire()
+{
+  if(current_ == 0)
+  {
+    current_ = handoff_.reclaim();
+    while(current_ == 0)
+    {
+      if(stopped())
+      {
+        // nobody is listening.
+        current_ = &discard_;
+      }
+      else
+      {
+        ++stalls_;
+        boost::thread::yield();
+        current_ = handoff_.reclaim();
+      }
+    }
+  }
+  return recorderIn(current_);
+}
+
+void
+MessageHandoff::deliverCurrent()
+{
+  if(current_ == &discard_)
+  {
+    recorderIn(current_).clear();
+  }
+  else
+  {
+    handoff_.deliver(current_);
+  }
+  current_ = 0;
+}
+
+const std::string &
+MessageHandoff::getApplicationType()const
+{
+  return current_ == 0 ? noApplicationType : recorderIn(current_).getApplicationType();
+}
+
+const std::string &
+MessageHandoff::getApplicationTypeNs()const
+{
+  return current_ == 0 ? noApplicationType : recorderIn(current_).getApplicationTypeNs();
+}
+
+void
+MessageHandoff::addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const int64 value)
+{
+  acquire().addValue(identity, type, value);
+}
+
+void
+MessageHandoff::addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const uint64 value)
+{
+  acquire().addValue(identity, type, value);
+}
+
+void
+MessageHandoff::addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const int32 value)
+{
+  acquire().addValue(identity, type, value);
+}
+
+void
+MessageHandoff::addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const uint32 value)
+{
+  acquire().addValue(identity, type, value);
+}
+
+void
+MessageHandoff::addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const int16 value)
+{
+  acquire().addValue(identity, type, value);
+}
+
+void
+MessageHandoff::addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const uint16 value)
+{
+  acquire().addValue(identity, type, value);
+}
+
+void
+MessageHandoff::addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const int8 value)
+{
+  acquire().addValue(identity, type, value);
+}
+
+void
+MessageHandoff::addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const uchar value)
+{
+  acquire().addValue(identity, type, value);
+}
+
+void
+MessageHandoff::addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const Decimal& value)
+{
+  acquire().addValue(identity, type, value);
+}
+
+void
+MessageHandoff::addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const unsigned char * value, size_t length)
+{
+  acquire().addValue(identity, type, value, length);
+}
+
+Messages::ValueMessageBuilder &
+MessageHandoff::startMessage(
+  const std::string & applicationType,
+  const std::string & applicationTypeNamespace,
+  size_t size)
+{
+  Messages::MessageRecorder & recorder = acquire();
+  if(newReceiveTime_)
+  {
+    recorder.reportReceiveTime(receiveTime_);
+    newReceiveTime_ = false;
+  }
+  if(newSource_)
+  {
+    recorder.reportSource(source_);
+    newSource_ = false;
+  }
+  inMessage_ = true;
+  return recorder.startMessage(applicationType, applicationTypeNamespace, size);
+}
+
+bool
+MessageHandoff::endMessage(Messages::ValueMessageBuilder & messageBuilder)
+{
+  acquire().endMessage(messageBuilder);
+  inMessage_ = false;
+  logPending_ = false;
+  deliverCurrent();
+  return !stopped();
+}
+
+bool
+MessageHandoff::ignoreMessage(Messages::ValueMessageBuilder & messageBuilder)
+{
+  acquire().ignoreMessage(messageBuilder);
+  inMessage_ = false;
+  if(logPending_)
+  {
+    // the recorder kept what was logged; don't hold it back.
+    logPending_ = false;
+    deliverCurrent();
+  }
+  // Otherwise keep the recorder for the next message.
+  return true;
+}
+
+Messages::ValueMessageBuilder &
+MessageHandoff::startSequence(
+  const Messages::FieldIdentity & identity,
+  const std::string & applicationType,
+  const std::string & applicationTypeNamespace,
+  size_t fieldCount,
+  const Messages::FieldIdentity & lengthIdentity,
+  size_t length)
+{
+  return acquire().startSequence(
+    identity,
+    applicationType,
+    applicationTypeNamespace,
+    fieldCount,
+    lengthIdentity,
+    length);
+}
+
+void
+MessageHandoff::endSequence(
+  const Messages::FieldIdentity & identity,
+  Messages::ValueMessageBuilder & sequenceBuilder)
+{
+  acquire().endSequence(identity, sequenceBuilder);
+}
+
+Messages::ValueMessageBuilder &
+MessageHandoff::startSequenceEntry(
+  const std::string & applicationType,
+  const std::string & applicationTypeNamespace,
+  size_t size)
+{
+  return acquire().startSequenceEntry(applicationType, applicationTypeNamespace, size);
+}
+
+void
+MessageHandoff::endSequenceEntry(Messages::ValueMessageBuilder & entry)
+{
+  acquire().endSequenceEntry(entry);
+}
+
+Messages::ValueMessageBuilder &
+MessageHandoff::startGroup(
+  const Messages::FieldIdentity & identity,
+  const std::string & applicationType,
+  const std::string & applicationTypeNamespace,
+  size_t size)
+{
+  return acquire().startGroup(identity, applicationType, applicationTypeNamespace, size);
+}
+
+void
+MessageHandoff::endGroup(
+  const Messages::FieldIdentity & identity,
+  Messages::ValueMessageBuilder & groupBuilder)
+{
+  acquire().endGroup(identity, groupBuilder);
+}
+
+void
+MessageHandoff::reportGap(sequence_t startGap, sequence_t endGap)
+{
+  acquire().reportGap(startGap, endGap);
+  deliverCurrent();
+}
+
+void
+MessageHandoff::reportReceiveTime(uint64 receiveTime)
+{
+  receiveTime_ = receiveTime;
+  newReceiveTime_ = true;
+}
+
+void
+MessageHandoff::reportSource(size_t source)
+{
+  source_ = source;
+  newSource_ = true;
+}
+
+bool
+MessageHandoff::wantLog(unsigned short level)
+{
+  return consumer_.wantLog(level);
+}
+
+bool
+MessageHandoff::logMessage(unsigned short level, const std::string & logMessage)
+{
+  acquire().logMessage(level, logMessage);
+  return deliverLog();
+}
+
+bool
+MessageHandoff::reportDecodingError(const std::string & errorMessage)
+{
+  acquire().reportDecodingError(errorMessage);
+  return deliverLog();
+}
+
+bool
+MessageHandoff::reportCommunicationError(const std::string & errorMessage)
+{
+  acquire().reportCommunicationError(errorMessage);
+  return deliverLog();
+}
+
+bool
+MessageHandoff::deliverLog()
+{
+  if(inMessage_)
+  {
+    logPending_ = true;
+  }
+  else
+  {
+    deliverCurrent();
+  }
+  return !stopped();
+}
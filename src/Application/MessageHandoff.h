@@ -0,0 +1,183 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef MESSAGEHANDOFF_H
+#define MESSAGEHANDOFF_H
+#include "MessageHandoff_fwd.h"
+#include <Common/QuickFAST_Export.h>
+#include <Messages/ValueMessageBuilder.h>
+#include <Messages/MessageRecorder_fwd.h>
+#include <Communication/BufferHandoff.h>
+#include <Common/AtomicOps.h>
+
+namespace QuickFAST{
+  namespace Application{
+    /// @brief Pass decoded messages from the decoding thread to a consumer thread without locks.
+    ///
+    /// The decoder builds into this object.  Each message is recorded by a
+    /// Messages::MessageRecorder and handed to the consumer thread through a
+    /// Communication::BufferHandoff, which also returns the empty recorders.
+    /// The consumer thread calls run(), which replays each message into the
+    /// application's builder.
+    ///
+    /// A fixed number of recorders circulate.  If they are all waiting for the
+    /// consumer the decoding thread yields until one comes back (see stalls()).
+    ///
+    /// Gaps, receive times, log messages and error reports are delivered in
+    /// order with the messages, on the consumer thread.  A log message reported
+    /// between messages is handed off at once; one reported while a message is
+    /// being decoded travels with that message.  Because the consumer answers
+    /// later, the Logger methods always tell the decoder to continue; if the
+    /// consumer's answer is false, decoding stops at the next message.
+    ///
+    /// wantLog() is the exception: the decoder needs its answer immediately, so
+    /// the application's builder is asked on the decoding thread.  It must be
+    /// safe to call concurrently with the builder's other methods.
+    class QuickFAST_Export MessageHandoff : public Messages::ValueMessageBuilder
+    {
+    public:
+      /// @brief Construct
+      /// @param consumer the application's builder; receives the messages on the consumer thread.
+      /// @param capacity how many messages may be waiting for the consumer.
+      /// @param spinCount how many times the consumer checks for a message before it yields or parks.
+      /// @param strategy what the consumer does after spinning.
+      /// @param measureLatency measure how long each message waits.
+      MessageHandoff(
+        Messages::ValueMessageBuilder & consumer,
+        size_t capacity = 1024,
+        size_t spinCount = 1000,
+        Communication::BufferHandoff::WaitStrategy strategy = Communication::BufferHandoff::PARK_WAIT,
+        bool measureLatency = false);
+
+      virtual ~MessageHandoff();
+
+      /// @brief Deliver messages to the consumer until finish() is called and
+      /// all messages have been delivered.
+      ///
+      /// This is the body of the consumer thread.
+      /// @returns false if the consumer asked to stop decoding.
+      bool run();
+
+      /// @brief No more messages will be decoded.
+      ///
+      /// Called by the decoding thread.  run() returns once the messages already
+      /// handed off have been delivered.
+      void finish();
+
+      /// @brief Access the underlying handoff (for statistics)
+      const Communication::BufferHandoff & handoff()const
+      {
+        return handoff_;
+      }
+
+      /// @brief Statistic: How many times did the decoding thread wait for a free recorder?
+      size_t stalls()const
+      {
+        return stalls_;
+      }
+
+      /// @brief Write the statistics in human readable form.
+      /// @param out is the destination
+      void report(std::ostream & out)const;
+
+      //////////////////////////////////
+      // Implement ValueMessageBuilder
+      virtual const std::string & getApplicationType()const;
+      virtual const std::string & getApplicationTypeNs()const;
+      virtual void addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const int64 value);
+      virtual void addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const uint64 value);
+      virtual void addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const int32 value);
+      virtual void addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const uint32 value);
+      virtual void addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const int16 value);
+      virtual void addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const uint16 value);
+      virtual void addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const int8 value);
+      virtual void addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const uchar value);
+      virtual void addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const Decimal& value);
+      virtual void addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const unsigned char * value, size_t length);
+      virtual Messages::ValueMessageBuilder & startMessage(
+        const std::string & applicationType,
+        const std::string & applicationTypeNamespace,
+        size_t size);
+      virtual bool endMessage(Messages::ValueMessageBuilder & messageBuilder);
+      virtual bool ignoreMessage(Messages::ValueMessageBuilder & messageBuilder);
+      virtual Messages::ValueMessageBuilder & startSequence(
+        const Messages::FieldIdentity & identity,
+        const std::string & applicationType,
+        const std::string & applicationTypeNamespace,
+        size_t fieldCount,
+        const Messages::FieldIdentity & lengthIdentity,
+        size_t length);
+      virtual void endSequence(
+        const Messages::FieldIdentity & identity,
+        Messages::ValueMessageBuilder & sequenceBuilder);
+      virtual Messages::ValueMessageBuilder & startSequenceEntry(
+        const std::string & applicationType,
+        const std::string & applicationTypeNamespace,
+        size_t size);
+      virtual void endSequenceEntry(Messages::ValueMessageBuilder & entry);
+      virtual Messages::ValueMessageBuilder & startGroup(
+        const Messages::FieldIdentity & identity,
+        const std::string & applicationType,
+        const std::string & applicationTypeNamespace,
+        size_t size);
+      virtual void endGroup(
+        const Messages::FieldIdentity & identity,
+        Messages::ValueMessageBuilder & groupBuilder);
+      virtual void reportGap(sequence_t startGap, sequence_t endGap);
+      virtual void reportReceiveTime(uint64 receiveTime);
+      virtual void reportSource(size_t source);
+
+      ///////////////////
+      // Implement Logger
+      virtual bool wantLog(unsigned short level);
+      virtual bool logMessage(unsigned short level, const std::string & logMessage);
+      virtual bool reportDecodingError(const std::string & errorMessage);
+      virtual bool reportCommunicationError(const std::string & errorMessage);
+
+    private:
+      /// @brief Get the recorder for the current message, waiting for one if necessary.
+      Messages::MessageRecorder & acquire();
+      /// @brief Pass the current recorder to the consumer.
+      void deliverCurrent();
+      /// @brief Deliver a log message at once unless it belongs with a message being decoded.
+      bool deliverLog();
+      bool stopped()const
+      {
+        return atomic_load_acquire_long(&stopped_) != 0;
+      }
+
+    private:
+      MessageHandoff(const MessageHandoff &);
+      MessageHandoff & operator=(const MessageHandoff &);
+
+    private:
+      Messages::ValueMessageBuilder & consumer_;
+      Communication::BufferHandoff handoff_;
+      /// Each shell carries one recorder (as its extra()) through the handoff.
+      boost::scoped_array<Communication::LinkedBuffer> shells_;
+      std::vector<Messages::MessageRecorderPtr> recorders_;
+      /// Used after the consumer stops; its messages are discarded.
+      Communication::LinkedBuffer discard_;
+      /// The shell being filled by the decoding thread (or zero).
+      Communication::LinkedBuffer * current_;
+      uint64 receiveTime_;
+      bool newReceiveTime_;
+      size_t source_;
+      bool newSource_;
+      size_t stalls_;
+      /// a message is being decoded
+      bool inMessage_;
+      /// something was logged while decoding the current message.
+      bool logPending_;
+      /// set by the decoding thread (atomic_store_release_long)
+      volatile long finished_;
+      /// set by the consumer thread (atomic_store_release_long)
+      volatile long stopped_;
+    };
+  }
+}
+#endif // MESSAGEHANDOFF_H
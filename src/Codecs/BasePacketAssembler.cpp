@@ -23,6 +23,8 @@ BasePacketAssembler::BasePacketAssembler(
   , messageCount_(0)
   , byteCount_(0)
   , messageLimit_(0)
+  , currentSource_(0)
+  , dictionaryPerSource_(false)
 {
 }
 
@@ -123,6 +125,39 @@ BasePacketAssembler::decodeBuffer(const unsigned char * buffer, size_t size)
   return result;
 }
 
+bool
+BasePacketAssembler::decodeBuffer(const Communication::LinkedBuffer * buffer)
+{
+  if(buffer->receiveTime() != 0)
+  {
+    builder_.reportReceiveTime(buffer->receiveTime());
+  }
+  size_t source = buffer->source();
+  if(source != currentSource_)
+  {
+    if(dictionaryPerSource_)
+    {
+      selectDictionary(source);
+    }
+    currentSource_ = source;
+    builder_.reportSource(source);
+  }
+  return decodeBuffer(buffer->get(), buffer->used());
+}
+
+void
+BasePacketAssembler::selectDictionary(size_t source)
+{
+  size_t needed = std::max(source, currentSource_) + 1;
+  if(sourceDictionaries_.size() < needed)
+  {
+    sourceDictionaries_.resize(needed, Dictionary(decoder_.dictionary().size()));
+  }
+  // Park the current source's entries, then bring in the new source's.
+  decoder_.swapDictionary(sourceDictionaries_[currentSource_]);
+  decoder_.swapDictionary(sourceDictionaries_[source]);
+}
+
 void
 BasePacketAssembler::receiverStarted(Communication::Receiver & /*receiver*/)
 {
@@ -11,6 +11,7 @@
 #include <Communication/Assembler.h>
 #include <Codecs/Decoder.h>
 #include <Codecs/DataSource.h>
+#include <Codecs/Dictionary.h>
 #include <Codecs/HeaderAnalyzer.h>
 #include <Codecs/TemplateRegistry_fwd.h>
 #include <Messages/ValueMessageBuilder_fwd.h>
@@ -46,6 +47,20 @@ namespace QuickFAST
         messageLimit_ = messageLimit;
       }
 
+      /// @brief Keep a separate dictionary for each source.
+      ///
+      /// When one receiver reads several independent feeds (see
+      /// EpollMulticastReceiver) each feed's packets must be decoded with that
+      /// feed's dictionary.  The source of each buffer (LinkedBuffer::source())
+      /// selects the dictionary to swap into the decoder.
+      ///
+      /// Do not use this with A/B arbitration; there the sources carry the same stream.
+      /// @param dictionaryPerSource true to keep the feeds' dictionaries apart.
+      void setDictionaryPerSource(bool dictionaryPerSource = true)
+      {
+        dictionaryPerSource_ = dictionaryPerSource;
+      }
+
       /// @brief Access the internal decoder
       /// @returns a reference to the internal decoder
       Codecs::Decoder & decoder()
@@ -91,6 +106,16 @@ namespace QuickFAST
       /// @param size is how many valid bytes of data are at *buffer.
       bool decodeBuffer(const unsigned char * buffer, size_t size);
 
+      /// @brief Decode the contents of a LinkedBuffer
+      ///
+      /// Also passes the buffer's receive time (if known) and
+      /// any change of source to the builder.
+      /// @param buffer contains the data.
+      bool decodeBuffer(const Communication::LinkedBuffer * buffer);
+
+    private:
+      void selectDictionary(size_t source);
+
     private:
       BasePacketAssembler & operator = (const BasePacketAssembler &);
       BasePacketAssembler(const BasePacketAssembler &);
@@ -115,6 +140,13 @@ namespace QuickFAST
       size_t byteCount_;
       /// How many buffers should be decoded before stopping artificially.
       size_t messageLimit_;
+
+      /// The source of the most recent buffer.
+      size_t currentSource_;
+      /// Swap dictionaries when the source changes.
+      bool dictionaryPerSource_;
+      /// The dictionaries of the sources not being decoded, indexed by source.
+      std::vector<Dictionary> sourceDictionaries_;
     };
 
   }
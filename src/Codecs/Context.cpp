@@ -17,9 +17,7 @@ Context::Context(Codecs::TemplateRegistryCPtr registry)
 , templateRegistry_(registry)
 , templateId_(~0U)
 , strict_(true)
-, indexedDictionarySize_(registry->dictionarySize())
-//, indexedDictionary_(new Messages::FieldCPtr[indexedDictionarySize_])
-, indexedDictionary_(new Value[indexedDictionarySize_])
+, dictionary_(registry->dictionarySize())
 {
 }
 
@@ -30,16 +28,29 @@ Context::~Context()
 void
 Context::reset(bool resetTemplateId /*= true*/)
 {
-  for(size_t nDict = 0; nDict < indexedDictionarySize_; ++nDict)
-  {
-    indexedDictionary_[nDict].erase();
-  }
+  dictionary_.reset();
   if(resetTemplateId)
   {
     templateId_ = ~0U;
   }
 }
 
+bool
+Context::placeDictionary(int node)
+{
+  return dictionary_.placeOnNode(node);
+}
+
+void
+Context::swapDictionary(Dictionary & dictionary)
+{
+  if(dictionary.size() != dictionary_.size())
+  {
+    throw UsageError("Coding Error", "Dictionary does not match the template registry.");
+  }
+  dictionary_.swap(dictionary);
+}
+
 
 bool
 Context::findTemplate(const std::string & name, const std::string & nameSpace, TemplateCPtr & result) const
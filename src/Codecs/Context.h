@@ -13,6 +13,7 @@
 #include <Common/Exceptions.h>
 #include <Common/WorkingBuffer.h>
 #include <Codecs/TemplateRegistry_fwd.h>
+#include <Codecs/Dictionary.h>
 #include <Codecs/Template_fwd.h>
 #include <Messages/FieldIdentity_fwd.h>
 
@@ -62,6 +63,32 @@ namespace QuickFAST
       ///        however there are cases when you don't.
       void reset(bool resetTemplateId = true);
 
+      /// @brief Move the dictionary to a NUMA node.
+      ///
+      /// Use the node of the CPU that decodes (see Common::ThreadPlacement).
+      /// @param node the destination
+      /// @returns true if the dictionary was moved.
+      bool placeDictionary(int node);
+
+      /// @brief Access the dictionary.
+      const Dictionary & dictionary()const
+      {
+        return dictionary_;
+      }
+
+      /// @brief Exchange this context's dictionary with another.
+      ///
+      /// Nothing is copied, so one Encoder or Decoder can serve several
+      /// channels, each with its own Dictionary, by swapping them in and out.
+      /// @param dictionary must have been created for the same registry.
+      void swapDictionary(Dictionary & dictionary);
+
+      /// @brief Statistic: how many bytes do the dictionary and working buffer use?
+      size_t memoryUsed()const
+      {
+        return dictionary_.memoryUsed() + workingBuffer_.capacity();
+      }
+
       /// @brief Remember the id of the template driving the Xcoding.
       void setTemplateId(const template_id_t & templateId)
       {
@@ -100,22 +127,26 @@ namespace QuickFAST
       /// @param index identifies the dictionary entry corresponding to this field
       void setDictionaryValueNull(size_t index)
       {
-        if(index > indexedDictionarySize_)
+        if(index >= dictionary_.size())
         {
           throw TemplateDefinitionError("Illegal dictionary index.");
         }
-        indexedDictionary_[index].setNull();
+        dictionary_.entry(index).setNull();
       }
 
       /// @brief Sets the value in the dictionary to be undefined
       /// @param index identifies the dictionary entry corresponding to this field
       void setDictionaryValueUndefined(size_t index)
       {
-        if(index > indexedDictionarySize_)
+        if(index >= dictionary_.size())
         {
           throw TemplateDefinitionError("Illegal dictionary index.");
         }
-        indexedDictionary_[index].setUndefined();
+        Value * entry = dictionary_.find(index);
+        if(entry != 0)
+        {
+          entry->setUndefined();
+        }
       }
 
       /// @brief Sets the value in the dictionary
@@ -124,11 +155,11 @@ namespace QuickFAST
       template<typename VALUE_TYPE>
       void setDictionaryValue(size_t index, const VALUE_TYPE & value)
       {
-        if(index > indexedDictionarySize_)
+        if(index >= dictionary_.size())
         {
           throw TemplateDefinitionError("Illegal dictionary index.");
         }
-        indexedDictionary_[index].setValue(value);
+        dictionary_.entry(index).setValue(value);
       }
 
       /// @brief Sets the string value in the dictionary
@@ -137,11 +168,11 @@ namespace QuickFAST
       /// @param length is the lenght of the string pointed to by value
       void setDictionaryValue(size_t index, const unsigned char * value, size_t length)
       {
-        if(index > indexedDictionarySize_)
+        if(index >= dictionary_.size())
         {
           throw TemplateDefinitionError("Illegal dictionary index.");
         }
-        indexedDictionary_[index].setValue(value, length);
+        dictionary_.entry(index).setValue(value, length);
       }
 
       /// @brief Get a value from the dictionary
@@ -150,20 +181,20 @@ namespace QuickFAST
       template<typename VALUE_TYPE>
       DictionaryStatus getDictionaryValue(size_t index, VALUE_TYPE & value)
       {
-        if(index > indexedDictionarySize_)
+        if(index >= dictionary_.size())
         {
           throw TemplateDefinitionError("Illegal dictionary index.");
         }
-        Value & entry = indexedDictionary_[index];
-        if(!entry.isDefined())
+        const Value * entry = dictionary_.find(index);
+        if(entry == 0 || !entry->isDefined())
         {
           return UNDEFINED_VALUE;
         }
-        if(entry.isNull())
+        if(entry->isNull())
         {
           return NULL_VALUE;
         }
-        (void)entry.getValue(value);
+        (void)entry->getValue(value);
         return OK_VALUE;
       }
 
@@ -173,20 +204,20 @@ namespace QuickFAST
       /// @param length is the length of the string pointed to by value
       DictionaryStatus getDictionaryValue(size_t index, const unsigned char *& value, size_t &length)
       {
-        if(index > indexedDictionarySize_)
+        if(index >= dictionary_.size())
         {
           throw TemplateDefinitionError("Illegal dictionary index.");
         }
-        Value & entry = indexedDictionary_[index];
-        if(!entry.isDefined())
+        const Value * entry = dictionary_.find(index);
+        if(entry == 0 || !entry->isDefined())
         {
           return UNDEFINED_VALUE;
         }
-        if(entry.isNull())
+        if(entry->isNull())
         {
           return NULL_VALUE;
         }
-        (void)entry.getValue(value, length);
+        (void)entry->getValue(value, length);
         return OK_VALUE;
       }
 
@@ -352,9 +383,7 @@ namespace QuickFAST
       /// false makes the Xcoder more forgiving
       bool strict_;
     private:
-      size_t indexedDictionarySize_;
-      typedef boost::scoped_array<Value> IndexedDictionary;
-      IndexedDictionary indexedDictionary_;
+      Dictionary dictionary_;
       WorkingBuffer workingBuffer_;
     };
   }
@@ -116,6 +116,7 @@ namespace QuickFAST{
         }
         else if(getBuffer(buffer_, size_))
         {
+          consumed_ += position_;
           position_ = 0;
           byte = buffer_[position_++];
         }
@@ -131,6 +132,16 @@ namespace QuickFAST{
         return ok;
       }
 
+      /// @brief How many bytes have been consumed from this DataSource?
+      ///
+      /// Counts across buffer boundaries so the difference between two calls
+      /// is the number of bytes used in between.
+      /// @returns the total number of bytes consumed so far.
+      size_t bytesConsumed()const
+      {
+        return consumed_ + position_;
+      }
+
       /// @brief A FYI from the decoder to tell the DataSource about a message boundary.
       /// No action is required but some data sources can do interesting things with
       /// the information
@@ -177,6 +188,7 @@ namespace QuickFAST{
       /// @brief Discard any remaining contents and prepare for new data.
       void reset()
       {
+        consumed_ += position_;
         size_ = 0;
         position_ = 0;
         buffer_ = 0;
@@ -203,6 +215,8 @@ namespace QuickFAST{
       size_t size_;
       /// position within current buffer
       size_t position_;
+      /// bytes consumed from previous buffers
+      size_t consumed_;
     protected:
       /// Where echo output gets written
       std::ostream * echo_;
@@ -8,6 +8,7 @@
 #include <Codecs/PresenceMap.h>
 #include <Codecs/TemplateRegistry.h>
 #include <Codecs/FieldInstruction.h>
+#include <Codecs/DecoderObserver.h>
 #include <Messages/ValueMessageBuilder.h>
 #include <Common/Profiler.h>
 
@@ -16,6 +17,7 @@ using namespace ::QuickFAST::Codecs;
 
 Decoder::Decoder(Codecs::TemplateRegistryPtr registry)
 : Context(registry)
+, observer_(0)
 {
 }
 
@@ -31,6 +33,7 @@ Decoder::decodeMessage(
 {
   PROFILE_POINT("decode");
   source.beginMessage();
+  size_t messageStart = source.bytesConsumed();
 
   Codecs::PresenceMap pmap(getTemplateRegistry()->presenceMapBits());
   if(this->verboseOut_)
@@ -61,6 +64,10 @@ Decoder::decodeMessage(
     {
       reset(false);
     }
+    if(observer_)
+    {
+      observer_->beginMessage(*templatePtr, source.bytesConsumed() - messageStart);
+    }
     Messages::ValueMessageBuilder & bodyBuilder(
       messageBuilder.startMessage(
         templatePtr->getApplicationType(),
@@ -68,6 +75,10 @@ Decoder::decodeMessage(
         templatePtr->fieldCount()));
 
     decodeSegmentBody(source, pmap, templatePtr, bodyBuilder);
+    if(observer_)
+    {
+      observer_->endMessage(*templatePtr, source.bytesConsumed() - messageStart);
+    }
     if(templatePtr->getIgnore())
     {
       messageBuilder.ignoreMessage(bodyBuilder);
@@ -184,6 +195,32 @@ Decoder::decodeSegmentBody(
       (*verboseOut_) <<std::endl << "Decode instruction[" <<nField << "]: " << instruction->getIdentity().name() << std::endl;
     }
     source.beginField(instruction->getIdentity().name());
-    (void)instruction->decode(source, pmap, *this, messageBuilder);
+    if(observer_)
+    {
+      observeField(source, pmap, *instruction, messageBuilder);
+    }
+    else
+    {
+      (void)instruction->decode(source, pmap, *this, messageBuilder);
+    }
   }
 }
+
+void
+Decoder::observeField(
+  DataSource & source,
+  Codecs::PresenceMap & pmap,
+  const Codecs::FieldInstruction & instruction,
+  Messages::ValueMessageBuilder & messageBuilder)
+{
+  size_t startByte = source.bytesConsumed();
+  size_t startBit = pmap.bitPosition();
+  (void)instruction.decode(source, pmap, *this, messageBuilder);
+  bool pmapBitUsed = instruction.getPresenceMapBitsUsed() != 0;
+  bool pmapBitSet = pmapBitUsed && pmap.bitPosition() != startBit && pmap.isFieldSet(startBit);
+  observer_->fieldDecoded(
+    instruction,
+    source.bytesConsumed() - startByte,
+    pmapBitUsed,
+    pmapBitSet);
+}
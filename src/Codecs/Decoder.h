@@ -11,8 +11,10 @@
 #include <Codecs/Context.h>
 #include <Codecs/DataSource_fwd.h>
 #include <Codecs/PresenceMap_fwd.h>
+#include <Codecs/FieldInstruction_fwd.h>
 #include <Codecs/Template.h>
 #include <Codecs/SegmentBody_fwd.h>
+#include <Codecs/DecoderObserver_fwd.h>
 #include <Messages/ValueMessageBuilder_fwd.h>
 
 #include <Common/Exceptions.h>
@@ -31,6 +33,22 @@ namespace QuickFAST{
       /// @param registry A registry containing all templates to be used to decode messages.
       explicit Decoder(TemplateRegistryPtr registry);
 
+      /// @brief Install an observer to be told the cost of every field decoded.
+      ///
+      /// The observer is not owned by the Decoder; it must outlive the decoding.
+      /// @param observer receives the reports.  Zero (the default) disables observation.
+      void setObserver(DecoderObserver * observer)
+      {
+        observer_ = observer;
+      }
+
+      /// @brief Access the observer if any.
+      /// @returns the observer or zero.
+      DecoderObserver * getObserver()const
+      {
+        return observer_;
+      }
+
       /// @brief Decode the next message.
       /// @param[in] source where to read the incoming message(s).
       /// @param[out] message an empty message into which the decoded fields will be stored.
@@ -77,6 +95,16 @@ namespace QuickFAST{
         PresenceMap & pmap,
         const SegmentBodyCPtr & segment,
         Messages::ValueMessageBuilder & messageBuilder);
+
+    private:
+      void observeField(
+        DataSource & source,
+        PresenceMap & pmap,
+        const FieldInstruction & instruction,
+        Messages::ValueMessageBuilder & messageBuilder);
+
+    private:
+      DecoderObserver * observer_;
     };
   }
 }
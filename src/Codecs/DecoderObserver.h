@@ -0,0 +1,54 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef DECODEROBSERVER_H
+#define DECODEROBSERVER_H
+#include "DecoderObserver_fwd.h"
+#include <Common/QuickFAST_Export.h>
+#include <Codecs/Template_fwd.h>
+#include <Codecs/FieldInstruction_fwd.h>
+
+namespace QuickFAST{
+  namespace Codecs{
+    /// @brief Receive a report of the wire cost of each field as it is decoded.
+    ///
+    /// Install an observer with Decoder::setObserver() to analyze how efficiently
+    /// a set of templates encodes the actual traffic.  When no observer is installed
+    /// the Decoder does not measure anything, so there is no cost to normal decoding.
+    ///
+    /// Calls for the fields of nested groups, sequences and template references arrive
+    /// before the call for the enclosing field, and the byte count for the enclosing
+    /// field includes the bytes of everything nested within it.
+    class QuickFAST_Export DecoderObserver
+    {
+    public:
+      /// @brief Typical virtual destructor
+      virtual ~DecoderObserver(){}
+
+      /// @brief A message has been identified and its body is about to be decoded.
+      /// @param templ is the template that will be used to decode the message.
+      /// @param headerBytes counts the bytes used by the presence map and template ID.
+      virtual void beginMessage(const Template & templ, size_t headerBytes) = 0;
+
+      /// @brief A field instruction has been applied to the incoming data.
+      /// @param instruction is the field instruction that was applied.
+      /// @param bytes counts the bytes consumed from the DataSource by this field.
+      /// @param pmapBitUsed is true if the field consumed a presence map bit.
+      /// @param pmapBitSet is true if that presence map bit was set.
+      virtual void fieldDecoded(
+        const FieldInstruction & instruction,
+        size_t bytes,
+        bool pmapBitUsed,
+        bool pmapBitSet) = 0;
+
+      /// @brief The message identified in beginMessage has been completely decoded.
+      /// @param templ is the template that was used to decode the message.
+      /// @param messageBytes counts all bytes in the message including the header.
+      virtual void endMessage(const Template & templ, size_t messageBytes) = 0;
+    };
+  }
+}
+#endif // DECODEROBSERVER_H
@@ -0,0 +1,140 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+#include "Dictionary.h"
+#include <Common/ThreadPlacement.h>
+#include <Common/Exceptions.h>
+
+using namespace ::QuickFAST;
+using namespace ::QuickFAST::Codecs;
+
+Dictionary::Dictionary(size_t size)
+: size_(size)
+, pageCount_((size + pageSize - 1) >> pageBits)
+, pages_(new Value *[pageCount_])
+, allocatedPages_(0)
+{
+  std::fill(pages_, pages_ + pageCount_, static_cast<Value *>(0));
+}
+
+Dictionary::Dictionary(const Dictionary & rhs)
+: size_(rhs.size_)
+, pageCount_(rhs.pageCount_)
+, pages_(new Value *[pageCount_])
+, allocatedPages_(0)
+{
+  std::fill(pages_, pages_ + pageCount_, static_cast<Value *>(0));
+  try
+  {
+    copyPages(rhs);
+  }
+  catch(...)
+  {
+    release();
+    delete [] pages_;
+    throw;
+  }
+}
+
+Dictionary::~Dictionary()
+{
+  release();
+  delete [] pages_;
+}
+
+Dictionary &
+Dictionary::operator=(const Dictionary & rhs)
+{
+  if(this != &rhs)
+  {
+    Dictionary copy(rhs);
+    swap(copy);
+  }
+  return *this;
+}
+
+void
+Dictionary::swap(Dictionary & rhs)
+{
+  std::swap(size_, rhs.size_);
+  std::swap(pageCount_, rhs.pageCount_);
+  std::swap(pages_, rhs.pages_);
+  std::swap(allocatedPages_, rhs.allocatedPages_);
+}
+
+void
+Dictionary::reset()
+{
+  for(size_t nPage = 0; nPage < pageCount_; ++nPage)
+  {
+    Value * page = pages_[nPage];
+    if(page != 0)
+    {
+      for(size_t nEntry = 0; nEntry < pageSize; ++nEntry)
+      {
+        page[nEntry].erase();
+      }
+    }
+  }
+}
+
+void
+Dictionary::release()
+{
+  for(size_t nPage = 0; nPage < pageCount_; ++nPage)
+  {
+    delete [] pages_[nPage];
+    pages_[nPage] = 0;
+  }
+  allocatedPages_ = 0;
+}
+
+size_t
+Dictionary::memoryUsed()const
+{
+  return sizeof(*this)
+    + pageCount_ * sizeof(Value *)
+    + allocatedPages_ * pageSize * sizeof(Value);
+}
+
+bool
+Dictionary::placeOnNode(int node)
+{
+  bool placed = true;
+  for(size_t nPage = 0; nPage < pageCount_; ++nPage)
+  {
+    if(pages_[nPage] != 0)
+    {
+      placed = Common::ThreadPlacement::placeOnNode(
+        pages_[nPage], pageSize * sizeof(Value), node) && placed;
+    }
+  }
+  return placed;
+}
+
+Value *
+Dictionary::allocatePage(size_t page)
+{
+  if(page >= pageCount_)
+  {
+    throw TemplateDefinitionError("Illegal dictionary index.");
+  }
+  pages_[page] = new Value[pageSize];
+  ++allocatedPages_;
+  return pages_[page];
+}
+
+void
+Dictionary::copyPages(const Dictionary & rhs)
+{
+  for(size_t nPage = 0; nPage < pageCount_; ++nPage)
+  {
+    const Value * source = rhs.pages_[nPage];
+    if(source != 0)
+    {
+      Value * page = allocatePage(nPage);
+      std::copy(source, source + pageSize, page);
+    }
+  }
+}
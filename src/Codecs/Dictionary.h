@@ -0,0 +1,123 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef DICTIONARY_H
+#define DICTIONARY_H
+#include "Dictionary_fwd.h"
+#include <Common/QuickFAST_Export.h>
+#include <Common/Value.h>
+
+namespace QuickFAST{
+  namespace Codecs{
+    /// @brief The dictionary entries used by one Encoder or Decoder.
+    ///
+    /// Entries are identified by the index assigned by the DictionaryIndexer
+    /// when the TemplateRegistry is finalized.  Every Context that shares a
+    /// registry sees the same indexes, but a Context that uses only some of
+    /// the templates touches only some of the entries.
+    ///
+    /// The entries are stored in pages of pageSize.  A page is allocated the
+    /// first time one of its entries is set, so the memory used scales with the
+    /// fields actually decoded rather than with the size of the registry.
+    /// Templates are indexed one after another so a template's fields share
+    /// a few pages.
+    ///
+    /// A Dictionary may be copied (to checkpoint or clone a channel's state)
+    /// or swapped into a Context (see Context::swapDictionary()).  Only the
+    /// allocated pages are copied.
+    class QuickFAST_Export Dictionary
+    {
+    public:
+      /// @brief Construct an empty dictionary.
+      /// @param size the number of entries (TemplateRegistry::dictionarySize())
+      explicit Dictionary(size_t size = 0);
+
+      /// @brief Copy the allocated pages of another dictionary.
+      Dictionary(const Dictionary & rhs);
+
+      ~Dictionary();
+
+      /// @brief Replace the contents with a copy of another dictionary.
+      Dictionary & operator=(const Dictionary & rhs);
+
+      /// @brief Exchange contents with another dictionary.  Nothing is copied.
+      void swap(Dictionary & rhs);
+
+      /// @brief How many entries can this dictionary hold?
+      size_t size()const
+      {
+        return size_;
+      }
+
+      /// @brief Find an entry without allocating it.
+      /// @param index identifies the entry.  Must be less than size().
+      /// @returns the entry or zero if it has never been set (and is therefore undefined.)
+      Value * find(size_t index)const
+      {
+        Value * page = pages_[index >> pageBits];
+        return page == 0 ? 0 : &page[index & pageMask];
+      }
+
+      /// @brief Access an entry, allocating its page if necessary.
+      /// @param index identifies the entry.  Must be less than size().
+      Value & entry(size_t index)
+      {
+        Value * page = pages_[index >> pageBits];
+        if(page == 0)
+        {
+          page = allocatePage(index >> pageBits);
+        }
+        return page[index & pageMask];
+      }
+
+      /// @brief Make every entry undefined.  Allocated pages are kept for reuse.
+      void reset();
+
+      /// @brief Make every entry undefined and free the pages.
+      void release();
+
+      /// @brief Statistic: how many entries are allocated?
+      size_t allocatedEntries()const
+      {
+        size_t entries = allocatedPages_ * pageSize;
+        return entries < size_ ? entries : size_;
+      }
+
+      /// @brief Statistic: how many bytes does this dictionary use?
+      ///
+      /// Includes the page table and the allocated pages.
+      /// Strings too long to be stored within an entry are not counted.
+      size_t memoryUsed()const;
+
+      /// @brief Move the allocated pages to a NUMA node.
+      ///
+      /// Pages allocated later are placed by the kernel's usual
+      /// policy: on the node of the thread that first touches them.
+      /// @param node the destination
+      /// @returns true if every allocated page was moved.
+      bool placeOnNode(int node);
+
+    private:
+      enum
+      {
+        pageBits = 5,
+        /// @brief Entries per page.  32 * sizeof(Value) is a few kilobytes.
+        pageSize = 1 << pageBits,
+        pageMask = pageSize - 1
+      };
+
+      Value * allocatePage(size_t page);
+      void copyPages(const Dictionary & rhs);
+
+    private:
+      size_t size_;
+      size_t pageCount_;
+      Value ** pages_;
+      size_t allocatedPages_;
+    };
+  }
+}
+#endif // DICTIONARY_H
@@ -9,6 +9,17 @@
 #include <Codecs/Decoder.h>
 #include <Codecs/Encoder.h>
 
+#if defined(__AVX2__) && !defined(QUICKFAST_NO_SIMD)
+# define QUICKFAST_USE_AVX2
+# include <immintrin.h>
+#elif (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)) && !defined(QUICKFAST_NO_SIMD)
+# define QUICKFAST_USE_SSE2
+# include <emmintrin.h>
+#endif
+#if defined(_MSC_VER)
+# include <intrin.h>
+#endif
+
 using namespace ::QuickFAST;
 using namespace ::QuickFAST::Codecs;
 
@@ -745,15 +756,145 @@ FieldInstruction::encodeBlobData(DataDestination & destination, const StringBuff
   }
 }
 
+namespace
+{
+  /// @brief Find the first mismatch within one vector-width block.
+  ///
+  /// @param mismatchBits has a one bit for each byte position that differs.
+  /// @returns the index of the lowest differing byte.
+  inline size_t lowestSetBit(unsigned int mismatchBits)
+  {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mismatchBits);
+    return index;
+#elif defined(__GNUC__)
+    return __builtin_ctz(mismatchBits);
+#else
+    size_t index = 0;
+    while((mismatchBits & 1) == 0)
+    {
+      mismatchBits >>= 1;
+      ++index;
+    }
+    return index;
+#endif
+  }
+
+  /// @brief Find the last mismatch within one vector-width block.
+  ///
+  /// @param mismatchBits has a one bit for each byte position that differs.
+  /// @returns the index of the highest differing byte.
+  inline size_t highestSetBit(unsigned int mismatchBits)
+  {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse(&index, mismatchBits);
+    return index;
+#elif defined(__GNUC__)
+    return 31 - __builtin_clz(mismatchBits);
+#else
+    size_t index = 31;
+    while((mismatchBits & 0x80000000U) == 0)
+    {
+      mismatchBits <<= 1;
+      --index;
+    }
+    return index;
+#endif
+  }
+
+#if defined(QUICKFAST_USE_AVX2)
+  const size_t vectorWidth = 32;
+  /// @brief Compare one block of bytes.
+  /// @returns a bit mask with a one for each byte that differs.
+  inline unsigned int mismatchMask(const uchar * lhs, const uchar * rhs)
+  {
+    __m256i l = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lhs));
+    __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rhs));
+    return ~static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(l, r)));
+  }
+#elif defined(QUICKFAST_USE_SSE2)
+  const size_t vectorWidth = 16;
+  /// @brief Compare one block of bytes.
+  /// @returns a bit mask with a one for each byte that differs.
+  inline unsigned int mismatchMask(const uchar * lhs, const uchar * rhs)
+  {
+    __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lhs));
+    __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rhs));
+    return ~static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(l, r))) & 0xFFFFU;
+  }
+#endif
+}
+
 size_t
 FieldInstruction::longestMatchingPrefix(
   const std::string & previous,
   const std::string & value)
 {
-  size_t plen = previous.length();
-  size_t vlen = value.length();
-  size_t len = std::min(plen, vlen);
+  return longestMatchingPrefix(
+    reinterpret_cast<const uchar *>(previous.data()),
+    previous.length(),
+    reinterpret_cast<const uchar *>(value.data()),
+    value.length());
+}
+
+size_t
+FieldInstruction::longestMatchingSuffix(
+  const std::string & previous,
+  const std::string & value)
+{
+  return longestMatchingSuffix(
+    reinterpret_cast<const uchar *>(previous.data()),
+    previous.length(),
+    reinterpret_cast<const uchar *>(value.data()),
+    value.length());
+}
+
+size_t
+FieldInstruction::longestMatchingPrefix(
+  const std::string & previous,
+  const StringBuffer & value)
+{
+  return longestMatchingPrefix(
+    reinterpret_cast<const uchar *>(previous.data()),
+    previous.length(),
+    value.c_str(),
+    value.size());
+}
+
+size_t
+FieldInstruction::longestMatchingSuffix(
+  const std::string & previous,
+  const StringBuffer & value)
+{
+  return longestMatchingSuffix(
+    reinterpret_cast<const uchar *>(previous.data()),
+    previous.length(),
+    value.c_str(),
+    value.size());
+}
+
+size_t
+FieldInstruction::longestMatchingPrefix(
+  const uchar * previous,
+  size_t previousLength,
+  const uchar * value,
+  size_t valueLength)
+{
+  size_t len = std::min(previousLength, valueLength);
   size_t result = 0;
+#if defined(QUICKFAST_USE_AVX2) || defined(QUICKFAST_USE_SSE2)
+  while(result + vectorWidth <= len)
+  {
+    unsigned int mismatch = mismatchMask(previous + result, value + result);
+    if(mismatch != 0)
+    {
+      return result + lowestSetBit(mismatch);
+    }
+    result += vectorWidth;
+  }
+#endif
   while(result < len && previous[result] == value[result])
   {
     ++result;
@@ -763,21 +904,60 @@ FieldInstruction::longestMatchingPrefix(
 
 size_t
 FieldInstruction::longestMatchingSuffix(
-  const std::string & previous,
-  const std::string & value)
+  const uchar * previous,
+  size_t previousLength,
+  const uchar * value,
+  size_t valueLength)
 {
-  size_t ppos = previous.length();
-  size_t vpos = value.length();
+  size_t len = std::min(previousLength, valueLength);
+  const uchar * pend = previous + previousLength;
+  const uchar * vend = value + valueLength;
   size_t result = 0;
-  while(ppos > 0 && vpos > 0 && previous[ppos-1] == value[vpos - 1])
+#if defined(QUICKFAST_USE_AVX2) || defined(QUICKFAST_USE_SSE2)
+  while(result + vectorWidth <= len)
+  {
+    unsigned int mismatch = mismatchMask(
+      pend - result - vectorWidth,
+      vend - result - vectorWidth);
+    if(mismatch != 0)
+    {
+      // bytes above the highest mismatch match.
+      return result + (vectorWidth - 1 - highestSetBit(mismatch));
+    }
+    result += vectorWidth;
+  }
+#endif
+  while(result < len && pend[-1 - ptrdiff_t(result)] == vend[-1 - ptrdiff_t(result)])
   {
     ++result;
-    --ppos;
-    --vpos;
   }
   return result;
 }
 
+void
+FieldInstruction::applyStringDelta(
+  const std::string & previous,
+  size_t removeCount,
+  bool atFront,
+  const uchar * delta,
+  size_t deltaLength,
+  std::string & result)
+{
+  size_t keep = previous.size() - removeCount;
+  result.clear();
+  result.reserve(keep + deltaLength);
+  if(atFront)
+  {
+    result.append(reinterpret_cast<const char *>(delta), deltaLength);
+    result.append(previous, removeCount, keep);
+  }
+  else
+  {
+    result.append(previous, 0, keep);
+    result.append(reinterpret_cast<const char *>(delta), deltaLength);
+  }
+}
+
 void
 FieldInstruction::setDictionaryName(const std::string & /*name*/)
 {
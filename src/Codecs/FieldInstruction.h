@@ -580,6 +580,72 @@ namespace QuickFAST{
         const std::string & previous,
         const std::string & value);
 
+      /// @brief Find the longest match at the beginning of a dictionary value and application data
+      ///
+      /// Avoids converting the StringBuffer to a std::string
+      /// @param previous the dictionary value
+      /// @param value the application data
+      /// @returns a count of bytes that match exactly at the beginning of the strings
+      static size_t longestMatchingPrefix(
+        const std::string & previous,
+        const StringBuffer & value);
+
+      /// @brief Find the longest match at the end of a dictionary value and application data
+      ///
+      /// Avoids converting the StringBuffer to a std::string
+      /// @param previous the dictionary value
+      /// @param value the application data
+      /// @returns a count of bytes that match exactly at the end of the strings
+      static size_t longestMatchingSuffix(
+        const std::string & previous,
+        const StringBuffer & value);
+
+      /// @brief Find the longest match at the beginning of two byte arrays
+      ///
+      /// Compares a vector register's worth of bytes per step when SSE2 (or AVX2) is available.
+      /// @param previous points to one of the arrays
+      /// @param previousLength is the size of previous in bytes
+      /// @param value points to the other array
+      /// @param valueLength is the size of value in bytes
+      /// @returns a count of bytes that match exactly at the beginning of the arrays
+      static size_t longestMatchingPrefix(
+        const uchar * previous,
+        size_t previousLength,
+        const uchar * value,
+        size_t valueLength);
+
+      /// @brief Find the longest match at the end of two byte arrays
+      ///
+      /// Compares a vector register's worth of bytes per step when SSE2 (or AVX2) is available.
+      /// @param previous points to one of the arrays
+      /// @param previousLength is the size of previous in bytes
+      /// @param value points to the other array
+      /// @param valueLength is the size of value in bytes
+      /// @returns a count of bytes that match exactly at the end of the arrays
+      static size_t longestMatchingSuffix(
+        const uchar * previous,
+        size_t previousLength,
+        const uchar * value,
+        size_t valueLength);
+
+      /// @brief Reconstruct a string from its previous value and a delta or tail
+      ///
+      /// Builds the result in place with at most one allocation rather than
+      /// concatenating temporary substrings.
+      /// @param previous the value from the dictionary
+      /// @param removeCount how many bytes to remove from previous (must not exceed previous.size())
+      /// @param atFront true to replace the front of previous; false to replace the end
+      /// @param delta points to the bytes to be added
+      /// @param deltaLength is the number of bytes to be added
+      /// @param[out] result receives the new value
+      static void applyStringDelta(
+        const std::string & previous,
+        size_t removeCount,
+        bool atFront,
+        const uchar * delta,
+        size_t deltaLength,
+        std::string & result);
+
 
       /// @brief Basic decoding for ByteVectors and Utf8 strings
       ///
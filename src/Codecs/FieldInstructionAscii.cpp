@@ -217,13 +217,13 @@ FieldInstructionAscii::decodeDelta(
       return;
     }
   }
-  std::string deltaValue;
+  const uchar * deltaValue = 0;
+  size_t deltaValueSize = 0;
   WorkingBuffer & buffer = decoder.getWorkingBuffer();
   if(decodeAsciiFromSource(source, true, buffer))
   {
-    deltaValue = std::string(
-      reinterpret_cast<const char *>(buffer.begin()),
-      buffer.size());
+    deltaValue = buffer.begin();
+    deltaValueSize = buffer.size();
   }
 
 
@@ -249,7 +249,8 @@ FieldInstructionAscii::decodeDelta(
       decoder.reportError("[ERR D7]", "ASCII tail delta front length exceeds length of previous string.", identity_);
       deltaLength = QuickFAST::int32(previousLength);
     }
-    std::string value = deltaValue + previousValue.substr(deltaLength);
+    std::string value;
+    applyStringDelta(previousValue, deltaLength, true, deltaValue, deltaValueSize, value);
     builder.addValue(
       identity_,
       ValueType::ASCII,
@@ -268,7 +269,8 @@ FieldInstructionAscii::decodeDelta(
       decoder.reportError("[ERR D7]", "ASCII tail delta back length exceeds length of previous string.", identity_);
       deltaLength = QuickFAST::uint32(previousLength);
     }
-    std::string value = previousValue.substr(0, previousLength - deltaLength) + deltaValue;
+    std::string value;
+    applyStringDelta(previousValue, deltaLength, false, deltaValue, deltaValueSize, value);
     builder.addValue(
       identity_,
       ValueType::ASCII,
@@ -292,8 +294,7 @@ FieldInstructionAscii::decodeTail(
     WorkingBuffer & buffer = decoder.getWorkingBuffer();
     if(decodeAsciiFromSource(source, isMandatory(), buffer))
     {
-      const std::string tailValue(reinterpret_cast<const char *>(buffer.begin()), buffer.size());
-      size_t tailLength = tailValue.length();
+      size_t tailLength = buffer.size();
       std::string previousValue;
       Context::DictionaryStatus previousStatus = fieldOp_->getDictionaryValue(decoder, previousValue);
       if(previousStatus == Context::UNDEFINED_VALUE)
@@ -305,11 +306,13 @@ FieldInstructionAscii::decodeTail(
         }
       }
       size_t previousLength = previousValue.length();
-      if(tailLength > previousLength)
+      size_t removeCount = tailLength;
+      if(removeCount > previousLength)
       {
-        tailLength = previousLength;
+        removeCount = previousLength;
       }
-      std::string value(previousValue.substr(0, previousLength - tailLength) + tailValue);
+      std::string value;
+      applyStringDelta(previousValue, removeCount, false, buffer.begin(), tailLength, value);
       builder.addValue(
         identity_,
         ValueType::ASCII,
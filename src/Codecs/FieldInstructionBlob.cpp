@@ -220,13 +220,13 @@ FieldInstructionBlob::decodeDelta(
     }
   }
 
-  std::string deltaValue;
+  const uchar * deltaValue = 0;
+  size_t deltaValueSize = 0;
   WorkingBuffer& buffer = decoder.getWorkingBuffer();
   if(decodeBlobFromSource(source, decoder, true /*isMandatory()*/, buffer))
   {
-    const uchar * value = buffer.begin();
-    size_t valueSize = buffer.size();
-    deltaValue = std::string(reinterpret_cast<const char *>(value), valueSize);
+    deltaValue = buffer.begin();
+    deltaValueSize = buffer.size();
   }
 
   std::string previousValue;
@@ -251,7 +251,8 @@ FieldInstructionBlob::decodeDelta(
       decoder.reportError("[ERR D7]", "String tail delta front length exceeds length of previous string.", identity_);
       deltaLength = QuickFAST::int32(previousLength);
     }
-    std::string value = deltaValue + previousValue.substr(deltaLength);
+    std::string value;
+    applyStringDelta(previousValue, deltaLength, true, deltaValue, deltaValueSize, value);
     builder.addValue(
       identity_,
       type_,
@@ -271,7 +272,8 @@ FieldInstructionBlob::decodeDelta(
       deltaLength = QuickFAST::uint32(previousLength);
     }
 
-    std::string value = previousValue.substr(0, previousLength - deltaLength) + deltaValue;
+    std::string value;
+    applyStringDelta(previousValue, deltaLength, false, deltaValue, deltaValueSize, value);
     builder.addValue(
       identity_,
       type_,
@@ -296,7 +298,6 @@ FieldInstructionBlob::decodeTail(
     if(decodeBlobFromSource(source, decoder, isMandatory(), buffer))
     {
       size_t tailLength = buffer.size();
-      std::string tailValue(reinterpret_cast<const char *>(buffer.begin()), tailLength);
 
       std::string previousValue;
       Context::DictionaryStatus previousStatus = fieldOp_->getDictionaryValue(decoder, previousValue);
@@ -309,11 +310,13 @@ FieldInstructionBlob::decodeTail(
         }
       }
       size_t previousLength = previousValue.length();
-      if(tailLength > previousLength)
+      size_t removeCount = tailLength;
+      if(removeCount > previousLength)
       {
-        tailLength = previousLength;
+        removeCount = previousLength;
       }
-      std::string value(previousValue.substr(0, previousLength - tailLength) + tailValue);
+      std::string value;
+      applyStringDelta(previousValue, removeCount, false, buffer.begin(), tailLength, value);
       builder.addValue(
         identity_,
         type_,
@@ -0,0 +1,691 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+#include "FixMessageAccessor.h"
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/Template.h>
+#include <Codecs/FieldInstruction.h>
+#include <Messages/FieldIdentity.h>
+#include <Common/Decimal.h>
+#include <Common/Exceptions.h>
+
+using namespace ::QuickFAST;
+using namespace ::QuickFAST::Codecs;
+
+namespace
+{
+  /// Tags below this are found through the direct index; larger tags by searching.
+  const uint32 maxIndexedTag = 1 << 20;
+  /// The slot table starts out large enough for all standard FIX tags.
+  const size_t initialSlots = 10000;
+  const size_t notFound = size_t(-1);
+  const int64 maxMantissa = int64((uint64(1) << 63) - 1);
+
+  /// @brief Convert a field id into a FIX tag.
+  /// @returns 0 if the id is not a FIX tag number.
+  uint32 parseTag(const std::string & id)
+  {
+    if(id.empty() || id.size() > 9)
+    {
+      return 0;
+    }
+    uint32 tag = 0;
+    for(size_t pos = 0; pos < id.size(); ++pos)
+    {
+      char c = id[pos];
+      if(c < '0' || c > '9')
+      {
+        return 0;
+      }
+      tag = tag * 10 + uint32(c - '0');
+    }
+    return tag;
+  }
+
+  bool parseUnsigned(const char * value, size_t length, uint64 & result)
+  {
+    if(length == 0 || length > 20)
+    {
+      return false;
+    }
+    uint64 accumulator = 0;
+    for(size_t pos = 0; pos < length; ++pos)
+    {
+      unsigned int digit = static_cast<unsigned char>(value[pos]) - '0';
+      if(digit > 9)
+      {
+        return false;
+      }
+      uint64 next = accumulator * 10 + digit;
+      if(next / 10 != accumulator)
+      {
+        return false;
+      }
+      accumulator = next;
+    }
+    result = accumulator;
+    return true;
+  }
+
+  bool parseSigned(const char * value, size_t length, int64 & result)
+  {
+    bool negative = length > 0 && value[0] == '-';
+    uint64 magnitude;
+    if(!parseUnsigned(value + (negative ? 1 : 0), length - (negative ? 1 : 0), magnitude))
+    {
+      return false;
+    }
+    if(negative)
+    {
+      if(magnitude > uint64(1) << 63)
+      {
+        return false;
+      }
+      result = int64(uint64(0) - magnitude);
+    }
+    else
+    {
+      if(magnitude >= uint64(1) << 63)
+      {
+        return false;
+      }
+      result = int64(magnitude);
+    }
+    return true;
+  }
+
+  /// @brief Parse [-]www[.fff] into mantissa and exponent without using floating point.
+  bool parseDecimal(const char * value, size_t length, Decimal & result)
+  {
+    size_t pos = 0;
+    bool negative = false;
+    if(pos < length && (value[pos] == '-' || value[pos] == '+'))
+    {
+      negative = value[pos] == '-';
+      ++pos;
+    }
+    int64 mantissa = 0;
+    int exponent = 0;
+    bool point = false;
+    bool digits = false;
+    for(; pos < length; ++pos)
+    {
+      char c = value[pos];
+      if(c == '.' && !point)
+      {
+        point = true;
+      }
+      else if(c >= '0' && c <= '9')
+      {
+        digits = true;
+        if(mantissa > (maxMantissa - 9) / 10)
+        {
+          return false;
+        }
+        mantissa = mantissa * 10 + (c - '0');
+        if(point)
+        {
+          --exponent;
+        }
+      }
+      else
+      {
+        return false;
+      }
+    }
+    if(!digits || exponent < -63)
+    {
+      return false;
+    }
+    result = Decimal(negative ? -mantissa : mantissa, exponent_t(exponent));
+    return true;
+  }
+
+  void reportBadValue(const Messages::FieldIdentity & identity, const char * value, size_t length)
+  {
+    std::string msg("FIX field ");
+    msg += identity.id();
+    msg += " (";
+    msg += identity.name();
+    msg += ") has an invalid value: ";
+    msg.append(value, length);
+    throw EncodingError(msg);
+  }
+}
+
+/// @brief A view of a range of fields within a FIX message.
+///
+/// The message body and each sequence entry are presented to the encoder
+/// through one of these.
+class FixMessageAccessor::Entry : public Messages::MessageAccessor
+{
+public:
+  Entry(const FixMessageAccessor & owner, size_t depth)
+    : owner_(owner)
+    , begin_(0)
+    , end_(0)
+    , depth_(depth)
+  {
+  }
+
+  void setRange(size_t begin, size_t end)
+  {
+    begin_ = begin;
+    end_ = end;
+  }
+
+  virtual bool isPresent(const Messages::FieldIdentity & identity)const
+  {
+    const char * value;
+    size_t length;
+    return owner_.findValue(identity, begin_, end_, depth_, value, length);
+  }
+
+  virtual bool getUnsignedInteger(const Messages::FieldIdentity & identity, ValueType::Type type, uint64 & value)const
+  {
+    const char * text;
+    size_t length;
+    if(!owner_.findValue(identity, begin_, end_, depth_, text, length))
+    {
+      return false;
+    }
+    if(!parseUnsigned(text, length, value))
+    {
+      reportBadValue(identity, text, length);
+    }
+    return true;
+  }
+
+  virtual bool getSignedInteger(const Messages::FieldIdentity & identity, ValueType::Type type, int64 & value)const
+  {
+    const char * text;
+    size_t length;
+    if(!owner_.findValue(identity, begin_, end_, depth_, text, length))
+    {
+      return false;
+    }
+    if(!parseSigned(text, length, value))
+    {
+      reportBadValue(identity, text, length);
+    }
+    return true;
+  }
+
+  virtual bool getDecimal(const Messages::FieldIdentity & identity, ValueType::Type type, Decimal & value)const
+  {
+    const char * text;
+    size_t length;
+    if(!owner_.findValue(identity, begin_, end_, depth_, text, length))
+    {
+      return false;
+    }
+    if(!parseDecimal(text, length, value))
+    {
+      reportBadValue(identity, text, length);
+    }
+    return true;
+  }
+
+  virtual bool getString(const Messages::FieldIdentity & identity, ValueType::Type type, const StringBuffer *& value)const
+  {
+    const char * text;
+    size_t length;
+    if(!owner_.findValue(identity, begin_, end_, depth_, text, length))
+    {
+      return false;
+    }
+    owner_.stringValue_.assign(reinterpret_cast<const unsigned char *>(text), length);
+    value = &owner_.stringValue_;
+    return true;
+  }
+
+  virtual bool getGroup(const Messages::FieldIdentity & identity, const MessageAccessor *& group)const
+  {
+    // FIX has no nested components on the wire, so the group's fields are merged into this view.
+    group = this;
+    return owner_.groupPresent(identity, begin_, end_, depth_);
+  }
+
+  virtual bool getSequenceLength(const Messages::FieldIdentity & identity, size_t & length)const
+  {
+    return owner_.sequenceLength(identity, begin_, end_, depth_, length);
+  }
+
+  virtual bool getSequenceEntry(const Messages::FieldIdentity & identity, size_t index, const MessageAccessor *& entry)const
+  {
+    return owner_.sequenceEntry(index, depth_, entry);
+  }
+
+  virtual const std::string & getApplicationType()const
+  {
+    return owner_.applicationType_;
+  }
+
+  virtual const std::string & getApplicationTypeNs()const
+  {
+    return owner_.applicationTypeNamespace_;
+  }
+
+private:
+  Entry & operator=(const Entry &);
+
+private:
+  const FixMessageAccessor & owner_;
+  size_t begin_;
+  size_t end_;
+  size_t depth_;
+};
+
+FixMessageAccessor::FixMessageAccessor(TemplateRegistryCPtr registry, char delimiter)
+  : registry_(registry)
+  , delimiter_(delimiter)
+  , buffer_(0)
+  , slots_(initialSlots)
+  , generation_(0)
+{
+  for(TemplateRegistry::const_iterator it = registry_->begin(); it != registry_->end(); ++it)
+  {
+    learnSegment(*it->second, 0);
+  }
+  for(RepeatingGroupMap::iterator it = repeatingGroups_.begin(); it != repeatingGroups_.end(); ++it)
+  {
+    RepeatingGroup & group = it->second;
+    std::sort(group.delimiters_.begin(), group.delimiters_.end());
+    group.delimiters_.erase(std::unique(group.delimiters_.begin(), group.delimiters_.end()), group.delimiters_.end());
+    std::sort(group.tags_.begin(), group.tags_.end());
+    group.tags_.erase(std::unique(group.tags_.begin(), group.tags_.end()), group.tags_.end());
+  }
+  body_.reset(new Entry(*this, 0));
+}
+
+FixMessageAccessor::~FixMessageAccessor()
+{
+}
+
+void
+FixMessageAccessor::learnSegment(const SegmentBody & segment, std::vector<uint32> * tags)
+{
+  size_t instructionCount = segment.size();
+  for(size_t pos = 0; pos < instructionCount; ++pos)
+  {
+    const FieldInstructionCPtr & instruction = segment.getInstruction(pos);
+    const Messages::FieldIdentity & identity = instruction->getIdentity();
+    ValueType::Type type = instruction->fieldInstructionType();
+    if(type == ValueType::SEQUENCE || type == ValueType::GROUP)
+    {
+      SegmentBodyPtr body;
+      if(!instruction->getSegmentBody(body) || !body)
+      {
+        continue;
+      }
+      CompoundInfo & info = compounds_[&identity];
+      info.lengthTag_ = 0;
+      info.delimiterTag_ = 0;
+      info.tags_.clear();
+      learnSegment(*body, &info.tags_);
+      if(type == ValueType::SEQUENCE)
+      {
+        FieldInstructionCPtr lengthInstruction;
+        if(body->getLengthInstruction(lengthInstruction))
+        {
+          info.lengthTag_ = parseTag(lengthInstruction->getIdentity().id());
+        }
+        if(info.lengthTag_ == 0)
+        {
+          info.lengthTag_ = parseTag(identity.id());
+        }
+        if(!info.tags_.empty())
+        {
+          info.delimiterTag_ = info.tags_.front();
+          RepeatingGroup & group = repeatingGroups_[info.lengthTag_];
+          group.delimiters_.push_back(info.delimiterTag_);
+          group.tags_.insert(group.tags_.end(), info.tags_.begin(), info.tags_.end());
+        }
+      }
+      if(tags != 0)
+      {
+        tags->insert(tags->end(), info.tags_.begin(), info.tags_.end());
+        if(info.lengthTag_ != 0)
+        {
+          tags->push_back(info.lengthTag_);
+        }
+      }
+      std::sort(info.tags_.begin(), info.tags_.end());
+    }
+    else
+    {
+      uint32 tag = parseTag(identity.id());
+      if(tag != 0)
+      {
+        tags_[&identity] = tag;
+        if(tags != 0)
+        {
+          tags->push_back(tag);
+        }
+      }
+    }
+  }
+}
+
+bool
+FixMessageAccessor::parse(const char * message, size_t length)
+{
+  buffer_ = message;
+  fields_.clear();
+  openGroups_.clear();
+  if(++generation_ == 0)
+  {
+    // the generation wrapped, so stale slots could look current.
+    std::fill(slots_.begin(), slots_.end(), Slot());
+    generation_ = 1;
+  }
+
+  const char * pos = message;
+  const char * end = message + length;
+  while(pos < end)
+  {
+    uint32 tag = 0;
+    const char * tagStart = pos;
+    while(pos < end && *pos != '=')
+    {
+      unsigned int digit = static_cast<unsigned char>(*pos) - '0';
+      if(digit > 9 || tag > 99999999)
+      {
+        return false;
+      }
+      tag = tag * 10 + digit;
+      ++pos;
+    }
+    if(pos == end || pos == tagStart || tag == 0)
+    {
+      return false;
+    }
+    ++pos; // skip '='
+    const char * valueEnd = static_cast<const char *>(std::memchr(pos, delimiter_, end - pos));
+    if(valueEnd == 0)
+    {
+      valueEnd = end;
+    }
+
+    // Close the repeating groups this tag does not belong to.  As in sequenceLength()
+    // an entry starts with a delimiter tag and the group ends at the first foreign tag.
+    while(!openGroups_.empty())
+    {
+      OpenGroup & open = openGroups_.back();
+      const RepeatingGroup & group = *open.group_;
+      if(std::binary_search(group.delimiters_.begin(), group.delimiters_.end(), tag))
+      {
+        open.started_ = true;
+        break;
+      }
+      if(open.started_ && std::binary_search(group.tags_.begin(), group.tags_.end(), tag))
+      {
+        break;
+      }
+      openGroups_.pop_back();
+    }
+
+    FixField field;
+    field.tag_ = tag;
+    field.offset_ = uint32(pos - message);
+    field.length_ = uint32(valueEnd - pos);
+    field.level_ = uint32(openGroups_.size());
+    // Only top-level fields are indexed: a group member must not hide a later top-level field.
+    if(field.level_ == 0 && tag < maxIndexedTag)
+    {
+      if(tag >= slots_.size())
+      {
+        slots_.resize(tag + 1);
+      }
+      Slot & slot = slots_[tag];
+      if(slot.generation_ != generation_)
+      {
+        slot.generation_ = generation_;
+        slot.index_ = uint32(fields_.size());
+      }
+    }
+    fields_.push_back(field);
+
+    RepeatingGroupMap::const_iterator group = repeatingGroups_.find(tag);
+    if(group != repeatingGroups_.end())
+    {
+      OpenGroup open;
+      open.group_ = &group->second;
+      open.started_ = false;
+      openGroups_.push_back(open);
+    }
+    pos = valueEnd + 1;
+  }
+  body_->setRange(0, fields_.size());
+  return true;
+}
+
+uint32
+FixMessageAccessor::tagFor(const Messages::FieldIdentity & identity)const
+{
+  TagMap::const_iterator it = tags_.find(&identity);
+  if(it != tags_.end())
+  {
+    return it->second;
+  }
+  // not from the registry: an implicit length field, for example.
+  return parseTag(identity.id());
+}
+
+size_t
+FixMessageAccessor::find(uint32 tag, size_t begin, size_t end, size_t depth)const
+{
+  if(depth == 0 && tag < maxIndexedTag)
+  {
+    if(tag < slots_.size() && slots_[tag].generation_ == generation_)
+    {
+      return slots_[tag].index_;
+    }
+    return notFound;
+  }
+  for(size_t pos = begin; pos < end; ++pos)
+  {
+    if(fields_[pos].tag_ == tag && (depth != 0 || fields_[pos].level_ == 0))
+    {
+      return pos;
+    }
+  }
+  return notFound;
+}
+
+bool
+FixMessageAccessor::findValue(
+  const Messages::FieldIdentity & identity,
+  size_t begin,
+  size_t end,
+  size_t depth,
+  const char *& value,
+  size_t & length)const
+{
+  uint32 tag = tagFor(identity);
+  if(tag == 0)
+  {
+    return false;
+  }
+  size_t index = find(tag, begin, end, depth);
+  if(index == notFound)
+  {
+    return false;
+  }
+  const FixField & field = fields_[index];
+  value = buffer_ + field.offset_;
+  length = field.length_;
+  return true;
+}
+
+bool
+FixMessageAccessor::getTagValue(uint32 tag, const char *& value, size_t & length)const
+{
+  size_t index = find(tag, 0, fields_.size(), 0);
+  if(index == notFound)
+  {
+    return false;
+  }
+  const FixField & field = fields_[index];
+  value = buffer_ + field.offset_;
+  length = field.length_;
+  return true;
+}
+
+bool
+FixMessageAccessor::groupPresent(
+  const Messages::FieldIdentity & identity,
+  size_t begin,
+  size_t end,
+  size_t depth)const
+{
+  CompoundMap::const_iterator it = compounds_.find(&identity);
+  if(it == compounds_.end() || it->second.tags_.empty())
+  {
+    return true;
+  }
+  const std::vector<uint32> & tags = it->second.tags_;
+  for(std::vector<uint32>::const_iterator tag = tags.begin(); tag != tags.end(); ++tag)
+  {
+    if(find(*tag, begin, end, depth) != notFound)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool
+FixMessageAccessor::sequenceLength(
+  const Messages::FieldIdentity & identity,
+  size_t begin,
+  size_t end,
+  size_t depth,
+  size_t & length)const
+{
+  CompoundMap::const_iterator it = compounds_.find(&identity);
+  if(it == compounds_.end() || it->second.lengthTag_ == 0)
+  {
+    return false;
+  }
+  const CompoundInfo & info = it->second;
+  size_t lengthIndex = find(info.lengthTag_, begin, end, depth);
+  if(lengthIndex == notFound)
+  {
+    return false;
+  }
+
+  if(boundaries_.size() <= depth)
+  {
+    boundaries_.resize(depth + 1);
+  }
+  Boundaries & boundaries = boundaries_[depth];
+  boundaries.clear();
+
+  // Entries start at each occurrence of the delimiter tag and the group
+  // ends at the first tag that does not belong to it.
+  size_t pos = lengthIndex + 1;
+  while(pos < end)
+  {
+    uint32 tag = fields_[pos].tag_;
+    if(tag == info.delimiterTag_)
+    {
+      boundaries.push_back(pos);
+    }
+    else if(boundaries.empty()
+      || !std::binary_search(info.tags_.begin(), info.tags_.end(), tag))
+    {
+      break;
+    }
+    ++pos;
+  }
+  length = boundaries.size();
+  boundaries.push_back(pos);
+  return true;
+}
+
+bool
+FixMessageAccessor::sequenceEntry(
+  size_t index,
+  size_t depth,
+  const MessageAccessor *& entry)const
+{
+  if(depth >= boundaries_.size() || index + 1 >= boundaries_[depth].size())
+  {
+    return false;
+  }
+  if(entries_.size() <= depth)
+  {
+    entries_.resize(depth + 1);
+  }
+  EntryPtr & view = entries_[depth];
+  if(!view)
+  {
+    view.reset(new Entry(*this, depth + 1));
+  }
+  const Boundaries & boundaries = boundaries_[depth];
+  view->setRange(boundaries[index], boundaries[index + 1]);
+  entry = view.get();
+  return true;
+}
+
+bool
+FixMessageAccessor::isPresent(const Messages::FieldIdentity & identity)const
+{
+  return body_->isPresent(identity);
+}
+
+bool
+FixMessageAccessor::getUnsignedInteger(const Messages::FieldIdentity & identity, ValueType::Type type, uint64 & value)const
+{
+  return body_->getUnsignedInteger(identity, type, value);
+}
+
+bool
+FixMessageAccessor::getSignedInteger(const Messages::FieldIdentity & identity, ValueType::Type type, int64 & value)const
+{
+  return body_->getSignedInteger(identity, type, value);
+}
+
+bool
+FixMessageAccessor::getDecimal(const Messages::FieldIdentity & identity, ValueType::Type type, Decimal & value)const
+{
+  return body_->getDecimal(identity, type, value);
+}
+
+bool
+FixMessageAccessor::getString(const Messages::FieldIdentity & identity, ValueType::Type type, const StringBuffer *& value)const
+{
+  return body_->getString(identity, type, value);
+}
+
+bool
+FixMessageAccessor::getGroup(const Messages::FieldIdentity & identity, const MessageAccessor *& group)const
+{
+  return body_->getGroup(identity, group);
+}
+
+bool
+FixMessageAccessor::getSequenceLength(const Messages::FieldIdentity & identity, size_t & length)const
+{
+  return body_->getSequenceLength(identity, length);
+}
+
+bool
+FixMessageAccessor::getSequenceEntry(const Messages::FieldIdentity & identity, size_t index, const MessageAccessor *& entry)const
+{
+  return body_->getSequenceEntry(identity, index, entry);
+}
+
+const std::string &
+FixMessageAccessor::getApplicationType()const
+{
+  return applicationType_;
+}
+
+const std::string &
+FixMessageAccessor::getApplicationTypeNs()const
+{
+  return applicationTypeNamespace_;
+}
@@ -0,0 +1,195 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef FIXMESSAGEACCESSOR_H
+#define FIXMESSAGEACCESSOR_H
+#include "FixMessageAccessor_fwd.h"
+#include <Common/QuickFAST_Export.h>
+#include <Common/StringBuffer.h>
+#include <Messages/MessageAccessor.h>
+#include <Codecs/TemplateRegistry_fwd.h>
+#include <Codecs/SegmentBody_fwd.h>
+#include <boost/unordered_map.hpp>
+
+namespace QuickFAST{
+  namespace Codecs{
+    /// @brief Present a FIX tag=value message to the Encoder.
+    ///
+    /// parse() indexes the tags in a raw FIX message without copying it and
+    /// without allocating memory per field.  The Encoder then reads the values
+    /// directly from the raw buffer, so the buffer must not change until the
+    /// message has been encoded.
+    ///
+    /// Fields are matched to FIX tags by the id= attribute in the templates.
+    /// FIX repeating groups are mapped to FAST sequences: the tag of the
+    /// sequence's length field is the NoXXX tag, and each entry begins with
+    /// the first field of the sequence.
+    ///
+    /// One instance should be used by one thread at a time.
+    class QuickFAST_Export FixMessageAccessor : public Messages::MessageAccessor
+    {
+    public:
+      /// @brief Construct and learn the tags used by a set of templates.
+      /// @param registry contains the templates that will be used to encode messages.
+      /// @param delimiter separates fields in the FIX messages (normally SOH)
+      explicit FixMessageAccessor(TemplateRegistryCPtr registry, char delimiter = '\x01');
+
+      virtual ~FixMessageAccessor();
+
+      /// @brief Change the field delimiter.
+      /// @param delimiter separates fields in the FIX messages.
+      void setDelimiter(char delimiter)
+      {
+        delimiter_ = delimiter;
+      }
+
+      /// @brief Index the fields in a FIX message.
+      ///
+      /// The message must remain unchanged while it is being encoded.
+      /// @param message points to the first byte of the message ("8=...")
+      /// @param length is the number of bytes in the message.
+      /// @returns false if the message is not well formed tag=value data.
+      bool parse(const char * message, size_t length);
+
+      /// @brief How many fields were found by parse()?
+      size_t fieldCount()const
+      {
+        return fields_.size();
+      }
+
+      /// @brief Find the raw value of a tag (for example to choose a template based on MsgType).
+      /// @param tag is the FIX tag number.
+      /// @param[out] value points to the value within the message
+      /// @param[out] length is the length of the value
+      /// @returns true if the tag is present.
+      bool getTagValue(uint32 tag, const char *& value, size_t & length)const;
+
+      ///////////////////////////
+      // Implement MessageAccessor
+      virtual bool isPresent(const Messages::FieldIdentity & identity)const;
+      virtual bool getUnsignedInteger(const Messages::FieldIdentity & identity, ValueType::Type type, uint64 & value)const;
+      virtual bool getSignedInteger(const Messages::FieldIdentity & identity, ValueType::Type type, int64 & value)const;
+      virtual bool getDecimal(const Messages::FieldIdentity & identity, ValueType::Type type, Decimal & value)const;
+      virtual bool getString(const Messages::FieldIdentity & identity, ValueType::Type type, const StringBuffer *& value)const;
+      virtual bool getGroup(const Messages::FieldIdentity & identity, const MessageAccessor *& group)const;
+      virtual bool getSequenceLength(const Messages::FieldIdentity & identity, size_t & length)const;
+      virtual bool getSequenceEntry(const Messages::FieldIdentity & identity, size_t index, const MessageAccessor *& entry)const;
+      virtual const std::string & getApplicationType()const;
+      virtual const std::string & getApplicationTypeNs()const;
+
+    private:
+      class Entry;
+      friend class Entry;
+      typedef boost::shared_ptr<Entry> EntryPtr;
+
+      /// @brief Location of one field within the message
+      struct FixField
+      {
+        uint32 tag_;
+        uint32 offset_;
+        uint32 length_;
+        /// how many repeating groups enclose the field (0 = top level)
+        uint32 level_;
+      };
+
+      /// @brief Direct index from tag number to the first top-level field with that tag.
+      ///
+      /// The generation avoids clearing the whole table for each message.
+      struct Slot
+      {
+        uint32 generation_;
+        uint32 index_;
+      };
+
+      /// @brief How a FAST sequence or group is represented in FIX
+      struct CompoundInfo
+      {
+        /// NoXXX tag (sequences only)
+        uint32 lengthTag_;
+        /// first tag of each entry (sequences only)
+        uint32 delimiterTag_;
+        /// all tags that may appear within the sequence entry or group (sorted)
+        std::vector<uint32> tags_;
+      };
+
+      /// @brief The tags that may follow a NoXXX tag, merged from every sequence that uses it.
+      struct RepeatingGroup
+      {
+        /// tags that start an entry (sorted)
+        std::vector<uint32> delimiters_;
+        /// all tags that may appear within an entry (sorted)
+        std::vector<uint32> tags_;
+      };
+
+      /// @brief A repeating group that is open while parse() walks the fields.
+      struct OpenGroup
+      {
+        const RepeatingGroup * group_;
+        bool started_;
+      };
+
+      void learnSegment(const SegmentBody & segment, std::vector<uint32> * tags);
+      uint32 tagFor(const Messages::FieldIdentity & identity)const;
+      size_t find(uint32 tag, size_t begin, size_t end, size_t depth)const;
+      bool findValue(
+        const Messages::FieldIdentity & identity,
+        size_t begin,
+        size_t end,
+        size_t depth,
+        const char *& value,
+        size_t & length)const;
+      bool groupPresent(
+        const Messages::FieldIdentity & identity,
+        size_t begin,
+        size_t end,
+        size_t depth)const;
+      bool sequenceLength(
+        const Messages::FieldIdentity & identity,
+        size_t begin,
+        size_t end,
+        size_t depth,
+        size_t & length)const;
+      bool sequenceEntry(
+        size_t index,
+        size_t depth,
+        const MessageAccessor *& entry)const;
+
+    private:
+      FixMessageAccessor(const FixMessageAccessor &);
+      FixMessageAccessor & operator=(const FixMessageAccessor &);
+
+    private:
+      typedef boost::unordered_map<const Messages::FieldIdentity *, uint32> TagMap;
+      typedef boost::unordered_map<const Messages::FieldIdentity *, CompoundInfo> CompoundMap;
+      typedef boost::unordered_map<uint32, RepeatingGroup> RepeatingGroupMap;
+      typedef std::vector<size_t> Boundaries;
+
+      TemplateRegistryCPtr registry_;
+      TagMap tags_;
+      CompoundMap compounds_;
+      /// repeating groups by NoXXX tag
+      RepeatingGroupMap repeatingGroups_;
+      char delimiter_;
+
+      const char * buffer_;
+      std::vector<FixField> fields_;
+      std::vector<Slot> slots_;
+      uint32 generation_;
+      /// the groups enclosing the current field during parse()
+      std::vector<OpenGroup> openGroups_;
+
+      /// the message body as a whole
+      EntryPtr body_;
+      /// entry boundaries and the entry accessor for each level of sequence nesting
+      mutable std::vector<Boundaries> boundaries_;
+      mutable std::vector<EntryPtr> entries_;
+      mutable StringBuffer stringValue_;
+      std::string applicationType_;
+      std::string applicationTypeNamespace_;
+    };
+  }
+}
+#endif // FIXMESSAGEACCESSOR_H
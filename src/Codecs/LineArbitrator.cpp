@@ -0,0 +1,168 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#include <Common/QuickFASTPch.h>
+#include "LineArbitrator.h"
+
+using namespace QuickFAST;
+using namespace Codecs;
+
+LineArbitrator::LineArbitrator(size_t window, sequence_t resetGap)
+  : seen_((window + 63) / 64 > 0 ? (window + 63) / 64 : 1, 0)
+  , window_(seen_.size() * 64)
+  , resetGap_(resetGap > window_ ? resetGap : sequence_t(window_ * 4))
+  , highest_(0)
+  , first_(true)
+  , staleHighest_(0)
+  , stale_(false)
+  , resets_(0)
+  , accepted_(0)
+{
+}
+
+LineArbitrator::~LineArbitrator()
+{
+}
+
+bool
+LineArbitrator::accept(size_t line, sequence_t sequenceNumber)
+{
+  if(line >= lines_.size())
+  {
+    lines_.resize(line + 1);
+  }
+  Line & stats = lines_[line];
+  ++stats.packets_;
+  if(!stats.started_)
+  {
+    stats.started_ = true;
+    stats.lastSequence_ = sequenceNumber;
+  }
+  else if(sequenceNumber > stats.lastSequence_)
+  {
+    // A jump of resetGap_ or more crosses a sequence reset; nothing is missing.
+    if(sequenceNumber - stats.lastSequence_ < resetGap_)
+    {
+      stats.missing_ += sequenceNumber - stats.lastSequence_ - 1;
+    }
+    stats.lastSequence_ = sequenceNumber;
+  }
+  else if(stats.lastSequence_ - sequenceNumber >= resetGap_)
+  {
+    stats.lastSequence_ = sequenceNumber;
+  }
+
+  bool result = testAndSet(sequenceNumber);
+  if(result)
+  {
+    ++stats.wins_;
+    ++accepted_;
+  }
+  return result;
+}
+
+bool
+LineArbitrator::testAndSet(sequence_t sequenceNumber)
+{
+  if(first_)
+  {
+    first_ = false;
+    highest_ = sequenceNumber;
+    clearBit(sequenceNumber);
+  }
+  else if(sequenceNumber > highest_)
+  {
+    if(stale_)
+    {
+      if(sequenceNumber - highest_ >= resetGap_ && sequenceNumber <= staleHighest_ + window_)
+      {
+        // a copy from before the reset arriving on a slower line.
+        return false;
+      }
+      if(sequenceNumber + resetGap_ > staleHighest_)
+      {
+        // The new sequence has caught up with the old one, so they can no longer be told apart.
+        stale_ = false;
+      }
+    }
+    // slide the window forward, forgetting what was there
+    if(sequenceNumber - highest_ >= window_)
+    {
+      std::fill(seen_.begin(), seen_.end(), 0);
+    }
+    else
+    {
+      for(sequence_t step = sequenceNumber - highest_; step > 0; --step)
+      {
+        clearBit(highest_ + step);
+      }
+    }
+    highest_ = sequenceNumber;
+  }
+  else if(highest_ - sequenceNumber >= resetGap_)
+  {
+    // The sequence numbers have been reset.  Start again here.
+    ++resets_;
+    staleHighest_ = highest_;
+    stale_ = true;
+    std::fill(seen_.begin(), seen_.end(), 0);
+    highest_ = sequenceNumber;
+  }
+  else if(highest_ - sequenceNumber >= window_)
+  {
+    // too old to know.  Assume it's a duplicate.
+    return false;
+  }
+
+  uint64 & word = seen_[(sequenceNumber / 64) % seen_.size()];
+  uint64 mask = uint64(1) << (sequenceNumber % 64);
+  if((word & mask) != 0)
+  {
+    return false;
+  }
+  word |= mask;
+  return true;
+}
+
+void
+LineArbitrator::reset()
+{
+  std::fill(seen_.begin(), seen_.end(), 0);
+  highest_ = 0;
+  first_ = true;
+  staleHighest_ = 0;
+  stale_ = false;
+  resets_ = 0;
+  accepted_ = 0;
+  lines_.clear();
+}
+
+double
+LineArbitrator::winRate(size_t line)const
+{
+  if(accepted_ == 0)
+  {
+    return 0.0;
+  }
+  return double(wins(line)) / double(accepted_);
+}
+
+void
+LineArbitrator::report(std::ostream & out)const
+{
+  for(size_t line = 0; line < lines_.size(); ++line)
+  {
+    out << "Line " << line
+      << ": packets " << packets(line)
+      << " first " << wins(line)
+      << " (" << std::fixed << std::setprecision(1) << winRate(line) * 100.0 << "%)"
+      << " duplicate " << duplicates(line)
+      << " missing " << missing(line)
+      << std::endl;
+  }
+  if(resets_ != 0)
+  {
+    out << "Sequence resets: " << resets_ << std::endl;
+  }
+}
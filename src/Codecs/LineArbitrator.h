@@ -0,0 +1,164 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef LINEARBITRATOR_H
+#define LINEARBITRATOR_H
+
+#include "LineArbitrator_fwd.h"
+#include <Common/QuickFAST_Export.h>
+#include <Common/Types.h>
+
+namespace QuickFAST
+{
+  namespace Codecs
+  {
+    /// @brief Choose between redundant copies of a sequenced packet stream.
+    ///
+    /// Exchanges often publish the same packets on two (or more) lines, typically
+    /// called the A and B feeds.  The arbitrator sees every packet from every line
+    /// and accepts the first copy of each sequence number.  Later copies are
+    /// rejected so they can be discarded without being decoded.
+    ///
+    /// Sequence numbers that have been seen are remembered in a sliding window
+    /// of bits following the highest sequence number seen so far, so the check costs
+    /// a few instructions regardless of how far out of order the lines are.
+    /// A packet that falls behind the window is rejected as too late.
+    ///
+    /// A packet much further behind means the exchange has reset its
+    /// sequence numbers.  The window starts again from that packet, and
+    /// copies of the old sequence that were still on their way are rejected.
+    ///
+    /// Statistics are kept for each line: how many packets arrived, how many
+    /// were the first copy ("wins"), how many were duplicates, and how many
+    /// sequence numbers never appeared on that line.
+    class QuickFAST_Export LineArbitrator
+    {
+    public:
+      /// @brief Construct
+      /// @param window how many sequence numbers to remember. Rounded up to a multiple of 64.
+      ///        Should be larger than any expected difference between the lines.
+      /// @param resetGap a packet at least this far behind the highest sequence number
+      ///        means the sequence numbers have been reset.  Zero means four windows.
+      explicit LineArbitrator(size_t window = 4096, sequence_t resetGap = 0);
+
+      ~LineArbitrator();
+
+      /// @brief Decide whether a packet is the first copy of its sequence number.
+      /// @param line identifies the line on which the packet arrived (0 = A, 1 = B, ...)
+      /// @param sequenceNumber from the packet header
+      /// @returns true if this packet should be decoded; false if it is a duplicate or too late.
+      bool accept(size_t line, sequence_t sequenceNumber);
+
+      /// @brief Forget all sequence numbers and statistics.
+      void reset();
+
+      /// @brief How many lines have delivered packets?
+      size_t lineCount()const
+      {
+        return lines_.size();
+      }
+
+      /// @brief Statistic: How many packets arrived on this line?
+      /// @param line identifies the line
+      size_t packets(size_t line)const
+      {
+        return line < lines_.size() ? lines_[line].packets_ : 0;
+      }
+
+      /// @brief Statistic: How many packets from this line were the first copy?
+      /// @param line identifies the line
+      size_t wins(size_t line)const
+      {
+        return line < lines_.size() ? lines_[line].wins_ : 0;
+      }
+
+      /// @brief Statistic: How many packets from this line were discarded?
+      ///
+      /// Includes duplicates and packets that arrived too late to be considered.
+      /// @param line identifies the line
+      size_t duplicates(size_t line)const
+      {
+        return line < lines_.size() ? lines_[line].packets_ - lines_[line].wins_ : 0;
+      }
+
+      /// @brief Statistic: How many sequence numbers were skipped on this line?
+      ///
+      /// This counts packets missing from this line, whether or not they arrived on another line.
+      /// @param line identifies the line
+      size_t missing(size_t line)const
+      {
+        return line < lines_.size() ? lines_[line].missing_ : 0;
+      }
+
+      /// @brief Statistic: What fraction of all accepted packets came from this line?
+      /// @param line identifies the line
+      /// @returns a value from 0.0 to 1.0
+      double winRate(size_t line)const;
+
+      /// @brief How many sequence numbers are remembered?
+      size_t window()const
+      {
+        return window_;
+      }
+
+      /// @brief Statistic: How many times have the sequence numbers been reset?
+      size_t resets()const
+      {
+        return resets_;
+      }
+
+      /// @brief Statistic: How many packets were accepted from all lines?
+      size_t accepted()const
+      {
+        return accepted_;
+      }
+
+      /// @brief Write the statistics in human readable form.
+      /// @param out is the destination
+      void report(std::ostream & out)const;
+
+    private:
+      struct Line
+      {
+        Line()
+          : packets_(0)
+          , wins_(0)
+          , missing_(0)
+          , lastSequence_(0)
+          , started_(false)
+        {
+        }
+        size_t packets_;
+        size_t wins_;
+        size_t missing_;
+        sequence_t lastSequence_;
+        bool started_;
+      };
+
+      bool testAndSet(sequence_t sequenceNumber);
+      void clearBit(sequence_t sequenceNumber)
+      {
+        seen_[(sequenceNumber / 64) % seen_.size()] &= ~(uint64(1) << (sequenceNumber % 64));
+      }
+
+    private:
+      std::vector<uint64> seen_;
+      size_t window_;
+      sequence_t resetGap_;
+      sequence_t highest_;
+      bool first_;
+      /// the highest sequence number before the last reset
+      sequence_t staleHighest_;
+      /// are copies from before the last reset still expected?
+      bool stale_;
+      size_t resets_;
+      size_t accepted_;
+      std::vector<Line> lines_;
+    };
+  }
+}
+#endif // LINEARBITRATOR_H
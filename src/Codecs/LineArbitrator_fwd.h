@@ -0,0 +1,21 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef LINEARBITRATOR_FWD_H
+#define LINEARBITRATOR_FWD_H
+
+namespace QuickFAST
+{
+  namespace Codecs
+  {
+    class LineArbitrator;
+
+    ///@brief smart pointer to LineArbitrator
+    typedef boost::shared_ptr<LineArbitrator> LineArbitratorPtr;
+  }
+}
+#endif // LINEARBITRATOR_FWD_H
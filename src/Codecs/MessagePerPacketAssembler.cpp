@@ -36,7 +36,7 @@ MessagePerPacketAssembler::serviceQueue(Communication::Receiver & receiver)
   {
     try
     {
-      result = decodeBuffer(buffer->get(), buffer->used());
+      result = decodeBuffer(buffer);
     }
     catch(const std::exception &ex)
     {
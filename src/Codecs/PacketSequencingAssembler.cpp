@@ -17,6 +17,38 @@ namespace
 {
   // A linked buffer flag to identify source of buffer
   uint32 FROM_RECOVERY_QUEUE = 1;
+
+  // bits per word in the occupied-slot map
+  const size_t OCCUPIED_BITS = 32;
+
+  size_t ringSize(size_t lookAheadCount)
+  {
+    size_t size = 1;
+    while(size < lookAheadCount)
+    {
+      size <<= 1;
+    }
+    return size;
+  }
+
+  inline size_t lowestSetBit(uint32 bits)
+  {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, bits);
+    return index;
+#elif defined(__GNUC__)
+    return __builtin_ctz(bits);
+#else
+    size_t index = 0;
+    while((bits & 1) == 0)
+    {
+      bits >>= 1;
+      ++index;
+    }
+    return index;
+#endif
+  }
 }
 
 PacketSequencingAssembler::PacketSequencingAssembler(
@@ -25,29 +57,41 @@ PacketSequencingAssembler::PacketSequencingAssembler(
       HeaderAnalyzer & messageHeaderAnalyzer,
       Messages::ValueMessageBuilder & builder,
       size_t lookAheadCount,
-      const Communication::RecoveryFeedPtr & recoveryFeed)
+      const Communication::RecoveryFeedPtr & recoveryFeed,
+      size_t arbitrationWindow)
   : BasePacketAssembler(
       templateRegistry,
       packetHeaderAnalyzer,
       messageHeaderAnalyzer,
       builder)
-  , lookAheadCount_(lookAheadCount)
-  , lookAhead_(new Communication::LinkedBuffer *[lookAheadCount])
+  , lookAheadCount_(ringSize(lookAheadCount))
+  , mask_(sequence_t(lookAheadCount_ - 1))
+  , lookAhead_(new Communication::LinkedBuffer *[lookAheadCount_])
+  , occupiedWords_((lookAheadCount_ + OCCUPIED_BITS - 1) / OCCUPIED_BITS)
+  , occupied_(new uint32[occupiedWords_])
   , first_(true)
   , nextSequenceNumber_(0)
   , gapWait_(false)
   , gapEnd_(0)
   , recoveryFeed_(recoveryFeed)
   , receiver_(0)
+  , arbitrator_(arbitrationWindow)
+  , reorderedPackets_(0)
+  , maxReorderDepth_(0)
+  , deferredPackets_(0)
 {
   if(!packetHeaderAnalyzer.supportsSequenceNumber())
   {
     throw UsageError("Configuration error", "Arbitrage requires sequence number support from packet header analyzer.");
   }
-  for(size_t nBuffer = 0; nBuffer < lookAheadCount; ++ nBuffer)
+  for(size_t nBuffer = 0; nBuffer < lookAheadCount_; ++ nBuffer)
   {
     lookAhead_[nBuffer] = 0;
   }
+  for(size_t nWord = 0; nWord < occupiedWords_; ++nWord)
+  {
+    occupied_[nWord] = 0;
+  }
 }
 
 PacketSequencingAssembler::~PacketSequencingAssembler()
@@ -66,10 +110,9 @@ PacketSequencingAssembler::serviceQueue(Communication::Receiver & receiver)
     more = false;
     /////////////////////////////////////////////////////////////////////
     // Check to see if the next packet is already in the look-ahead array
-    Communication::LinkedBuffer * buffer = lookAhead_[nextSequenceNumber_ % lookAheadCount_];
+    Communication::LinkedBuffer * buffer = takePacket(nextSequenceNumber_);
     if(buffer != 0)
     {
-      lookAhead_[nextSequenceNumber_ % lookAheadCount_] = 0;
       processPacket(buffer);
       more = true;
     }
@@ -84,7 +127,22 @@ PacketSequencingAssembler::serviceQueue(Communication::Receiver & receiver)
       if(buffer != 0)
       {
         buffer->clearFlag(FROM_RECOVERY_QUEUE);
-        capturePacket(buffer);
+        // Discard the copy from the slower line before doing anything else
+        size_t resets = arbitrator_.resets();
+        sequence_t sequenceNumber = packetHeaderAnalyzer_.getSequenceNumber(buffer->get());
+        if(arbitrator_.accept(buffer->source(), sequenceNumber))
+        {
+          if(arbitrator_.resets() != resets)
+          {
+            // The exchange started its sequence numbers again.
+            resequence(sequenceNumber);
+          }
+          capturePacket(buffer);
+        }
+        else
+        {
+          releasePacket(buffer);
+        }
         more = true;
       }
     }
@@ -137,6 +195,27 @@ PacketSequencingAssembler::serviceQueue(Communication::Receiver & receiver)
 }
 
 
+void
+PacketSequencingAssembler::receiverStopped(Communication::Receiver & receiver)
+{
+  if(builder_.wantLog(Common::Logger::QF_LOG_INFO) && arbitrator_.lineCount() > 1)
+  {
+    std::stringstream msg;
+    arbitrator_.report(msg);
+    builder_.logMessage(Common::Logger::QF_LOG_INFO, msg.str());
+  }
+
+  if(builder_.wantLog(Common::Logger::QF_LOG_INFO) && reorderedPackets_ > 0)
+  {
+    std::stringstream msg;
+    msg << "Reordered packets " << reorderedPackets_
+      << " max depth " << maxReorderDepth_
+      << " beyond look-ahead " << deferredPackets_;
+    builder_.logMessage(Common::Logger::QF_LOG_INFO, msg.str());
+  }
+  BasePacketAssembler::receiverStopped(receiver);
+}
+
 void
 PacketSequencingAssembler::capturePacket(Communication::LinkedBuffer * buffer)
 {
@@ -154,28 +233,65 @@ PacketSequencingAssembler::capturePacket(Communication::LinkedBuffer * buffer)
   {
     releasePacket(buffer);
   }
-  else if(sequenceNumber <  nextSequenceNumber_ + lookAheadCount_)
+  else
   {
-    if(lookAhead_[sequenceNumber % lookAheadCount_] != 0)
+    ++reorderedPackets_;
+    size_t depth = sequenceNumber - nextSequenceNumber_;
+    if(depth > maxReorderDepth_)
     {
-      releasePacket(buffer);
+      maxReorderDepth_ = depth;
+    }
+    if(depth < lookAheadCount_)
+    {
+      if(!holdPacket(sequenceNumber, buffer))
+      {
+        releasePacket(buffer);
+      }
     }
     else
     {
-      lookAhead_[sequenceNumber % lookAheadCount_] = buffer;
+      /// buffer is beyond look-ahead
+      ++deferredPackets_;
+      addToDeferred(buffer, sequenceNumber);
     }
   }
-  else
+}
+
+bool
+PacketSequencingAssembler::holdPacket(sequence_t sequenceNumber, Communication::LinkedBuffer * buffer)
+{
+  size_t slot = sequenceNumber & mask_;
+  uint32 bit = uint32(1) << (slot % OCCUPIED_BITS);
+  uint32 & word = occupied_[slot / OCCUPIED_BITS];
+  if((word & bit) != 0)
+  {
+    return false;
+  }
+  word |= bit;
+  lookAhead_[slot] = buffer;
+  return true;
+}
+
+Communication::LinkedBuffer *
+PacketSequencingAssembler::takePacket(sequence_t sequenceNumber)
+{
+  size_t slot = sequenceNumber & mask_;
+  uint32 bit = uint32(1) << (slot % OCCUPIED_BITS);
+  uint32 & word = occupied_[slot / OCCUPIED_BITS];
+  if((word & bit) == 0)
   {
-    /// buffer is beyond look-ahead
-    addToDeferred(buffer, sequenceNumber);
+    return 0;
   }
+  word &= ~bit;
+  Communication::LinkedBuffer * buffer = lookAhead_[slot];
+  lookAhead_[slot] = 0;
+  return buffer;
 }
 
 void
 PacketSequencingAssembler::processPacket(Communication::LinkedBuffer * buffer)
 {
-  decodeBuffer(buffer->get(), buffer->used());
+  decodeBuffer(buffer);
   releasePacket(buffer);
   ++nextSequenceNumber_;
 }
@@ -271,9 +387,8 @@ PacketSequencingAssembler::promoteDeferred()
   {
     buffer = deferredQueue_.pop();
     sequence_t sequenceNumber = packetHeaderAnalyzer_.getSequenceNumber(buffer->get());
-    if(lookAhead_[sequenceNumber % lookAheadCount_] == 0)
+    if(holdPacket(sequenceNumber, buffer))
     {
-      lookAhead_[sequenceNumber % lookAheadCount_] = buffer;
       result = true;
     }
     else
@@ -285,6 +400,49 @@ PacketSequencingAssembler::promoteDeferred()
   return result;
 }
 
+void
+PacketSequencingAssembler::resequence(sequence_t sequenceNumber)
+{
+  if(builder_.wantLog(Common::Logger::QF_LOG_WARNING))
+  {
+    std::stringstream msg;
+    msg << "Sequence numbers reset: expecting " << nextSequenceNumber_
+      << " received " << sequenceNumber;
+    builder_.logMessage(Common::Logger::QF_LOG_WARNING, msg.str());
+  }
+  // Packets held from the old sequence will never be decoded.
+  for(size_t slot = 0; slot < lookAheadCount_; ++slot)
+  {
+    if(lookAhead_[slot] != 0)
+    {
+      releasePacket(lookAhead_[slot]);
+      lookAhead_[slot] = 0;
+    }
+  }
+  for(size_t nWord = 0; nWord < occupiedWords_; ++nWord)
+  {
+    occupied_[nWord] = 0;
+  }
+  Communication::LinkedBuffer * buffer = deferredQueue_.pop();
+  while(buffer != 0)
+  {
+    releasePacket(buffer);
+    buffer = deferredQueue_.pop();
+  }
+  buffer = recoveryIncoming_.pop();
+  while(buffer != 0)
+  {
+    buffer->setFlag(FROM_RECOVERY_QUEUE);
+    releasePacket(buffer);
+    buffer = recoveryIncoming_.pop();
+  }
+  // Any gap in the old sequence will never be filled.
+  gapWait_ = false;
+  gapEnd_ = 0;
+  first_ = false;
+  nextSequenceNumber_ = sequenceNumber;
+}
+
 void
 PacketSequencingAssembler::handleGap()
 {
@@ -336,14 +494,32 @@ PacketSequencingAssembler::handleGap()
 sequence_t
 PacketSequencingAssembler::findGapEnd() const
 {
-  sequence_t gapEnd = nextSequenceNumber_ + 1;
-  while( gapEnd < nextSequenceNumber_ + lookAheadCount_)
+  // Scan the occupied-slot map a word at a time starting after the next expected packet.
+  sequence_t offset = 1;
+  while(offset < lookAheadCount_)
   {
-    if(lookAhead_[gapEnd % lookAheadCount_] != 0)
+    size_t slot = (nextSequenceNumber_ + offset) & mask_;
+    size_t bit = slot % OCCUPIED_BITS;
+    // don't look past the end of the ring or beyond the look-ahead range
+    size_t span = OCCUPIED_BITS - bit;
+    if(span > lookAheadCount_ - slot)
+    {
+      span = lookAheadCount_ - slot;
+    }
+    if(span > lookAheadCount_ - offset)
+    {
+      span = lookAheadCount_ - offset;
+    }
+    uint32 bits = occupied_[slot / OCCUPIED_BITS] >> bit;
+    if(span < OCCUPIED_BITS)
+    {
+      bits &= (uint32(1) << span) - 1;
+    }
+    if(bits != 0)
     {
-      return gapEnd;
+      return nextSequenceNumber_ + offset + sequence_t(lowestSetBit(bits));
     }
-    ++gapEnd;
+    offset += sequence_t(span);
   }
   Communication::LinkedBuffer * deferredBuffer = deferredQueue_.peek();
   // assert deferredBuffer != 0
@@ -7,6 +7,7 @@
 
 #include "PacketSequencingAssembler_fwd.h"
 #include <Codecs/BasePacketAssembler.h>
+#include <Codecs/LineArbitrator.h>
 #include <Communication/BufferQueue.h>
 #include <Communication/RecoveryFeed_fwd.h>
 
@@ -16,6 +17,20 @@ namespace QuickFAST
   {
     /// @brief Service a Receiver's Queue when expecting packet boundaries to match message boundaries (UDP or Multicast)
     /// with (or without) block headers.
+    ///
+    /// Packets are decoded in sequence number order.  When the same packets arrive
+    /// on more than one line (A/B feeds: see MulticastReceiver::addFeed) a LineArbitrator
+    /// accepts the first copy of each packet and the rest are discarded before
+    /// they reach the decoder.
+    ///
+    /// Packets that arrive early are held in a look-ahead ring indexed by
+    /// (sequence number & mask), so storing an early packet and finding the next
+    /// one to decode take constant time.  A bit per slot records which slots are
+    /// occupied, so the end of a gap is found a word at a time.
+    /// Packets too far ahead to fit in the ring are kept in a sorted deferred queue.
+    ///
+    /// When the LineArbitrator sees the exchange reset its sequence numbers, the
+    /// held packets are discarded and decoding continues from the new sequence.
     class QuickFAST_Export PacketSequencingAssembler
       : public BasePacketAssembler
     {
@@ -26,20 +41,55 @@ namespace QuickFAST
       /// @param messageHeaderAnalyzer analyzes the header of each message (if any)
       /// @param builder receives the data from the decoder.
       /// @param lookAheadCount how many packets to look ahead before deciding there is a gap.
+      ///        Rounded up to a power of two.
       /// @param recoveryFeed an object to recover the packets that should have been in a gap.
+      /// @param arbitrationWindow how many sequence numbers the LineArbitrator remembers.
+      ///        Should be larger than any expected difference between the lines.
       PacketSequencingAssembler(
           TemplateRegistryPtr templateRegistry,
           HeaderAnalyzer & packetHeaderAnalyzer,
           HeaderAnalyzer & messageHeaderAnalyzer,
           Messages::ValueMessageBuilder & builder,
           size_t lookAheadCount,
-          const Communication::RecoveryFeedPtr & recoveryFeed);
+          const Communication::RecoveryFeedPtr & recoveryFeed,
+          size_t arbitrationWindow = 4096);
 
       virtual ~PacketSequencingAssembler();
 
       ///////////////////////////////////////
       // Implement Remaining Assembler method
       virtual bool serviceQueue(Communication::Receiver & receiver);
+      virtual void receiverStopped(Communication::Receiver & receiver);
+
+      /// @brief Access the per-line statistics.
+      const LineArbitrator & arbitrator()const
+      {
+        return arbitrator_;
+      }
+
+      /// @brief Size of the look-ahead ring (lookAheadCount rounded up to a power of two)
+      size_t lookAheadCount()const
+      {
+        return lookAheadCount_;
+      }
+
+      /// @brief Statistic: How many packets arrived ahead of the next expected packet?
+      size_t reorderedPackets()const
+      {
+        return reorderedPackets_;
+      }
+
+      /// @brief Statistic: How far ahead of the next expected packet was the earliest arrival?
+      size_t maxReorderDepth()const
+      {
+        return maxReorderDepth_;
+      }
+
+      /// @brief Statistic: How many packets arrived too far ahead to fit in the look-ahead ring?
+      size_t deferredPackets()const
+      {
+        return deferredPackets_;
+      }
 
     private:
       /// @brief Initial processing of incoming packet from any source.
@@ -54,9 +104,20 @@ namespace QuickFAST
       /// @return true any were promoted.
       bool promoteDeferred();
 
+      /// @brief Put a packet in its look-ahead slot.
+      /// @returns false if the slot is already occupied (i.e. a duplicate)
+      bool holdPacket(sequence_t sequenceNumber, Communication::LinkedBuffer * buffer);
+      /// @brief Remove a packet from its look-ahead slot.
+      /// @returns the packet or null if the slot is empty.
+      Communication::LinkedBuffer * takePacket(sequence_t sequenceNumber);
+
       /// @brief find the sequence number of the first available packet after a gap.
       sequence_t findGapEnd()const;
 
+      /// @brief Start again at a new sequence number after the exchange resets its sequence.
+      /// Packets held from the old sequence are discarded.
+      void resequence(sequence_t sequenceNumber);
+
       /// @brief Report a gap to the recovery feed.
       /// Either wait for recovery information to arrive, or skip over the gap.
       void handleGap();
@@ -68,7 +129,10 @@ namespace QuickFAST
 
     private:
       size_t lookAheadCount_;
+      sequence_t mask_;
       boost::scoped_array<Communication::LinkedBuffer *> lookAhead_;
+      size_t occupiedWords_;
+      boost::scoped_array<uint32> occupied_;
       bool first_;
       sequence_t nextSequenceNumber_;
       bool gapWait_;
@@ -80,6 +144,12 @@ namespace QuickFAST
 
       Communication::Receiver * receiver_;
 
+      LineArbitrator arbitrator_;
+
+      size_t reorderedPackets_;
+      size_t maxReorderDepth_;
+      size_t deferredPackets_;
+
     };
 
   }
@@ -12,7 +12,7 @@ using namespace ::QuickFAST;
 using namespace ::QuickFAST::Codecs;
 
 size_t
-PresenceMap::maskToBitNumber(uchar bitMask)
+PresenceMap::maskToBitNumber(uchar bitMask)const
 {
   size_t bitNumber = 0;
   while(bitMask != PresenceMap::startByteMask &&  bitMask != 0)
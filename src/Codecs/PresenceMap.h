@@ -84,6 +84,22 @@ namespace QuickFAST{
       /// @returns true if the bit is set
       bool checkSpecificField(size_t bit);
 
+      /// @brief Check a specific bit without verbose output.
+      ///
+      /// Do not change PMAP position.  Intended for analysis rather than decoding.
+      /// @param bit is the bit to be checked.
+      /// @returns true if the bit is set
+      bool isFieldSet(size_t bit)const;
+
+      /// @brief Which bit will be consumed by the next checkNextField() or setNextField()?
+      ///
+      /// Not intended for use in the normal decoding path.
+      /// @returns the number of the next bit.
+      size_t bitPosition()const
+      {
+        return bitNumber(bytePosition_, bitMask_);
+      }
+
       /// @brief Reinitialize the presence map to be empty with room for bitCount fields.
       /// @param bitCount how many fields can be represented in the presence map.
       void reset(size_t bitCount = 0);
@@ -111,8 +127,8 @@ namespace QuickFAST{
 
       /// @brief convert byte to bit# in stop bit encoded pmap
       /// slow-- not for production use
-      size_t maskToBitNumber(uchar bitMask);
-      size_t bitNumber(size_t byteOffset, uchar bitMask)
+      size_t maskToBitNumber(uchar bitMask)const;
+      size_t bitNumber(size_t byteOffset, uchar bitMask)const
       {
         return byteOffset * 7 + maskToBitNumber(bitMask);
       }
@@ -198,6 +214,19 @@ namespace QuickFAST{
       return result;
     }
 
+    inline
+    bool
+    PresenceMap::isFieldSet(size_t bit)const
+    {
+      size_t byte = bit / 7;
+      if(byte >= byteCapacity_)
+      {
+        return false;
+      }
+      uchar bitmask = startByteMask >> (bit % 7);
+      return (bits_[byte] & bitmask) != 0;
+    }
+
   }
 }
 #endif // PRESENCEMAP_H
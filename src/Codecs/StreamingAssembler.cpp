@@ -28,6 +28,14 @@ StreamingAssembler::StreamingAssembler(
   , skipBlock_(false)
   , blockSize_(0)
   , inDecoder_(false)
+  , framed_(false)
+  , pendingBuffer_(0)
+  , pendingOffset_(0)
+  , stitchUsed_(0)
+  , stitching_(false)
+  , stitchReady_(false)
+  , stitchReceiveTime_(0)
+  , stitchedMessages_(0)
   , messageCount_(0)
   , byteCount_(0)
   , messageLimit_(0)
@@ -53,25 +61,16 @@ StreamingAssembler::serviceQueue(
     }
     more = headerIsComplete_ && !stopping_;
 
-    if(more)
+    if(more && waitForCompleteMessage_ && blockSize_ > 0)
     {
-      if(waitForCompleteMessage_ && blockSize_ > 0)
-      {
-        /// check # bytes available to see if there's a complete message to decode
-        size_t available = currentBytesAvailable();
-
-        // try for more bytes: false means don't wait if they aren't there
-        if(available < blockSize_
-          && !receiver_->needBytes(blockSize_ - available, false))
-        {
-          // need more data;  Return and continue receiving
-          more = false;
-        }
-      }
+      // Don't start decoding until the entire message is available.
+      // Return and continue receiving if it isn't here yet.
+      more = frameMessage();
     }
     if(more)
     {
       headerIsComplete_ = 0;
+      framed_ = waitForCompleteMessage_ && blockSize_ > 0;
       blockSize_ = 0;
       if(skipBlock_)
       {
@@ -139,6 +138,98 @@ StreamingAssembler::receiverStopped(Communication::Receiver & receiver)
     receiver.releaseBuffer(currentBuffer_);
     currentBuffer_ = 0;
   }
+  if(pendingBuffer_ != 0)
+  {
+    receiver.releaseBuffer(pendingBuffer_);
+    pendingBuffer_ = 0;
+  }
+  if(stitchedMessages_ != 0 && builder_.wantLog(Common::Logger::QF_LOG_INFO))
+  {
+    std::stringstream msg;
+    msg << "Stitched " << stitchedMessages_ << " messages that spanned buffers.";
+    builder_.logMessage(Common::Logger::QF_LOG_INFO, msg.str());
+  }
+}
+
+bool
+StreamingAssembler::fetchPending()
+{
+  if(pendingBuffer_ == 0)
+  {
+    pendingBuffer_ = receiver_->getBuffer(false);
+    pendingOffset_ = 0;
+  }
+  return pendingBuffer_ != 0;
+}
+
+bool
+StreamingAssembler::frameMessage()
+{
+  if(!stitching_)
+  {
+    const uchar * start = 0;
+    if(hasContiguous(blockSize_, start))
+    {
+      // the usual case: decode in place.
+      return true;
+    }
+    size_t available = currentBytesAvailable();
+    if(available == 0)
+    {
+      // The message starts at a buffer boundary.
+      // If it fits in the next buffer, getBuffer() will hand that buffer to the decoder.
+      if(!fetchPending())
+      {
+        return false;
+      }
+      if(pendingBuffer_->used() >= blockSize_)
+      {
+        return true;
+      }
+    }
+
+    // The message spans buffers.  Collect it in the stitch buffer.
+    if(stitch_.size() < blockSize_)
+    {
+      stitch_.resize(blockSize_);
+    }
+    if(available > 0)
+    {
+      std::memcpy(&stitch_[0], start, available);
+    }
+    stitchUsed_ = available;
+    stitching_ = true;
+    // The DataSource forgets the bytes that were copied, and the buffer that held them
+    // can go back to the receiver.
+    DataSource::reset();
+    if(currentBuffer_ != 0)
+    {
+      receiver_->releaseBuffer(currentBuffer_);
+      currentBuffer_ = 0;
+    }
+  }
+
+  while(stitchUsed_ < blockSize_)
+  {
+    if(!fetchPending())
+    {
+      return false;
+    }
+    size_t count = std::min(blockSize_ - stitchUsed_, pendingBuffer_->used() - pendingOffset_);
+    std::memcpy(&stitch_[stitchUsed_], pendingBuffer_->get() + pendingOffset_, count);
+    stitchUsed_ += count;
+    pendingOffset_ += count;
+    stitchReceiveTime_ = pendingBuffer_->receiveTime();
+    if(pendingOffset_ >= pendingBuffer_->used())
+    {
+      receiver_->releaseBuffer(pendingBuffer_);
+      pendingBuffer_ = 0;
+    }
+  }
+  stitching_ = false;
+  stitchReady_ = true;
+  ++stitchedMessages_;
+  return true;
 }
 
 
@@ -158,16 +249,47 @@ StreamingAssembler::getBuffer(const uchar *& buffer, size_t & size)
     currentBuffer_ = 0;
   }
 
-  // Look for a new buffer.  If we're in the decoder, wait for it.
-  if(inDecoder_)
+  if(stitchReady_)
+  {
+    // a message assembled by frameMessage()
+    stitchReady_ = false;
+    buffer = &stitch_[0];
+    size = stitchUsed_;
+    if(stitchReceiveTime_ != 0)
+    {
+      builder_.reportReceiveTime(stitchReceiveTime_);
+    }
+    return size > 0;
+  }
+
+  size_t offset = 0;
+  if(pendingBuffer_ != 0)
   {
-    receiver_->waitBuffer();
+    // a buffer obtained (and possibly partially copied) by frameMessage()
+    currentBuffer_ = pendingBuffer_;
+    offset = pendingOffset_;
+    pendingBuffer_ = 0;
+    pendingOffset_ = 0;
+  }
+  else
+  {
+    // Look for a new buffer.  If we're in the decoder, wait for it
+    // unless the message was framed in which case it's all here.
+    bool wait = inDecoder_ && !framed_;
+    if(wait)
+    {
+      receiver_->waitBuffer();
+    }
+    currentBuffer_ = receiver_->getBuffer(wait);
   }
-  currentBuffer_ = receiver_->getBuffer(inDecoder_);
   if(currentBuffer_ != 0)
   {
-    buffer = currentBuffer_->get();
-    size = currentBuffer_->used();
+    buffer = currentBuffer_->get() + offset;
+    size = currentBuffer_->used() - offset;
+    if(currentBuffer_->receiveTime() != 0)
+    {
+      builder_.reportReceiveTime(currentBuffer_->receiveTime());
+    }
   }
   return size > 0;
 }
@@ -23,6 +23,19 @@ namespace QuickFAST
   namespace Codecs
   {
     /// @brief Service a Receiver's Queue when expecting streaming data (TCP/IP) with (or without) block headers.
+    ///
+    /// When the header analyzer supplies the length of each message (and waitForCompleteMessage
+    /// is true) framing is decided before decoding starts.  The decoder runs only when the
+    /// whole message has arrived, and always over contiguous memory:
+    ///  - If the message is contained in one buffer it is decoded in place.
+    ///  - A message that spans buffers is copied into a stitch buffer as its pieces arrive.
+    ///    Each buffer is released as soon as it has been copied, so the receiver's buffers
+    ///    do not have to be large enough to hold the entire message.
+    /// No thread ever waits for input inside the decoder.
+    ///
+    /// FAST messages are not self-delimiting (the stop bits mark the end of fields, not of messages)
+    /// so without a length in the header the decoder must read directly from the stream and may
+    /// wait in the middle of a message for more data to arrive.
     class QuickFAST_Export StreamingAssembler
       : public Communication::Assembler
       , public Codecs::DataSource
@@ -33,12 +46,12 @@ namespace QuickFAST
       /// @param headerAnalyzer analyzes the header of each message (if any)
       /// @param builder receives the data from the decoder.
       /// @param waitForCompleteMessage if true cause decoding to be delayed (without thread blocking)
-      ///        until a complete message is available.
+      ///        until a complete message is available.  Requires a header that contains the message length.
       StreamingAssembler(
           TemplateRegistryPtr templateRegistry,
           HeaderAnalyzer & headerAnalyzer,
           Messages::ValueMessageBuilder & builder,
-          bool waitForCompleteMessage = false);
+          bool waitForCompleteMessage = true);
 
       virtual ~StreamingAssembler();
 
@@ -61,6 +74,12 @@ namespace QuickFAST
       virtual bool getBuffer(const uchar *& buffer, size_t & size);
       virtual int messageAvailable();
 
+      /// @brief Statistic: How many messages spanned buffers and had to be copied?
+      size_t stitchedMessages()const
+      {
+        return stitchedMessages_;
+      }
+
       /// @brief Access the internal decoder
       /// @returns a reference to the internal decoder
       Codecs::Decoder & decoder()
@@ -68,6 +87,10 @@ namespace QuickFAST
         return decoder_;
       }
 
+    private:
+      bool frameMessage();
+      bool fetchPending();
+
     private:
       StreamingAssembler & operator = (const StreamingAssembler &);
       StreamingAssembler(const StreamingAssembler &);
@@ -91,6 +114,22 @@ namespace QuickFAST
       size_t blockSize_;
 
       bool inDecoder_;
+      // true if the message being decoded is known to be complete.
+      bool framed_;
+      // A buffer obtained while framing a message, but not yet given to the decoder.
+      Communication::LinkedBuffer * pendingBuffer_;
+      // how much of pendingBuffer_ has already been copied to the stitch buffer.
+      size_t pendingOffset_;
+
+      // Holds a message that spans buffers.
+      std::vector<uchar> stitch_;
+      size_t stitchUsed_;
+      // true while the pieces of a message are being collected in stitch_
+      bool stitching_;
+      // true when stitch_ holds a complete message that the decoder has not seen.
+      bool stitchReady_;
+      uint64 stitchReceiveTime_;
+      size_t stitchedMessages_;
 
       size_t messageCount_;
       size_t byteCount_;
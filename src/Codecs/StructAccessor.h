@@ -0,0 +1,584 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef STRUCTACCESSOR_H
+#define STRUCTACCESSOR_H
+#include "StructAccessor_fwd.h"
+#include <Messages/MessageAccessor.h>
+#include <Messages/FieldIdentity.h>
+#include <Codecs/SegmentBody.h>
+#include <Codecs/FieldInstruction.h>
+#include <Common/Decimal.h>
+#include <Common/StringBuffer.h>
+#include <Common/Exceptions.h>
+
+namespace QuickFAST
+{
+  namespace Codecs
+  {
+    /// @brief Getter for an integer data member that is always present.
+    ///
+    /// Use with StructBinding::bindUnsigned:
+    ///   binding.bindUnsigned("MsgSeqNum", &unsignedMember<Quote, uint32, &Quote::seqNum_>);
+    template<typename RECORD, typename MEMBER, MEMBER RECORD::*Member>
+    bool unsignedMember(const RECORD & record, uint64 & value)
+    {
+      value = static_cast<uint64>(record.*Member);
+      return true;
+    }
+
+    /// @brief Getter for a signed integer data member that is always present.
+    template<typename RECORD, typename MEMBER, MEMBER RECORD::*Member>
+    bool signedMember(const RECORD & record, int64 & value)
+    {
+      value = static_cast<int64>(record.*Member);
+      return true;
+    }
+
+    /// @brief Getter for a Decimal data member that is always present.
+    template<typename RECORD, Decimal RECORD::*Member>
+    bool decimalMember(const RECORD & record, Decimal & value)
+    {
+      value = record.*Member;
+      return true;
+    }
+
+    /// @brief Getter for a std::string data member that is always present.
+    template<typename RECORD, std::string RECORD::*Member>
+    bool stringMember(const RECORD & record, const uchar *& value, size_t & length)
+    {
+      const std::string & member = record.*Member;
+      value = reinterpret_cast<const uchar *>(member.data());
+      length = member.size();
+      return true;
+    }
+
+    /// @brief Type-independent access to a sequence contained in a RECORD.
+    ///
+    /// Implemented by StructSequenceBinder which knows the type of the sequence entries.
+    template<typename RECORD>
+    class StructSequenceBinderBase
+    {
+    public:
+      virtual ~StructSequenceBinderBase(){}
+
+      /// @brief How many entries does this record's sequence contain?
+      /// @param record contains the sequence
+      virtual size_t length(const RECORD & record) const = 0;
+
+      /// @brief Create an accessor that can be pointed at each entry in turn.
+      virtual Messages::MessageAccessor * createEntryAccessor() const = 0;
+
+      /// @brief Point an accessor created by createEntryAccessor() at a sequence entry.
+      /// @param entryAccessor was created by createEntryAccessor()
+      /// @param record contains the sequence
+      /// @param index selects the entry.
+      virtual void setEntry(
+        Messages::MessageAccessor & entryAccessor,
+        const RECORD & record,
+        size_t index) const = 0;
+    };
+
+    /// @brief Describe how the fields of one template are found in an application-defined struct.
+    ///
+    /// The binding is built once from the template definition and can then be shared
+    /// (read only) by any number of StructAccessors.  Fields are kept in template order
+    /// (merging the fields of any groups) so the StructAccessor can locate each field
+    /// the encoder asks for by ordinal rather than by name.
+    ///
+    /// Fields that are not bound are reported as absent.
+    template<typename RECORD>
+    class StructBinding
+    {
+    public:
+      /// @brief Retrieve an unsigned integer. Return false if absent.
+      typedef bool (*UnsignedGetter)(const RECORD & record, uint64 & value);
+      /// @brief Retrieve a signed integer. Return false if absent.
+      typedef bool (*SignedGetter)(const RECORD & record, int64 & value);
+      /// @brief Retrieve a decimal. Return false if absent.
+      typedef bool (*DecimalGetter)(const RECORD & record, Decimal & value);
+      /// @brief Retrieve an ascii, utf8 or byte vector. Return false if absent.
+      typedef bool (*StringGetter)(const RECORD & record, const uchar *& value, size_t & length);
+      /// @brief Report whether an optional group is present.
+      typedef bool (*PresenceGetter)(const RECORD & record);
+
+      /// @brief Everything known about how to find one field.
+      struct FieldBinding
+      {
+        /// @brief construct for the field defined by the instruction
+        explicit FieldBinding(const FieldInstruction & instruction)
+          : instruction_(&instruction)
+          , identity_(&instruction.getIdentity())
+          , type_(instruction.fieldInstructionType())
+          , unsignedGetter_(0)
+          , signedGetter_(0)
+          , decimalGetter_(0)
+          , stringGetter_(0)
+          , presenceGetter_(0)
+          , sequenceIndex_(0)
+        {
+        }
+        /// @brief the instruction that defines this field
+        const FieldInstruction * instruction_;
+        /// @brief the identity the encoder will use to ask for this field
+        const Messages::FieldIdentity * identity_;
+        /// @brief the type of field instruction
+        ValueType::Type type_;
+        /// @brief getter for unsigned integer fields
+        UnsignedGetter unsignedGetter_;
+        /// @brief getter for signed integer fields
+        SignedGetter signedGetter_;
+        /// @brief getter for decimal fields
+        DecimalGetter decimalGetter_;
+        /// @brief getter for string fields
+        StringGetter stringGetter_;
+        /// @brief presence for merged groups.
+        PresenceGetter presenceGetter_;
+        /// @brief access to sequence entries
+        boost::shared_ptr<StructSequenceBinderBase<RECORD> > sequence_;
+        /// @brief position of this sequence among the sequences of this binding
+        size_t sequenceIndex_;
+      };
+
+      /// @brief Construct a binding for the fields of a template or sequence
+      /// @param segment defines the fields to be bound.
+      explicit StructBinding(const SegmentBodyCPtr & segment)
+        : segment_(segment)
+        , sequenceCount_(0)
+      {
+        addSegment(*segment_);
+      }
+
+      /// @brief Bind an unsigned integer field.
+      /// @param localName is the name of the field in the template
+      /// @param getter retrieves the value from the record
+      void bindUnsigned(const std::string & localName, UnsignedGetter getter)
+      {
+        fields_[ordinalOf(localName)].unsignedGetter_ = getter;
+      }
+
+      /// @brief Bind a signed integer field.
+      /// @param localName is the name of the field in the template
+      /// @param getter retrieves the value from the record
+      void bindSigned(const std::string & localName, SignedGetter getter)
+      {
+        fields_[ordinalOf(localName)].signedGetter_ = getter;
+      }
+
+      /// @brief Bind a decimal field.
+      /// @param localName is the name of the field in the template
+      /// @param getter retrieves the value from the record
+      void bindDecimal(const std::string & localName, DecimalGetter getter)
+      {
+        fields_[ordinalOf(localName)].decimalGetter_ = getter;
+      }
+
+      /// @brief Bind an ascii, utf8, or byte vector field.
+      /// @param localName is the name of the field in the template
+      /// @param getter retrieves the value from the record
+      void bindString(const std::string & localName, StringGetter getter)
+      {
+        fields_[ordinalOf(localName)].stringGetter_ = getter;
+      }
+
+      /// @brief Decide whether an optional group is present.
+      ///
+      /// The fields of the group are bound as if they were members of the enclosing record.
+      /// Unless this method is called the group is always considered present.
+      /// @param localName is the name of the group in the template
+      /// @param getter returns true if the group is present in the record
+      void bindGroup(const std::string & localName, PresenceGetter getter)
+      {
+        fields_[ordinalOf(localName)].presenceGetter_ = getter;
+      }
+
+      /// @brief Bind a sequence to a std::vector of entry structs.
+      /// @param localName is the name of the sequence in the template
+      /// @param member points to the vector in the record.
+      /// @returns a binding to be used to bind the fields of each entry
+      template<typename ENTRY>
+      StructBinding<ENTRY> & bindSequence(
+        const std::string & localName,
+        std::vector<ENTRY> RECORD::* member);
+
+      /// @brief How many fields are in this binding
+      size_t size()const
+      {
+        return fields_.size();
+      }
+
+      /// @brief How many sequences are in this binding
+      size_t sequenceCount()const
+      {
+        return sequenceCount_;
+      }
+
+      /// @brief access a field binding
+      /// @param ordinal is the position of the field in template order
+      const FieldBinding & field(size_t ordinal)const
+      {
+        return fields_[ordinal];
+      }
+
+      /// @brief Find the ordinal of the field the encoder is asking for
+      ///
+      /// Searches forward from a hint, so when fields are requested in template order
+      /// (the normal case) each lookup is a single pointer comparison.
+      /// @param identity is the identity passed to the MessageAccessor
+      /// @param[in,out] ordinal is a hint on input; receives the ordinal of the field if found.
+      /// @returns true if the field is known to this binding
+      bool findOrdinal(const Messages::FieldIdentity & identity, size_t & ordinal)const
+      {
+        size_t count = fields_.size();
+        for(size_t probe = 0; probe < count; ++probe)
+        {
+          size_t candidate = ordinal + probe;
+          if(candidate >= count)
+          {
+            candidate -= count;
+          }
+          if(fields_[candidate].identity_ == &identity)
+          {
+            ordinal = candidate;
+            return true;
+          }
+        }
+        // Not one of our identities (i.e. a template from a different registry).  Fall back to names.
+        for(size_t candidate = 0; candidate < count; ++candidate)
+        {
+          if(*fields_[candidate].identity_ == identity)
+          {
+            ordinal = candidate;
+            return true;
+          }
+        }
+        return false;
+      }
+
+    private:
+      void addSegment(const SegmentBody & segment)
+      {
+        size_t instructionCount = segment.size();
+        for(size_t pos = 0; pos < instructionCount; ++pos)
+        {
+          const FieldInstructionCPtr & instruction = segment.getInstruction(pos);
+          fields_.push_back(FieldBinding(*instruction));
+          if(instruction->fieldInstructionType() == ValueType::GROUP)
+          {
+            SegmentBodyPtr group;
+            if(instruction->getSegmentBody(group) && group)
+            {
+              addSegment(*group);
+            }
+          }
+        }
+      }
+
+      size_t ordinalOf(const std::string & localName)const
+      {
+        for(size_t ordinal = 0; ordinal < fields_.size(); ++ordinal)
+        {
+          if(fields_[ordinal].identity_->getLocalName() == localName)
+          {
+            return ordinal;
+          }
+        }
+        throw UsageError("Coding Error", ("Field \"" + localName + "\" is not defined in the template.").c_str());
+      }
+
+    private:
+      SegmentBodyCPtr segment_;
+      std::vector<FieldBinding> fields_;
+      size_t sequenceCount_;
+    };
+
+    /// @brief A MessageAccessor that encodes directly from an application-defined struct.
+    ///
+    /// Avoids building a Messages::Message full of Fields just so the Encoder can read it back.
+    /// The accessor is bound to a record with setRecord() before each call to Encoder::encodeMessage().
+    /// An accessor is lightweight, but not thread-safe.  Use one per encoding thread.
+    template<typename RECORD>
+    class StructAccessor : public Messages::MessageAccessor
+    {
+    public:
+      /// @brief Construct
+      /// @param binding describes where to find the fields. It must outlive this accessor.
+      explicit StructAccessor(const StructBinding<RECORD> & binding)
+        : binding_(binding)
+        , record_(0)
+        , cursor_(0)
+        , entryAccessors_(binding.sequenceCount())
+      {
+      }
+
+      /// @brief Select the record to be encoded.
+      /// @param record will be encoded.  It must remain valid while it is being encoded.
+      void setRecord(const RECORD & record)
+      {
+        record_ = &record;
+        cursor_ = 0;
+      }
+
+      /////////////
+      // Implement MessageAccessor
+      virtual bool isPresent(const Messages::FieldIdentity & identity)const
+      {
+        const typename StructBinding<RECORD>::FieldBinding * field;
+        if(!find(identity, field))
+        {
+          return false;
+        }
+        if(field->unsignedGetter_ != 0)
+        {
+          uint64 value;
+          return field->unsignedGetter_(*record_, value);
+        }
+        if(field->signedGetter_ != 0)
+        {
+          int64 value;
+          return field->signedGetter_(*record_, value);
+        }
+        if(field->decimalGetter_ != 0)
+        {
+          Decimal value;
+          return field->decimalGetter_(*record_, value);
+        }
+        if(field->stringGetter_ != 0)
+        {
+          const uchar * value;
+          size_t length;
+          return field->stringGetter_(*record_, value, length);
+        }
+        if(field->type_ == ValueType::GROUP)
+        {
+          return field->presenceGetter_ == 0 || field->presenceGetter_(*record_);
+        }
+        return field->sequence_.get() != 0;
+      }
+
+      virtual bool getUnsignedInteger(const Messages::FieldIdentity & identity, ValueType::Type /*type*/, uint64 & value)const
+      {
+        const typename StructBinding<RECORD>::FieldBinding * field;
+        if(find(identity, field))
+        {
+          if(field->unsignedGetter_ != 0)
+          {
+            return field->unsignedGetter_(*record_, value);
+          }
+          if(field->signedGetter_ != 0)
+          {
+            int64 signedValue;
+            if(field->signedGetter_(*record_, signedValue))
+            {
+              value = static_cast<uint64>(signedValue);
+              return true;
+            }
+          }
+        }
+        return false;
+      }
+
+      virtual bool getSignedInteger(const Messages::FieldIdentity & identity, ValueType::Type /*type*/, int64 & value)const
+      {
+        const typename StructBinding<RECORD>::FieldBinding * field;
+        if(find(identity, field))
+        {
+          if(field->signedGetter_ != 0)
+          {
+            return field->signedGetter_(*record_, value);
+          }
+          if(field->unsignedGetter_ != 0)
+          {
+            uint64 unsignedValue;
+            if(field->unsignedGetter_(*record_, unsignedValue))
+            {
+              value = static_cast<int64>(unsignedValue);
+              return true;
+            }
+          }
+        }
+        return false;
+      }
+
+      virtual bool getDecimal(const Messages::FieldIdentity & identity, ValueType::Type /*type*/, Decimal & value)const
+      {
+        const typename StructBinding<RECORD>::FieldBinding * field;
+        if(find(identity, field) && field->decimalGetter_ != 0)
+        {
+          return field->decimalGetter_(*record_, value);
+        }
+        return false;
+      }
+
+      virtual bool getString(const Messages::FieldIdentity & identity, ValueType::Type /*type*/, const StringBuffer *& value)const
+      {
+        const typename StructBinding<RECORD>::FieldBinding * field;
+        if(find(identity, field) && field->stringGetter_ != 0)
+        {
+          const uchar * data;
+          size_t length;
+          if(field->stringGetter_(*record_, data, length))
+          {
+            // Note: the encoder is finished with a string before asking for the next one.
+            stringValue_.assign(data, length);
+            value = &stringValue_;
+            return true;
+          }
+        }
+        return false;
+      }
+
+      virtual bool getGroup(const Messages::FieldIdentity & identity, const Messages::MessageAccessor *& group)const
+      {
+        // Group fields are merged into the record, so this accessor serves the group, too.
+        const typename StructBinding<RECORD>::FieldBinding * field;
+        if(find(identity, field) && field->type_ == ValueType::GROUP)
+        {
+          if(field->presenceGetter_ == 0 || field->presenceGetter_(*record_))
+          {
+            group = this;
+            return true;
+          }
+        }
+        return false;
+      }
+
+      virtual bool getSequenceLength(const Messages::FieldIdentity & identity, size_t & length)const
+      {
+        const typename StructBinding<RECORD>::FieldBinding * field;
+        if(find(identity, field) && field->sequence_)
+        {
+          length = field->sequence_->length(*record_);
+          return true;
+        }
+        return false;
+      }
+
+      virtual bool getSequenceEntry(const Messages::FieldIdentity & identity, size_t index, const Messages::MessageAccessor *& entry)const
+      {
+        const typename StructBinding<RECORD>::FieldBinding * field;
+        if(find(identity, field) && field->sequence_)
+        {
+          if(entryAccessors_.size() <= field->sequenceIndex_)
+          {
+            entryAccessors_.resize(field->sequenceIndex_ + 1);
+          }
+          boost::shared_ptr<Messages::MessageAccessor> & entryAccessor = entryAccessors_[field->sequenceIndex_];
+          if(!entryAccessor)
+          {
+            entryAccessor.reset(field->sequence_->createEntryAccessor());
+          }
+          field->sequence_->setEntry(*entryAccessor, *record_, index);
+          entry = entryAccessor.get();
+          return true;
+        }
+        return false;
+      }
+
+      virtual const std::string & getApplicationType()const
+      {
+        return applicationType_;
+      }
+
+      virtual const std::string & getApplicationTypeNs()const
+      {
+        return applicationType_;
+      }
+
+    private:
+      bool find(const Messages::FieldIdentity & identity, const typename StructBinding<RECORD>::FieldBinding *& field)const
+      {
+        size_t ordinal = cursor_;
+        if(record_ != 0 && binding_.findOrdinal(identity, ordinal))
+        {
+          field = &binding_.field(ordinal);
+          // the next request is most likely to be for the next field.
+          // stay on this one anyway; isPresent() and get*() may ask for the same field twice.
+          cursor_ = ordinal;
+          return true;
+        }
+        return false;
+      }
+
+    private:
+      StructAccessor & operator=(const StructAccessor &); // no autogenerated assignment
+    private:
+      const StructBinding<RECORD> & binding_;
+      const RECORD * record_;
+      mutable size_t cursor_;
+      mutable StringBuffer stringValue_;
+      mutable std::vector<boost::shared_ptr<Messages::MessageAccessor> > entryAccessors_;
+      std::string applicationType_;
+    };
+
+    /// @brief Access the entries of a sequence stored as a std::vector<ENTRY> in a RECORD
+    template<typename RECORD, typename ENTRY>
+    class StructSequenceBinder : public StructSequenceBinderBase<RECORD>
+    {
+    public:
+      /// @brief Construct
+      /// @param segment defines the fields of each sequence entry
+      /// @param member points to the vector in the record.
+      StructSequenceBinder(const SegmentBodyCPtr & segment, std::vector<ENTRY> RECORD::* member)
+        : entryBinding_(segment)
+        , member_(member)
+      {
+      }
+
+      /// @brief Access the binding for the entries so their fields can be bound.
+      StructBinding<ENTRY> & entryBinding()
+      {
+        return entryBinding_;
+      }
+
+      virtual size_t length(const RECORD & record) const
+      {
+        return (record.*member_).size();
+      }
+
+      virtual Messages::MessageAccessor * createEntryAccessor() const
+      {
+        return new StructAccessor<ENTRY>(entryBinding_);
+      }
+
+      virtual void setEntry(
+        Messages::MessageAccessor & entryAccessor,
+        const RECORD & record,
+        size_t index) const
+      {
+        static_cast<StructAccessor<ENTRY> &>(entryAccessor).setRecord((record.*member_)[index]);
+      }
+
+    private:
+      StructBinding<ENTRY> entryBinding_;
+      std::vector<ENTRY> RECORD::* member_;
+    };
+
+    template<typename RECORD>
+    template<typename ENTRY>
+    StructBinding<ENTRY> &
+    StructBinding<RECORD>::bindSequence(
+      const std::string & localName,
+      std::vector<ENTRY> RECORD::* member)
+    {
+      FieldBinding & field = fields_[ordinalOf(localName)];
+      SegmentBodyPtr segment;
+      if(field.type_ != ValueType::SEQUENCE || !field.instruction_->getSegmentBody(segment) || !segment)
+      {
+        throw UsageError("Coding Error", ("Field \"" + localName + "\" is not a sequence.").c_str());
+      }
+      boost::shared_ptr<StructSequenceBinder<RECORD, ENTRY> > binder(
+        new StructSequenceBinder<RECORD, ENTRY>(segment, member));
+      if(!field.sequence_)
+      {
+        field.sequenceIndex_ = sequenceCount_++;
+      }
+      field.sequence_ = binder;
+      return binder->entryBinding();
+    }
+  }
+}
+#endif // STRUCTACCESSOR_H
@@ -156,6 +156,72 @@ namespace QuickFAST
 #endif
   }
 
+  /// @brief Read a long integer with acquire semantics
+  ///
+  /// Reads and writes that follow this call in program order will not be moved
+  /// before it.  Use with atomic_store_release_long() to publish data from one
+  /// thread to another without a lock.
+  /// @param source points to the long to be read
+  inline
+  long atomic_load_acquire_long(const volatile long * source)
+  {
+#if defined(_WIN32)
+    long value = *source;
+    _ReadWriteBarrier();
+    return value;
+#elif defined(__GNUC__) && defined(__ATOMIC_ACQUIRE)
+    return __atomic_load_n(source, __ATOMIC_ACQUIRE);
+#elif defined(__GNUC__)
+    long value = *source;
+    __sync_synchronize();
+    return value;
+#else
+    long value = *source;
+    membar_consumer();
+    return value;
+#endif
+  }
+
+  /// @brief Write a long integer with release semantics
+  ///
+  /// Reads and writes that precede this call in program order will be
+  /// visible to any thread that sees the new value.
+  /// @param target points to the long to be updated
+  /// @param value the new value to be stored in target
+  inline
+  void atomic_store_release_long(volatile long * target, long value)
+  {
+#if defined(_WIN32)
+    _ReadWriteBarrier();
+    *target = value;
+#elif defined(__GNUC__) && defined(__ATOMIC_RELEASE)
+    __atomic_store_n(target, value, __ATOMIC_RELEASE);
+#elif defined(__GNUC__)
+    __sync_synchronize();
+    *target = value;
+#else
+    membar_producer();
+    *target = value;
+#endif
+  }
+
+  /// @brief Full memory barrier
+  ///
+  /// No read or write is moved across this call in either direction.  In
+  /// particular a write before it is visible before a read after it, which
+  /// acquire and release alone do not promise.
+  inline
+  void atomic_full_barrier()
+  {
+#if defined(_WIN32)
+    MemoryBarrier();
+#elif defined(__GNUC__)
+    __sync_synchronize();
+#else
+    membar_enter();
+#endif
+  }
+
   /// @brief compare and swap long longs
   ///
   /// @param target the long long to be updated
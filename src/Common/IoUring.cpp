@@ -0,0 +1,377 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+#include "IoUring.h"
+#if defined(__linux__)
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+# if defined(__NR_io_uring_setup)
+#  include <linux/io_uring.h>
+#  define QUICKFAST_IO_URING
+# endif
+#endif
+
+using namespace ::QuickFAST;
+using namespace ::QuickFAST::Common;
+
+#if defined(QUICKFAST_IO_URING)
+namespace
+{
+  // The kernel and this process share the ring indexes.
+  // Read the kernel's with acquire and publish ours with release.
+  unsigned int loadAcquire(const unsigned int * index)
+  {
+    return __atomic_load_n(index, __ATOMIC_ACQUIRE);
+  }
+
+  void storeRelease(unsigned int * index, unsigned int value)
+  {
+    __atomic_store_n(index, value, __ATOMIC_RELEASE);
+  }
+
+  template<typename TYPE>
+  TYPE * at(void * base, size_t offset)
+  {
+    return reinterpret_cast<TYPE *>(static_cast<unsigned char *>(base) + offset);
+  }
+}
+#endif // QUICKFAST_IO_URING
+
+IoUring::IoUring()
+: fd_(-1)
+, submissionRing_(0)
+, submissionRingSize_(0)
+, completionRing_(0)
+, completionRingSize_(0)
+, entries_(0)
+, entriesSize_(0)
+, submissionHead_(0)
+, submissionTail_(0)
+, submissionMask_(0)
+, submissionArray_(0)
+, completionHead_(0)
+, completionTail_(0)
+, completionMask_(0)
+, completions_(0)
+, toSubmit_(0)
+, prepared_(0)
+, completed_(0)
+, systemCalls_(0)
+, lastError_(0)
+{
+}
+
+IoUring::~IoUring()
+{
+  close();
+}
+
+bool
+IoUring::supported()
+{
+  IoUring ring;
+  return ring.open(1);
+}
+
+bool
+IoUring::open(unsigned int entries)
+{
+#if defined(QUICKFAST_IO_URING)
+  close();
+  io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+  int fd = int(::syscall(__NR_io_uring_setup, entries, &params));
+  if(fd < 0)
+  {
+    lastError_ = errno;
+    return false;
+  }
+  fd_ = fd;
+
+  submissionRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+  completionRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  if(params.features & IORING_FEAT_SINGLE_MMAP)
+  {
+    submissionRingSize_ = std::max(submissionRingSize_, completionRingSize_);
+    completionRingSize_ = submissionRingSize_;
+  }
+  submissionRing_ = ::mmap(0, submissionRingSize_, PROT_READ | PROT_WRITE,
+    MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+  if(submissionRing_ == MAP_FAILED)
+  {
+    submissionRing_ = 0;
+    lastError_ = errno;
+    close();
+    return false;
+  }
+  if(params.features & IORING_FEAT_SINGLE_MMAP)
+  {
+    completionRing_ = submissionRing_;
+  }
+  else
+  {
+    completionRing_ = ::mmap(0, completionRingSize_, PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+    if(completionRing_ == MAP_FAILED)
+    {
+      completionRing_ = 0;
+      lastError_ = errno;
+      close();
+      return false;
+    }
+  }
+  entriesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+  entries_ = ::mmap(0, entriesSize_, PROT_READ | PROT_WRITE,
+    MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+  if(entries_ == MAP_FAILED)
+  {
+    entries_ = 0;
+    lastError_ = errno;
+    close();
+    return false;
+  }
+
+  submissionHead_ = at<unsigned int>(submissionRing_, params.sq_off.head);
+  submissionTail_ = at<unsigned int>(submissionRing_, params.sq_off.tail);
+  submissionMask_ = *at<unsigned int>(submissionRing_, params.sq_off.ring_mask);
+  submissionArray_ = at<unsigned int>(submissionRing_, params.sq_off.array);
+  completionHead_ = at<unsigned int>(completionRing_, params.cq_off.head);
+  completionTail_ = at<unsigned int>(completionRing_, params.cq_off.tail);
+  completionMask_ = *at<unsigned int>(completionRing_, params.cq_off.ring_mask);
+  completions_ = at<void>(completionRing_, params.cq_off.cqes);
+  return true;
+#else // QUICKFAST_IO_URING
+  lastError_ = ENOSYS;
+  return false;
+#endif // QUICKFAST_IO_URING
+}
+
+void
+IoUring::close()
+{
+#if defined(QUICKFAST_IO_URING)
+  if(entries_ != 0)
+  {
+    ::munmap(entries_, entriesSize_);
+  }
+  if(completionRing_ != 0 && completionRing_ != submissionRing_)
+  {
+    ::munmap(completionRing_, completionRingSize_);
+  }
+  if(submissionRing_ != 0)
+  {
+    ::munmap(submissionRing_, submissionRingSize_);
+  }
+  if(fd_ >= 0)
+  {
+    ::close(fd_);
+  }
+#endif // QUICKFAST_IO_URING
+  fd_ = -1;
+  entries_ = 0;
+  completionRing_ = 0;
+  submissionRing_ = 0;
+  toSubmit_ = 0;
+  prepared_ = 0;
+  completed_ = 0;
+  regions_.clear();
+}
+
+bool
+IoUring::registerBuffers(const std::vector<Region> & regions)
+{
+#if defined(QUICKFAST_IO_URING)
+  if(fd_ < 0)
+  {
+    return false;
+  }
+  if(!regions_.empty())
+  {
+    ::syscall(__NR_io_uring_register, fd_, IORING_UNREGISTER_BUFFERS, 0, 0);
+    regions_.clear();
+  }
+  if(regions.empty())
+  {
+    return true;
+  }
+  std::vector<iovec> vectors(regions.size());
+  for(size_t nRegion = 0; nRegion < regions.size(); ++nRegion)
+  {
+    vectors[nRegion].iov_base = regions[nRegion].address_;
+    vectors[nRegion].iov_len = regions[nRegion].size_;
+  }
+  if(::syscall(__NR_io_uring_register, fd_, IORING_REGISTER_BUFFERS, &vectors[0], unsigned(vectors.size())) < 0)
+  {
+    lastError_ = errno;
+    return false;
+  }
+  regions_ = regions;
+  return true;
+#else // QUICKFAST_IO_URING
+  return false;
+#endif // QUICKFAST_IO_URING
+}
+
+int
+IoUring::registeredRegion(const void * address, size_t size)const
+{
+  const unsigned char * start = static_cast<const unsigned char *>(address);
+  for(size_t nRegion = 0; nRegion < regions_.size(); ++nRegion)
+  {
+    const unsigned char * region = static_cast<const unsigned char *>(regions_[nRegion].address_);
+    if(start >= region && start + size <= region + regions_[nRegion].size_)
+    {
+      return int(nRegion);
+    }
+  }
+  return -1;
+}
+
+bool
+IoUring::registerEventFd(int eventFd)
+{
+#if defined(QUICKFAST_IO_URING)
+  if(fd_ < 0 || ::syscall(__NR_io_uring_register, fd_, IORING_REGISTER_EVENTFD, &eventFd, 1) < 0)
+  {
+    lastError_ = fd_ < 0 ? EBADF : errno;
+    return false;
+  }
+  return true;
+#else // QUICKFAST_IO_URING
+  return false;
+#endif // QUICKFAST_IO_URING
+}
+
+void *
+IoUring::nextEntry()
+{
+#if defined(QUICKFAST_IO_URING)
+  if(fd_ < 0)
+  {
+    return 0;
+  }
+  unsigned int tail = *submissionTail_ + toSubmit_;
+  if(tail - loadAcquire(submissionHead_) > submissionMask_)
+  {
+    return 0;
+  }
+  unsigned int index = tail & submissionMask_;
+  io_uring_sqe * entry = static_cast<io_uring_sqe *>(entries_) + index;
+  std::memset(entry, 0, sizeof(*entry));
+  submissionArray_[index] = index;
+  ++toSubmit_;
+  ++prepared_;
+  return entry;
+#else // QUICKFAST_IO_URING
+  return 0;
+#endif // QUICKFAST_IO_URING
+}
+
+bool
+IoUring::prepareRead(int fd, void * address, size_t size, uint64 offset, uint64 tag, int region)
+{
+#if defined(QUICKFAST_IO_URING)
+  io_uring_sqe * entry = static_cast<io_uring_sqe *>(nextEntry());
+  if(entry == 0)
+  {
+    return false;
+  }
+  entry->opcode = region >= 0 ? IORING_OP_READ_FIXED : IORING_OP_READ;
+  entry->fd = fd;
+  entry->addr = uint64(size_t(address));
+  entry->len = unsigned(size);
+  entry->off = offset;
+  entry->user_data = tag;
+  entry->buf_index = region >= 0 ? region : 0;
+  return true;
+#else // QUICKFAST_IO_URING
+  return false;
+#endif // QUICKFAST_IO_URING
+}
+
+bool
+IoUring::prepareWrite(int fd, const void * address, size_t size, uint64 offset, uint64 tag, int region)
+{
+#if defined(QUICKFAST_IO_URING)
+  io_uring_sqe * entry = static_cast<io_uring_sqe *>(nextEntry());
+  if(entry == 0)
+  {
+    return false;
+  }
+  entry->opcode = region >= 0 ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+  entry->fd = fd;
+  entry->addr = uint64(size_t(address));
+  entry->len = unsigned(size);
+  entry->off = offset;
+  entry->user_data = tag;
+  entry->buf_index = region >= 0 ? region : 0;
+  return true;
+#else // QUICKFAST_IO_URING
+  return false;
+#endif // QUICKFAST_IO_URING
+}
+
+bool
+IoUring::submit(unsigned int waitFor)
+{
+#if defined(QUICKFAST_IO_URING)
+  if(fd_ < 0)
+  {
+    return false;
+  }
+  if(toSubmit_ == 0 && waitFor == 0)
+  {
+    return true;
+  }
+  storeRelease(submissionTail_, *submissionTail_ + toSubmit_);
+  unsigned int count = toSubmit_;
+  toSubmit_ = 0;
+  int result = 0;
+  do
+  {
+    ++systemCalls_;
+    result = int(::syscall(__NR_io_uring_enter, fd_, count, waitFor,
+      waitFor > 0 ? IORING_ENTER_GETEVENTS : 0, 0, 0));
+    if(result >= 0)
+    {
+      count -= std::min(count, unsigned(result));
+    }
+  } while((result < 0 && errno == EINTR) || (result > 0 && count > 0));
+  if(result < 0)
+  {
+    lastError_ = errno;
+    return false;
+  }
+  return true;
+#else // QUICKFAST_IO_URING
+  return false;
+#endif // QUICKFAST_IO_URING
+}
+
+bool
+IoUring::nextCompletion(uint64 & tag, int & result)
+{
+#if defined(QUICKFAST_IO_URING)
+  if(fd_ < 0)
+  {
+    return false;
+  }
+  unsigned int head = *completionHead_;
+  if(head == loadAcquire(completionTail_))
+  {
+    return false;
+  }
+  const io_uring_cqe & completion = static_cast<io_uring_cqe *>(completions_)[head & completionMask_];
+  tag = completion.user_data;
+  result = completion.res;
+  storeRelease(completionHead_, head + 1);
+  ++completed_;
+  return true;
+#else // QUICKFAST_IO_URING
+  return false;
+#endif // QUICKFAST_IO_URING
+}
@@ -0,0 +1,167 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef IOURING_H
+#define IOURING_H
+#include <Common/QuickFAST_Export.h>
+#include <Common/Types.h>
+
+namespace QuickFAST{
+  namespace Common{
+    /// @brief A Linux io_uring: a submission queue and a completion queue shared with the kernel.
+    ///
+    /// Reads and writes are placed in the submission queue, handed to the
+    /// kernel by submit(), and their results are collected from the completion
+    /// queue.  Many operations can be in flight at once, and a batch of them
+    /// costs a single system call.
+    ///
+    /// Buffers registered with registerBuffers() are pinned once, so
+    /// the kernel does not map them again for every operation.
+    ///
+    /// The system calls are made directly, so liburing is not required.
+    /// On other platforms, or if the kernel refuses, open() returns false.
+    ///
+    /// One thread at a time may prepare and submit operations, and one thread at a
+    /// time may collect completions.  These may be different threads.
+    class QuickFAST_Export IoUring
+    {
+    public:
+      /// @brief A region of memory to register.
+      struct Region
+      {
+        /// @brief Construct
+        Region(void * address = 0, size_t size = 0)
+          : address_(address)
+          , size_(size)
+        {
+        }
+        /// @brief the start of the region
+        void * address_;
+        /// @brief how many bytes
+        size_t size_;
+      };
+
+      IoUring();
+      ~IoUring();
+
+      /// @brief Can this process use io_uring?
+      static bool supported();
+
+      /// @brief Create the queues.
+      /// @param entries the size of the submission queue; rounded up to a power of two by the kernel.
+      /// @returns false if io_uring is not available.  See lastError().
+      bool open(unsigned int entries);
+
+      /// @brief Has open() succeeded?
+      bool isOpen()const
+      {
+        return fd_ >= 0;
+      }
+
+      /// @brief Release the queues.  Operations still in flight are abandoned.
+      void close();
+
+      /// @brief Register buffers for reads and writes.
+      ///
+      /// Replaces any buffers registered earlier.
+      /// @param regions the buffers.  An operation may use any part of a region.
+      /// @returns false if the kernel refused (for example RLIMIT_MEMLOCK is too small.)
+      bool registerBuffers(const std::vector<Region> & regions);
+
+      /// @brief Find the registered region that holds a buffer.
+      /// @returns the region's index or -1 if the buffer is not within a registered region.
+      int registeredRegion(const void * address, size_t size)const;
+
+      /// @brief Ask the kernel to signal an eventfd whenever an operation completes.
+      bool registerEventFd(int eventFd);
+
+      /// @brief Queue a read.  Nothing is sent to the kernel until submit().
+      /// @param fd the file to read
+      /// @param address where to put the data
+      /// @param size how many bytes to read
+      /// @param offset where in the file to start
+      /// @param tag returned with the completion
+      /// @param region the registered region holding the buffer, or -1.
+      /// @returns false if the submission queue is full.
+      bool prepareRead(int fd, void * address, size_t size, uint64 offset, uint64 tag, int region = -1);
+
+      /// @brief Queue a write.  Nothing is sent to the kernel until submit().
+      /// @param fd the file to write
+      /// @param address the data
+      /// @param size how many bytes to write
+      /// @param offset where in the file to write
+      /// @param tag returned with the completion
+      /// @param region the registered region holding the buffer, or -1.
+      /// @returns false if the submission queue is full.
+      bool prepareWrite(int fd, const void * address, size_t size, uint64 offset, uint64 tag, int region = -1);
+
+      /// @brief Send the queued operations to the kernel.
+      /// @param waitFor wait until at least this many completions are available.
+      /// @returns false if the kernel reported an error.  See lastError().
+      bool submit(unsigned int waitFor = 0);
+
+      /// @brief Collect a completion without waiting.
+      /// @param tag receives the tag given when the operation was prepared.
+      /// @param result receives the byte count, or a negative errno.
+      /// @returns false if no operation has completed.
+      bool nextCompletion(uint64 & tag, int & result);
+
+      /// @brief How many operations have been prepared but not completed?
+      size_t inFlight()const
+      {
+        return prepared_ - completed_;
+      }
+
+      /// @brief How many times has the kernel been entered?
+      size_t systemCalls()const
+      {
+        return systemCalls_;
+      }
+
+      /// @brief The errno of the most recent failure.
+      int lastError()const
+      {
+        return lastError_;
+      }
+
+    private:
+      void * nextEntry();
+
+    private:
+      IoUring(const IoUring &);
+      IoUring & operator=(const IoUring &);
+
+    private:
+      int fd_;
+      void * submissionRing_;
+      size_t submissionRingSize_;
+      void * completionRing_;
+      size_t completionRingSize_;
+      void * entries_;
+      size_t entriesSize_;
+
+      unsigned int * submissionHead_;
+      unsigned int * submissionTail_;
+      unsigned int submissionMask_;
+      unsigned int * submissionArray_;
+      unsigned int * completionHead_;
+      unsigned int * completionTail_;
+      unsigned int completionMask_;
+      void * completions_;
+
+      /// prepared since the last submit()
+      unsigned int toSubmit_;
+      /// counted by the submitting thread
+      size_t prepared_;
+      /// counted by the completing thread
+      size_t completed_;
+      size_t systemCalls_;
+      int lastError_;
+      std::vector<Region> regions_;
+    };
+  }
+}
+#endif // IOURING_H
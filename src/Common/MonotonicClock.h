@@ -0,0 +1,38 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef MONOTONICCLOCK_H
+#define MONOTONICCLOCK_H
+// All inline, do not export.
+#include <Common/Types.h>
+#if !defined(_WIN32)
+#include <time.h>
+#endif
+
+namespace QuickFAST{
+  namespace Common{
+    /// @brief Read a monotonic clock in nanoseconds.
+    ///
+    /// Only differences between values are meaningful.  Used to measure
+    /// how long buffers and messages wait between threads.
+    inline uint64 monotonicNanoseconds()
+    {
+#if defined(_WIN32)
+      LARGE_INTEGER frequency;
+      LARGE_INTEGER counter;
+      ::QueryPerformanceFrequency(&frequency);
+      ::QueryPerformanceCounter(&counter);
+      return uint64(counter.QuadPart / frequency.QuadPart) * 1000000000
+        + uint64(counter.QuadPart % frequency.QuadPart) * 1000000000 / uint64(frequency.QuadPart);
+#else // _WIN32
+      timespec ts;
+      ::clock_gettime(CLOCK_MONOTONIC, &ts);
+      return uint64(ts.tv_sec) * 1000000000 + uint64(ts.tv_nsec);
+#endif // _WIN32
+    }
+  }
+}
+#endif // MONOTONICCLOCK_H
@@ -0,0 +1,231 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+#include "ThreadPlacement.h"
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#endif
+
+using namespace ::QuickFAST;
+using namespace ::QuickFAST::Common;
+
+namespace
+{
+#if defined(__linux__)
+  enum
+  {
+    maxNodes = 1024,
+    bitsPerWord = sizeof(unsigned long) * CHAR_BIT
+  };
+#endif
+
+  bool parseCpu(const std::string & text, size_t & pos, int & cpu)
+  {
+    size_t start = pos;
+    cpu = 0;
+    while(pos < text.size() && text[pos] >= '0' && text[pos] <= '9')
+    {
+      cpu = cpu * 10 + (text[pos] - '0');
+      ++pos;
+    }
+    return pos > start;
+  }
+}
+
+bool
+ThreadPlacement::parseCpuList(const std::string & text, std::vector<int> & cpus)
+{
+  cpus.clear();
+  size_t pos = 0;
+  while(pos < text.size())
+  {
+    int first = 0;
+    if(!parseCpu(text, pos, first))
+    {
+      return false;
+    }
+    int last = first;
+    if(pos < text.size() && text[pos] == '-')
+    {
+      ++pos;
+      if(!parseCpu(text, pos, last) || last < first)
+      {
+        return false;
+      }
+    }
+    for(int cpu = first; cpu <= last; ++cpu)
+    {
+      cpus.push_back(cpu);
+    }
+    if(pos < text.size())
+    {
+      if(text[pos] != ',')
+      {
+        return false;
+      }
+      ++pos;
+    }
+  }
+  return !cpus.empty();
+}
+
+std::string
+ThreadPlacement::formatCpuList(const std::vector<int> & cpus)
+{
+  std::stringstream list;
+  size_t pos = 0;
+  while(pos < cpus.size())
+  {
+    size_t end = pos + 1;
+    while(end < cpus.size() && cpus[end] == cpus[end - 1] + 1)
+    {
+      ++end;
+    }
+    if(pos != 0)
+    {
+      list << ',';
+    }
+    list << cpus[pos];
+    if(end - pos > 1)
+    {
+      list << '-' << cpus[end - 1];
+    }
+    pos = end;
+  }
+  return list.str();
+}
+
+bool
+ThreadPlacement::pinThread(const std::vector<int> & cpus)
+{
+  if(cpus.empty())
+  {
+    return false;
+  }
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for(size_t nCpu = 0; nCpu < cpus.size(); ++nCpu)
+  {
+    if(cpus[nCpu] < 0 || cpus[nCpu] >= CPU_SETSIZE)
+    {
+      return false;
+    }
+    CPU_SET(cpus[nCpu], &set);
+  }
+  return ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+  DWORD_PTR mask = 0;
+  for(size_t nCpu = 0; nCpu < cpus.size(); ++nCpu)
+  {
+    if(cpus[nCpu] < 0 || size_t(cpus[nCpu]) >= sizeof(mask) * CHAR_BIT)
+    {
+      return false;
+    }
+    mask |= DWORD_PTR(1) << cpus[nCpu];
+  }
+  return ::SetThreadAffinityMask(::GetCurrentThread(), mask) != 0;
+#else
+  return false;
+#endif
+}
+
+bool
+ThreadPlacement::pinThread(int cpu)
+{
+  if(cpu < 0)
+  {
+    return false;
+  }
+  return pinThread(std::vector<int>(1, cpu));
+}
+
+bool
+ThreadPlacement::nameThread(const std::string & name)
+{
+#if defined(__linux__)
+  // The limit includes the terminating null.
+  std::string shortName(name, 0, 15);
+  return ::pthread_setname_np(::pthread_self(), shortName.c_str()) == 0;
+#else
+  return false;
+#endif
+}
+
+int
+ThreadPlacement::nodeOfCpu(int cpu)
+{
+  int node = -1;
+#if defined(__linux__)
+  if(cpu < 0)
+  {
+    return node;
+  }
+  // The cpu directory contains a link named for its node: node0, node1...
+  std::stringstream path;
+  path << "/sys/devices/system/cpu/cpu" << cpu;
+  DIR * dir = ::opendir(path.str().c_str());
+  if(dir == 0)
+  {
+    return node;
+  }
+  struct dirent * entry;
+  while(node < 0 && (entry = ::readdir(dir)) != 0)
+  {
+    if(std::strncmp(entry->d_name, "node", 4) == 0)
+    {
+      std::string number(entry->d_name + 4);
+      size_t pos = 0;
+      int value = 0;
+      if(parseCpu(number, pos, value) && pos == number.size())
+      {
+        node = value;
+      }
+    }
+  }
+  ::closedir(dir);
+#endif
+  return node;
+}
+
+int
+ThreadPlacement::currentNode()
+{
+#if defined(__linux__) && defined(SYS_getcpu)
+  unsigned int cpu = 0;
+  unsigned int node = 0;
+  if(::syscall(SYS_getcpu, &cpu, &node, 0) == 0)
+  {
+    return int(node);
+  }
+#endif
+  return -1;
+}
+
+bool
+ThreadPlacement::placeOnNode(void * address, size_t bytes, int node)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+  if(node < 0 || node >= maxNodes || address == 0 || bytes == 0)
+  {
+    return false;
+  }
+  size_t pageSize = size_t(::sysconf(_SC_PAGESIZE));
+  size_t first = size_t(address) / pageSize * pageSize;
+  size_t end = (size_t(address) + bytes + pageSize - 1) / pageSize * pageSize;
+  unsigned long nodes[maxNodes / bitsPerWord];
+  std::memset(nodes, 0, sizeof(nodes));
+  nodes[node / bitsPerWord] = 1UL << (node % bitsPerWord);
+  // The kernel reads one bit less than maxnode says.
+  return ::syscall(SYS_mbind, first, end - first, MPOL_PREFERRED,
+    nodes, (unsigned long)(maxNodes + 1), MPOL_MF_MOVE) == 0;
+#else
+  return false;
+#endif
+}
@@ -0,0 +1,74 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef THREADPLACEMENT_H
+#define THREADPLACEMENT_H
+#include <Common/QuickFAST_Export.h>
+
+namespace QuickFAST{
+  namespace Common{
+    /// @brief Control where threads run and where their memory lives.
+    ///
+    /// On a multi-socket machine memory belongs to one NUMA node.  A thread
+    /// that touches memory on another node pays for the trip across the
+    /// interconnect.  These helpers pin threads to CPUs, find the node a CPU
+    /// belongs to, and move memory to a node.  Threads can also be named so
+    /// they are easy to find in top, perf, gdb, etc.
+    ///
+    /// Implemented for Linux.  On other platforms the methods do nothing and
+    /// return false (or -1).
+    ///
+    /// NUMA placement uses the mbind system call directly, so libnuma is not required.
+    class QuickFAST_Export ThreadPlacement
+    {
+    public:
+      /// @brief Parse a CPU list in the style of taskset and /sys: "0-3,8,10-11"
+      /// @param text the CPU list.
+      /// @param cpus receives the CPU numbers in the order given.
+      /// @returns false if the text is not a valid CPU list.
+      static bool parseCpuList(const std::string & text, std::vector<int> & cpus);
+
+      /// @brief Format a CPU list (the inverse of parseCpuList)
+      static std::string formatCpuList(const std::vector<int> & cpus);
+
+      /// @brief Allow the calling thread to run only on the given CPUs.
+      /// @param cpus the allowed CPUs.  If empty nothing is changed.
+      /// @returns true if the thread was pinned.
+      static bool pinThread(const std::vector<int> & cpus);
+
+      /// @brief Allow the calling thread to run only on one CPU.
+      /// @param cpu the CPU.  If negative nothing is changed.
+      /// @returns true if the thread was pinned.
+      static bool pinThread(int cpu);
+
+      /// @brief Name the calling thread.
+      ///
+      /// Linux limits the name to 15 characters.  Longer names are truncated.
+      /// @returns true if the name was set.
+      static bool nameThread(const std::string & name);
+
+      /// @brief Which NUMA node is a CPU on?
+      /// @returns the node or -1 if unknown.
+      static int nodeOfCpu(int cpu);
+
+      /// @brief Which NUMA node is the calling thread running on right now?
+      /// @returns the node or -1 if unknown.
+      static int currentNode();
+
+      /// @brief Place memory on a NUMA node.
+      ///
+      /// Pages that already exist are moved.  Pages that do not exist yet
+      /// are created on the node when they are first touched.  Whole pages
+      /// are affected, so anything sharing the first or last page moves, too.
+      /// @param address the start of the memory
+      /// @param bytes how much memory
+      /// @param node the destination.  If negative nothing is changed.
+      /// @returns true if the memory was placed.
+      static bool placeOnNode(void * address, size_t bytes, int node);
+    };
+  }
+}
+#endif // THREADPLACEMENT_H
@@ -0,0 +1,107 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef TOKENBUCKET_H
+#define TOKENBUCKET_H
+// All inline, do not export.
+#include <Common/Types.h>
+
+namespace QuickFAST{
+  namespace Common{
+    /// @brief Limit an average rate while allowing short bursts.
+    ///
+    /// Tokens accumulate at a fixed rate up to the depth of the bucket.
+    /// Sending something costs tokens (one per packet, or one per bit, for
+    /// example.)  When the bucket holds too few tokens the caller is told how
+    /// long to wait.
+    ///
+    /// Something that costs more than the whole bucket may go as soon as the
+    /// bucket is full; the bucket then goes into debt so the average rate holds.
+    ///
+    /// Not thread safe.  Times are nanoseconds from any monotonic clock.
+    class TokenBucket
+    {
+    public:
+      TokenBucket()
+        : rate_(0.0)
+        , depth_(0.0)
+        , tokens_(0.0)
+        , lastFill_(0)
+        , started_(false)
+        , waits_(0)
+      {
+      }
+
+      /// @brief Set the rate and the size of a burst.
+      /// @param tokensPerSecond the average rate.  Zero or less means unlimited.
+      /// @param depth the most tokens saved while idle.  At least one.
+      void setRate(double tokensPerSecond, double depth)
+      {
+        rate_ = tokensPerSecond;
+        depth_ = depth >= 1.0 ? depth : 1.0;
+        started_ = false;
+      }
+
+      /// @brief Is there a limit?
+      bool limited()const
+      {
+        return rate_ > 0.0;
+      }
+
+      /// @brief Take tokens if they are available.
+      /// @param cost how many tokens are needed.
+      /// @param now the current time.
+      /// @returns zero if the tokens were taken, otherwise the
+      ///          nanoseconds until they will be available.
+      uint64 take(double cost, uint64 now)
+      {
+        if(rate_ <= 0.0)
+        {
+          return 0;
+        }
+        if(!started_)
+        {
+          // Start full so the first burst goes at once.
+          started_ = true;
+          tokens_ = depth_;
+          lastFill_ = now;
+        }
+        else if(now > lastFill_)
+        {
+          tokens_ += double(now - lastFill_) * rate_ / 1.0e9;
+          if(tokens_ > depth_)
+          {
+            tokens_ = depth_;
+          }
+          lastFill_ = now;
+        }
+        double needed = cost < depth_ ? cost : depth_;
+        if(tokens_ >= needed)
+        {
+          tokens_ -= cost;
+          return 0;
+        }
+        ++waits_;
+        return uint64((needed - tokens_) * 1.0e9 / rate_) + 1;
+      }
+
+      /// @brief Statistic: How many times has take() said wait?
+      size_t waits()const
+      {
+        return waits_;
+      }
+
+    private:
+      double rate_;
+      double depth_;
+      double tokens_;
+      uint64 lastFill_;
+      bool started_;
+      size_t waits_;
+    };
+  }
+}
+#endif // TOKENBUCKET_H
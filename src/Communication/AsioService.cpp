@@ -4,6 +4,7 @@
 #include <Common/QuickFASTPch.h>
 #include "AsioService.h"
 #include <Common/Logger.h>
+#include <Common/ThreadPlacement.h>
 
 using namespace QuickFAST;
 using namespace Communication;
@@ -79,11 +80,12 @@ AsioService::runThreads(size_t threadCount /*= 0*/, bool useThisThread /* = true
   while(threadCount_ < threadCount)
   {
     threads_[threadCount_].reset(
-      new boost::thread(boost::bind(&AsioService::run, this)));
+      new boost::thread(boost::bind(&AsioService::runThread, this, threadCount_)));
     ++threadCount_;
   }
   if(useThisThread)
   {
+    placeThread(threadCount_);
     run();
     joinThreads();
   }
@@ -131,3 +133,31 @@ AsioService::run()
   --runningThreadCount_;
 }
 
+
+void
+AsioService::runThread(size_t index)
+{
+  placeThread(index);
+  run();
+}
+
+void
+AsioService::placeThread(size_t index)
+{
+  if(!threadName_.empty())
+  {
+    std::stringstream name;
+    name << threadName_ << '/' << index;
+    Common::ThreadPlacement::nameThread(name.str());
+  }
+  if(!threadCpus_.empty())
+  {
+    int cpu = threadCpus_[index % threadCpus_.size()];
+    if(!Common::ThreadPlacement::pinThread(cpu) && logger_ != 0)
+    {
+      std::stringstream msg;
+      msg << "AsioService: Cannot pin thread " << index << " to CPU " << cpu << '.';
+      logger_->logMessage(Common::Logger::QF_LOG_WARNING, msg.str());
+    }
+  }
+}
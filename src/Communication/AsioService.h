@@ -40,8 +40,38 @@ namespace QuickFAST
       void setLogger(Common::Logger & logger);
 
       /// @brief Run the event loop with this threads and threadCount additional threads.
+      ///
+      /// Threads are placed according to setThreadCpus() and setThreadName().
+      /// The additional threads are numbered from zero.  If useThisThread is true
+      /// this thread is numbered threadCount and it is placed, too.
       void runThreads(size_t threadCount = 0, bool useThisThread = true);
 
+      /// @brief Pin the threads started by runThreads() to CPUs.
+      ///
+      /// Thread n runs only on cpus[n % cpus.size()].
+      /// Must be called before runThreads().
+      /// @param cpus the CPUs to use, in order.  Empty means any CPU.
+      void setThreadCpus(const std::vector<int> & cpus)
+      {
+        threadCpus_ = cpus;
+      }
+
+      /// @brief Which CPUs will the threads use?
+      const std::vector<int> & threadCpus()const
+      {
+        return threadCpus_;
+      }
+
+      /// @brief Name the threads started by runThreads().
+      ///
+      /// Thread n is named name/n (truncated to 15 characters on Linux.)
+      /// Must be called before runThreads().
+      /// @param name the base name.  Empty means do not name the threads.
+      void setThreadName(const std::string & name)
+      {
+        threadName_ = name;
+      }
+
       /// @brief run the event loop in this thread
       ///
       /// Exceptions are caught, logged, and ignored.  The event loop continues.
@@ -119,6 +149,12 @@ namespace QuickFAST
         return runningThreadCount_;
       }
 
+    private:
+      /// @brief place thread number index, then run the event loop.
+      void runThread(size_t index);
+      /// @brief pin and name the calling thread as thread number index
+      void placeThread(size_t index);
+
     private:
       // if no io_service is specified, this one
       // will be used (shared among all users)
@@ -136,6 +172,8 @@ namespace QuickFAST
       boost::asio::io_service & ioService_;
       bool usingSharedService_;
       Common::Logger * logger_;
+      std::vector<int> threadCpus_;
+      std::string threadName_;
     };
   }
 }
@@ -13,6 +13,14 @@
 #include <Communication/AsynchReceiver.h>
 #include <Common/Types.h>
 #include <Common/Exceptions.h>
+#if defined(__linux__)
+#include <Common/IoUring.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <cstring>
+#include <sys/eventfd.h>
+#endif
 namespace QuickFAST
 {
   namespace Communication
@@ -65,6 +73,27 @@ namespace QuickFAST
         }
       }
 
+      /// @brief How many reads may be in flight at once.  Windows reads one buffer at a time.
+      void setReadsInFlight(size_t /*readsInFlight*/)
+      {
+      }
+
+      /// @brief Bypass the file system cache (FILE_FLAG_NO_BUFFERING).
+      ///
+      /// Buffers must be sector aligned; see Receiver::setSlabBuffers().
+      /// Must be called before start().
+      void setDirectIO(bool directIO = true)
+      {
+        if(directIO)
+        {
+          additionalAttributes_ |= FILE_FLAG_NO_BUFFERING;
+        }
+        else
+        {
+          additionalAttributes_ &= ~FILE_FLAG_NO_BUFFERING;
+        }
+      }
+
       // Implement Receiver method
       virtual bool initializeReceiver()
       {
@@ -163,7 +192,419 @@ namespace QuickFAST
       boost::uint64_t offset_;
     };
 
-#else // not _WIN32
+#elif defined(__linux__)
+    /// @brief Read stream of FAST-encoded data from a file using asynchronous I/O
+    ///
+    /// The Linux implementation uses io_uring.  Several reads are kept in
+    /// flight at once (see setReadsInFlight()), each into its own buffer at
+    /// the next offset in the file.  Completions may arrive in any order but
+    /// the buffers are passed to the assembler in file order.
+    ///
+    /// The receiver's buffers are registered with the kernel when reading
+    /// starts so they are not mapped again for every read.  If registration
+    /// fails (for example RLIMIT_MEMLOCK is too small) the buffers are read
+    /// unregistered.
+    ///
+    /// A short read is taken as the end of the file.
+    class AsynchFileReceiver
+      : public AsynchReceiver
+    {
+    public:
+      /// @brief Construct given file name, and extra attributes
+      /// @param fileName the file to read
+      /// @param additionalAttributes flags added to those passed to open(), for example O_NOATIME.
+      AsynchFileReceiver(
+        const std::string & fileName,
+        uint32 additionalAttributes = 0
+        )
+        : AsynchReceiver()
+        , fileName_(fileName)
+        , additionalAttributes_(additionalAttributes)
+        , fd_(-1)
+        , eventFd_(-1)
+        , eventDescriptor_(ioService_.ioService())
+        , eventCount_(0)
+        , readsInFlight_(defaultReadsInFlight)
+        , directIO_(false)
+        , started_(false)
+        , endOfFile_(false)
+        , deferSubmit_(false)
+        , readOffset_(0)
+        , registeredReads_(0)
+      {
+      }
+
+      /// @brief Construct given ioservice, file name, and extra attributes
+      /// @param ioService an ioService to be shared with other objects
+      /// @param fileName the file to read
+      /// @param additionalAttributes flags added to those passed to open(), for example O_NOATIME.
+      AsynchFileReceiver(
+        boost::asio::io_service & ioService,
+        const std::string & fileName,
+        uint32 additionalAttributes = 0
+        )
+        : AsynchReceiver(ioService)
+        , fileName_(fileName)
+        , additionalAttributes_(additionalAttributes)
+        , fd_(-1)
+        , eventFd_(-1)
+        , eventDescriptor_(ioService_.ioService())
+        , eventCount_(0)
+        , readsInFlight_(defaultReadsInFlight)
+        , directIO_(false)
+        , started_(false)
+        , endOfFile_(false)
+        , deferSubmit_(false)
+        , readOffset_(0)
+        , registeredReads_(0)
+      {
+      }
+
+      ~AsynchFileReceiver()
+      {
+        close();
+      }
+
+      /// @brief How many reads may be in flight at once.
+      ///
+      /// Allocate more buffers than this so the decoder has
+      /// something to work on while the reads are in flight.
+      /// Must be called before start().
+      /// @param readsInFlight the limit.  Zero means one.
+      void setReadsInFlight(size_t readsInFlight)
+      {
+        readsInFlight_ = readsInFlight > 0 ? readsInFlight : 1;
+      }
+
+      /// @brief Bypass the page cache (O_DIRECT).
+      ///
+      /// Each buffer must start on a page and its size must be a multiple of
+      /// the page size.  Use Receiver::setSlabBuffers() with such a buffer size.
+      /// If the buffers or the file system do not allow direct I/O the file
+      /// is read through the page cache.
+      /// Must be called before start().
+      void setDirectIO(bool directIO = true)
+      {
+        directIO_ = directIO;
+      }
+
+      /// @brief Statistic: How many reads used registered buffers?
+      size_t registeredReads()const
+      {
+        return registeredReads_;
+      }
+
+      /// @brief Statistic: How many times has the kernel been entered to submit reads?
+      size_t submitCalls()const
+      {
+        return ring_.systemCalls();
+      }
+
+      // Implement Receiver method
+      virtual bool initializeReceiver()
+      {
+        if(assembler_->wantLog(Common::Logger::QF_LOG_INFO))
+        {
+          std::stringstream msg;
+          msg << "Opening file: " << fileName_;
+          assembler_->logMessage(Common::Logger::QF_LOG_INFO, msg.str());
+        }
+        int flags = O_RDONLY | O_CLOEXEC | int(additionalAttributes_);
+        fd_ = ::open(fileName_.c_str(), flags | (directIO_ ? O_DIRECT : 0));
+        if(fd_ < 0 && directIO_ && errno == EINVAL)
+        {
+          // The file system does not support direct I/O.
+          directIO_ = false;
+          fd_ = ::open(fileName_.c_str(), flags);
+        }
+        if(fd_ < 0)
+        {
+          return reportFailure("Cannot open", errno);
+        }
+        ::posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+        if(!ring_.open(unsigned(readsInFlight_)))
+        {
+          return reportFailure("io_uring is not available for", ring_.lastError());
+        }
+        eventFd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if(eventFd_ < 0 || !ring_.registerEventFd(eventFd_))
+        {
+          return reportFailure("Cannot wait for completions of reads from", eventFd_ < 0 ? errno : ring_.lastError());
+        }
+        eventDescriptor_.assign(eventFd_);
+        waitCompletions();
+        return true;
+      }
+
+      // Implement Receiver method
+      virtual void close()
+      {
+        boost::system::error_code ignored;
+        if(eventDescriptor_.is_open())
+        {
+          eventDescriptor_.cancel(ignored);
+          // the descriptor owns eventFd_
+          eventDescriptor_.close(ignored);
+          eventFd_ = -1;
+        }
+        {
+          boost::mutex::scoped_lock lock(ringMutex_);
+          if(ring_.isOpen() && ring_.inFlight() > 0)
+          {
+            // Let the kernel finish with the buffers before they can be released.
+            ring_.submit(unsigned(ring_.inFlight()));
+          }
+          ring_.close();
+        }
+        if(eventFd_ >= 0)
+        {
+          ::close(eventFd_);
+          eventFd_ = -1;
+        }
+        if(fd_ >= 0)
+        {
+          ::close(fd_);
+          fd_ = -1;
+        }
+      }
+
+      // Implement Receiver method
+      virtual void stop()
+      {
+        close();
+
+        // and then shut everything down for good.
+        AsynchReceiver::stop();
+      }
+
+    private:
+      enum
+      {
+        defaultReadsInFlight = 4,
+        pageSize = 4096
+      };
+
+      /// @brief A read in flight or waiting for an earlier read to complete.
+      struct Read
+      {
+        Read(LinkedBuffer * buffer = 0)
+          : buffer_(buffer)
+          , result_(0)
+          , complete_(false)
+        {
+        }
+        LinkedBuffer * buffer_;
+        int result_;
+        bool complete_;
+      };
+      /// indexed by file offset
+      typedef std::map<uint64, Read> Reads;
+
+      bool reportFailure(const char * what, int error)
+      {
+        std::stringstream msg;
+        msg << "AsynchFileReceiver: " << what << ' ' << fileName_ << ": " << std::strerror(error);
+        assembler_->logMessage(Common::Logger::QF_LOG_SERIOUS, msg.str());
+        close();
+        return false;
+      }
+
+      // Override Receiver method
+      virtual bool canStartRead()
+      {
+        return readsInProgress_ < readsInFlight_ && !endOfFile_ && ring_.isOpen();
+      }
+
+      // Implement Receiver method
+      bool fillBuffer(LinkedBuffer * buffer, boost::mutex::scoped_lock& lock)
+      {
+        if(!started_)
+        {
+          started_ = true;
+          registerBuffers();
+        }
+        if(directIO_ && (size_t(buffer->get()) % pageSize != 0 || buffer->capacity() % pageSize != 0))
+        {
+          directIO_ = false;
+          ::fcntl(fd_, F_SETFL, ::fcntl(fd_, F_GETFL) & ~O_DIRECT);
+          assembler_->logMessage(Common::Logger::QF_LOG_WARNING,
+            "AsynchFileReceiver: Buffers are not page aligned.  Not using direct I/O.");
+        }
+        bool submitted = true;
+        {
+          boost::mutex::scoped_lock ringLock(ringMutex_);
+          int region = ring_.registeredRegion(buffer->get(), buffer->capacity());
+          if(!ring_.prepareRead(fd_, buffer->get(), buffer->capacity(), readOffset_, readOffset_, region))
+          {
+            return false;
+          }
+          if(region >= 0)
+          {
+            ++registeredReads_;
+          }
+          reads_[readOffset_] = Read(buffer);
+          readOffset_ += buffer->capacity();
+          // startReceive() calls again while another read can start, so
+          // submit the whole batch with the last one.  While completions are
+          // being delivered handleCompletions() submits the batch instead.
+          if(!deferSubmit_ && (readsInProgress_ >= readsInFlight_ || idleBufferPool_.isEmpty()))
+          {
+            submitted = ring_.submit();
+          }
+        }
+        if(!submitted)
+        {
+          reads_.erase(readOffset_ - buffer->capacity());
+          reportFailure("Cannot start reading", ring_.lastError());
+          return false;
+        }
+        return true;
+      }
+
+      void registerBuffers()
+      {
+        std::vector<Common::IoUring::Region> regions;
+        for(size_t nPool = 0; nPool < bufferPools_.size(); ++nPool)
+        {
+          regions.push_back(Common::IoUring::Region(bufferPools_[nPool]->data(), bufferPools_[nPool]->footprint()));
+        }
+        for(size_t nBuffer = 0; nBuffer < bufferLifetimes_.size(); ++nBuffer)
+        {
+          regions.push_back(Common::IoUring::Region(bufferLifetimes_[nBuffer]->get(), bufferLifetimes_[nBuffer]->capacity()));
+        }
+        if(!ring_.registerBuffers(regions) && assembler_->wantLog(Common::Logger::QF_LOG_INFO))
+        {
+          std::stringstream msg;
+          msg << "AsynchFileReceiver: Buffers not registered: " << std::strerror(ring_.lastError());
+          assembler_->logMessage(Common::Logger::QF_LOG_INFO, msg.str());
+        }
+      }
+
+      void waitCompletions()
+      {
+        eventDescriptor_.async_read_some(
+          boost::asio::buffer(&eventCount_, sizeof(eventCount_)),
+          boost::bind(&AsynchFileReceiver::handleCompletions,
+            this,
+            boost::asio::placeholders::error)
+          );
+      }
+
+      /// Only one call is outstanding, so completions are handled one thread at a time.
+      void handleCompletions(const boost::system::error_code& error)
+      {
+        if(error == boost::asio::error::operation_aborted || !ring_.isOpen())
+        {
+          return;
+        }
+        std::vector<Read> ready;
+        bool finished = false;
+        {
+          boost::mutex::scoped_lock lock(bufferMutex_);
+          {
+            boost::mutex::scoped_lock ringLock(ringMutex_);
+            deferSubmit_ = true;
+            uint64 offset = 0;
+            int result = 0;
+            while(ring_.nextCompletion(offset, result))
+            {
+              Reads::iterator read = reads_.find(offset);
+              if(read != reads_.end())
+              {
+                read->second.result_ = result;
+                read->second.complete_ = true;
+              }
+            }
+          }
+          // Deliver in file order.
+          while(!reads_.empty() && reads_.begin()->second.complete_)
+          {
+            Read & read = reads_.begin()->second;
+            if(endOfFile_)
+            {
+              // Reads beyond the end of the file.
+              idleBufferPool_.push(read.buffer_);
+              --readsInProgress_;
+            }
+            else
+            {
+              if(read.result_ <= 0 || size_t(read.result_) < read.buffer_->capacity())
+              {
+                endOfFile_ = true;
+              }
+              if(read.result_ == 0)
+              {
+                idleBufferPool_.push(read.buffer_);
+                --readsInProgress_;
+              }
+              else
+              {
+                ready.push_back(read);
+              }
+            }
+            reads_.erase(reads_.begin());
+          }
+          finished = endOfFile_ && reads_.empty();
+        }
+
+        for(size_t nRead = 0; nRead < ready.size(); ++nRead)
+        {
+          const Read & read = ready[nRead];
+          boost::system::error_code readError;
+          if(read.result_ < 0)
+          {
+            readError = boost::system::error_code(-read.result_, boost::system::system_category());
+          }
+          handleReceive(readError, read.buffer_, read.result_ < 0 ? 0 : size_t(read.result_));
+        }
+        bool submitted = true;
+        {
+          // The reads started while delivering go to the kernel together.
+          boost::mutex::scoped_lock ringLock(ringMutex_);
+          deferSubmit_ = false;
+          if(ring_.isOpen())
+          {
+            submitted = ring_.submit();
+          }
+        }
+        if(!submitted)
+        {
+          reportFailure("Cannot continue reading", ring_.lastError());
+          finished = true;
+        }
+        if(finished)
+        {
+          // With no more work the io_service runs down.
+          close();
+        }
+        else if(ring_.isOpen())
+        {
+          waitCompletions();
+        }
+      }
+
+    private:
+      std::string fileName_;
+      uint32 additionalAttributes_;
+      int fd_;
+      int eventFd_;
+      boost::asio::posix::stream_descriptor eventDescriptor_;
+      uint64 eventCount_;
+      /// Serialize use of the ring by the reading, completing and closing threads.
+      boost::mutex ringMutex_;
+      Common::IoUring ring_;
+      size_t readsInFlight_;
+      bool directIO_;
+      bool started_;
+      bool endOfFile_;
+      /// Protected by ringMutex_
+      bool deferSubmit_;
+      uint64 readOffset_;
+      Reads reads_;
+      size_t registeredReads_;
+    };
+
+#else // neither _WIN32 nor __linux__
     /// @brief Read stream of FAST-encoded data from a file using asynchronous I/O
     class AsynchFileReceiver
       : public AsynchReceiver
@@ -178,7 +619,7 @@ namespace QuickFAST
         )
         : AsynchReceiver()
       {
-        throw UsageError("Platform Error", "Asynchronous File I/O is only supported on Windows.");
+        throw UsageError("Platform Error", "Asynchronous File I/O is only supported on Windows and Linux.");
       }
 
       /// @brief Construct given ioservice, file name, and extra attributes
@@ -192,7 +633,7 @@ namespace QuickFAST
         )
         : AsynchReceiver()
       {
-        throw UsageError("Platform Error", "Asynchronous File I/O is only supported on Windows.");
+        throw UsageError("Platform Error", "Asynchronous File I/O is only supported on Windows and Linux.");
       }
 
 
@@ -200,6 +641,16 @@ namespace QuickFAST
       {
       }
 
+      /// @brief How many reads may be in flight at once.  Not supported on this platform.
+      void setReadsInFlight(size_t /*readsInFlight*/)
+      {
+      }
+
+      /// @brief Bypass the file system cache.  Not supported on this platform.
+      void setDirectIO(bool /*directIO*/ = true)
+      {
+      }
+
       // Implement Receiver method
       virtual bool initializeReceiver()
       {
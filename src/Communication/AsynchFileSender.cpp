@@ -4,15 +4,23 @@
 //
 #include <Common/QuickFASTPch.h>
 
-#if defined(_WIN32) // Not available on non-Windows systems
+#if defined(_WIN32) || defined(__linux__) // Not available on other systems
 
 #include "AsynchFileSender.h"
 #include <Communication/LinkedBuffer.h>
 #include <Common/Exceptions.h>
 #include <Common/AtomicOps.h>
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/eventfd.h>
+#endif // __linux__
 using namespace QuickFAST;
 using namespace Communication;
 
+#if defined(_WIN32)
+
 AsynchFileSender::AsynchFileSender(
   BufferRecycler & recycler,
   const char * fileName,
@@ -119,4 +127,225 @@ AsynchFileSender::close()
   }
   AsynchSender::close();
 }
+
+#else // __linux__
+
+namespace
+{
+  enum
+  {
+    /// Writes that can be queued before the kernel must be entered.
+    ringEntries = 64
+  };
+}
+
+AsynchFileSender::AsynchFileSender(
+  BufferRecycler & recycler,
+  const char * fileName,
+  unsigned long additionalAttributes)
+    : AsynchSender(recycler, fileName)
+    , additionalAttributes_(additionalAttributes)
+    , fd_(-1)
+    , eventDescriptor_(ioService_.ioService())
+    , eventCount_(0)
+    , stopping_(false)
+    , offset_(0LL)
+{
+}
+
+AsynchFileSender::AsynchFileSender(
+  boost::asio::io_service & ioService,
+  BufferRecycler & recycler,
+  const char * fileName,
+  unsigned long additionalAttributes)
+    : AsynchSender(ioService, recycler, fileName)
+    , additionalAttributes_(additionalAttributes)
+    , fd_(-1)
+    , eventDescriptor_(ioService_.ioService())
+    , eventCount_(0)
+    , stopping_(false)
+    , offset_(0LL)
+{
+}
+
+AsynchFileSender::~AsynchFileSender()
+{
+  close();
+}
+
+void
+AsynchFileSender::open()
+{
+  fd_ = ::open(name_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC | int(additionalAttributes_), 0644);
+  if(fd_ < 0)
+  {
+    std::stringstream msg;
+    msg << "Error opening file " << name_ << ": " << std::strerror(errno);
+    throw CommunicationError(msg.str());
+  }
+  int eventFd = -1;
+  if(!ring_.open(ringEntries) || (eventFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0 || !ring_.registerEventFd(eventFd))
+  {
+    int error = eventFd < 0 && ring_.isOpen() ? errno : ring_.lastError();
+    if(eventFd >= 0)
+    {
+      ::close(eventFd);
+    }
+    close();
+    std::stringstream msg;
+    msg << "Error starting io_uring for " << name_ << ": " << std::strerror(error);
+    throw CommunicationError(msg.str());
+  }
+  eventDescriptor_.assign(eventFd);
+  stopping_ = false;
+  waitCompletions();
+}
+
+bool
+AsynchFileSender::registerBuffers(const std::vector<LinkedBuffer *> & buffers)
+{
+  std::vector<Common::IoUring::Region> regions;
+  for(size_t nBuffer = 0; nBuffer < buffers.size(); ++nBuffer)
+  {
+    regions.push_back(Common::IoUring::Region(buffers[nBuffer]->get(), buffers[nBuffer]->capacity()));
+  }
+  boost::mutex::scoped_lock lock(ringMutex_);
+  return ring_.registerBuffers(regions);
+}
+
+void
+AsynchFileSender::send(LinkedBuffer * buffer)
+{
+  const size_t bytesToWrite = buffer->used();
+  long long pos = offset_;
+  while(!CASLongLong(&offset_, pos, pos + bytesToWrite))
+  {
+    pos = offset_;
+  }
+  sendAt(buffer, pos);
+}
+
+void
+AsynchFileSender::sendAt(LinkedBuffer * buffer, long long offset)
+{
+  const size_t bytesToWrite = buffer->used();
+  if(bytesToWrite == 0)
+  {
+    recycle(buffer);
+    return;
+  }
+  bool queued = false;
+  {
+    boost::mutex::scoped_lock lock(ringMutex_);
+    int region = ring_.registeredRegion(buffer->get(), bytesToWrite);
+    queued = ring_.prepareWrite(fd_, buffer->get(), bytesToWrite, uint64(offset), uint64(size_t(buffer)), region);
+    if(!queued && ring_.submit())
+    {
+      // The submission queue was full.  Now it's empty.
+      queued = ring_.prepareWrite(fd_, buffer->get(), bytesToWrite, uint64(offset), uint64(size_t(buffer)), region);
+    }
+    queued = queued && ring_.submit();
+  }
+  if(!queued)
+  {
+    recycle(buffer);
+    std::stringstream msg;
+    msg << "Error writing to " << name_ << " " << std::strerror(ring_.lastError());
+    throw CommunicationError(msg.str());
+  }
+}
+
+void
+AsynchFileSender::waitCompletions()
+{
+  eventDescriptor_.async_read_some(
+    boost::asio::buffer(&eventCount_, sizeof(eventCount_)),
+    boost::bind(&AsynchFileSender::handleCompletions,
+      this,
+      boost::asio::placeholders::error)
+    );
+}
+
+void
+AsynchFileSender::handleCompletions(const boost::system::error_code& error)
+{
+  if(error == boost::asio::error::operation_aborted)
+  {
+    return;
+  }
+  // Only one call is outstanding, so one thread at a time collects completions.
+  std::vector<std::pair<LinkedBuffer *, int> > completed;
+  {
+    boost::mutex::scoped_lock lock(ringMutex_);
+    uint64 tag = 0;
+    int result = 0;
+    while(ring_.nextCompletion(tag, result))
+    {
+      completed.push_back(std::make_pair(reinterpret_cast<LinkedBuffer *>(size_t(tag)), result));
+    }
+  }
+  for(size_t nWrite = 0; nWrite < completed.size(); ++nWrite)
+  {
+    int result = completed[nWrite].second;
+    boost::system::error_code writeError;
+    if(result < 0)
+    {
+      writeError = boost::system::error_code(-result, boost::system::system_category());
+    }
+    // Recycling may start another write or stop the sender.
+    handleWrite(writeError, completed[nWrite].first, result < 0 ? 0 : size_t(result));
+  }
+  bool finished = false;
+  {
+    boost::mutex::scoped_lock lock(ringMutex_);
+    finished = stopping_ && ring_.inFlight() == 0;
+  }
+  if(!finished && eventDescriptor_.is_open())
+  {
+    waitCompletions();
+  }
+}
+
+void
+AsynchFileSender::stop()
+{
+  {
+    boost::mutex::scoped_lock lock(ringMutex_);
+    stopping_ = true;
+    if(ring_.inFlight() == 0 && eventDescriptor_.is_open())
+    {
+      // Nothing left to complete so stop waiting.
+      boost::system::error_code ignored;
+      eventDescriptor_.cancel(ignored);
+    }
+  }
+  AsynchSender::stop();
+}
+
+void
+AsynchFileSender::close()
+{
+  boost::system::error_code ignored;
+  if(eventDescriptor_.is_open())
+  {
+    eventDescriptor_.cancel(ignored);
+    eventDescriptor_.close(ignored);
+  }
+  {
+    boost::mutex::scoped_lock lock(ringMutex_);
+    if(ring_.isOpen() && ring_.inFlight() > 0)
+    {
+      // Let the kernel finish with the buffers before they are reused.
+      ring_.submit(unsigned(ring_.inFlight()));
+    }
+    ring_.close();
+  }
+  if(fd_ >= 0)
+  {
+    ::close(fd_);
+    fd_ = -1;
+  }
+  AsynchSender::close();
+}
 #endif // _WIN32
+#endif // _WIN32 || __linux__
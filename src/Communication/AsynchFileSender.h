@@ -7,20 +7,27 @@
 #include <Common/QuickFAST_Export.h>
 #include "AsynchFileSender_fwd.h"
 #include <Communication/AsynchSender.h>
+#include <Common/IoUring.h>
 //#include <Common/Types.h>
 namespace QuickFAST
 {
   namespace Communication
   {
-#if defined(_WIN32)
-    /// @brief Sender that writes data to a fil asynchronously (WINDOWS ONLY)
+#if defined(_WIN32) || defined(__linux__)
+    /// @brief Sender that writes data to a file asynchronously (Windows and Linux only)
+    ///
+    /// On Windows the writes use overlapped I/O.  On Linux they use io_uring:
+    /// each send() is queued and handed to the kernel without waiting, so many
+    /// writes can be in flight.  The buffers are recycled as their writes
+    /// complete, in the threads running the io_service.
     class QuickFAST_Export AsynchFileSender: public AsynchSender
     {
     public:
       /// @brief Construct
       /// @param recycler will receive empty buffers after their contents have been written
       /// @param fileName is the name of the file to be written
-      /// @param additionalAttributes will be used in the Windows CreateFile call.
+      /// @param additionalAttributes will be used in the Windows CreateFile call,
+      ///        or added to the flags passed to open() on Linux.
       AsynchFileSender(
         BufferRecycler & recycler,
         const char * fileName,
@@ -30,7 +37,8 @@ namespace QuickFAST
       /// @param ioService is a shared io_service.
       /// @param recycler will receive empty buffers after their contents have been written
       /// @param fileName is the name of the file to be written
-      /// @param additionalAttributes will be used in the Windows CreateFile call.
+      /// @param additionalAttributes will be used in the Windows CreateFile call,
+      ///        or added to the flags passed to open() on Linux.
       AsynchFileSender(
         boost::asio::io_service & ioService,
         BufferRecycler & recycler,
@@ -60,13 +68,46 @@ namespace QuickFAST
       // Override Sender method
       virtual void close();
 
+#if defined(__linux__)
+      // Override Sender method
+      virtual void stop();
+
+      /// @brief Register the buffers that will be written (Linux only)
+      ///
+      /// Registered buffers are pinned once rather than mapped for every write.
+      /// Must be called after open().  Buffers that are not registered are
+      /// written normally.
+      /// @param buffers the buffers to register.
+      /// @returns false if the kernel refused.
+      bool registerBuffers(const std::vector<LinkedBuffer *> & buffers);
+
+      /// @brief How many writes have been submitted but not completed?
+      size_t writesInFlight()const
+      {
+        return ring_.inFlight();
+      }
+#endif // __linux__
 
     private:
+#if defined(_WIN32)
       uint32 additionalAttributes_; // consider: FILE_FLAG_NO_BUFFERING
       boost::asio::windows::random_access_handle handle_;
+#else // __linux__
+      void waitCompletions();
+      void handleCompletions(const boost::system::error_code& error);
+
+      unsigned long additionalAttributes_;
+      int fd_;
+      boost::asio::posix::stream_descriptor eventDescriptor_;
+      boost::uint64_t eventCount_;
+      /// Serialize use of the ring by the sending, completing and closing threads.
+      boost::mutex ringMutex_;
+      Common::IoUring ring_;
+      bool stopping_;
+#endif // _WIN32
       long long volatile offset_;
     };
-#endif // _WIN32
+#endif // _WIN32 || __linux__
   }
 }
 #endif // ASYNCHFILESENDER_H
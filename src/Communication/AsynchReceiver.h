@@ -37,6 +37,69 @@ namespace QuickFAST
       {
       }
 
+      /// @brief Decode in a separate thread, handing buffers off without locks.
+      ///
+      /// Normally the thread that completes a read also decodes the buffer
+      /// (or queues it for the thread that is already decoding.)  After this call
+      /// completed reads are passed through a BufferHandoff to a decoding thread
+      /// that calls runDecoder().  Empty buffers come back the same way.
+      ///
+      /// Exactly one thread may run the I/O service and exactly one thread
+      /// may call runDecoder().
+      ///
+      /// Must be called before start().  Buffers cannot be added after start().
+      /// @param spinCount how many times the decoding thread checks for a buffer
+      ///        before it yields or parks.
+      /// @param strategy what the decoding thread does after spinning.
+      /// @param measureLatency measure how long each buffer waits (see BufferHandoff::meanLatency())
+      void setLockFreeHandoff(
+        size_t spinCount = 1000,
+        BufferHandoff::WaitStrategy strategy = BufferHandoff::PARK_WAIT,
+        bool measureLatency = false)
+      {
+        handoffSpinCount_ = spinCount > 0 ? spinCount : 1;
+        handoffStrategy_ = strategy;
+        handoffLatency_ = measureLatency;
+        // When every buffer is waiting to be decoded no read is in progress.
+        // Keep the I/O thread alive until the decoding thread restarts reading.
+        handoffWork_.reset(new boost::asio::io_service::work(ioService_.ioService()));
+      }
+
+      /// @brief Access the AsioService that runs this receiver's I/O.
+      ///
+      /// For example, to place its threads (see AsioService::setThreadCpus())
+      AsioService & asioService()
+      {
+        return ioService_;
+      }
+
+      /// @brief Decode buffers until stop() is called.
+      ///
+      /// Use only with setLockFreeHandoff().
+      void runDecoder()
+      {
+        if(!handoff_)
+        {
+          throw UsageError("Coding Error", "AsynchReceiver::runDecoder() requires setLockFreeHandoff()");
+        }
+        serviceHandoff();
+      }
+
+      /// @brief Decode the buffers that are ready, then return without waiting.
+      ///
+      /// For a thread that decodes for several receivers (see Application::ChannelManager).
+      /// Use only with setLockFreeHandoff().  As with runDecoder() only one thread
+      /// at a time may call this.
+      /// @returns the number of buffers decoded.
+      size_t pollDecoder()
+      {
+        if(!handoff_)
+        {
+          throw UsageError("Coding Error", "AsynchReceiver::pollDecoder() requires setLockFreeHandoff()");
+        }
+        return pollHandoff();
+      }
+
       //////
       // Implement Receiver public methods
 
@@ -80,11 +143,16 @@ namespace QuickFAST
       virtual void stop()
       {
         Receiver::stop();
+        handoffWork_.reset();
         ioService_.stopService();
       }
 
       virtual bool waitBuffer()
       {
+        if(handoff_)
+        {
+          return waitHandoff();
+        }
         while(!stopping_)
         {
           if(queue_.peekOutgoing() != 0)
@@ -161,32 +229,12 @@ namespace QuickFAST
           ++packetsReceived_;
           if (!error)
           {
-            // it's possible to receive empty packets.
-            if(bytesReceived <= 0)
-            {
-              // empty buffer? just use it again
-              ++emptyPackets_;
-              idleBufferPool_.push(buffer);
-            }
-            else if(paused_)
-            {
-              // We're paused.  Ignore incoming packets
-              ++pausedPackets_;
-              idleBufferPool_.push(buffer);
-            }
-            else
+            if(acceptReceivedBuffer(buffer, bytesReceived, lock))
             {
-              ++packetsQueued_;
-              bytesReceived_ += bytesReceived;
-              largestPacket_ = std::max(largestPacket_, bytesReceived);
-              buffer->setUsed(bytesReceived);
-              if(queue_.push(buffer, lock))
-              {
-                // A true return from push means that no one is servicing the queue
-                // Volunteer to service it. If it returns true, then the offer was
-                // accepted.  We'll service the queue after releasing the lock.
-                service = queue_.startService(lock);
-              }
+              // A true return means that no one is servicing the queue
+              // Volunteer to service it. If it returns true, then the offer was
+              // accepted.  We'll service the queue after releasing the lock.
+              service = queue_.startService(lock);
             }
           }
           else
@@ -215,9 +263,95 @@ namespace QuickFAST
         }
       }
 
+      /// @brief handle completion of a read that filled several buffers at once.
+      ///
+      /// Like handleReceive() but all of the buffers are queued under a single
+      /// acquisition of the buffer mutex and the queue is serviced at most once.
+      /// One read is considered complete regardless of how many buffers were filled.
+      ///
+      /// @param error indicates status of the receive
+      /// @param buffers the buffers offered to the read.
+      /// @param sizes the number of bytes received into each of the first [received] buffers
+      /// @param received how many buffers were filled
+      /// @param count how many buffers were offered.  Unfilled buffers are returned to the idle pool.
+      void handleReceiveBatch(
+        const boost::system::error_code& error,
+        LinkedBuffer ** buffers,
+        const size_t * sizes,
+        size_t received,
+        size_t count)
+      {
+        bool service = false;
+        { // Scope for lock
+          boost::mutex::scoped_lock lock(bufferMutex_);
+          --readsInProgress_;
+          bool queued = false;
+          for(size_t nBuffer = 0; nBuffer < received; ++nBuffer)
+          {
+            ++packetsReceived_;
+            queued = acceptReceivedBuffer(buffers[nBuffer], sizes[nBuffer], lock) || queued;
+          }
+          for(size_t nBuffer = received; nBuffer < count; ++nBuffer)
+          {
+            idleBufferPool_.push(buffers[nBuffer]);
+          }
+          if(error && !paused_ && !stopping_)
+          {
+            ++errorPackets_;
+            if(!assembler_->reportCommunicationError(error.message()))
+            {
+              stop();
+            }
+          }
+          if(queued)
+          {
+            service = queue_.startService(lock);
+          }
+          startReceive(lock);
+        }
+
+        while(service)
+        {
+          service = serviceQueue();
+        }
+      }
+
+    private:
+      /// @brief Queue one successfully received buffer (or recycle it)
+      /// @returns true if the queue needs to be serviced.
+      bool acceptReceivedBuffer(
+        LinkedBuffer * buffer,
+        size_t bytesReceived,
+        boost::mutex::scoped_lock & lock)
+      {
+        // it's possible to receive empty packets.
+        if(bytesReceived <= 0)
+        {
+          // empty buffer? just use it again
+          ++emptyPackets_;
+          idleBufferPool_.push(buffer);
+          return false;
+        }
+        if(paused_)
+        {
+          // We're paused.  Ignore incoming packets
+          ++pausedPackets_;
+          idleBufferPool_.push(buffer);
+          return false;
+        }
+        ++packetsQueued_;
+        bytesReceived_ += bytesReceived;
+        largestPacket_ = std::max(largestPacket_, bytesReceived);
+        buffer->setUsed(bytesReceived);
+        return queueBuffer(buffer, lock);
+      }
+
     protected:
       /// @brief a manager for the boost::io_service object
       AsioService ioService_;
+    private:
+      /// @brief keeps the I/O service running while the decoding thread holds every buffer.
+      boost::scoped_ptr<boost::asio::io_service::work> handoffWork_;
     };
   }
 }
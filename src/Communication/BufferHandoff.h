@@ -0,0 +1,326 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef BUFFERHANDOFF_H
+#define BUFFERHANDOFF_H
+// All inline, do not export.
+//#include <Common/QuickFAST_Export.h>
+#include "BufferHandoff_fwd.h"
+#include <Communication/SpscBufferRing.h>
+#include <Common/MonotonicClock.h>
+
+namespace QuickFAST
+{
+  namespace Communication
+  {
+    /// @brief Pass buffers between one receiving thread and one decoding thread without locks.
+    ///
+    /// Full buffers travel from the receiving thread to the decoding thread
+    /// through one SpscBufferRing.  Empty buffers travel back through another.
+    ///
+    /// When the decoding thread runs out of work it spins for a while checking
+    /// for new buffers, yields the CPU a few times, then parks on a condition variable.  The receiving thread
+    /// takes the mutex only to wake a parked decoding thread.
+    /// The park is limited to one millisecond so a wakeup that is missed
+    /// because of the race between parking and delivery costs at most that long.
+    /// Other wait strategies never park (YIELD_WAIT) or never give up the CPU (SPIN_WAIT).
+    ///
+    /// The capacity must be at least the number of buffers in circulation so
+    /// neither ring can overflow.
+    ///
+    /// Statistics: the depth of the full ring is sampled on every delivery.
+    /// If enabled, the time each buffer spends in the ring is measured, too.
+    class BufferHandoff
+    {
+      enum {yieldCount = 16};
+    public:
+      /// @brief What the decoding thread does when no buffer is waiting.
+      enum WaitStrategy
+      {
+        SPIN_WAIT,  /// Keep checking.  Lowest latency, but uses all of a CPU.
+        YIELD_WAIT, /// Spin for a while, then yield the CPU between checks.
+        PARK_WAIT   /// Spin, yield, then sleep until a buffer is delivered.
+      };
+
+      /// @brief Construct
+      /// @param capacity the number of buffers that will be in circulation.
+      /// @param spinCount how many times to check for a buffer before yielding or parking.
+      /// @param strategy what to do after spinning.
+      explicit BufferHandoff(size_t capacity, size_t spinCount = 1000, WaitStrategy strategy = PARK_WAIT)
+        : full_(capacity)
+        , empty_(capacity)
+        , spinCount_(spinCount)
+        , strategy_(strategy)
+        , parked_(0)
+        , parks_(0)
+        , measureLatency_(false)
+        , deliveries_(0)
+        , totalDepth_(0)
+        , maxDepth_(0)
+        , received_(0)
+        , totalLatency_(0)
+        , maxLatency_(0)
+      {
+      }
+
+      /// @brief Measure how long each buffer waits in the ring.
+      ///
+      /// Costs two clock reads per buffer.  Call before any buffers are delivered.
+      /// @param measureLatency true to measure.
+      void setMeasureLatency(bool measureLatency = true)
+      {
+        measureLatency_ = measureLatency;
+      }
+
+      /// @brief How many buffers can be in circulation?
+      size_t capacity() const
+      {
+        return full_.capacity();
+      }
+
+      /////////////////////////////
+      // Receiving thread methods
+
+      /// @brief Pass a full buffer to the decoding thread
+      /// @param buffer the buffer to be decoded
+      void deliver(LinkedBuffer * buffer)
+      {
+        if(measureLatency_)
+        {
+          buffer->setHandoffTime(Common::monotonicNanoseconds());
+        }
+        size_t depth = full_.size();
+        ++deliveries_;
+        totalDepth_ += depth;
+        if(depth > maxDepth_)
+        {
+          maxDepth_ = depth;
+        }
+        while(!full_.push(buffer))
+        {
+          // can't happen if capacity is right, but don't lose the buffer.
+          boost::thread::yield();
+        }
+        // wait() sets parked_ then looks at the ring; this pushes then looks at parked_.
+        // Without the barrier both loads could pass both stores, so neither thread
+        // would see the other and the decoding thread would sleep through the delivery.
+        atomic_full_barrier();
+        // only the first delivery after parking needs to wake the decoding thread.
+        if(parked_ != 0 && CASLong(&parked_, 1, 0))
+        {
+          boost::mutex::scoped_lock lock(mutex_);
+          condition_.notify_one();
+        }
+      }
+
+      /// @brief Get a buffer that the decoding thread is finished with.
+      /// @returns the buffer or zero if none is waiting
+      LinkedBuffer * reclaim()
+      {
+        return empty_.pop();
+      }
+
+      /////////////////////////////
+      // Decoding thread methods
+
+      /// @brief Get the next full buffer.
+      /// @returns the buffer or zero if none is waiting
+      LinkedBuffer * next()
+      {
+        LinkedBuffer * buffer = full_.pop();
+        if(buffer != 0 && measureLatency_)
+        {
+          uint64 latency = Common::monotonicNanoseconds() - buffer->handoffTime();
+          ++received_;
+          totalLatency_ += latency;
+          if(latency > maxLatency_)
+          {
+            maxLatency_ = latency;
+          }
+        }
+        return buffer;
+      }
+
+      /// @brief Look at a full buffer without removing it.
+      /// @param index zero for the next buffer, one for the one after that, etc.
+      /// @returns the buffer or zero if there are not that many full buffers.
+      const LinkedBuffer * peek(size_t index)
+      {
+        return full_.peek(index);
+      }
+
+      /// @brief Return an empty buffer to the receiving thread.
+      /// @param buffer the buffer that is no longer needed.
+      void recycle(LinkedBuffer * buffer)
+      {
+        while(!empty_.push(buffer))
+        {
+          boost::thread::yield();
+        }
+      }
+
+      /// @brief Wait for a full buffer: spin, then yield or park depending on the strategy.
+      /// @param stopping the wait ends early if this becomes true.
+      /// @param index wait until there are more than this many full buffers.
+      /// @returns true if the full buffer is available.
+      bool wait(const bool & stopping, size_t index = 0)
+      {
+        return waitUntil(stopping, index);
+      }
+
+      /// @brief Wait for a full buffer, ending early when another thread sets a flag.
+      /// @param stopping the wait ends early if this becomes nonzero.
+      ///        The other thread sets it with atomic_store_release_long().
+      /// @param index wait until there are more than this many full buffers.
+      /// @returns true if the full buffer is available.
+      bool wait(const volatile long & stopping, size_t index = 0)
+      {
+        return waitUntil(stopping, index);
+      }
+
+      /// @brief Wake the decoding thread if it is parked (during shutdown, for example)
+      void wakeup()
+      {
+        boost::mutex::scoped_lock lock(mutex_);
+        condition_.notify_all();
+      }
+
+      /// @brief Statistic: how many times has the decoding thread parked?
+      size_t parks() const
+      {
+        return parks_;
+      }
+
+      /// @brief Statistic: how many buffers have been delivered?
+      size_t deliveries() const
+      {
+        return deliveries_;
+      }
+
+      /// @brief Statistic: the average number of buffers already waiting when one was delivered.
+      double meanDepth() const
+      {
+        return deliveries_ == 0 ? 0.0 : double(totalDepth_) / double(deliveries_);
+      }
+
+      /// @brief Statistic: the most buffers that were waiting when one was delivered.
+      size_t maxDepth() const
+      {
+        return maxDepth_;
+      }
+
+      /// @brief Statistic: the average time (nanoseconds) a buffer waited in the ring.
+      ///
+      /// Zero unless setMeasureLatency() was called.
+      uint64 meanLatency() const
+      {
+        return received_ == 0 ? 0 : totalLatency_ / received_;
+      }
+
+      /// @brief Statistic: the longest time (nanoseconds) a buffer waited in the ring.
+      ///
+      /// Zero unless setMeasureLatency() was called.
+      uint64 maxLatency() const
+      {
+        return maxLatency_;
+      }
+
+      /// @brief Write the statistics in human readable form.
+      /// @param out is the destination
+      /// @param name identifies the handoff
+      void report(std::ostream & out, const char * name) const
+      {
+        out << name << ": " << deliveries_ << " handed off; depth mean "
+          << std::fixed << std::setprecision(1) << meanDepth()
+          << " max " << maxDepth_
+          << "; parked " << parks_ << " times." << std::endl;
+        if(measureLatency_)
+        {
+          out << name << ": latency mean " << std::setprecision(3) << double(meanLatency()) / 1000.0
+            << " usec; max " << double(maxLatency_) / 1000.0 << " usec." << std::endl;
+        }
+      }
+
+    private:
+      static bool isSet(const bool & flag)
+      {
+        return flag;
+      }
+
+      static bool isSet(const volatile long & flag)
+      {
+        return atomic_load_acquire_long(&flag) != 0;
+      }
+
+      template<typename Flag>
+      bool waitUntil(const Flag & stopping, size_t index)
+      {
+        for(size_t spin = 0; spin < spinCount_; ++spin)
+        {
+          if(full_.peek(index) != 0)
+          {
+            return true;
+          }
+          if(isSet(stopping))
+          {
+            return false;
+          }
+        }
+        if(strategy_ == SPIN_WAIT)
+        {
+          // the caller will try again.
+          return false;
+        }
+        // give the receiving thread a chance if it shares this CPU.
+        for(size_t yield = 0; yield < yieldCount; ++yield)
+        {
+          boost::thread::yield();
+          if(full_.peek(index) != 0)
+          {
+            return true;
+          }
+        }
+        if(strategy_ == YIELD_WAIT)
+        {
+          return false;
+        }
+        boost::mutex::scoped_lock lock(mutex_);
+        // The CAS is a full barrier, and deliver() has one between its push and its
+        // check of parked_, so a delivery is either seen by the check below or wakes us.
+        // The time limit is only a backstop.
+        CASLong(&parked_, 0, 1);
+        if(full_.peek(index) == 0 && !isSet(stopping))
+        {
+          ++parks_;
+          condition_.timed_wait(lock, boost::posix_time::milliseconds(1));
+        }
+        CASLong(&parked_, 1, 0);
+        return full_.peek(index) != 0;
+      }
+
+    private:
+      SpscBufferRing full_;
+      SpscBufferRing empty_;
+      size_t spinCount_;
+      WaitStrategy strategy_;
+      volatile long parked_;
+      size_t parks_;
+      bool measureLatency_;
+      // written by the receiving thread
+      size_t deliveries_;
+      size_t totalDepth_;
+      size_t maxDepth_;
+      // written by the decoding thread
+      size_t received_;
+      uint64 totalLatency_;
+      uint64 maxLatency_;
+      boost::mutex mutex_;
+      boost::condition_variable condition_;
+    };
+  }
+}
+#endif // BUFFERHANDOFF_H
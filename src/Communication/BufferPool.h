@@ -0,0 +1,219 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef BUFFERPOOL_H
+#define BUFFERPOOL_H
+// All inline, do not export.
+//#include <Common/QuickFAST_Export.h>
+#include "BufferPool_fwd.h"
+#include <Communication/LinkedBuffer.h>
+#include <Common/ThreadPlacement.h>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace QuickFAST
+{
+  namespace Communication
+  {
+    /// @brief A set of LinkedBuffers carved from one contiguous region of memory.
+    ///
+    /// Every buffer's data starts on a cache line (64 byte) boundary and
+    /// occupies a whole number of cache lines.  If the buffer size is a
+    /// multiple of the page size every buffer starts on a page, as direct
+    /// (O_DIRECT) file I/O requires.  The LinkedBuffer objects
+    /// themselves live in a separate region, one per cache line, so a thread
+    /// updating one buffer's link or size never shares a cache line with
+    /// the data or with another buffer.
+    ///
+    /// On Linux the data region can be backed by 2MB huge pages to reduce
+    /// TLB misses when there are many buffers.  Explicit huge pages
+    /// (MAP_HUGETLB) are tried first, then transparent huge pages (madvise).
+    /// If neither is available ordinary pages are used.
+    ///
+    /// On a multi-socket machine the pool can be moved to the NUMA node of
+    /// the threads that use it (placeOnNode()).
+    ///
+    /// The pool owns the memory; the buffers must not be used after the pool
+    /// is destroyed.
+    class BufferPool
+    {
+    public:
+      /// @brief Allocate the buffers.
+      /// @param bufferCount how many buffers
+      /// @param bufferSize the capacity of each buffer
+      /// @param hugePages try to use 2MB pages for the data.
+      BufferPool(size_t bufferCount, size_t bufferSize, bool hugePages = false)
+        : bufferCount_(bufferCount)
+        , bufferSize_(bufferSize)
+        , stride_(roundUp(bufferSize > 0 ? bufferSize : 1, cacheLine))
+        , headerStride_(roundUp(sizeof(LinkedBuffer), cacheLine))
+        , data_(0)
+        , dataBytes_(0)
+        , dataAllocation_(0)
+        , mapped_(false)
+        , hugePages_(false)
+        , headers_(0)
+        , headerAllocation_(0)
+      {
+        allocateData(stride_ * bufferCount_, hugePages);
+        try
+        {
+          headerAllocation_ = new unsigned char[headerStride_ * bufferCount_ + cacheLine];
+        }
+        catch (...)
+        {
+          releaseData();
+          throw;
+        }
+        headers_ = align(headerAllocation_);
+        for(size_t nBuffer = 0; nBuffer < bufferCount_; ++nBuffer)
+        {
+          LinkedBuffer * buffer = new(headers_ + nBuffer * headerStride_) LinkedBuffer;
+          buffer->setStorage(data_ + nBuffer * stride_, bufferSize_);
+        }
+      }
+
+      ~BufferPool()
+      {
+        for(size_t nBuffer = 0; nBuffer < bufferCount_; ++nBuffer)
+        {
+          (*this)[nBuffer]->~LinkedBuffer();
+        }
+        delete[] headerAllocation_;
+        releaseData();
+      }
+
+      /// @brief How many buffers are in the pool?
+      size_t size() const
+      {
+        return bufferCount_;
+      }
+
+      /// @brief Access a buffer
+      /// @param index identifies the buffer: 0 <= index < size()
+      LinkedBuffer * operator[](size_t index)
+      {
+        return reinterpret_cast<LinkedBuffer *>(headers_ + index * headerStride_);
+      }
+
+      /// @brief The start of the data region
+      unsigned char * data()
+      {
+        return data_;
+      }
+
+      /// @brief How much memory does the pool use for data?
+      size_t footprint() const
+      {
+        return dataBytes_;
+      }
+
+      /// @brief Move the buffers to a NUMA node.
+      /// @param node the destination
+      /// @returns true if the buffers were moved.
+      bool placeOnNode(int node)
+      {
+        bool placed = Common::ThreadPlacement::placeOnNode(data_, dataBytes_, node);
+        return Common::ThreadPlacement::placeOnNode(
+          headers_, headerStride_ * bufferCount_, node) && placed;
+      }
+
+      /// @brief Is the data backed by huge pages?
+      ///
+      /// True for explicit huge pages or if transparent huge pages were requested successfully.
+      bool usingHugePages() const
+      {
+        return hugePages_;
+      }
+
+    private:
+      enum
+      {
+        cacheLine = 64,
+        pageSize = 4096,
+        hugePageSize = 2 * 1024 * 1024
+      };
+
+      static size_t roundUp(size_t value, size_t boundary)
+      {
+        return (value + boundary - 1) / boundary * boundary;
+      }
+
+      static unsigned char * align(unsigned char * address, size_t boundary = cacheLine)
+      {
+        size_t offset = size_t(address) % boundary;
+        return offset == 0 ? address : address + boundary - offset;
+      }
+
+      void allocateData(size_t bytes, bool hugePages)
+      {
+#if defined(__linux__)
+        if(hugePages)
+        {
+          dataBytes_ = roundUp(bytes, hugePageSize);
+# if defined(MAP_HUGETLB)
+          void * region = ::mmap(0, dataBytes_, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+          if(region != MAP_FAILED)
+          {
+            data_ = static_cast<unsigned char *>(region);
+            mapped_ = true;
+            hugePages_ = true;
+            return;
+          }
+# endif // MAP_HUGETLB
+          void * region2 = ::mmap(0, dataBytes_, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+          if(region2 != MAP_FAILED)
+          {
+            data_ = static_cast<unsigned char *>(region2);
+            mapped_ = true;
+# if defined(MADV_HUGEPAGE)
+            hugePages_ = ::madvise(region2, dataBytes_, MADV_HUGEPAGE) == 0;
+# endif // MADV_HUGEPAGE
+            return;
+          }
+        }
+#endif // __linux__
+        size_t boundary = stride_ % pageSize == 0 ? size_t(pageSize) : size_t(cacheLine);
+        dataBytes_ = bytes;
+        dataAllocation_ = new unsigned char[bytes + boundary];
+        data_ = align(dataAllocation_, boundary);
+      }
+
+      void releaseData()
+      {
+#if defined(__linux__)
+        if(mapped_)
+        {
+          ::munmap(data_, dataBytes_);
+        }
+#endif // __linux__
+        delete[] dataAllocation_;
+      }
+
+    private:
+      BufferPool(const BufferPool &);
+      BufferPool & operator=(const BufferPool &);
+
+    private:
+      size_t bufferCount_;
+      size_t bufferSize_;
+      size_t stride_;
+      size_t headerStride_;
+      unsigned char * data_;
+      size_t dataBytes_;
+      unsigned char * dataAllocation_;
+      bool mapped_;
+      bool hugePages_;
+      unsigned char * headers_;
+      unsigned char * headerAllocation_;
+    };
+  }
+}
+#endif // BUFFERPOOL_H
@@ -0,0 +1,384 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef BUSYPOLLRECEIVER_H
+#define BUSYPOLLRECEIVER_H
+// All inline, do not export.
+//#include <Common/QuickFAST_Export.h>
+#include "BusyPollReceiver_fwd.h"
+#include <Communication/SynchReceiver.h>
+#include <boost/asio.hpp>
+#if defined(__linux__)
+#include <sys/socket.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace QuickFAST
+{
+  namespace Communication
+  {
+    /// @brief Receive multicast packets by spinning on a non-blocking socket.
+    ///
+    /// There is no reactor: the thread that calls run() (or the thread
+    /// started by runThreads()) polls the socket continuously and decodes
+    /// each packet as soon as it arrives, in the same thread.  This trades
+    /// a fully busy CPU for the lowest and most predictable latency from
+    /// packet arrival to message delivery.
+    ///
+    /// Only one multicast group is supported per receiver.  Use a
+    /// MulticastReceiver if many feeds must share a thread.
+    ///
+    /// On Linux the receiving thread can be pinned to a CPU (setCpu()), and
+    /// the kernel can be asked to busy poll the device queue (setBusyPoll()).
+    class BusyPollReceiver
+      : public SynchReceiver
+    {
+    public:
+      /// @brief Construct given multicast information.
+      /// @param multicastGroupIP multicast address as a text string
+      /// @param listenInterfaceIP listen address as a text string.
+      ///        This identifies the network interface to be used.
+      ///        0.0.0.0 means "let the system choose"
+      /// @param bindIP the address to bind to.  Normally the same as listenInterfaceIP
+      /// @param portNumber port number
+      BusyPollReceiver(
+        const std::string & multicastGroupIP,
+        const std::string & listenInterfaceIP,
+        const std::string & bindIP,
+        unsigned short portNumber
+        )
+        : listenInterface_(boost::asio::ip::address::from_string(listenInterfaceIP))
+        , portNumber_(portNumber)
+        , multicastGroup_(boost::asio::ip::address::from_string(multicastGroupIP))
+        , bindAddress_(boost::asio::ip::address::from_string(bindIP))
+        , socket_(ioService_)
+        , pending_(0)
+        , received_(0)
+        , busyPoll_(0)
+        , cpu_(-1)
+        , spins_(0)
+      {
+      }
+
+      ~BusyPollReceiver()
+      {
+        // the receiving thread must be gone before the socket is closed.
+        stop();
+        joinThreads();
+        boost::system::error_code ignored;
+        socket_.close(ignored);
+      }
+
+      /// @brief Ask the kernel to busy poll the device queue for incoming packets.
+      ///
+      /// Sets SO_BUSY_POLL on the socket (Linux only; ignored elsewhere).
+      /// Must be called before start().
+      /// @param microseconds how long a receive may busy poll. Zero disables it.
+      void setBusyPoll(int microseconds)
+      {
+        busyPoll_ = microseconds;
+      }
+
+      /// @brief Pin the receiving thread to a CPU.
+      ///
+      /// Takes effect when run() starts (Linux only; ignored elsewhere).
+      /// @param cpu zero based CPU number. Negative means don't pin.
+      void setCpu(int cpu)
+      {
+        cpu_ = cpu;
+      }
+
+      /// @brief Statistic: How many times was the socket polled and found empty?
+      size_t emptyPolls() const
+      {
+        return spins_;
+      }
+
+      ////////////////////////////////////
+      // Implement Receiver public methods
+      virtual void run()
+      {
+        pinThread();
+        while(!stopping_)
+        {
+          if(receivePending())
+          {
+            decodeReceived();
+          }
+        }
+      }
+
+      virtual void run_one()
+      {
+        bool received = false;
+        while(!received && !stopping_)
+        {
+          received = receivePending();
+        }
+        if(received)
+        {
+          decodeReceived();
+        }
+      }
+
+      virtual size_t poll()
+      {
+        size_t count = 0;
+        while(!stopping_ && receivePending())
+        {
+          decodeReceived();
+          ++count;
+        }
+        return count;
+      }
+
+      virtual size_t poll_one()
+      {
+        size_t count = 0;
+        if(!stopping_ && receivePending())
+        {
+          decodeReceived();
+          ++count;
+        }
+        return count;
+      }
+
+      virtual bool waitBuffer()
+      {
+        while(received_ == 0 && !stopping_)
+        {
+          receivePending();
+        }
+        return !stopping_;
+      }
+
+      /// @brief Get the next buffer without blocking the thread.
+      ///
+      /// The buffer comes straight from the socket: it never passes
+      /// through the queue.  Rather than waiting, this keeps polling the socket.
+      virtual LinkedBuffer * getBuffer(bool wait)
+      {
+        LinkedBuffer * next = takeReceived();
+        while(next == 0 && wait && !stopping_)
+        {
+          receivePending();
+          next = takeReceived();
+        }
+        return next;
+      }
+
+      virtual void resetService()
+      {
+        return;
+      }
+
+    private:
+      // Implement Receiver method
+      virtual bool initializeReceiver()
+      {
+        boost::asio::ip::udp::endpoint endpoint(listenInterface_, portNumber_);
+        socket_.open(endpoint.protocol());
+        socket_.set_option(boost::asio::ip::udp::socket::reuse_address(true));
+        boost::asio::ip::udp::endpoint bindpoint(bindAddress_, portNumber_);
+        socket_.bind(bindpoint);
+
+        boost::asio::ip::multicast::join_group joinRequest(
+          multicastGroup_.to_v4(),
+          listenInterface_.to_v4());
+        socket_.set_option(joinRequest);
+        socket_.non_blocking(true);
+#if defined(__linux__) && defined(SO_BUSY_POLL)
+        if(busyPoll_ > 0)
+        {
+          if(::setsockopt(socket_.native_handle(), SOL_SOCKET, SO_BUSY_POLL, &busyPoll_, sizeof(busyPoll_)) != 0)
+          {
+            // not fatal: it needs CAP_NET_ADMIN on some kernels.
+            assembler_->logMessage(Common::Logger::QF_LOG_WARNING, "BusyPollReceiver: SO_BUSY_POLL was not accepted.");
+          }
+        }
+#endif
+#if defined(__linux__)
+        if(receiveTimestamps_ && !enableKernelTimestamps(socket_.native_handle()))
+        {
+          assembler_->logMessage(Common::Logger::QF_LOG_WARNING, "BusyPollReceiver: Kernel receive timestamps are not available.");
+        }
+#endif
+        return true;
+      }
+
+      // Implement Receiver method
+      // This never blocks. The buffer is filled later by receivePending().
+      virtual bool fillBuffer(LinkedBuffer * buffer, boost::mutex::scoped_lock& /*lock*/)
+      {
+        if(stopping_ || !socket_.is_open())
+        {
+          return false;
+        }
+        pending_ = buffer;
+        return true;
+      }
+
+      /// @brief Find a buffer for the next receive.
+      ///
+      /// The buffer released by the last decode is reused without locking:
+      /// only this thread fills or releases buffers.
+      /// @returns true if a buffer is ready in pending_.
+      bool nextPending()
+      {
+        pending_ = idleBuffers_.pop();
+        if(pending_ != 0)
+        {
+          ++readsInProgress_;
+          return true;
+        }
+        boost::mutex::scoped_lock lock(bufferMutex_);
+        startReceive(lock);
+        return pending_ != 0;
+      }
+
+      /// @brief Try to receive one packet into the pending buffer.
+      /// @returns true if a packet is waiting in received_ to be decoded.
+      bool receivePending()
+      {
+        if(received_ != 0)
+        {
+          return true;
+        }
+        if(pending_ == 0 && !nextPending())
+        {
+          return false;
+        }
+        LinkedBuffer * buffer = pending_;
+        boost::system::error_code error;
+        size_t bytesReceived = 0;
+#if defined(__linux__)
+        if(receiveTimestamps_)
+        {
+          ssize_t result = receiveTimestamped(socket_.native_handle(), buffer);
+          if(result < 0)
+          {
+            error = boost::system::error_code(errno, boost::asio::error::get_system_category());
+          }
+          else
+          {
+            bytesReceived = size_t(result);
+          }
+        }
+        else
+#endif
+        {
+          bytesReceived = socket_.receive(
+            boost::asio::buffer(buffer->get(), buffer->capacity()),
+            0,
+            error);
+        }
+        if(error == boost::asio::error::would_block || error == boost::asio::error::try_again)
+        {
+          ++spins_;
+          return false;
+        }
+        if(error)
+        {
+          if(!stopping_)
+          {
+            ++errorPackets_;
+            if(!assembler_->reportCommunicationError(error.message()))
+            {
+              stop();
+            }
+          }
+          return false;
+        }
+
+        ++packetsReceived_;
+        if(paused_)
+        {
+          // keep the buffer for the next receive.
+          ++pausedPackets_;
+          return false;
+        }
+        if(bytesReceived == 0)
+        {
+          ++emptyPackets_;
+          return false;
+        }
+        pending_ = 0;
+        --readsInProgress_;
+        ++packetsQueued_;
+        bytesReceived_ += bytesReceived;
+        largestPacket_ = std::max(largestPacket_, bytesReceived);
+        buffer->setUsed(bytesReceived);
+        received_ = buffer;
+        return true;
+      }
+
+      /// @brief Hand the received buffer to the assembler (once).
+      LinkedBuffer * takeReceived()
+      {
+        LinkedBuffer * next = received_;
+        if(next != 0)
+        {
+          received_ = 0;
+          ++packetsProcessed_;
+          bytesProcessed_ += next->used();
+        }
+        return next;
+      }
+
+      /// @brief Decode the packet in received_ on this thread.
+      void decodeReceived()
+      {
+        ++batchesProcessed_;
+        if(!assembler_->serviceQueue(*this))
+        {
+          stop();
+        }
+        if(received_ != 0)
+        {
+          // the assembler stopped before it took the buffer.
+          idleBuffers_.push(received_);
+          received_ = 0;
+        }
+      }
+
+      void pinThread()
+      {
+#if defined(__linux__)
+        if(cpu_ >= 0)
+        {
+          cpu_set_t cpus;
+          CPU_ZERO(&cpus);
+          CPU_SET(cpu_, &cpus);
+          if(::pthread_setaffinity_np(::pthread_self(), sizeof(cpus), &cpus) != 0)
+          {
+            assembler_->logMessage(Common::Logger::QF_LOG_WARNING, "BusyPollReceiver: Cannot pin the receiving thread.");
+          }
+        }
+#endif
+      }
+
+    private:
+      boost::asio::ip::address listenInterface_;
+      unsigned short portNumber_;
+      boost::asio::ip::address multicastGroup_;
+      boost::asio::ip::address bindAddress_;
+      /// only used to construct the socket. It is never run.
+      boost::asio::io_service ioService_;
+      boost::asio::ip::udp::socket socket_;
+      /// the buffer to receive the next packet (if any)
+      LinkedBuffer * pending_;
+      /// the packet waiting to be decoded (if any)
+      LinkedBuffer * received_;
+      int busyPoll_;
+      int cpu_;
+      size_t spins_;
+    };
+  }
+}
+#endif // BUSYPOLLRECEIVER_H
@@ -0,0 +1,718 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef EPOLLMULTICASTRECEIVER_H
+#define EPOLLMULTICASTRECEIVER_H
+// All inline, do not export.
+//#include <Common/QuickFAST_Export.h>
+#include "EpollMulticastReceiver_fwd.h"
+#include <Communication/SynchReceiver.h>
+#include <boost/asio.hpp>
+#include <Common/MonotonicClock.h>
+#include <Common/ThreadPlacement.h>
+#include <Common/Exceptions.h>
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <errno.h>
+#include <unistd.h>
+#endif
+
+namespace QuickFAST
+{
+  namespace Communication
+  {
+#if defined(__linux__)
+    /// @brief Receive many multicast groups in one thread using epoll.
+    ///
+    /// MulticastReceiver keeps one asynchronous read outstanding per feed and
+    /// lets the I/O service dispatch each completion.  With hundreds of groups
+    /// that means hundreds of outstanding operations and one handler per datagram.
+    ///
+    /// This receiver puts every feed's socket in a single epoll set.  The
+    /// thread that calls run() (or the thread started by runThreads()) waits
+    /// on the set, drains each ready socket with recvmmsg() (up to the receive
+    /// batch size per call) and then decodes the packets, all in the same thread.
+    ///
+    /// Each buffer is marked with the index of the feed it arrived on (see
+    /// LinkedBuffer::source()), so an assembler can keep the feeds apart.
+    ///
+    /// On Linux every socket is opened with IP_MULTICAST_ALL disabled so
+    /// feeds that share a port see only the groups they joined.
+    class EpollMulticastReceiver
+      : public SynchReceiver
+    {
+    private:
+      /// @brief One multicast group: its socket and statistics.
+      struct Feed
+      {
+        Feed(
+            boost::asio::io_service & ioService,
+            const std::string & name,
+            const std::string & multicastGroupIP,
+            const std::string & listenInterfaceIP,
+            const std::string & bindIP,
+            unsigned short portNumber)
+          : name_(name)
+          , multicastGroup_(boost::asio::ip::address::from_string(multicastGroupIP))
+          , listenInterface_(boost::asio::ip::address::from_string(listenInterfaceIP))
+          , bindAddress_(boost::asio::ip::address::from_string(bindIP))
+          , portNumber_(portNumber)
+          , socket_(ioService)
+          , joined_(false)
+          , packets_(0)
+          , bytes_(0)
+          , reads_(0)
+          , emptyReads_(0)
+          , receiveTime_(0)
+        {
+        }
+
+        void join()
+        {
+          if(!joined_)
+          {
+            boost::asio::ip::multicast::join_group joinRequest(
+              multicastGroup_.to_v4(),
+              listenInterface_.to_v4());
+            socket_.set_option(joinRequest);
+            joined_ = true;
+          }
+        }
+
+        void leave()
+        {
+          if(joined_)
+          {
+            boost::system::error_code ignored;
+            boost::asio::ip::multicast::leave_group leaveRequest(
+              multicastGroup_.to_v4(),
+              listenInterface_.to_v4());
+            socket_.set_option(leaveRequest, ignored);
+            joined_ = false;
+          }
+        }
+
+        std::string name_;
+        boost::asio::ip::address multicastGroup_;
+        boost::asio::ip::address listenInterface_;
+        boost::asio::ip::address bindAddress_;
+        unsigned short portNumber_;
+        boost::asio::ip::udp::socket socket_;
+        bool joined_;
+        size_t packets_;
+        size_t bytes_;
+        /// recvmmsg() calls
+        size_t reads_;
+        /// reads that found nothing
+        size_t emptyReads_;
+        /// nanoseconds spent in recvmmsg()
+        uint64 receiveTime_;
+      };
+      typedef boost::shared_ptr<Feed> FeedPtr;
+      typedef std::vector<FeedPtr> Feeds;
+
+      enum
+      {
+        /// epoll data for the event that wakes the receiving thread.
+        wakeupTag = 0xFFFFFFFF,
+        /// a blocked wait checks for stop() this often (milliseconds) even without a wakeup.
+        waitMilliseconds = 100,
+        /// room for one SCM_TIMESTAMPNS control message per datagram
+        controlSize = CMSG_SPACE(sizeof(timespec))
+      };
+
+    public:
+      /// @brief Construct.  Use addFeed() to add the multicast groups.
+      EpollMulticastReceiver()
+        : epollFd_(-1)
+        , wakeupFd_(-1)
+        , pending_(0)
+        , batchSize_(1)
+        , cpu_(-1)
+        , waits_(0)
+        , idleWaits_(0)
+      {
+      }
+
+      ~EpollMulticastReceiver()
+      {
+        // the receiving thread must be gone before the sockets are closed.
+        stop();
+        joinThreads();
+        for(size_t nFeed = 0; nFeed < feeds_.size(); ++nFeed)
+        {
+          feeds_[nFeed]->leave();
+          boost::system::error_code ignored;
+          feeds_[nFeed]->socket_.close(ignored);
+        }
+        if(wakeupFd_ >= 0)
+        {
+          ::close(wakeupFd_);
+        }
+        if(epollFd_ >= 0)
+        {
+          ::close(epollFd_);
+        }
+      }
+
+      /// @brief Add a multicast group.
+      ///
+      /// All feeds must be added before start() is called.
+      /// Buffers received from this feed are marked with its position
+      /// (zero for the first feed added) as their source.
+      /// @param name identifies the feed in reports and log messages.
+      /// @param multicastGroupIP multicast address as a text string
+      /// @param listenInterfaceIP listen address as a text string.
+      ///        This identifies the network interface to be used.
+      ///        0.0.0.0 means "let the system choose"
+      /// @param bindIP the address to bind to.  Normally the same as listenInterfaceIP
+      /// @param portNumber port number
+      void addFeed(
+        const std::string & name,
+        const std::string & multicastGroupIP,
+        const std::string & listenInterfaceIP,
+        const std::string & bindIP,
+        unsigned short portNumber)
+      {
+        FeedPtr feed(new Feed(ioService_, name, multicastGroupIP, listenInterfaceIP, bindIP, portNumber));
+        feeds_.push_back(feed);
+      }
+
+      /// @brief Receive up to batchSize datagrams from a ready socket per system call.
+      ///
+      /// Allocate enough buffers (see Receiver::start) to make batching effective.
+      /// Must be called before start().
+      /// @param batchSize the maximum number of datagrams per read. 0 or 1 disables batching.
+      void setReceiveBatch(size_t batchSize)
+      {
+        batchSize_ = batchSize > 1 ? batchSize : 1;
+      }
+
+      /// @brief Pin the receiving thread to a CPU.
+      ///
+      /// Takes effect when run() starts.
+      /// @param cpu zero based CPU number. Negative means don't pin.
+      void setCpu(int cpu)
+      {
+        cpu_ = cpu;
+      }
+
+      /// @brief How many feeds (multicast groups) does this receiver handle?
+      size_t feedCount()const
+      {
+        return feeds_.size();
+      }
+
+      /// @brief The name of a feed.
+      const std::string & feedName(size_t feed)const
+      {
+        return feeds_[feed]->name_;
+      }
+
+      /// @brief Statistic: How many packets have arrived on a feed?
+      size_t feedPackets(size_t feed)const
+      {
+        return feeds_[feed]->packets_;
+      }
+
+      /// @brief Statistic: How many bytes have arrived on a feed?
+      size_t feedBytes(size_t feed)const
+      {
+        return feeds_[feed]->bytes_;
+      }
+
+      /// @brief Statistic: How many times has a feed's socket been read?
+      size_t feedReads(size_t feed)const
+      {
+        return feeds_[feed]->reads_;
+      }
+
+      /// @brief Statistic: How many times has the receiving thread waited for a ready socket?
+      size_t epollWaits()const
+      {
+        return waits_;
+      }
+
+      /// @brief Write the receiving overhead, in total and per feed, in human readable form.
+      /// @param out is the destination
+      void report(std::ostream & out)const
+      {
+        size_t reads = 0;
+        size_t packets = 0;
+        uint64 receiveTime = 0;
+        size_t quietFeeds = 0;
+        for(size_t nFeed = 0; nFeed < feeds_.size(); ++nFeed)
+        {
+          const Feed & feed = *feeds_[nFeed];
+          reads += feed.reads_;
+          packets += feed.packets_;
+          receiveTime += feed.receiveTime_;
+          if(feed.packets_ == 0)
+          {
+            ++quietFeeds;
+          }
+        }
+        out << "Epoll receiver: " << feeds_.size() << " groups (" << quietFeeds << " silent); "
+          << packets << " packets; " << waits_ << " waits (" << idleWaits_ << " timed out); "
+          << reads << " reads";
+        if(packets != 0)
+        {
+          out << "; " << double(waits_ + reads) / double(packets) << " system calls per packet; "
+            << receiveTime / packets << " ns per packet in recvmmsg; "
+            << double(reads) / double(feeds_.size()) << " reads and "
+            << receiveTime / feeds_.size() << " ns in recvmmsg per group";
+        }
+        out << '.' << std::endl;
+        for(size_t nFeed = 0; nFeed < feeds_.size(); ++nFeed)
+        {
+          const Feed & feed = *feeds_[nFeed];
+          if(feed.packets_ == 0)
+          {
+            continue;
+          }
+          out << "Group " << feed.name_ << ": " << feed.packets_ << " packets; "
+            << feed.bytes_ << " bytes; " << feed.reads_ << " reads ("
+            << feed.emptyReads_ << " empty); "
+            << double(feed.packets_) / double(feed.reads_) << " packets per read; "
+            << feed.receiveTime_ / feed.packets_ << " ns per packet." << std::endl;
+        }
+      }
+
+      ////////////////////////////////////
+      // Implement Receiver public methods
+      virtual void run()
+      {
+        if(cpu_ >= 0 && !Common::ThreadPlacement::pinThread(cpu_))
+        {
+          assembler_->logMessage(Common::Logger::QF_LOG_WARNING, "EpollMulticastReceiver: Cannot pin the receiving thread.");
+        }
+        while(!stopping_)
+        {
+          if(receiveReady(true))
+          {
+            tryServiceQueue();
+          }
+        }
+      }
+
+      virtual void run_one()
+      {
+        bool received = false;
+        while(!received && !stopping_)
+        {
+          received = receiveReady(true);
+        }
+        tryServiceQueue();
+      }
+
+      virtual size_t poll()
+      {
+        size_t count = 0;
+        while(!stopping_ && receiveReady(false))
+        {
+          count += tryServiceQueue();
+        }
+        return count;
+      }
+
+      virtual size_t poll_one()
+      {
+        size_t count = 0;
+        if(!stopping_ && receiveReady(false))
+        {
+          count += tryServiceQueue();
+        }
+        return count;
+      }
+
+      virtual bool waitBuffer()
+      {
+        while(queue_.peekOutgoing() == 0 && !stopping_)
+        {
+          boost::mutex::scoped_lock lock(bufferMutex_);
+          queue_.refresh(lock, false);
+          if(queue_.peekOutgoing() == 0)
+          {
+            lock.unlock();
+            receiveReady(true);
+          }
+        }
+        return !stopping_;
+      }
+
+      /// @brief Get the next buffer.
+      ///
+      /// No other thread will fill a buffer, so rather than waiting on
+      /// the queue this reads the ready sockets.
+      virtual LinkedBuffer * getBuffer(bool wait)
+      {
+        LinkedBuffer * next = Receiver::getBuffer(false);
+        while(next == 0 && wait && !stopping_)
+        {
+          receiveReady(true);
+          next = Receiver::getBuffer(false);
+        }
+        return next;
+      }
+
+      virtual void stop()
+      {
+        SynchReceiver::stop();
+        if(wakeupFd_ >= 0)
+        {
+          uint64 one = 1;
+          ssize_t ignored = ::write(wakeupFd_, &one, sizeof(one));
+          (void)ignored;
+        }
+      }
+
+      virtual void pause()
+      {
+        for(size_t nFeed = 0; nFeed < feeds_.size(); ++nFeed)
+        {
+          feeds_[nFeed]->leave();
+        }
+        SynchReceiver::pause();
+      }
+
+      virtual void resume()
+      {
+        SynchReceiver::resume();
+        for(size_t nFeed = 0; nFeed < feeds_.size(); ++nFeed)
+        {
+          feeds_[nFeed]->join();
+        }
+      }
+
+      virtual void resetService()
+      {
+        return;
+      }
+
+    private:
+      // Implement Receiver method
+      virtual bool initializeReceiver()
+      {
+        epollFd_ = ::epoll_create1(EPOLL_CLOEXEC);
+        wakeupFd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if(epollFd_ < 0 || wakeupFd_ < 0 || !watch(wakeupFd_, wakeupTag))
+        {
+          assembler_->logMessage(Common::Logger::QF_LOG_SERIOUS, "EpollMulticastReceiver: Cannot create the epoll set.");
+          return false;
+        }
+        events_.resize(feeds_.size() + 1);
+        headers_.resize(batchSize_);
+        iovecs_.resize(batchSize_);
+        batch_.resize(batchSize_);
+        controls_.resize(batchSize_ * controlSize);
+
+        size_t nFeed = 0;
+        try
+        {
+          for(nFeed = 0; nFeed < feeds_.size(); ++nFeed)
+          {
+            Feed & feed = *feeds_[nFeed];
+            boost::asio::ip::udp::endpoint endpoint(feed.listenInterface_, feed.portNumber_);
+            feed.socket_.open(endpoint.protocol());
+            feed.socket_.set_option(boost::asio::ip::udp::socket::reuse_address(true));
+#if defined(IP_MULTICAST_ALL)
+            int all = 0;
+            ::setsockopt(feed.socket_.native_handle(), IPPROTO_IP, IP_MULTICAST_ALL, &all, sizeof(all));
+#endif
+            boost::asio::ip::udp::endpoint bindpoint(feed.bindAddress_, feed.portNumber_);
+            feed.socket_.bind(bindpoint);
+            feed.join();
+            feed.socket_.non_blocking(true);
+            if(receiveTimestamps_ && !enableKernelTimestamps(feed.socket_.native_handle()))
+            {
+              assembler_->logMessage(Common::Logger::QF_LOG_WARNING,
+                "EpollMulticastReceiver: Kernel receive timestamps are not available on feed " + feed.name_);
+            }
+            if(!watch(feed.socket_.native_handle(), uint32(nFeed)))
+            {
+              throw std::runtime_error("epoll_ctl failed");
+            }
+          }
+        }
+        catch (const std::exception & exception)
+        {
+          std::stringstream msg;
+          msg << "Error " << exception.what() << " joining multicast group";
+          if(nFeed < feeds_.size())
+          {
+            msg << " for feed " << feeds_[nFeed]->name_
+              << ": " << feeds_[nFeed]->multicastGroup_.to_string()
+              << " via interface " << feeds_[nFeed]->listenInterface_.to_string()
+              << ':' << feeds_[nFeed]->portNumber_;
+          }
+          assembler_->logMessage(Common::Logger::QF_LOG_SERIOUS, msg.str());
+          return false;
+        }
+        if(assembler_->wantLog(Common::Logger::QF_LOG_INFO))
+        {
+          std::stringstream msg;
+          msg << "EpollMulticastReceiver: Joined " << feeds_.size() << " multicast groups.";
+          assembler_->logMessage(Common::Logger::QF_LOG_INFO, msg.str());
+        }
+        return true;
+      }
+
+      // Implement Receiver method
+      // This never blocks. The buffer is filled later by receiveFeed().
+      virtual bool fillBuffer(LinkedBuffer * buffer, boost::mutex::scoped_lock& /*lock*/)
+      {
+        if(stopping_ || epollFd_ < 0)
+        {
+          return false;
+        }
+        pending_ = buffer;
+        return true;
+      }
+
+      bool watch(int fd, uint32 tag)
+      {
+        epoll_event event;
+        std::memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.u32 = tag;
+        return ::epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event) == 0;
+      }
+
+      /// @brief Wait for ready sockets and read them.
+      /// @param block true to wait for a socket to become ready; false to return at once.
+      /// @returns true if any packets were queued.
+      bool receiveReady(bool block)
+      {
+        int ready = ::epoll_wait(epollFd_, &events_[0], int(events_.size()), block ? int(waitMilliseconds) : 0);
+        ++waits_;
+        if(ready < 0)
+        {
+          if(errno != EINTR)
+          {
+            reportError(errno);
+          }
+          return false;
+        }
+        if(ready == 0)
+        {
+          ++idleWaits_;
+        }
+        bool queued = false;
+        for(int nEvent = 0; nEvent < ready && !stopping_; ++nEvent)
+        {
+          uint32 tag = events_[nEvent].data.u32;
+          if(tag == uint32(wakeupTag))
+          {
+            uint64 count;
+            ssize_t ignored = ::read(wakeupFd_, &count, sizeof(count));
+            (void)ignored;
+          }
+          else
+          {
+            queued = receiveFeed(tag) || queued;
+          }
+        }
+        return queued;
+      }
+
+      /// @brief Read as many datagrams as the batch allows from one feed.
+      /// @returns true if any packets were queued.
+      bool receiveFeed(size_t index)
+      {
+        Feed & feed = *feeds_[index];
+        size_t count = 0;
+        {
+          boost::mutex::scoped_lock lock(bufferMutex_);
+          idleBufferPool_.push(idleBuffers_);
+          if(pending_ == 0)
+          {
+            startReceive(lock);
+            if(pending_ == 0)
+            {
+              // The socket stays ready; it will be read when buffers are free.
+              return false;
+            }
+          }
+          batch_[count++] = pending_;
+          pending_ = 0;
+          while(count < batchSize_)
+          {
+            LinkedBuffer * buffer = idleBufferPool_.pop();
+            if(buffer == 0)
+            {
+              break;
+            }
+            batch_[count++] = buffer;
+          }
+        }
+
+        for(size_t nBuffer = 0; nBuffer < count; ++nBuffer)
+        {
+          iovecs_[nBuffer].iov_base = batch_[nBuffer]->get();
+          iovecs_[nBuffer].iov_len = batch_[nBuffer]->capacity();
+          std::memset(&headers_[nBuffer], 0, sizeof(headers_[nBuffer]));
+          headers_[nBuffer].msg_hdr.msg_iov = &iovecs_[nBuffer];
+          headers_[nBuffer].msg_hdr.msg_iovlen = 1;
+          if(receiveTimestamps_)
+          {
+            headers_[nBuffer].msg_hdr.msg_control = &controls_[nBuffer * controlSize];
+            headers_[nBuffer].msg_hdr.msg_controllen = controlSize;
+          }
+        }
+        uint64 start = Common::monotonicNanoseconds();
+        int result = ::recvmmsg(feed.socket_.native_handle(), &headers_[0], unsigned(count), MSG_DONTWAIT, 0);
+        feed.receiveTime_ += Common::monotonicNanoseconds() - start;
+        ++feed.reads_;
+        int error = result < 0 ? errno : 0;
+        size_t received = result < 0 ? 0 : size_t(result);
+
+        bool queued = false;
+        {
+          boost::mutex::scoped_lock lock(bufferMutex_);
+          --readsInProgress_;
+          for(size_t nBuffer = 0; nBuffer < received; ++nBuffer)
+          {
+            LinkedBuffer * buffer = batch_[nBuffer];
+            size_t bytesReceived = headers_[nBuffer].msg_len;
+            ++packetsReceived_;
+            buffer->setSource(index);
+            if(receiveTimestamps_)
+            {
+              buffer->setReceiveTime(kernelReceiveTime(headers_[nBuffer].msg_hdr));
+            }
+            if(bytesReceived == 0)
+            {
+              ++emptyPackets_;
+              idleBufferPool_.push(buffer);
+            }
+            else if(paused_)
+            {
+              ++pausedPackets_;
+              idleBufferPool_.push(buffer);
+            }
+            else
+            {
+              ++feed.packets_;
+              feed.bytes_ += bytesReceived;
+              ++packetsQueued_;
+              bytesReceived_ += bytesReceived;
+              largestPacket_ = std::max(largestPacket_, bytesReceived);
+              buffer->setUsed(bytesReceived);
+              queue_.push(buffer, lock);
+              queued = true;
+            }
+          }
+          for(size_t nBuffer = received; nBuffer < count; ++nBuffer)
+          {
+            idleBufferPool_.push(batch_[nBuffer]);
+          }
+          startReceive(lock);
+        }
+
+        if(received == 0)
+        {
+          ++feed.emptyReads_;
+        }
+        if(error != 0 && error != EAGAIN && error != EWOULDBLOCK)
+        {
+          reportError(error);
+        }
+        return queued;
+      }
+
+      void reportError(int error)
+      {
+        if(!stopping_ && !paused_)
+        {
+          ++errorPackets_;
+          boost::system::error_code code(error, boost::asio::error::get_system_category());
+          if(!assembler_->reportCommunicationError(code.message()))
+          {
+            stop();
+          }
+        }
+      }
+
+    private:
+      /// only used to construct the sockets. It is never run.
+      boost::asio::io_service ioService_;
+      Feeds feeds_;
+      int epollFd_;
+      int wakeupFd_;
+      /// the buffer reserved for the next read
+      LinkedBuffer * pending_;
+      size_t batchSize_;
+      int cpu_;
+      size_t waits_;
+      size_t idleWaits_;
+      std::vector<epoll_event> events_;
+      std::vector<mmsghdr> headers_;
+      std::vector<iovec> iovecs_;
+      std::vector<LinkedBuffer *> batch_;
+      std::vector<char> controls_;
+    };
+
+#else // not __linux__
+    /// @brief Receive many multicast groups in one thread using epoll.
+    ///
+    /// Only available on Linux.  Use MulticastReceiver elsewhere.
+    class EpollMulticastReceiver
+      : public SynchReceiver
+    {
+    public:
+      EpollMulticastReceiver()
+      {
+        throw UsageError("Platform Error", "The epoll multicast receiver is only supported on Linux.");
+      }
+
+      /// @brief Add a multicast group.  Not supported on this platform.
+      void addFeed(
+        const std::string &,
+        const std::string &,
+        const std::string &,
+        const std::string &,
+        unsigned short)
+      {
+      }
+
+      /// @brief Receive several datagrams per system call.  Not supported on this platform.
+      void setReceiveBatch(size_t)
+      {
+      }
+
+      /// @brief Pin the receiving thread.  Not supported on this platform.
+      void setCpu(int)
+      {
+      }
+
+      /// @brief Report the receiving overhead.  Not supported on this platform.
+      void report(std::ostream &)const
+      {
+      }
+
+      virtual void resetService()
+      {
+      }
+
+    private:
+      virtual bool initializeReceiver()
+      {
+        return false;
+      }
+
+      virtual bool fillBuffer(LinkedBuffer *, boost::mutex::scoped_lock &)
+      {
+        return false;
+      }
+    };
+#endif // __linux__
+  }
+}
+#endif // EPOLLMULTICASTRECEIVER_H
@@ -0,0 +1,23 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef EPOLLMULTICASTRECEIVER_FWD_H
+#define EPOLLMULTICASTRECEIVER_FWD_H
+#ifndef QUICKFAST_HEADERS
+#error Please include <Application/QuickFAST.h> preferably as a precompiled header file.
+#endif //QUICKFAST_HEADERS
+
+namespace QuickFAST
+{
+  namespace Communication
+  {
+    class EpollMulticastReceiver;
+    /// @brief smart pointer to a EpollMulticastReceiver
+    typedef boost::shared_ptr<EpollMulticastReceiver> EpollMulticastReceiverPtr;
+  }
+}
+#endif // EPOLLMULTICASTRECEIVER_FWD_H
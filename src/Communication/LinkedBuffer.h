@@ -27,6 +27,14 @@ namespace QuickFAST
     ///
     /// A LinkedBuffer also has a flags field containing 32 uncommitted flags that may be
     /// used for whatever purpose is needed.
+    ///
+    /// The storage for a LinkedBuffer can also be provided by someone else (see setStorage())
+    /// in which case it behaves like an internal buffer, but the memory is not released
+    /// by the LinkedBuffer.  BufferPool uses this to carve many buffers from one region.
+    ///
+    /// Receivers that know when the data arrived record it as the receive time
+    /// (nanoseconds since the epoch; zero means unknown.)  Receivers with more than
+    /// one feed record which feed (line) filled the buffer as its source.
     class LinkedBuffer
     {
     public:
@@ -39,6 +47,10 @@ namespace QuickFAST
         , used_(0)
         , extra_(0)
         , flags_(0)
+        , owned_(true)
+        , receiveTime_(0)
+        , source_(0)
+        , handoffTime_(0)
       {
       }
 
@@ -52,6 +64,11 @@ namespace QuickFAST
         , capacity_(0)
         , used_(0)
         , extra_(0)
+        , flags_(0)
+        , owned_(false)
+        , receiveTime_(0)
+        , source_(0)
+        , handoffTime_(0)
       {
       }
 
@@ -65,12 +82,17 @@ namespace QuickFAST
         , capacity_(0)
         , used_(used)
         , extra_(extra)
+        , flags_(0)
+        , owned_(false)
+        , receiveTime_(0)
+        , source_(0)
+        , handoffTime_(0)
       {
       }
 
       ~LinkedBuffer()
       {
-        if(capacity_ != 0)
+        if(owned_)
         {
           delete[] buffer_;
         }
@@ -121,16 +143,34 @@ namespace QuickFAST
       ///
       void setExternal(const unsigned char * externalBuffer, size_t used, void * extra = 0)
       {
-        if(capacity_ != 0)
+        if(owned_)
         {
           delete[] buffer_;
-          capacity_ = 0;
+          owned_ = false;
         }
+        capacity_ = 0;
         buffer_ = const_cast<unsigned char *>(externalBuffer);
         used_ = used;
         extra_ = extra;
       }
 
+      /// @brief Fill this buffer using storage that belongs to someone else.
+      ///
+      /// The storage must outlive this buffer's use of it.
+      /// @param storage where the data will be stored.
+      /// @param capacity how many bytes are available in storage.
+      void setStorage(unsigned char * storage, size_t capacity)
+      {
+        if(owned_)
+        {
+          delete[] buffer_;
+          owned_ = false;
+        }
+        buffer_ = storage;
+        capacity_ = capacity;
+        used_ = 0;
+      }
+
       /// @brief Set the number of bytes used in this buffer
       /// @param used byte count
       void setUsed(size_t used)
@@ -138,6 +178,47 @@ namespace QuickFAST
         used_ = used;
       }
 
+      /// @brief Record when the data in this buffer arrived.
+      /// @param nanoseconds since the epoch. Zero means unknown.
+      void setReceiveTime(uint64 nanoseconds)
+      {
+        receiveTime_ = nanoseconds;
+      }
+
+      /// @brief When did the data in this buffer arrive?
+      /// @returns nanoseconds since the epoch or zero if unknown.
+      uint64 receiveTime()const
+      {
+        return receiveTime_;
+      }
+
+      /// @brief Record when this buffer was passed to another thread.
+      /// @param nanoseconds from Common::monotonicNanoseconds().
+      void setHandoffTime(uint64 nanoseconds)
+      {
+        handoffTime_ = nanoseconds;
+      }
+
+      /// @brief When was this buffer passed to another thread?
+      /// @returns nanoseconds from Common::monotonicNanoseconds() or zero if not recorded.
+      uint64 handoffTime()const
+      {
+        return handoffTime_;
+      }
+
+      /// @brief Record which feed (line) filled this buffer.
+      /// @param source zero for the first (or only) feed, one for the next, etc.
+      void setSource(size_t source)
+      {
+        source_ = source;
+      }
+
+      /// @brief Which feed (line) filled this buffer?
+      size_t source()const
+      {
+        return source_;
+      }
+
       /// @brief Access the number of bytes used in this buffer
       /// @returns used byte count
       size_t used()const
@@ -216,6 +297,10 @@ namespace QuickFAST
       size_t used_;
       void * extra_;
       uint32 flags_;
+      bool owned_;
+      uint64 receiveTime_;
+      size_t source_;
+      uint64 handoffTime_;
     };
 
   }
@@ -0,0 +1,110 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef MMAPFILERECEIVER_H
+#define MMAPFILERECEIVER_H
+// All inline, do not export.
+//#include <Common/QuickFAST_Export.h>
+#include "MMapFileReceiver_fwd.h"
+#include <Communication/SynchReceiver.h>
+#include <Communication/MemoryMappedFile.h>
+
+namespace QuickFAST
+{
+  namespace Communication
+  {
+    /// @brief A Receiver that maps a file of FAST encoded data into memory.
+    ///
+    /// The file is delivered in chunks.  Each buffer points directly into
+    /// the mapped file, so no data is copied and a recording much larger than
+    /// the available memory can be replayed.  The operating system is told to
+    /// read the file sequentially and to start reading the next few chunks
+    /// while the current one is being decoded.
+    class MMapFileReceiver
+      : public SynchReceiver
+    {
+    public:
+      /// @brief Construct given the name of the file.
+      /// @param fileName the file to read
+      /// @param chunkSize how many bytes to deliver in each buffer.
+      /// @param readAhead how many chunks beyond the current one to prefetch.
+      explicit MMapFileReceiver(
+        const std::string & fileName,
+        size_t chunkSize = 1024 * 1024,
+        size_t readAhead = 4
+        )
+        : fileName_(fileName)
+        , chunkSize_(chunkSize > 0 ? chunkSize : 1)
+        , readAhead_(readAhead)
+        , position_(0)
+      {
+      }
+
+      ~MMapFileReceiver()
+      {
+      }
+
+    private:
+
+      // Implement Receiver method
+      virtual bool initializeReceiver()
+      {
+        if(assembler_->wantLog(Common::Logger::QF_LOG_INFO))
+        {
+          std::stringstream msg;
+          msg << "Mapping file: " << fileName_;
+          assembler_->logMessage(Common::Logger::QF_LOG_INFO, msg.str());
+        }
+        if(!file_.open(fileName_))
+        {
+          std::stringstream msg;
+          msg << "Can't map file: " << fileName_;
+          assembler_->logMessage(Common::Logger::QF_LOG_SERIOUS, msg.str());
+          return false;
+        }
+        position_ = 0;
+        file_.adviseSequential();
+        file_.prefetch(0, chunkSize_ * (readAhead_ + 1));
+        return file_.size() > 0;
+      }
+
+      // Implement Receiver method
+      bool fillBuffer(LinkedBuffer * buffer, boost::mutex::scoped_lock& lock)
+      {
+        bool result = !stopping_ && position_ < file_.size();
+        if(result)
+        {
+          size_t size = std::min(chunkSize_, file_.size() - position_);
+          buffer->setExternal(file_.data() + position_, size);
+          position_ += size;
+          // The rest of the read-ahead window was requested by earlier calls,
+          // so this only needs to extend it by one chunk.
+          if(readAhead_ > 0)
+          {
+            file_.prefetch(position_ + chunkSize_ * readAhead_, chunkSize_);
+          }
+          (void) acceptFullBuffer(buffer, size, lock);
+        }
+        return result;
+      }
+
+      // Implement Receiver method
+      virtual void resetService()
+      {
+        ;
+      }
+
+    private:
+      std::string fileName_;
+      size_t chunkSize_;
+      size_t readAhead_;
+      MemoryMappedFile file_;
+      size_t position_;
+    };
+  }
+}
+#endif // MMAPFILERECEIVER_H
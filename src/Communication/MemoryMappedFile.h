@@ -0,0 +1,214 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef MEMORYMAPPEDFILE_H
+#define MEMORYMAPPEDFILE_H
+// All inline, do not export.
+//#include <Common/QuickFAST_Export.h>
+#include "MemoryMappedFile_fwd.h"
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif // _WIN32
+
+namespace QuickFAST
+{
+  namespace Communication
+  {
+    /// @brief Map an entire file into memory for reading.
+    ///
+    /// The contents of the file are available at data() without being copied
+    /// into the process.  Pages are read from disk (or the page cache) when they
+    /// are first touched, so only the parts of the file being used occupy memory.
+    ///
+    /// The whole file is mapped at once, so files larger than a few gigabytes
+    /// require a 64 bit process.
+    class MemoryMappedFile
+    {
+    public:
+      MemoryMappedFile()
+        : data_(0)
+        , size_(0)
+#if defined(_WIN32)
+        , file_(INVALID_HANDLE_VALUE)
+        , mapping_(0)
+#endif // _WIN32
+      {
+      }
+
+      ~MemoryMappedFile()
+      {
+        close();
+      }
+
+      /// @brief Map a file.
+      /// @param fileName names the file.
+      /// @returns true if the file is mapped (an empty file is "mapped" with size() zero)
+      bool open(const std::string & fileName)
+      {
+        close();
+#if defined(_WIN32)
+        file_ = ::CreateFile(
+          fileName.c_str(),
+          GENERIC_READ,
+          FILE_SHARE_READ,
+          NULL,
+          OPEN_EXISTING,
+          FILE_FLAG_SEQUENTIAL_SCAN,
+          NULL);
+        if(file_ == INVALID_HANDLE_VALUE)
+        {
+          return false;
+        }
+        LARGE_INTEGER fileSize;
+        if(!::GetFileSizeEx(file_, &fileSize))
+        {
+          close();
+          return false;
+        }
+        size_ = size_t(fileSize.QuadPart);
+        if(size_ == 0)
+        {
+          return true;
+        }
+        mapping_ = ::CreateFileMapping(file_, NULL, PAGE_READONLY, 0, 0, NULL);
+        if(mapping_ == 0)
+        {
+          close();
+          return false;
+        }
+        data_ = static_cast<const unsigned char *>(::MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+        if(data_ == 0)
+        {
+          close();
+          return false;
+        }
+#else // _WIN32
+        int fd = ::open(fileName.c_str(), O_RDONLY);
+        if(fd < 0)
+        {
+          return false;
+        }
+        struct stat status;
+        if(::fstat(fd, &status) != 0)
+        {
+          ::close(fd);
+          return false;
+        }
+        size_ = size_t(status.st_size);
+        if(size_ > 0)
+        {
+          void * region = ::mmap(0, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+          if(region == MAP_FAILED)
+          {
+            size_ = 0;
+            ::close(fd);
+            return false;
+          }
+          data_ = static_cast<const unsigned char *>(region);
+        }
+        // the mapping remains valid after the descriptor is closed.
+        ::close(fd);
+#endif // _WIN32
+        return true;
+      }
+
+      /// @brief Release the mapping.
+      void close()
+      {
+#if defined(_WIN32)
+        if(data_ != 0)
+        {
+          ::UnmapViewOfFile(data_);
+        }
+        if(mapping_ != 0)
+        {
+          ::CloseHandle(mapping_);
+          mapping_ = 0;
+        }
+        if(file_ != INVALID_HANDLE_VALUE)
+        {
+          ::CloseHandle(file_);
+          file_ = INVALID_HANDLE_VALUE;
+        }
+#else // _WIN32
+        if(data_ != 0)
+        {
+          ::munmap(const_cast<unsigned char *>(data_), size_);
+        }
+#endif // _WIN32
+        data_ = 0;
+        size_ = 0;
+      }
+
+      /// @brief Access the contents of the file.
+      /// @returns the address of the first byte or null if the file is empty or not open.
+      const unsigned char * data()const
+      {
+        return data_;
+      }
+
+      /// @brief How big is the file?
+      size_t size()const
+      {
+        return size_;
+      }
+
+      /// @brief Tell the operating system the file will be read from beginning to end.
+      ///
+      /// This enables aggressive read-ahead, and allows pages that have been
+      /// read to be dropped early.  Ignored where not supported.
+      void adviseSequential()
+      {
+#if !defined(_WIN32) && defined(MADV_SEQUENTIAL)
+        if(data_ != 0)
+        {
+          (void)::madvise(const_cast<unsigned char *>(data_), size_, MADV_SEQUENTIAL);
+        }
+#endif // MADV_SEQUENTIAL
+      }
+
+      /// @brief Ask the operating system to start reading part of the file now.
+      ///
+      /// Returns immediately.  Ignored where not supported.
+      /// @param offset of the first byte that will be needed soon.
+      /// @param length how many bytes will be needed.
+      void prefetch(size_t offset, size_t length)
+      {
+#if !defined(_WIN32) && defined(MADV_WILLNEED)
+        if(offset >= size_)
+        {
+          return;
+        }
+        if(length > size_ - offset)
+        {
+          length = size_ - offset;
+        }
+        // madvise requires a page aligned address.
+        static const size_t pageSize = size_t(::sysconf(_SC_PAGESIZE));
+        size_t start = offset - offset % pageSize;
+        (void)::madvise(const_cast<unsigned char *>(data_ + start), length + (offset - start), MADV_WILLNEED);
+#endif // MADV_WILLNEED
+      }
+
+    private:
+      MemoryMappedFile(const MemoryMappedFile &);
+      MemoryMappedFile & operator=(const MemoryMappedFile &);
+
+    private:
+      const unsigned char * data_;
+      size_t size_;
+#if defined(_WIN32)
+      HANDLE file_;
+      HANDLE mapping_;
+#endif // _WIN32
+    };
+  }
+}
+#endif // MEMORYMAPPEDFILE_H
@@ -11,13 +11,34 @@
 //#include <Common/QuickFAST_Export.h>
 #include "MulticastSender_fwd.h"
 #include <Communication/AsynchSender.h>
+#include <Communication/LinkedBuffer.h>
+#include <Communication/BufferQueue.h>
+#include <Common/TokenBucket.h>
+#include <Common/MonotonicClock.h>
+#include <Common/Exceptions.h>
+#if defined(__linux__)
+#include <sys/socket.h>
+#include <errno.h>
+#endif
 
 namespace QuickFAST
 {
   namespace Communication
   {
     /// @brief Send Multicast Packets
-    /// WARNING: Under construction
+    ///
+    /// Each LinkedBuffer passed to send() becomes one datagram.  Buffers are
+    /// queued and a handler on the io_service flushes the queue, so the
+    /// sender must be run (see AsynchSender::runThreads()).  On Linux a flush
+    /// sends up to setSendBatch() datagrams with each sendmmsg() call.
+    ///
+    /// The flush can be paced to an average number of packets or bits per
+    /// second (see setPacketRate() and setBitRate()) so bursts of send()
+    /// calls leave the host smoothly.  Buffers wait in the queue until the
+    /// pacer allows them to go.
+    ///
+    /// The synchronous send() and asynchronous asyncSend() templates write
+    /// directly to the socket; they are neither batched nor paced.
     class MulticastSender : public AsynchSender
     {
     public:
@@ -33,8 +54,17 @@ namespace QuickFAST
         : AsynchSender(recycler, sendAddress.c_str())
         , sendAddress_(sendAddress)
         , portNumber_(portNumber)
-        , socket_(ioService_)
+        , socket_(ioService_.ioService())
+        , timer_(ioService_.ioService())
+        , sendBatch_(defaultSendBatch)
+        , pacing_(PACE_NONE)
+        , flushing_(false)
+        , stopping_(false)
+        , sendCalls_(0)
+        , packetsSent_(0)
+        , bytesSent_(0)
       {
+        setSendBatch(defaultSendBatch);
       }
 
       /// @brief Construct given multicast information.
@@ -51,12 +81,57 @@ namespace QuickFAST
         : AsynchSender(ioService, recycler, sendAddress.c_str())
         , sendAddress_(sendAddress)
         , portNumber_(portNumber)
-        , socket_(ioService_)
+        , socket_(ioService_.ioService())
+        , timer_(ioService_.ioService())
+        , sendBatch_(defaultSendBatch)
+        , pacing_(PACE_NONE)
+        , flushing_(false)
+        , stopping_(false)
+        , sendCalls_(0)
+        , packetsSent_(0)
+        , bytesSent_(0)
       {
+        setSendBatch(defaultSendBatch);
       }
 
       ~MulticastSender()
       {
+        close();
+      }
+
+      /// @brief The most datagrams sent by one system call.
+      ///
+      /// Only Linux sends more than one (with sendmmsg.)
+      /// Must not be called while buffers are being sent.
+      /// @param sendBatch the limit.  Zero means one.
+      void setSendBatch(size_t sendBatch)
+      {
+        sendBatch_ = sendBatch > 0 ? sendBatch : 1;
+        batch_.resize(sendBatch_);
+#if defined(__linux__)
+        headers_.resize(sendBatch_);
+        iovecs_.resize(sendBatch_);
+#endif
+      }
+
+      /// @brief Pace sends to an average number of packets per second.
+      /// @param packetsPerSecond the rate.  Zero means as fast as possible.
+      /// @param burst how many packets may go back to back after a quiet period.
+      void setPacketRate(double packetsPerSecond, size_t burst = 1)
+      {
+        pacing_ = packetsPerSecond > 0.0 ? PACE_PACKETS : PACE_NONE;
+        pacer_.setRate(packetsPerSecond, double(burst));
+      }
+
+      /// @brief Pace sends to an average number of bits per second.
+      ///
+      /// Only the UDP payload is counted.
+      /// @param bitsPerSecond the rate.  Zero means as fast as possible.
+      /// @param burstBytes how many bytes may go back to back after a quiet period.
+      void setBitRate(double bitsPerSecond, size_t burstBytes = 1500)
+      {
+        pacing_ = bitsPerSecond > 0.0 ? PACE_BITS : PACE_NONE;
+        pacer_.setRate(bitsPerSecond, double(burstBytes) * 8.0);
       }
 
       ///@brief Prepare the sender to be used
@@ -68,9 +143,75 @@ namespace QuickFAST
         return true;
       }
 
-      /// @brief Prepare to shut down
-      void stop()
+      // Implement Sender method
+      virtual void open()
+      {
+        if(!socket_.is_open())
+        {
+          initializeSender();
+        }
+        boost::mutex::scoped_lock lock(queueMutex_);
+        stopping_ = false;
+      }
+
+      /// @brief Queue a buffer to be sent as one datagram.
+      ///
+      /// The buffer is returned to the recycler after it has been sent.
+      /// @param buffer holds the datagram.
+      virtual void send(LinkedBuffer * buffer)
+      {
+        if(buffer->used() == 0)
+        {
+          recycle(buffer);
+          return;
+        }
+        bool startFlush = false;
+        {
+          boost::mutex::scoped_lock lock(queueMutex_);
+          queue_.push(buffer);
+          startFlush = !flushing_;
+          flushing_ = true;
+        }
+        if(startFlush)
+        {
+          // Buffers queued before the handler runs go out in the same batch.
+          ioService_.ioService().post(boost::bind(&MulticastSender::flush, this));
+        }
+      }
+
+      /// @brief Stop after the queued buffers have been sent.
+      virtual void stop()
       {
+        bool idle = false;
+        {
+          boost::mutex::scoped_lock lock(queueMutex_);
+          stopping_ = true;
+          idle = !flushing_;
+        }
+        if(idle)
+        {
+          AsynchSender::stop();
+        }
+      }
+
+      /// @brief Close the socket.  Buffers that have not been sent are recycled.
+      virtual void close()
+      {
+        boost::system::error_code ignored;
+        timer_.cancel(ignored);
+        LinkedBuffer * buffer = 0;
+        {
+          boost::mutex::scoped_lock lock(queueMutex_);
+          buffer = queue_.popList();
+          flushing_ = false;
+        }
+        while(buffer != 0)
+        {
+          LinkedBuffer * next = buffer->link();
+          buffer->link(0);
+          recycle(buffer);
+          buffer = next;
+        }
         try
         {
           socket_.close();
@@ -78,16 +219,31 @@ namespace QuickFAST
         catch(...)
         {
         }
+        AsynchSender::close();
+      }
+
+      /// @brief Statistic: How many system calls have sent queued buffers?
+      size_t sendCalls()const
+      {
+        return sendCalls_;
+      }
+
+      /// @brief Statistic: How many queued buffers have been sent?
+      size_t packetsSent()const
+      {
+        return packetsSent_;
       }
 
-      void open()
+      /// @brief Statistic: How many bytes of queued buffers have been sent?
+      size_t bytesSent()const
       {
-        int todo;
+        return bytesSent_;
       }
 
-      void send(LinkedBuffer * buffer)
+      /// @brief Statistic: How many times has the pacer held a buffer back?
+      size_t pacingWaits()const
       {
-        int todo;
+        return pacer_.waits();
       }
 
       /// @brief Provide direct access to the internal asio socket.
@@ -154,12 +310,183 @@ namespace QuickFAST
       }
 
     private:
-//      AsioService ioService_;
-      const std::string & sendAddress_;
+      enum PacingUnit
+      {
+        PACE_NONE,
+        PACE_PACKETS,
+        PACE_BITS
+      };
+
+      enum
+      {
+        defaultSendBatch = 32
+      };
+
+      /// Only one flush runs at a time: flushing_ stays set while one is posted,
+      /// running or waiting for the pacer.
+      void flush()
+      {
+        bool more = true;
+        while(more)
+        {
+          size_t count = 0;
+          uint64 wait = 0;
+          bool finished = false;
+          {
+            boost::mutex::scoped_lock lock(queueMutex_);
+            if(!flushing_)
+            {
+              // closed
+              return;
+            }
+            while(count < sendBatch_ && wait == 0 && !queue_.isEmpty())
+            {
+              if(pacing_ != PACE_NONE)
+              {
+                double cost = pacing_ == PACE_BITS ? double(queue_.peek()->used()) * 8.0 : 1.0;
+                wait = pacer_.take(cost, Common::monotonicNanoseconds());
+              }
+              if(wait == 0)
+              {
+                batch_[count] = queue_.pop();
+                ++count;
+              }
+            }
+            if(count == 0)
+            {
+              more = false;
+              if(wait != 0)
+              {
+                timer_.expires_from_now(boost::posix_time::microseconds((wait + 999) / 1000));
+                timer_.async_wait(boost::bind(&MulticastSender::handleTimer,
+                  this,
+                  boost::asio::placeholders::error));
+              }
+              else
+              {
+                flushing_ = false;
+                finished = stopping_;
+              }
+            }
+          }
+          if(count > 0)
+          {
+            try
+            {
+              sendBatch(count);
+            }
+            catch(...)
+            {
+              // The next send() starts another flush.
+              boost::mutex::scoped_lock lock(queueMutex_);
+              flushing_ = false;
+              throw;
+            }
+          }
+          if(finished)
+          {
+            AsynchSender::stop();
+          }
+        }
+      }
+
+      void handleTimer(const boost::system::error_code & error)
+      {
+        if(!error)
+        {
+          flush();
+        }
+      }
+
+      void sendBatch(size_t count)
+      {
+        boost::system::error_code error;
+        size_t sent = 0;
+#if defined(__linux__)
+        while(sent < count && !error)
+        {
+          for(size_t nBuffer = sent; nBuffer < count; ++nBuffer)
+          {
+            iovecs_[nBuffer].iov_base = const_cast<unsigned char *>(batch_[nBuffer]->get());
+            iovecs_[nBuffer].iov_len = batch_[nBuffer]->used();
+            std::memset(&headers_[nBuffer], 0, sizeof(headers_[nBuffer]));
+            headers_[nBuffer].msg_hdr.msg_name = endpoint_.data();
+            headers_[nBuffer].msg_hdr.msg_namelen = socklen_t(endpoint_.size());
+            headers_[nBuffer].msg_hdr.msg_iov = &iovecs_[nBuffer];
+            headers_[nBuffer].msg_hdr.msg_iovlen = 1;
+          }
+          ++sendCalls_;
+          int result = ::sendmmsg(socket_.native_handle(), &headers_[sent], unsigned(count - sent), 0);
+          if(result < 0)
+          {
+            if(errno != EINTR)
+            {
+              error = boost::system::error_code(errno, boost::system::system_category());
+            }
+          }
+          else
+          {
+            for(int nSent = 0; nSent < result; ++nSent)
+            {
+              bytesSent_ += batch_[sent]->used();
+              ++packetsSent_;
+              recycle(batch_[sent]);
+              ++sent;
+            }
+          }
+        }
+#else // __linux__
+        while(sent < count && !error)
+        {
+          ++sendCalls_;
+          socket_.send_to(boost::asio::buffer(batch_[sent]->get(), batch_[sent]->used()), endpoint_, 0, error);
+          if(!error)
+          {
+            bytesSent_ += batch_[sent]->used();
+            ++packetsSent_;
+            recycle(batch_[sent]);
+            // the buffer that failed stays for the error handling below.
+            ++sent;
+          }
+        }
+#endif // __linux__
+        if(error)
+        {
+          for(; sent < count; ++sent)
+          {
+            recycle(batch_[sent]);
+          }
+          std::stringstream msg;
+          msg << "Error sending to " << name_ << " " << error.message();
+          throw CommunicationError(msg.str());
+        }
+      }
+
+    private:
+      std::string sendAddress_;
       unsigned short portNumber_;
       boost::asio::ip::address multicastAddress_;
       boost::asio::ip::udp::endpoint endpoint_;
       boost::asio::ip::udp::socket socket_;
+      boost::asio::deadline_timer timer_;
+
+      boost::mutex queueMutex_;
+      BufferQueue queue_;
+      size_t sendBatch_;
+      PacingUnit pacing_;
+      Common::TokenBucket pacer_;
+      bool flushing_;
+      bool stopping_;
+
+      /// used only by the flushing thread
+      std::vector<LinkedBuffer *> batch_;
+#if defined(__linux__)
+      std::vector<mmsghdr> headers_;
+      std::vector<iovec> iovecs_;
+#endif
+      size_t sendCalls_;
+      size_t packetsSent_;
+      size_t bytesSent_;
     };
   }
 }
@@ -17,7 +17,11 @@ namespace QuickFAST
 {
   namespace Communication
   {
-    /// A Receiver that reads input from an istream.
+    /// @brief A Receiver that reads UDP packets from a pcap or pcapng capture file.
+    ///
+    /// The file is memory mapped.  Each packet is delivered in place:
+    /// the buffer handed to the assembler points into the mapped file
+    /// rather than holding a copy of the packet.
     class PCapFileReceiver
       : public SynchReceiver
     {
@@ -33,6 +37,7 @@ namespace QuickFAST
         : SynchReceiver()
         , filename_(filename)
         , wordSize_(wordSize)
+        , filterPort_(0)
       {
       }
 
@@ -40,6 +45,17 @@ namespace QuickFAST
       {
       }
 
+      /// @brief Deliver only packets sent to a particular multicast group and/or port.
+      ///
+      /// Must be called before the receiver is started.
+      /// @param destinationIP dotted IP address. Empty means any address.
+      /// @param destinationPort UDP port. Zero means any port.
+      void setFilter(const std::string & destinationIP, unsigned short destinationPort)
+      {
+        filterIP_ = destinationIP;
+        filterPort_ = destinationPort;
+      }
+
     private:
 
       // Implement Receiver method
@@ -53,6 +69,7 @@ namespace QuickFAST
         {
           reader_.set64bit(true);
         }
+        reader_.setFilter(filterIP_, filterPort_);
         reader_.open(filename_.c_str()); // for debugging, dump to->, &std::cout);
         return reader_.good();
       }
@@ -65,12 +82,10 @@ namespace QuickFAST
         bool result = reader_.read(pcapBuffer, pcapSize);
         if(result)
         {
-          if(pcapSize <= buffer->capacity())
-          {
-            memcpy(buffer->get(), pcapBuffer, pcapSize);
-            acceptFullBuffer(buffer, pcapSize, lock);
-            result = true;
-          }
+          // The mapping lives as long as the reader, so no copy is needed.
+          buffer->setExternal(pcapBuffer, pcapSize);
+          buffer->setReceiveTime(reader_.packetTime());
+          (void) acceptFullBuffer(buffer, pcapSize, lock);
         }
         return result;
       }
@@ -83,6 +98,8 @@ namespace QuickFAST
     private:
       std::string filename_;
       size_t wordSize_;
+      std::string filterIP_;
+      unsigned short filterPort_;
       PCapReader reader_;
     };
   }
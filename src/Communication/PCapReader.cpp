@@ -4,6 +4,9 @@
 //
 #include <Common/QuickFASTPch.h>
 #include "PCapReader.h"
+#include <Common/Exceptions.h>
+#include <algorithm>
+#include <cstddef>
 #ifdef _WIN32
 #include <Winsock2.h>
 #else
@@ -90,27 +93,16 @@ namespace
     DLT_PPP = 9, /* Point-to-point Protocol */
     DLT_FDDI = 10, 	/* FDDI */
     DLT_LINUX_SLL = 113, /* Linux cooked sockets */
+    DLT_RAW = 101, /* raw IP */
     DLT_NULL = 0 /* no link-layer encapsulation */
   };
 
   /*
-   * Generic per-packet information, as supplied by libpcap.
-   *
-   * The time stamp can and should be a "struct timeval", regardless of
-   * whether your system supports 32-bit tv_sec in "struct timeval",
-   * 64-bit tv_sec in "struct timeval", or both if it supports both 32-bit
-   * and 64-bit applications.  The on-disk format of savefiles uses 32-bit
-   * tv_sec (and tv_usec); this structure is irrelevant to that.  32-bit
-   * and 64-bit versions of libpcap, even if they're on the same platform,
-   * should supply the appropriate version of "struct timeval", even if
-   * that's not what the underlying packet capture mechanism supplies.
+   * Per-packet information as stored in the file.
+   * The on-disk format of savefiles uses 32-bit tv_sec (and tv_usec).
+   * (tv_usec is nanoseconds in files with the nanosecond magic number.)
+   * Some tools on 64 bit systems wrote 64 bit values instead.
    */
-  struct pcap_pkthdr {
-    struct timeval ts;	/* time stamp */
-    uint32 caplen;	/* length of portion present */
-    uint32 len;	/* length this packet (off wire) */
-  };
-
   struct pcap_pkthdr32 {
     uint32 tv_sec;
     uint32 tv_usec;
@@ -207,18 +199,115 @@ namespace
 
   static const uint32 nativeMagic = 0xa1b2c3d4;
   static const uint32 swappedMagic = 0xd4c3b2a1;
+  static const uint32 nativeNanoMagic = 0xa1b23c4d;
+  static const uint32 swappedNanoMagic = 0x4d3cb2a1;
+
+  /*
+   * pcapng blocks and options.
+   * See "PCAP Next Generation Dump File Format" (draft-tuexen-opsawg-pcapng).
+   * Every block starts with the type and total length, and ends with
+   * the total length again.  Block bodies are padded to a multiple of 4 bytes.
+   */
+  struct pcapng_block_header {
+    uint32 type;
+    uint32 length;
+  };
+
+  struct pcapng_section_header {
+    uint32 byteOrderMagic;
+    uint16 version_major;
+    uint16 version_minor;
+    uint64 sectionLength;
+  };
+
+  struct pcapng_interface_description {
+    uint16 linktype;
+    uint16 reserved;
+    uint32 snaplen;
+  };
+
+  struct pcapng_enhanced_packet {
+    uint32 interfaceId;
+    uint32 timestampHigh;
+    uint32 timestampLow;
+    uint32 caplen;
+    uint32 len;
+  };
+
+  struct pcapng_packet { // obsolete, but still seen
+    uint16 interfaceId;
+    uint16 drops;
+    uint32 timestampHigh;
+    uint32 timestampLow;
+    uint32 caplen;
+    uint32 len;
+  };
+
+  struct pcapng_simple_packet {
+    uint32 len;
+  };
+
+  struct pcapng_option {
+    uint16 code;
+    uint16 length;
+  };
+
+  enum pcapngBlockType
+  {
+    SECTION_HEADER_BLOCK = 0x0A0D0D0A,
+    INTERFACE_DESCRIPTION_BLOCK = 1,
+    PACKET_BLOCK = 2,
+    SIMPLE_PACKET_BLOCK = 3,
+    ENHANCED_PACKET_BLOCK = 6
+  };
+
+  enum pcapngOption
+  {
+    OPT_ENDOFOPT = 0,
+    IF_TSRESOL = 9,
+    IF_TSOFFSET = 14
+  };
+
+  static const uint32 byteOrderMagic = 0x1A2B3C4D;
+  static const uint32 swappedByteOrderMagic = 0x4D3C2B1A;
+
+  // block type + length at the start, length at the end.
+  static const size_t blockOverhead = sizeof(pcapng_block_header) + sizeof(uint32);
 
 #pragma pack(pop)
 
+  static const uchar UDP_PROTOCOL = 17;
+  static const uint64 nanosecondsPerSecond = 1000000000;
+
+  size_t padTo4(size_t length)
+  {
+    return (length + 3) & ~size_t(3);
+  }
+
+  uint64 powerOf10(uint32 exponent)
+  {
+    uint64 result = 1;
+    while(exponent-- > 0)
+    {
+      result *= 10;
+    }
+    return result;
+  }
 }
 
 PCapReader::PCapReader()
-: fileSize_(0)
+: data_(0)
+, fileSize_(0)
 , pos_(0)
 , ok_(false)
 , usetv32_(false)
 , usetv64_(false)
+, pcapng_(false)
+, fractionUnit_(1000)
 , linktype_(DLT_NULL)
+, packetTime_(0)
+, filterAddress_(0)
+, filterPort_(0)
 , swap(false)
 , verbose_(false)
 {
@@ -227,29 +316,22 @@ PCapReader::PCapReader()
 bool
 PCapReader::open(const char * filename, std::ostream * dumpFile)
 {
-  ok_ = true;
-  FILE * file = fopen(filename, "rb");
-  ok_ = file != 0;
+  ok_ = file_.open(filename);
+  data_ = file_.data();
+  fileSize_ = file_.size();
   if(ok_)
   {
-    fseek(file, 0, SEEK_END);
-    fileSize_ = ftell(file);
-    buffer_.reset(new unsigned char[fileSize_]);
-    fseek(file, 0, SEEK_SET);
-    unsigned char * rawBuffer = buffer_.get();
-    size_t byteCount = fread(rawBuffer, 1, fileSize_, file);
-    fclose(file);
-    ok_ = byteCount == fileSize_;
+    file_.adviseSequential();
     if(dumpFile != 0)
     {
       *dumpFile << std::hex << std::setfill('0') <<std::endl;
-      for(size_t pos = 0; pos < byteCount;)
+      for(size_t pos = 0; pos < fileSize_;)
       {
         *dumpFile << std::setw(4) << pos << ' ';
         size_t end = pos + 16;
-        for(;pos < end && pos < byteCount; ++pos)
+        for(;pos < end && pos < fileSize_; ++pos)
         {
-          *dumpFile << ' ' << std::setw(2) << (short) rawBuffer[pos];
+          *dumpFile << ' ' << std::setw(2) << (short) data_[pos];
         }
         *dumpFile << std::endl;
       }
@@ -268,31 +350,50 @@ PCapReader::rewind()
 {
   ok_ = true;
   pos_ = 0;
+  pcapng_ = false;
+  interfaces_.clear();
 
   //////////////////////////
   // Process the file header
-  if(fileSize_ - pos_ < sizeof(pcap_file_header))
+  if(fileSize_ < sizeof(uint32))
   {
     std::cerr << "Invalid pcap file: no header." << std::endl;
     ok_ = false;
   }
-  if(ok_)
+  else if(*reinterpret_cast<const uint32 *>(data_) == SECTION_HEADER_BLOCK)
   {
-    pcap_file_header * fileHeader = reinterpret_cast<pcap_file_header *>(buffer_.get() + pos_);
+    pcapng_ = true;
+    ok_ = readSectionHeader();
+    if(!ok_)
+    {
+      std::cerr << "Invalid pcapng file: bad section header." << std::endl;
+    }
+  }
+  else if(fileSize_ < sizeof(pcap_file_header))
+  {
+    std::cerr << "Invalid pcap file: no header." << std::endl;
+    ok_ = false;
+  }
+  else
+  {
+    const pcap_file_header * fileHeader = reinterpret_cast<const pcap_file_header *>(data_ + pos_);
     pos_ += sizeof(pcap_file_header);
 
-    if(fileHeader->magic != nativeMagic && fileHeader->magic != swappedMagic)
+    uint32 magic = fileHeader->magic;
+    if(magic != nativeMagic && magic != swappedMagic
+      && magic != nativeNanoMagic && magic != swappedNanoMagic)
     {
       std::cerr << "Invalid pcap file: missing magic." << std::endl;
       ok_ = false;
     }
     if(ok_)
     {
-      swap.setSwap(fileHeader->magic == swappedMagic);
-      assert(swap(fileHeader->magic) == nativeMagic);
+      bool swapped = (magic == swappedMagic || magic == swappedNanoMagic);
+      swap.setSwap(swapped);
+      fractionUnit_ = (swap(magic) == nativeNanoMagic) ? 1 : 1000;
       if(verbose_)
       {
-        std::cout << "PCapReader: Setting swap to : " << (fileHeader->magic == swappedMagic) << std::endl;
+        std::cout << "PCapReader: Setting swap to : " << swapped << std::endl;
       }
     }
     linktype_ = swap(fileHeader->linktype);
@@ -300,197 +401,441 @@ PCapReader::rewind()
   return ok_;
 }
 
+bool
+PCapReader::readSectionHeader()
+{
+  if(pos_ + sizeof(pcapng_block_header) + sizeof(pcapng_section_header) > fileSize_)
+  {
+    return false;
+  }
+  const pcapng_block_header * header = reinterpret_cast<const pcapng_block_header *>(data_ + pos_);
+  const pcapng_section_header * section = reinterpret_cast<const pcapng_section_header *>(header + 1);
+  if(section->byteOrderMagic == byteOrderMagic)
+  {
+    swap.setSwap(false);
+  }
+  else if(section->byteOrderMagic == swappedByteOrderMagic)
+  {
+    swap.setSwap(true);
+  }
+  else
+  {
+    return false;
+  }
+  size_t length = swap(header->length);
+  if(length < blockOverhead + sizeof(pcapng_section_header) || pos_ + length > fileSize_)
+  {
+    return false;
+  }
+  if(verbose_)
+  {
+    std::cout << "PCapReader: pcapng section at " << pos_
+      << " swap: " << (section->byteOrderMagic == swappedByteOrderMagic) << std::endl;
+  }
+  // Interface numbers start over in each section
+  interfaces_.clear();
+  pos_ += length;
+  return true;
+}
+
+void
+PCapReader::readInterface(const unsigned char * body, size_t bodyLength)
+{
+  if(bodyLength < sizeof(pcapng_interface_description))
+  {
+    return;
+  }
+  const pcapng_interface_description * description =
+    reinterpret_cast<const pcapng_interface_description *>(body);
+  Interface info;
+  info.linktype_ = swap(description->linktype);
+  info.binaryResolution_ = false;
+  info.resolution_ = 6; // microseconds unless the if_tsresol option says otherwise
+  info.offset_ = 0;
+
+  size_t position = sizeof(pcapng_interface_description);
+  while(position + sizeof(pcapng_option) <= bodyLength)
+  {
+    const pcapng_option * option = reinterpret_cast<const pcapng_option *>(body + position);
+    uint16 code = swap(option->code);
+    size_t length = swap(option->length);
+    const unsigned char * value = body + position + sizeof(pcapng_option);
+    if(code == OPT_ENDOFOPT || position + sizeof(pcapng_option) + length > bodyLength)
+    {
+      break;
+    }
+    if(code == IF_TSRESOL && length >= 1)
+    {
+      info.binaryResolution_ = (value[0] & 0x80) != 0;
+      info.resolution_ = value[0] & 0x7F;
+    }
+    else if(code == IF_TSOFFSET && length >= sizeof(uint64))
+    {
+      uint64 offset;
+      std::memcpy(&offset, value, sizeof(offset));
+      info.offset_ = swap(offset);
+    }
+    position += sizeof(pcapng_option) + padTo4(length);
+  }
+  if(verbose_)
+  {
+    std::cout << "PCapReader: interface " << interfaces_.size()
+      << " link type " << info.linktype_
+      << " resolution " << (info.binaryResolution_ ? "2^-" : "10^-") << info.resolution_
+      << std::endl;
+  }
+  interfaces_.push_back(info);
+}
+
+uint64
+PCapReader::interfaceTime(size_t interfaceId, uint32 high, uint32 low)const
+{
+  const Interface & info = interfaces_[interfaceId];
+  uint64 ticks = (uint64(high) << 32) | low;
+  uint64 result = 0;
+  if(info.binaryResolution_)
+  {
+    uint32 shift = std::min(info.resolution_, uint32(63));
+    uint64 seconds = ticks >> shift;
+    uint64 fraction = ticks - (seconds << shift);
+    // keep the multiplication within 64 bits.
+    if(shift > 33)
+    {
+      fraction >>= (shift - 33);
+      shift = 33;
+    }
+    result = seconds * nanosecondsPerSecond + ((fraction * nanosecondsPerSecond) >> shift);
+  }
+  else if(info.resolution_ <= 9)
+  {
+    result = ticks * powerOf10(9 - info.resolution_);
+  }
+  else
+  {
+    result = ticks / powerOf10(info.resolution_ - 9);
+  }
+  return result + info.offset_ * nanosecondsPerSecond;
+}
+
 bool
 PCapReader::good()const
 {
   return ok_;
 }
 
+void
+PCapReader::setFilter(const std::string & destinationIP, unsigned short destinationPort)
+{
+  filterAddress_ = 0;
+  if(!destinationIP.empty())
+  {
+    unsigned int b1, b2, b3, b4;
+    char extra;
+    if(std::sscanf(destinationIP.c_str(), "%u.%u.%u.%u%c", &b1, &b2, &b3, &b4, &extra) != 4
+      || b1 > 255 || b2 > 255 || b3 > 255 || b4 > 255)
+    {
+      throw UsageError("PCapReader", "Filter address must be a dotted IP address.");
+    }
+    filterAddress_ = (b1 << 24) | (b2 << 16) | (b3 << 8) | b4;
+  }
+  filterPort_ = destinationPort;
+}
+
 bool
 PCapReader::read(const unsigned char *& buffer, size_t & size)
 {
   if(ok_)
   {
-    ok_ = false;
+    bool found = false;
     size_t skipped = 0;
-    size_t minBytes = sizeof(pcap_pkthdr) + sizeof(ip_header) + sizeof(udp_header);
-    if(usetv32_)
-    {
-      minBytes = sizeof(pcap_pkthdr32) + sizeof(ip_header) + sizeof(udp_header);
-    }
-    if(usetv64_)
-    {
-      minBytes = sizeof(pcap_pkthdr64) + sizeof(ip_header) + sizeof(udp_header);
-    }
-
-    if(verbose_)
+    const unsigned char * frame = 0;
+    size_t caplen = 0;
+    size_t len = 0;
+    uint32 linktype = linktype_;
+    while(!found && nextRecord(frame, caplen, len, linktype))
     {
-      std::cout << "PCapReader: Starting read position: " << pos_ << " file size: " << fileSize_
-                << " minimum packet size: " << minBytes << std::endl;
-      if(usetv32_)
+      if(caplen != len)
       {
-        std::cout << "PCapReader: reading from 32 bit packet capture" << std::endl;
-      }
-      else if(usetv64_)
-      {
-        std::cout << "PCapReader: reading from 64 bit packet capture" << std::endl;
+        skipped += 1;
+        if(verbose_)
+        {
+          std::cout << "PCapReader: Truncated. received 0x"  << std::hex << caplen
+                    << " expected 0x" << len << std::dec << std::endl;
+        }
       }
       else
       {
-        std::cout << "PCapReader: reading from unidentified packet capture" << std::endl;
+        found = findUdp(frame, caplen, linktype, buffer, size);
       }
     }
+    ok_ = found;
+    if(skipped != 0)
+    {
+      std::cerr << "Warning: ignoring " << skipped << " truncated packets." << std::endl;
+    }
+  }
+  return ok_;
+}
+
+bool
+PCapReader::nextRecord(const unsigned char *& frame, size_t & caplen, size_t & len, uint32 & linktype)
+{
+  if(pcapng_)
+  {
+    return nextNgRecord(frame, caplen, len, linktype);
+  }
+  linktype = linktype_;
+  return nextClassicRecord(frame, caplen, len);
+}
+
+bool
+PCapReader::nextClassicRecord(const unsigned char *& frame, size_t & caplen, size_t & len)
+{
+  size_t headerSize = usetv64_ ? sizeof(pcap_pkthdr64) : sizeof(pcap_pkthdr32);
+  if(pos_ + headerSize > fileSize_)
+  {
+    return false;
+  }
+  if(usetv64_)
+  {
+    const pcap_pkthdr64 * packetHeader = reinterpret_cast<const pcap_pkthdr64 *>(data_ + pos_);
+    packetTime_ = swap(packetHeader->tv_sec) * nanosecondsPerSecond + swap(packetHeader->tv_usec) * fractionUnit_;
+    caplen = swap(packetHeader->caplen);
+    len = swap(packetHeader->len);
+  }
+  else
+  {
+    const pcap_pkthdr32 * packetHeader = reinterpret_cast<const pcap_pkthdr32 *>(data_ + pos_);
+    packetTime_ = uint64(swap(packetHeader->tv_sec)) * nanosecondsPerSecond + uint64(swap(packetHeader->tv_usec)) * fractionUnit_;
+    caplen = swap(packetHeader->caplen);
+    len = swap(packetHeader->len);
+  }
+  if(verbose_)
+  {
+    std::cout << "PCapReader: packet at " << pos_ << " data length: " << caplen << std::endl;
+  }
+  pos_ += headerSize;
+  if(pos_ + caplen > fileSize_)
+  {
+    // the file was truncated in the middle of a packet.
+    pos_ = fileSize_;
+    return false;
+  }
+  frame = data_ + pos_;
+  pos_ += caplen;
+  return true;
+}
 
-    while(!ok_ && (pos_ + minBytes < fileSize_))
+bool
+PCapReader::nextNgRecord(const unsigned char *& frame, size_t & caplen, size_t & len, uint32 & linktype)
+{
+  while(pos_ + sizeof(pcapng_block_header) <= fileSize_)
+  {
+    const pcapng_block_header * header = reinterpret_cast<const pcapng_block_header *>(data_ + pos_);
+    // The section header block type reads the same in either byte order.
+    if(header->type == SECTION_HEADER_BLOCK)
     {
-      ////////////////////////////
-      // process the packet header
-      size_t headerPos = pos_;
-      size_t datalen = 0;
-      size_t expectlen = 0;
-      bool truncate = false;
-//      unsigned int dataLinkType = 0;
-
-      if(usetv32_)
-      {
-        pcap_pkthdr32 * packetHeader = reinterpret_cast<pcap_pkthdr32 *>(buffer_.get() + pos_);
-        pos_ += sizeof(pcap_pkthdr32);
-        datalen = swap(packetHeader->caplen);
-        expectlen = swap(packetHeader->len);
-        truncate = (packetHeader->caplen != packetHeader->len);
-      }
-      else if(usetv64_)
-      {
-        pcap_pkthdr64 * packetHeader = reinterpret_cast<pcap_pkthdr64 *>(buffer_.get() + pos_);
-        pos_ += sizeof(pcap_pkthdr64);
-        datalen = swap(packetHeader->caplen);
-        expectlen = swap(packetHeader->len);
-        truncate = (packetHeader->caplen != packetHeader->len);
-      }
-      else
+      if(!readSectionHeader())
       {
-        pcap_pkthdr * packetHeader = reinterpret_cast<pcap_pkthdr *>(buffer_.get() + pos_);
-        pos_ += sizeof(pcap_pkthdr);
-        datalen = swap(packetHeader->caplen);
-        expectlen = swap(packetHeader->len);
-        truncate = (packetHeader->caplen != packetHeader->len);
+        return false;
       }
-      if(verbose_)
+      continue;
+    }
+    uint32 type = swap(header->type);
+    size_t length = swap(header->length);
+    if(length < blockOverhead || pos_ + length > fileSize_)
+    {
+      // corrupt or truncated file
+      pos_ = fileSize_;
+      return false;
+    }
+    if(verbose_)
+    {
+      std::cout << "PCapReader: block type " << type << " at " << pos_ << " length: " << length << std::endl;
+    }
+    const unsigned char * body = data_ + pos_ + sizeof(pcapng_block_header);
+    size_t bodyLength = length - blockOverhead;
+    pos_ += length;
+
+    switch(type)
+    {
+    case INTERFACE_DESCRIPTION_BLOCK:
       {
-        std::cout << "PCapReader: after header position: " << pos_ << " data length: " << datalen;
+        readInterface(body, bodyLength);
+        break;
       }
-      if(truncate)
+    case ENHANCED_PACKET_BLOCK:
       {
-        pos_ += datalen;
-        skipped+= 1;
-        if(verbose_)
+        if(bodyLength < sizeof(pcapng_enhanced_packet))
+        {
+          break;
+        }
+        const pcapng_enhanced_packet * packet = reinterpret_cast<const pcapng_enhanced_packet *>(body);
+        size_t interfaceId = swap(packet->interfaceId);
+        caplen = swap(packet->caplen);
+        len = swap(packet->len);
+        if(interfaceId < interfaces_.size() && sizeof(pcapng_enhanced_packet) + caplen <= bodyLength)
         {
-          std::cout << "  Truncated. received 0x"  << std::hex << datalen
-                    << " expected 0x" << expectlen << std::dec << std::endl;
+          linktype = interfaces_[interfaceId].linktype_;
+          packetTime_ = interfaceTime(interfaceId, swap(packet->timestampHigh), swap(packet->timestampLow));
+          frame = body + sizeof(pcapng_enhanced_packet);
+          return true;
         }
+        break;
       }
-      else
+    case PACKET_BLOCK:
       {
-        if(verbose_)
+        if(bodyLength < sizeof(pcapng_packet))
         {
-          std::cout << std::endl;
+          break;
         }
-        bool found = false;
-        switch(linktype_)
+        const pcapng_packet * packet = reinterpret_cast<const pcapng_packet *>(body);
+        size_t interfaceId = swap(packet->interfaceId);
+        caplen = swap(packet->caplen);
+        len = swap(packet->len);
+        if(interfaceId < interfaces_.size() && sizeof(pcapng_packet) + caplen <= bodyLength)
         {
-        case DLT_EN10MB:
-          {
-            if(verbose_)
-            {
-              std::cout << "PCapReader: Ethernet packet." << std::endl;
-            }
-            pos_ += sizeof(ethernetIIHeader);
-            datalen -= sizeof(ethernetIIHeader);
-            found = true;
-            break;
-          }
-        case DLT_LINUX_SLL:
-          {
-            if(verbose_)
-            {
-              std::cout << "PCapReader: Linux cooked socket packet." << std::endl;
-            }
-            pos_ += sizeof(linuxCookedCaptureHeader);
-            datalen -= sizeof(linuxCookedCaptureHeader);
-            found = true;
-            break;
-          }
-        default:
-          {
-            if(verbose_)
-            {
-              std::cout << "PCapReader: Other type of packet.  Checking for IP protocol flag." << std::endl;
-            }
-            // HACK!look for the IP protocol flag to mark the end of the the link layer header
-            static unsigned short IPProtocol = 0x0008;
-            while(!found && datalen > 2)
-            {
-              unsigned short protocol = *(unsigned short *)(buffer_.get() + pos_);
-              if(swap(protocol) == IPProtocol)
-              {
-                found = true;
-                pos_ += 2;
-                datalen -= 2;
-              }
-              else
-              {
-                pos_ += 1;
-                datalen -= 1;
-              }
-            }
-            break;
-          }
+          linktype = interfaces_[interfaceId].linktype_;
+          packetTime_ = interfaceTime(interfaceId, swap(packet->timestampHigh), swap(packet->timestampLow));
+          frame = body + sizeof(pcapng_packet);
+          return true;
         }
-        if(found)
+        break;
+      }
+    case SIMPLE_PACKET_BLOCK:
+      {
+        // Simple packets belong to the first interface and have no time stamp.
+        if(bodyLength < sizeof(pcapng_simple_packet) || interfaces_.empty())
         {
-          ip_header * ipHeader = reinterpret_cast<ip_header *>(buffer_.get() + pos_);
-          // IP header contains its own length expressed in 4 byte units.
-          size_t ipLen = (ipHeader->ver_ihl & 0xF) * 4;
-          pos_ += ipLen;
-          datalen -= ipLen;
-          udp_header * udpHeader = reinterpret_cast<udp_header*>(buffer_.get() + pos_);
-          pos_ += sizeof(udp_header);
-          datalen -= sizeof(udp_header);
-
-          // udplen includes udp header + cargo
-          // udplen is stored in network byte order
-          size_t udplen = ntohs(udpHeader->len);
-
-          buffer = buffer_.get() + pos_;
-          // trust the udp header for actual cargo size
-          // but continue to trust pos_ and datalen (originates in pcap header) for position in buffer.
-          size = udplen - sizeof(udp_header);
-          if(verbose_)
-          {
-            std::cout << "PCapReader: " << headerPos << ": " << pos_ << ' ' << size
-              << "=== 0x" << std::hex  << headerPos << ": 0x" << pos_ << " 0x" << size << std::dec << std::endl;
-          }
-          ok_ = true;
-          pos_ += datalen;
+          break;
         }
-        else
+        const pcapng_simple_packet * packet = reinterpret_cast<const pcapng_simple_packet *>(body);
+        len = swap(packet->len);
+        caplen = std::min(len, bodyLength - sizeof(pcapng_simple_packet));
+        linktype = interfaces_[0].linktype_;
+        packetTime_ = 0;
+        frame = body + sizeof(pcapng_simple_packet);
+        return true;
+      }
+    default:
+      {
+        // statistics, name resolution, custom blocks, etc. are not interesting.
+        break;
+      }
+    }
+  }
+  return false;
+}
+
+bool
+PCapReader::findUdp(
+  const unsigned char * frame,
+  size_t caplen,
+  uint32 linktype,
+  const unsigned char *& buffer,
+  size_t & size)const
+{
+  size_t offset = 0;
+  bool found = false;
+  switch(linktype)
+  {
+  case DLT_EN10MB:
+    {
+      // skip any 802.1Q (or 802.1ad) VLAN tags to find the real ether type.
+      size_t typePosition = offsetof(ethernetIIHeader, ether_type);
+      while(typePosition + 2 <= caplen
+        && ((frame[typePosition] == 0x81 && frame[typePosition + 1] == 0x00)
+          || (frame[typePosition] == 0x88 && frame[typePosition + 1] == 0xA8)))
+      {
+        typePosition += 4;
+      }
+      offset = typePosition + 2;
+      found = true;
+      break;
+    }
+  case DLT_LINUX_SLL:
+    {
+      offset = sizeof(linuxCookedCaptureHeader);
+      found = true;
+      break;
+    }
+  case DLT_RAW:
+    {
+      offset = 0;
+      found = true;
+      break;
+    }
+  default:
+    {
+      // HACK!look for the IP protocol flag to mark the end of the the link layer header
+      while(!found && offset + 2 < caplen)
+      {
+        if(frame[offset] == 0x08 && frame[offset + 1] == 0x00)
         {
-          if(verbose_)
-          {
-            std::cout << "PCapReader: could not find packet. Skipping " << datalen << " bytes." << std::endl;
-          }
-          pos_ += datalen;
-          skipped += 1;
+          found = true;
         }
-
+        offset += (found ? 2 : 1);
       }
+      break;
     }
-    if(skipped != 0)
+  }
+  // minimum IPv4 header (without options) + UDP header
+  static const size_t minimumIpHeader = 20;
+  if(!found || offset + minimumIpHeader + sizeof(udp_header) > caplen)
+  {
+    if(verbose_)
     {
-      std::cerr << "Warning: ignoring " << skipped << " truncated packets." << std::endl;
+      std::cout << "PCapReader: could not find packet." << std::endl;
     }
+    return false;
   }
-  return ok_;
+
+  const ip_header * ipHeader = reinterpret_cast<const ip_header *>(frame + offset);
+  if((ipHeader->ver_ihl >> 4) != 4 || ipHeader->proto != UDP_PROTOCOL)
+  {
+    return false;
+  }
+  // IP header contains its own length expressed in 4 byte units.
+  size_t ipLen = (ipHeader->ver_ihl & 0xF) * 4;
+  offset += ipLen;
+  if(offset + sizeof(udp_header) > caplen)
+  {
+    return false;
+  }
+  const udp_header * udpHeader = reinterpret_cast<const udp_header*>(frame + offset);
+  offset += sizeof(udp_header);
+
+  if(filterPort_ != 0 && ntohs(udpHeader->dport) != filterPort_)
+  {
+    return false;
+  }
+  if(filterAddress_ != 0)
+  {
+    const ip_address & address = ipHeader->daddr;
+    uint32 destination = (uint32(address.byte1) << 24) | (uint32(address.byte2) << 16)
+      | (uint32(address.byte3) << 8) | uint32(address.byte4);
+    if(destination != filterAddress_)
+    {
+      return false;
+    }
+  }
+
+  // udplen includes udp header + cargo
+  // udplen is stored in network byte order
+  size_t udplen = ntohs(udpHeader->len);
+  if(udplen < sizeof(udp_header))
+  {
+    return false;
+  }
+  buffer = frame + offset;
+  // trust the udp header for actual cargo size
+  // but never beyond the captured data.
+  size = std::min(udplen - sizeof(udp_header), caplen - offset);
+  if(verbose_)
+  {
+    std::cout << "PCapReader: UDP payload " << size << " bytes." << std::endl;
+  }
+  return true;
 }
 
 void
@@ -504,4 +849,3 @@ PCapReader::seek(size_t address)
 {
   pos_ = address;
 }
-
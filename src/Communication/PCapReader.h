@@ -13,6 +13,7 @@
 #include <Common/QuickFAST_Export.h>
 #include <Common/Types.h>
 #include <Common/ByteSwapper.h>
+#include <Communication/MemoryMappedFile.h>
 
 
 namespace QuickFAST
@@ -26,6 +27,14 @@ namespace QuickFAST
     ///
     /// PCap is the format used by many communication utility data capture packages
     /// including Wireshark (aka Ethereal) and tcpdump.
+    ///
+    /// Both the classic pcap format (microsecond or nanosecond timestamps) and
+    /// pcapng are supported.  A pcapng file may contain several sections and
+    /// several interfaces, each with its own link type and timestamp resolution.
+    ///
+    /// The file is mapped into memory rather than read, so the buffer returned
+    /// by read() points into the file itself and remains valid until the reader
+    /// is destroyed or another file is opened.
     class QuickFAST_Export PCapReader
     {
     public:
@@ -59,6 +68,26 @@ namespace QuickFAST
       /// @returns true if the read was successful.  False usually means end of data
       bool read(const unsigned char *& buffer, size_t & size);
 
+      /// @brief When was the packet returned by the most recent read() captured?
+      /// @returns nanoseconds since the epoch.
+      uint64 packetTime()const
+      {
+        return packetTime_;
+      }
+
+      /// @brief Only return packets sent to this address and/or port.
+      ///
+      /// Other packets are skipped.
+      /// @param destinationIP dotted IP address (usually a multicast group).  Empty matches any address.
+      /// @param destinationPort UDP port.  Zero matches any port.
+      void setFilter(const std::string & destinationIP, unsigned short destinationPort);
+
+      /// @brief Is the file in pcapng format?
+      bool isPcapNg()const
+      {
+        return pcapng_;
+      }
+
       /// @brief DEBUG ONLY.  Seek to a particular address.
       ///
       /// since there is no tell() method the address probably came from a verbose display.
@@ -66,8 +95,10 @@ namespace QuickFAST
       /// @param address raw seek address of the beginning of a packet
       void seek(size_t address);
 
-      /// @brief force the reader to expect 64 bit headers even on a 32 bit system.
+      /// @brief force the reader to expect 64 bit time stamps in the packet headers.
       ///
+      /// Standard pcap files have 32 bit time stamps.  Some tools running on 64 bit
+      /// systems wrote 64 bit time stamps instead.  Ignored for pcapng files.
       /// Only one of 64bit and 32bit should be set.
       /// @param state turns the 64bit state on or off (default is off)
       void set64bit(bool state = true)
@@ -75,8 +106,9 @@ namespace QuickFAST
         usetv64_ = state;
       }
 
-      /// @brief force the reader to expect 32 bit headers even on a 64 bit system.
+      /// @brief force the reader to expect 32 bit time stamps in the packet headers.
       ///
+      /// This is the standard format and the default.
       /// Only one of 64bit and 32bit should be set.
       /// @param state turns the 32bit state on or off (default is off)
       void set32bit(bool state = true)
@@ -85,15 +117,49 @@ namespace QuickFAST
       }
 
     private:
-      boost::scoped_array<unsigned char> buffer_;
+      /// @brief Find the next captured frame in the file.
+      bool nextRecord(const unsigned char *& frame, size_t & caplen, size_t & len, uint32 & linktype);
+      bool nextClassicRecord(const unsigned char *& frame, size_t & caplen, size_t & len);
+      bool nextNgRecord(const unsigned char *& frame, size_t & caplen, size_t & len, uint32 & linktype);
+      /// @brief Process the pcapng section header block at pos_
+      bool readSectionHeader();
+      /// @brief Process the body of a pcapng interface description block
+      void readInterface(const unsigned char * body, size_t bodyLength);
+      /// @brief Convert a pcapng time stamp to nanoseconds since the epoch.
+      uint64 interfaceTime(size_t interfaceId, uint32 high, uint32 low)const;
+      /// @brief Find the UDP payload in a captured frame and apply the filter.
+      bool findUdp(
+        const unsigned char * frame,
+        size_t caplen,
+        uint32 linktype,
+        const unsigned char *& buffer,
+        size_t & size)const;
+
+    private:
+      /// @brief A pcapng interface
+      struct Interface
+      {
+        uint32 linktype_;
+        bool binaryResolution_; // time stamp units are 2^-resolution_ rather than 10^-resolution_ seconds
+        uint32 resolution_;
+        uint64 offset_;         // seconds to add to each time stamp
+      };
+
+      MemoryMappedFile file_;
+      const unsigned char * data_;
       size_t fileSize_;
       size_t pos_;
       bool ok_;
-      bool usetv32_;  // true forces 32 bit header on 64 bit platform
-      bool usetv64_;  // true forces 64 bit header on 32 bit platform
-                      // neither usetv32_ nor usetv64_ means use native
+      bool usetv32_;  // true forces 32 bit header (the default)
+      bool usetv64_;  // true forces 64 bit header
                       // both is an (undetected) error.
+      bool pcapng_;
+      uint64 fractionUnit_; // nanoseconds per unit of the fractional part of a classic time stamp
       uint32 linktype_;
+      uint64 packetTime_;
+      std::vector<Interface> interfaces_;
+      uint32 filterAddress_;   // host byte order.  Zero matches any.
+      uint16 filterPort_;      // Zero matches any.
 
       // Important note: swap applies to pcap hader info.  It does NOT apply to
       // network ordered bytes within the message body.
@@ -0,0 +1,995 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef PACKETRINGRECEIVER_H
+#define PACKETRINGRECEIVER_H
+// All inline, do not export.
+//#include <Common/QuickFAST_Export.h>
+#include "PacketRingReceiver_fwd.h"
+#include <Communication/SynchReceiver.h>
+#include <boost/asio.hpp>
+#include <Common/ThreadPlacement.h>
+#include <Common/Exceptions.h>
+#if defined(__linux__)
+#include <sys/socket.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <linux/if_packet.h>
+#include <linux/if_ether.h>
+#include <linux/filter.h>
+#include <errno.h>
+#include <unistd.h>
+#endif
+
+namespace QuickFAST
+{
+  namespace Communication
+  {
+#if defined(__linux__)
+    /// @brief Receive UDP feeds straight from a network interface through a shared packet ring.
+    ///
+    /// An AF_PACKET socket with a TPACKET_V3 ring lets the kernel copy
+    /// datagrams into memory mapped into this process.  The kernel fills a
+    /// block of the ring, hands it over, and moves on to the next block.  No
+    /// system call is needed per packet, or even per block: the receiving
+    /// thread only calls poll() when it has caught up with the kernel.
+    ///
+    /// A BPF program attached to the socket passes only UDP datagrams sent to
+    /// the configured address and port pairs, so the kernel does not copy
+    /// other traffic into the ring.  Multicast groups are joined through an
+    /// ordinary UDP socket so the interface accepts them.  Any interface,
+    /// including the loopback interface, may be used.
+    ///
+    /// The UDP payloads are not copied: each buffer passed to the assembler
+    /// points into a ring block (see LinkedBuffer::setExternal) and is marked with
+    /// the index of its feed (see LinkedBuffer::source()).  A block is returned
+    /// to the kernel once every packet in it has been read and every buffer
+    /// that points into it has been released.  The buffers given to start()
+    /// are used only as descriptors, so their size does not matter but their
+    /// number limits how many packets may be waiting for the assembler.
+    ///
+    /// IP fragments are dropped; feeds must fit in one datagram.
+    class PacketRingReceiver
+      : public SynchReceiver
+    {
+    private:
+      /// @brief One address and port: its statistics.
+      struct Feed
+      {
+        Feed(
+            const std::string & name,
+            const std::string & groupIP,
+            const std::string & listenInterfaceIP,
+            unsigned short portNumber)
+          : name_(name)
+          , group_(boost::asio::ip::address::from_string(groupIP))
+          , listenInterface_(boost::asio::ip::address::from_string(listenInterfaceIP))
+          , portNumber_(portNumber)
+          , joined_(false)
+          , packets_(0)
+          , bytes_(0)
+        {
+        }
+
+        std::string name_;
+        boost::asio::ip::address group_;
+        boost::asio::ip::address listenInterface_;
+        unsigned short portNumber_;
+        bool joined_;
+        size_t packets_;
+        size_t bytes_;
+      };
+      typedef std::vector<Feed> Feeds;
+      typedef std::map<uint64, size_t> FeedIndex;
+
+      enum
+      {
+        /// a blocked wait checks for stop() this often (milliseconds) even without a wakeup.
+        waitMilliseconds = 100,
+        /// the snap length returned by the filter for a wanted packet
+        acceptPacket = 0x40000,
+        /// frames mean little in a TPACKET_V3 ring, but the kernel checks their size.
+        frameSize = 2048
+      };
+
+    public:
+      /// @brief Construct.  Use addFeed() to add the feeds.
+      /// @param interfaceName the network interface to read, for example "eth0" or "lo".
+      ///        Empty means every interface.
+      PacketRingReceiver(const std::string & interfaceName = "")
+        : interfaceName_(interfaceName)
+        , socket_(ioService_)
+        , fd_(-1)
+        , wakeupFd_(-1)
+        , ring_(0)
+        , ringSize_(0)
+        , blockSize_(1024 * 1024)
+        , blockCount_(16)
+        , blockTimeout_(10)
+        , cpu_(-1)
+        , currentBlock_(0)
+        , inBlock_(false)
+        , packetsLeft_(0)
+        , nextPacket_(0)
+        , blocks_(0)
+        , blocksReleased_(0)
+        , waits_(0)
+        , idleWaits_(0)
+        , unwantedPackets_(0)
+        , truncatedPackets_(0)
+        , kernelPackets_(0)
+        , kernelDrops_(0)
+        , kernelFreezes_(0)
+      {
+      }
+
+      ~PacketRingReceiver()
+      {
+        // the receiving thread must be gone before the ring is unmapped.
+        stop();
+        joinThreads();
+        leaveGroups();
+        boost::system::error_code ignored;
+        socket_.close(ignored);
+        if(ring_ != 0)
+        {
+          ::munmap(ring_, ringSize_);
+        }
+        if(fd_ >= 0)
+        {
+          ::close(fd_);
+        }
+        if(wakeupFd_ >= 0)
+        {
+          ::close(wakeupFd_);
+        }
+      }
+
+      /// @brief Add a feed.
+      ///
+      /// All feeds must be added before start() is called.
+      /// Buffers received from this feed are marked with its position
+      /// (zero for the first feed added) as their source.
+      /// @param name identifies the feed in reports and log messages.
+      /// @param groupIP the destination address of the datagrams as a text string.
+      ///        Multicast groups are joined; other addresses are only filtered.
+      /// @param listenInterfaceIP the address of the interface that joins the group.
+      ///        0.0.0.0 means "let the system choose"
+      /// @param portNumber the destination port of the datagrams.
+      void addFeed(
+        const std::string & name,
+        const std::string & groupIP,
+        const std::string & listenInterfaceIP,
+        unsigned short portNumber)
+      {
+        feeds_.push_back(Feed(name, groupIP, listenInterfaceIP, portNumber));
+      }
+
+      /// @brief Choose the network interface to read.
+      ///
+      /// Must be called before start().
+      /// @param interfaceName for example "eth0" or "lo".  Empty means every interface.
+      void setInterface(const std::string & interfaceName)
+      {
+        interfaceName_ = interfaceName;
+      }
+
+      /// @brief Set the shape of the ring.
+      ///
+      /// Must be called before start().
+      /// @param blockSize bytes per block; rounded up to a multiple of the page size.
+      /// @param blockCount how many blocks.
+      /// @param blockTimeout milliseconds the kernel waits before handing over a block that is not full.
+      ///        This bounds the latency added on a quiet feed.
+      void setRing(size_t blockSize, size_t blockCount, unsigned int blockTimeout = 10)
+      {
+        size_t page = size_t(::sysconf(_SC_PAGESIZE));
+        blockSize = std::max(blockSize, size_t(frameSize));
+        blockSize_ = (blockSize + page - 1) / page * page;
+        blockCount_ = blockCount > 1 ? blockCount : 2;
+        blockTimeout_ = blockTimeout > 0 ? blockTimeout : 1;
+      }
+
+      /// @brief Pin the receiving thread to a CPU.
+      ///
+      /// Takes effect when run() starts.
+      /// @param cpu zero based CPU number. Negative means don't pin.
+      void setCpu(int cpu)
+      {
+        cpu_ = cpu;
+      }
+
+      /// @brief How many feeds does this receiver handle?
+      size_t feedCount()const
+      {
+        return feeds_.size();
+      }
+
+      /// @brief The name of a feed.
+      const std::string & feedName(size_t feed)const
+      {
+        return feeds_[feed].name_;
+      }
+
+      /// @brief Statistic: How many packets have arrived on a feed?
+      size_t feedPackets(size_t feed)const
+      {
+        return feeds_[feed].packets_;
+      }
+
+      /// @brief Statistic: How many bytes have arrived on a feed?
+      size_t feedBytes(size_t feed)const
+      {
+        return feeds_[feed].bytes_;
+      }
+
+      /// @brief Statistic: How many ring blocks has the kernel handed over?
+      size_t ringBlocks()const
+      {
+        return blocks_;
+      }
+
+      /// @brief Statistic: How many ring blocks have been returned to the kernel?
+      size_t ringBlocksReleased()const
+      {
+        return blocksReleased_;
+      }
+
+      /// @brief Statistic: How many times has the receiving thread waited for the kernel?
+      size_t ringWaits()const
+      {
+        return waits_;
+      }
+
+      /// @brief Statistic: How many packets did the kernel drop because the ring was full?
+      ///
+      /// Up to date as of the last wait for the kernel or the last report().
+      size_t ringDrops()const
+      {
+        return kernelDrops_;
+      }
+
+      /// @brief Write the receiving statistics, in total and per feed, in human readable form.
+      /// @param out is the destination
+      void report(std::ostream & out)const
+      {
+        updateKernelStatistics();
+        size_t packets = 0;
+        size_t quietFeeds = 0;
+        for(size_t nFeed = 0; nFeed < feeds_.size(); ++nFeed)
+        {
+          packets += feeds_[nFeed].packets_;
+          if(feeds_[nFeed].packets_ == 0)
+          {
+            ++quietFeeds;
+          }
+        }
+        out << "Packet ring receiver on " << (interfaceName_.empty() ? std::string("all interfaces") : interfaceName_)
+          << ": " << feeds_.size() << " feeds (" << quietFeeds << " silent); "
+          << packets << " packets; " << blocks_ << " blocks of " << blockSize_ << " bytes ("
+          << blocksReleased_ << " released); " << waits_ << " waits (" << idleWaits_ << " timed out); "
+          << unwantedPackets_ << " unwanted; " << truncatedPackets_ << " truncated; kernel: "
+          << kernelPackets_ << " packets, " << kernelDrops_ << " dropped, "
+          << kernelFreezes_ << " ring full";
+        if(packets != 0)
+        {
+          out << "; " << double(waits_) / double(packets) << " system calls per packet";
+        }
+        out << '.' << std::endl;
+        for(size_t nFeed = 0; nFeed < feeds_.size(); ++nFeed)
+        {
+          const Feed & feed = feeds_[nFeed];
+          if(feed.packets_ != 0)
+          {
+            out << "Feed " << feed.name_ << ": " << feed.packets_ << " packets; "
+              << feed.bytes_ << " bytes." << std::endl;
+          }
+        }
+      }
+
+      ////////////////////////////////////
+      // Implement Receiver public methods
+      virtual void run()
+      {
+        if(cpu_ >= 0 && !Common::ThreadPlacement::pinThread(cpu_))
+        {
+          assembler_->logMessage(Common::Logger::QF_LOG_WARNING, "PacketRingReceiver: Cannot pin the receiving thread.");
+        }
+        while(!stopping_)
+        {
+          if(receiveReady(true))
+          {
+            tryServiceQueue();
+          }
+        }
+      }
+
+      virtual void run_one()
+      {
+        bool received = false;
+        while(!received && !stopping_)
+        {
+          received = receiveReady(true);
+        }
+        tryServiceQueue();
+      }
+
+      virtual size_t poll()
+      {
+        size_t count = 0;
+        while(!stopping_ && receiveReady(false))
+        {
+          count += tryServiceQueue();
+        }
+        return count;
+      }
+
+      virtual size_t poll_one()
+      {
+        size_t count = 0;
+        if(!stopping_ && receiveReady(false))
+        {
+          count += tryServiceQueue();
+        }
+        return count;
+      }
+
+      virtual bool waitBuffer()
+      {
+        while(queue_.peekOutgoing() == 0 && !stopping_)
+        {
+          boost::mutex::scoped_lock lock(bufferMutex_);
+          queue_.refresh(lock, false);
+          if(queue_.peekOutgoing() == 0)
+          {
+            lock.unlock();
+            receiveReady(true);
+          }
+        }
+        return !stopping_;
+      }
+
+      /// @brief Get the next buffer.
+      ///
+      /// No other thread will fill a buffer, so rather than waiting on
+      /// the queue this reads the ring.
+      virtual LinkedBuffer * getBuffer(bool wait)
+      {
+        LinkedBuffer * next = Receiver::getBuffer(false);
+        while(next == 0 && wait && !stopping_)
+        {
+          receiveReady(true);
+          next = Receiver::getBuffer(false);
+        }
+        return next;
+      }
+
+      virtual void stop()
+      {
+        SynchReceiver::stop();
+        if(wakeupFd_ >= 0)
+        {
+          uint64 one = 1;
+          ssize_t ignored = ::write(wakeupFd_, &one, sizeof(one));
+          (void)ignored;
+        }
+      }
+
+      virtual void pause()
+      {
+        leaveGroups();
+        SynchReceiver::pause();
+      }
+
+      virtual void resume()
+      {
+        SynchReceiver::resume();
+        try
+        {
+          joinGroups();
+        }
+        catch (const std::exception & exception)
+        {
+          assembler_->reportCommunicationError(
+            std::string("PacketRingReceiver: Cannot rejoin multicast groups: ") + exception.what());
+        }
+      }
+
+      virtual void resetService()
+      {
+        return;
+      }
+
+    protected:
+      /// Buffers are filled by walking the ring, not by reads.
+      virtual bool canStartRead()
+      {
+        return false;
+      }
+
+    private:
+      // Implement Receiver method
+      virtual bool initializeReceiver()
+      {
+        if(feeds_.empty())
+        {
+          assembler_->logMessage(Common::Logger::QF_LOG_SERIOUS, "PacketRingReceiver: No feeds.");
+          return false;
+        }
+        feedIndex_.clear();
+        for(size_t nFeed = 0; nFeed < feeds_.size(); ++nFeed)
+        {
+          const Feed & feed = feeds_[nFeed];
+          if(!feed.group_.is_v4())
+          {
+            assembler_->logMessage(Common::Logger::QF_LOG_SERIOUS, "PacketRingReceiver: Only IPv4 is supported: " + feed.name_);
+            return false;
+          }
+          feedIndex_.insert(FeedIndex::value_type(feedKey(uint32(feed.group_.to_v4().to_ulong()), feed.portNumber_), nFeed));
+        }
+
+        std::string failed;
+        int interfaceIndex = 0;
+        if(!interfaceName_.empty())
+        {
+          interfaceIndex = int(::if_nametoindex(interfaceName_.c_str()));
+          if(interfaceIndex == 0)
+          {
+            failed = "no such interface " + interfaceName_;
+          }
+        }
+        std::vector<sock_filter> program;
+        buildFilter(program);
+        sock_fprog filter;
+        filter.len = (unsigned short)program.size();
+        filter.filter = &program[0];
+        int version = TPACKET_V3;
+        tpacket_req3 request;
+        std::memset(&request, 0, sizeof(request));
+        request.tp_block_size = unsigned(blockSize_);
+        request.tp_block_nr = unsigned(blockCount_);
+        request.tp_frame_size = frameSize;
+        request.tp_frame_nr = unsigned(blockSize_ / frameSize * blockCount_);
+        request.tp_retire_blk_tov = blockTimeout_;
+
+        // The filter goes on before the ring or the bind so nothing unwanted slips in.
+        if(failed.empty() && (fd_ = ::socket(AF_PACKET, SOCK_DGRAM, 0)) < 0)
+        {
+          failed = "socket";
+        }
+        else if(failed.empty() && ::setsockopt(fd_, SOL_SOCKET, SO_ATTACH_FILTER, &filter, sizeof(filter)) != 0)
+        {
+          failed = "SO_ATTACH_FILTER";
+        }
+        else if(failed.empty() && ::setsockopt(fd_, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) != 0)
+        {
+          failed = "TPACKET_V3";
+        }
+        else if(failed.empty() && ::setsockopt(fd_, SOL_PACKET, PACKET_RX_RING, &request, sizeof(request)) != 0)
+        {
+          failed = "PACKET_RX_RING";
+        }
+        if(failed.empty())
+        {
+#if defined(PACKET_IGNORE_OUTGOING)
+          // Datagrams this host sends to an external interface are not wanted.
+          // Loopback traffic is still seen on its way back in.
+          int ignore = 1;
+          ::setsockopt(fd_, SOL_PACKET, PACKET_IGNORE_OUTGOING, &ignore, sizeof(ignore));
+#endif
+          ringSize_ = blockSize_ * blockCount_;
+          void * ring = ::mmap(0, ringSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, 0);
+          if(ring == MAP_FAILED)
+          {
+            failed = "mmap";
+          }
+          else
+          {
+            ring_ = static_cast<unsigned char *>(ring);
+            blockRefs_.assign(blockCount_, 0);
+            sockaddr_ll address;
+            std::memset(&address, 0, sizeof(address));
+            address.sll_family = AF_PACKET;
+            address.sll_protocol = htons(ETH_P_IP);
+            address.sll_ifindex = interfaceIndex;
+            if(::bind(fd_, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0)
+            {
+              failed = "bind";
+            }
+          }
+        }
+        if(failed.empty() && (wakeupFd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0)
+        {
+          failed = "eventfd";
+        }
+        if(!failed.empty())
+        {
+          std::stringstream msg;
+          msg << "PacketRingReceiver: Cannot open the packet ring: " << failed;
+          if(errno != 0)
+          {
+            msg << ": " << std::strerror(errno);
+          }
+          assembler_->logMessage(Common::Logger::QF_LOG_SERIOUS, msg.str());
+          return false;
+        }
+
+        try
+        {
+          joinGroups();
+        }
+        catch (const std::exception & exception)
+        {
+          assembler_->logMessage(Common::Logger::QF_LOG_SERIOUS,
+            std::string("PacketRingReceiver: Error joining multicast groups: ") + exception.what());
+          return false;
+        }
+        if(assembler_->wantLog(Common::Logger::QF_LOG_INFO))
+        {
+          std::stringstream msg;
+          msg << "PacketRingReceiver: Receiving " << feeds_.size() << " feeds on "
+            << (interfaceName_.empty() ? std::string("all interfaces") : interfaceName_)
+            << " through " << blockCount_ << " blocks of " << blockSize_ << " bytes.";
+          assembler_->logMessage(Common::Logger::QF_LOG_INFO, msg.str());
+        }
+        return true;
+      }
+
+      // Implement Receiver method
+      // Never called: canStartRead() is always false.
+      virtual bool fillBuffer(LinkedBuffer * /*buffer*/, boost::mutex::scoped_lock& /*lock*/)
+      {
+        return false;
+      }
+
+      static uint64 feedKey(uint32 address, unsigned short port)
+      {
+        return (uint64(address) << 16) | port;
+      }
+
+      /// @brief Build a classic BPF program that accepts the feeds' UDP datagrams.
+      ///
+      /// The socket is SOCK_DGRAM, so the program sees the packet from the IP header on.
+      /// Jumps are all short so any number of feeds fits.
+      void buildFilter(std::vector<sock_filter> & program)const
+      {
+        program.clear();
+        // UDP only
+        program.push_back(statement(BPF_LD | BPF_B | BPF_ABS, 9));
+        program.push_back(jump(BPF_JMP | BPF_JEQ | BPF_K, IPPROTO_UDP, 1, 0));
+        program.push_back(statement(BPF_RET | BPF_K, 0));
+        // no fragments: more fragments flag or a fragment offset
+        program.push_back(statement(BPF_LD | BPF_H | BPF_ABS, 6));
+        program.push_back(jump(BPF_JMP | BPF_JSET | BPF_K, 0x3FFF, 0, 1));
+        program.push_back(statement(BPF_RET | BPF_K, 0));
+        // X = the IP header length
+        program.push_back(statement(BPF_LDX | BPF_B | BPF_MSH, 0));
+        for(size_t nFeed = 0; nFeed < feeds_.size(); ++nFeed)
+        {
+          const Feed & feed = feeds_[nFeed];
+          program.push_back(statement(BPF_LD | BPF_W | BPF_ABS, 16));
+          program.push_back(jump(BPF_JMP | BPF_JEQ | BPF_K, uint32(feed.group_.to_v4().to_ulong()), 0, 3));
+          program.push_back(statement(BPF_LD | BPF_H | BPF_IND, 2));
+          program.push_back(jump(BPF_JMP | BPF_JEQ | BPF_K, feed.portNumber_, 0, 1));
+          program.push_back(statement(BPF_RET | BPF_K, acceptPacket));
+        }
+        program.push_back(statement(BPF_RET | BPF_K, 0));
+      }
+
+      static sock_filter statement(unsigned short code, uint32 k)
+      {
+        sock_filter instruction;
+        instruction.code = code;
+        instruction.jt = 0;
+        instruction.jf = 0;
+        instruction.k = k;
+        return instruction;
+      }
+
+      static sock_filter jump(unsigned short code, uint32 k, unsigned char jt, unsigned char jf)
+      {
+        sock_filter instruction = statement(code, k);
+        instruction.jt = jt;
+        instruction.jf = jf;
+        return instruction;
+      }
+
+      void joinGroups()
+      {
+        for(size_t nFeed = 0; nFeed < feeds_.size(); ++nFeed)
+        {
+          Feed & feed = feeds_[nFeed];
+          if(feed.group_.is_multicast() && !feed.joined_)
+          {
+            if(!socket_.is_open())
+            {
+              socket_.open(boost::asio::ip::udp::v4());
+            }
+            // Feeds that share a group share the membership.
+            boost::system::error_code error;
+            socket_.set_option(boost::asio::ip::multicast::join_group(
+              feed.group_.to_v4(), feed.listenInterface_.to_v4()), error);
+            if(error && error != boost::asio::error::address_in_use)
+            {
+              throw boost::system::system_error(error, feed.name_);
+            }
+            feed.joined_ = !error;
+          }
+        }
+      }
+
+      void leaveGroups()
+      {
+        for(size_t nFeed = 0; nFeed < feeds_.size(); ++nFeed)
+        {
+          Feed & feed = feeds_[nFeed];
+          if(feed.joined_)
+          {
+            boost::system::error_code ignored;
+            socket_.set_option(boost::asio::ip::multicast::leave_group(
+              feed.group_.to_v4(), feed.listenInterface_.to_v4()), ignored);
+            feed.joined_ = false;
+          }
+        }
+      }
+
+      tpacket_block_desc * block(size_t index)const
+      {
+        return reinterpret_cast<tpacket_block_desc *>(ring_ + index * blockSize_);
+      }
+
+      /// @brief Give a block back to the kernel.
+      void releaseBlock(size_t index)
+      {
+        // The kernel may refill the block as soon as it sees this.
+        __atomic_store_n(&block(index)->hdr.bh1.block_status, uint32(TP_STATUS_KERNEL), __ATOMIC_RELEASE);
+        ++blocksReleased_;
+      }
+
+      /// @brief Detach a buffer from the ring block it points into.
+      ///
+      /// The block is released if nothing else needs it.
+      void unreference(LinkedBuffer * buffer)
+      {
+        const unsigned char * data = buffer->get();
+        if(ring_ != 0 && data >= ring_ && data < ring_ + ringSize_)
+        {
+          size_t index = size_t(data - ring_) / blockSize_;
+          if(--blockRefs_[index] == 0 && !(inBlock_ && index == currentBlock_))
+          {
+            releaseBlock(index);
+          }
+          buffer->setExternal(0, 0);
+        }
+      }
+
+      /// @brief Detach every idle buffer from the ring.
+      ///
+      /// Buffers released by the assembler still point into their blocks.
+      /// Do this before waiting for the kernel, or it may wait for a block
+      /// that only an idle buffer is holding.
+      void reclaimBlocks()
+      {
+        boost::mutex::scoped_lock lock(bufferMutex_);
+        idleBufferPool_.push(idleBuffers_);
+        // reclaim buffers from a handoff
+        startReceive(lock);
+        BufferQueue detached;
+        LinkedBuffer * buffer = idleBufferPool_.pop();
+        while(buffer != 0)
+        {
+          unreference(buffer);
+          detached.push(buffer);
+          buffer = idleBufferPool_.pop();
+        }
+        idleBufferPool_.push(detached);
+      }
+
+      /// @brief Queue the packets the kernel has handed over, waiting for some if asked.
+      /// @param block true to wait for the kernel; false to return at once.
+      /// @returns true if any packets were queued.
+      bool receiveReady(bool block)
+      {
+        bool queued = walkRing();
+        if(!queued)
+        {
+          reclaimBlocks();
+        }
+        if(!queued && block && !stopping_)
+        {
+          pollfd waitFor[2];
+          waitFor[0].fd = fd_;
+          waitFor[0].events = POLLIN | POLLERR;
+          waitFor[0].revents = 0;
+          waitFor[1].fd = wakeupFd_;
+          waitFor[1].events = POLLIN;
+          waitFor[1].revents = 0;
+          int ready = ::poll(waitFor, 2, int(waitMilliseconds));
+          ++waits_;
+          if(ready < 0)
+          {
+            if(errno != EINTR)
+            {
+              reportError(errno);
+            }
+          }
+          else if(ready == 0)
+          {
+            ++idleWaits_;
+            updateKernelStatistics();
+          }
+          else if(waitFor[1].revents != 0)
+          {
+            uint64 count;
+            ssize_t ignored = ::read(wakeupFd_, &count, sizeof(count));
+            (void)ignored;
+          }
+          queued = walkRing();
+        }
+        return queued;
+      }
+
+      /// @brief Queue a buffer for every wanted packet in the blocks the kernel has handed over.
+      ///
+      /// Stops when the ring is empty or every buffer is in use.
+      /// @returns true if any packets were queued.
+      bool walkRing()
+      {
+        bool queued = false;
+        boost::mutex::scoped_lock lock(bufferMutex_);
+        idleBufferPool_.push(idleBuffers_);
+        // reclaim buffers from a handoff
+        startReceive(lock);
+        while(!stopping_)
+        {
+          if(packetsLeft_ == 0)
+          {
+            if(inBlock_)
+            {
+              inBlock_ = false;
+              if(blockRefs_[currentBlock_] == 0)
+              {
+                releaseBlock(currentBlock_);
+              }
+              currentBlock_ = (currentBlock_ + 1) % blockCount_;
+            }
+            if(blockRefs_[currentBlock_] != 0)
+            {
+              // Still held from the last trip around the ring, so the kernel is waiting for it too.
+              break;
+            }
+            tpacket_block_desc * desc = block(currentBlock_);
+            if((__atomic_load_n(&desc->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER) == 0)
+            {
+              break;
+            }
+            inBlock_ = true;
+            ++blocks_;
+            packetsLeft_ = desc->hdr.bh1.num_pkts;
+            nextPacket_ = reinterpret_cast<unsigned char *>(desc) + desc->hdr.bh1.offset_to_first_pkt;
+            continue;
+          }
+
+          const tpacket3_hdr * header = reinterpret_cast<const tpacket3_hdr *>(nextPacket_);
+          const unsigned char * payload = 0;
+          size_t size = 0;
+          size_t index = 0;
+          if(findPayload(header, payload, size, index))
+          {
+            LinkedBuffer * buffer = idleBufferPool_.pop();
+            if(buffer == 0)
+            {
+              // resume at this packet when the assembler releases a buffer.
+              ++noBufferAvailable_;
+              break;
+            }
+            unreference(buffer);
+            ++blockRefs_[currentBlock_];
+            buffer->setExternal(payload, size);
+            buffer->setSource(index);
+            if(receiveTimestamps_)
+            {
+              buffer->setReceiveTime(uint64(header->tp_sec) * 1000000000 + uint64(header->tp_nsec));
+            }
+            ++packetsReceived_;
+            if(size == 0)
+            {
+              ++emptyPackets_;
+              unreference(buffer);
+              idleBufferPool_.push(buffer);
+            }
+            else if(paused_)
+            {
+              ++pausedPackets_;
+              unreference(buffer);
+              idleBufferPool_.push(buffer);
+            }
+            else
+            {
+              Feed & feed = feeds_[index];
+              ++feed.packets_;
+              feed.bytes_ += size;
+              ++packetsQueued_;
+              bytesReceived_ += size;
+              largestPacket_ = std::max(largestPacket_, size);
+              queue_.push(buffer, lock);
+              queued = true;
+            }
+          }
+          nextPacket_ += header->tp_next_offset;
+          --packetsLeft_;
+        }
+        return queued;
+      }
+
+      /// @brief Find the UDP payload in a packet and the feed it belongs to.
+      /// @returns false if the packet is not wanted.
+      bool findPayload(const tpacket3_hdr * header, const unsigned char *& payload, size_t & size, size_t & index)
+      {
+        const sockaddr_ll * link = reinterpret_cast<const sockaddr_ll *>(
+          reinterpret_cast<const unsigned char *>(header) + TPACKET_ALIGN(sizeof(tpacket3_hdr)));
+        const unsigned char * ip = reinterpret_cast<const unsigned char *>(header) + header->tp_net;
+        size_t captured = header->tp_snaplen;
+        if(link->sll_pkttype == PACKET_OUTGOING || captured < 20 || (ip[0] >> 4) != 4 || ip[9] != IPPROTO_UDP)
+        {
+          ++unwantedPackets_;
+          return false;
+        }
+        size_t ipHeaderSize = size_t(ip[0] & 0x0F) * 4;
+        if(header->tp_snaplen < header->tp_len || captured < ipHeaderSize + 8)
+        {
+          ++truncatedPackets_;
+          return false;
+        }
+        const unsigned char * udp = ip + ipHeaderSize;
+        uint32 destination = (uint32(ip[16]) << 24) | (uint32(ip[17]) << 16) | (uint32(ip[18]) << 8) | uint32(ip[19]);
+        unsigned short port = (unsigned short)((udp[2] << 8) | udp[3]);
+        size_t udpSize = (size_t(udp[4]) << 8) | size_t(udp[5]);
+        FeedIndex::const_iterator feed = feedIndex_.find(feedKey(destination, port));
+        if(feed == feedIndex_.end() || udpSize < 8)
+        {
+          ++unwantedPackets_;
+          return false;
+        }
+        payload = udp + 8;
+        size = std::min(udpSize - 8, captured - ipHeaderSize - 8);
+        index = feed->second;
+        return true;
+      }
+
+      /// @brief Collect the kernel's counters.  Reading them resets them, so they are accumulated here.
+      void updateKernelStatistics()const
+      {
+        if(fd_ < 0)
+        {
+          return;
+        }
+        tpacket_stats_v3 statistics;
+        std::memset(&statistics, 0, sizeof(statistics));
+        socklen_t length = sizeof(statistics);
+        if(::getsockopt(fd_, SOL_PACKET, PACKET_STATISTICS, &statistics, &length) == 0)
+        {
+          kernelPackets_ += statistics.tp_packets;
+          kernelDrops_ += statistics.tp_drops;
+          kernelFreezes_ += statistics.tp_freeze_q_cnt;
+        }
+      }
+
+      void reportError(int error)
+      {
+        if(!stopping_ && !paused_)
+        {
+          ++errorPackets_;
+          boost::system::error_code code(error, boost::asio::error::get_system_category());
+          if(!assembler_->reportCommunicationError(code.message()))
+          {
+            stop();
+          }
+        }
+      }
+
+    private:
+      std::string interfaceName_;
+      /// only used to construct the socket that joins multicast groups. It is never run.
+      boost::asio::io_service ioService_;
+      /// joins the multicast groups; never read.
+      boost::asio::ip::udp::socket socket_;
+      Feeds feeds_;
+      /// feedKey(address, port) to the feed's index
+      FeedIndex feedIndex_;
+      int fd_;
+      int wakeupFd_;
+      unsigned char * ring_;
+      size_t ringSize_;
+      size_t blockSize_;
+      size_t blockCount_;
+      unsigned int blockTimeout_;
+      int cpu_;
+      /// buffers pointing into each block
+      std::vector<size_t> blockRefs_;
+      /// the block being read, or the next one the kernel will hand over.
+      size_t currentBlock_;
+      /// has the kernel handed over currentBlock_?
+      bool inBlock_;
+      size_t packetsLeft_;
+      unsigned char * nextPacket_;
+      size_t blocks_;
+      size_t blocksReleased_;
+      size_t waits_;
+      size_t idleWaits_;
+      size_t unwantedPackets_;
+      size_t truncatedPackets_;
+      mutable size_t kernelPackets_;
+      mutable size_t kernelDrops_;
+      mutable size_t kernelFreezes_;
+    };
+
+#else // not __linux__
+    /// @brief Receive UDP feeds straight from a network interface through a shared packet ring.
+    ///
+    /// Only available on Linux.  Use MulticastReceiver elsewhere.
+    class PacketRingReceiver
+      : public SynchReceiver
+    {
+    public:
+      PacketRingReceiver(const std::string & = "")
+      {
+        throw UsageError("Platform Error", "The packet ring receiver is only supported on Linux.");
+      }
+
+      /// @brief Add a feed.  Not supported on this platform.
+      void addFeed(
+        const std::string &,
+        const std::string &,
+        const std::string &,
+        unsigned short)
+      {
+      }
+
+      /// @brief Choose the network interface.  Not supported on this platform.
+      void setInterface(const std::string &)
+      {
+      }
+
+      /// @brief Set the shape of the ring.  Not supported on this platform.
+      void setRing(size_t, size_t, unsigned int = 10)
+      {
+      }
+
+      /// @brief Pin the receiving thread.  Not supported on this platform.
+      void setCpu(int)
+      {
+      }
+
+      /// @brief Report the receiving statistics.  Not supported on this platform.
+      void report(std::ostream &)const
+      {
+      }
+
+      virtual void resetService()
+      {
+      }
+
+    private:
+      virtual bool initializeReceiver()
+      {
+        return false;
+      }
+
+      virtual bool fillBuffer(LinkedBuffer *, boost::mutex::scoped_lock &)
+      {
+        return false;
+      }
+    };
+#endif // __linux__
+  }
+}
+#endif // PACKETRINGRECEIVER_H
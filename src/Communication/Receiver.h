@@ -12,7 +12,13 @@
 #include "Receiver_fwd.h"
 #include <Communication/Assembler.h>
 #include <Communication/SingleServerBufferQueue.h>
+#include <Communication/BufferHandoff.h>
+#include <Communication/BufferPool.h>
 #include <Common/Exceptions.h>
+#if defined(__linux__)
+#include <sys/socket.h>
+#include <time.h>
+#endif
 
 namespace QuickFAST
 {
@@ -38,6 +44,13 @@ namespace QuickFAST
         , packetsProcessed_(0)
         , bytesProcessed_(0)
         , largestPacket_(0)
+        , handoffSpinCount_(0)
+        , handoffStrategy_(BufferHandoff::PARK_WAIT)
+        , handoffLatency_(false)
+        , slabBuffers_(false)
+        , hugePages_(false)
+        , numaNode_(-1)
+        , receiveTimestamps_(false)
       {
       }
 
@@ -61,17 +74,15 @@ namespace QuickFAST
         if(initializeReceiver())
         {
           assembler_->receiverStarted(*this);
+          if(handoffSpinCount_ != 0)
+          {
+            handoff_.reset(new BufferHandoff(bufferCount, handoffSpinCount_, handoffStrategy_));
+            handoff_->setMeasureLatency(handoffLatency_);
+          }
 
           // Allocate initial set of buffers
           boost::mutex::scoped_lock lock(bufferMutex_);
-
-          for(size_t nBuffer = 0; nBuffer < bufferCount; ++nBuffer)
-          {
-            BufferLifetime buffer(new LinkedBuffer(bufferSize));
-            /// bufferLifetimes_ is used only to clean up on object destruction
-            bufferLifetimes_.push_back(buffer);
-            idleBufferPool_.push(buffer.get());
-          }
+          allocateBuffers(bufferCount, lock);
           startReceive(lock);
           result = true;
         }
@@ -85,14 +96,61 @@ namespace QuickFAST
         size_t bufferCount = 1)
       {
         boost::mutex::scoped_lock lock(bufferMutex_);
-
-        for(size_t nBuffer = 0; nBuffer < bufferCount; ++nBuffer)
+        if(handoff_ && buffersAllocated() + bufferCount > handoff_->capacity())
         {
-          BufferLifetime buffer(new LinkedBuffer(bufferSize_));
-          /// bufferLifetimes_ is used only to clean up on object destruction
-          bufferLifetimes_.push_back(buffer);
-          idleBufferPool_.push(buffer.get());
+          throw UsageError("Coding Error", "Receiver: Buffers cannot be added when using a lock-free handoff.");
         }
+        allocateBuffers(bufferCount, lock);
+      }
+
+      /// @brief Allocate buffers from a BufferPool rather than individually.
+      ///
+      /// All buffers allocated by start() come from one contiguous, cache-line
+      /// aligned region; each call to addBuffers() allocates another region.
+      /// Must be called before start().
+      /// @param hugePages back the region with 2MB pages if possible (Linux only)
+      void setSlabBuffers(bool hugePages = false)
+      {
+        slabBuffers_ = true;
+        hugePages_ = hugePages;
+      }
+
+      /// @brief Record the time each buffer was received (see LinkedBuffer::receiveTime()).
+      ///
+      /// Socket based receivers ask the kernel for the time each packet arrived
+      /// (SO_TIMESTAMPNS, Linux only).  Receivers that cannot get
+      /// a receive time ignore this setting.
+      /// Must be called before start().
+      /// @param receiveTimestamps true to record the receive time.
+      void setReceiveTimestamps(bool receiveTimestamps = true)
+      {
+        receiveTimestamps_ = receiveTimestamps;
+      }
+
+      /// @brief Place the buffers on a NUMA node.
+      ///
+      /// Use the node of the CPUs that receive and decode
+      /// (see Common::ThreadPlacement::nodeOfCpu()).
+      /// Works best with setSlabBuffers() because individual buffers share
+      /// pages with other allocations.
+      /// Must be called before start().
+      /// @param node the node.  If negative the buffers stay wherever they are allocated.
+      void setNumaNode(int node)
+      {
+        numaNode_ = node;
+      }
+
+      /// @brief Will the receive time be recorded?
+      bool receiveTimestamps()const
+      {
+        return receiveTimestamps_;
+      }
+
+      /// @brief Access the lock-free handoff to the decoding thread (for statistics).
+      /// @returns the handoff or zero if buffers are not handed off.
+      const BufferHandoff * handoff()const
+      {
+        return handoff_.get();
       }
 
       ////////////////////////////////////////////////////////////////////
@@ -110,6 +168,16 @@ namespace QuickFAST
       virtual void stop()
       {
         stopping_ = true;
+        if(handoff_)
+        {
+          handoff_->wakeup();
+        }
+      }
+
+      /// @brief Has stop() been called?
+      bool stopping()const
+      {
+        return stopping_;
       }
 
       /// @brief Ignore incoming packets until resume()
@@ -186,6 +254,10 @@ namespace QuickFAST
       /// @return pointer to the buffer or zero
       virtual LinkedBuffer * getBuffer(bool wait)
       {
+        if(handoff_)
+        {
+          return getHandoffBuffer(wait);
+        }
         LinkedBuffer *next = queue_.serviceNext();
         bool more = true;
         while(more && next == 0  && !stopping_)
@@ -217,6 +289,10 @@ namespace QuickFAST
       /// @returns true if needed bytes are available.
       bool needBytes(size_t needed, bool wait)
       {
+        if(handoff_)
+        {
+          return needHandoffBytes(needed, wait);
+        }
         size_t available = 0;
         bool more = true;
         while(available < needed && more)
@@ -253,7 +329,14 @@ namespace QuickFAST
         //std::ostringstream msg;
         //msg << "{" << (void *)this << "} Release buffer " << (void *)buffer << std::endl;
         //std::cout << msg.str();
-        idleBuffers_.push(buffer);
+        if(handoff_)
+        {
+          handoff_->recycle(buffer);
+        }
+        else
+        {
+          idleBuffers_.push(buffer);
+        }
       }
       // Assembler support routines
       /////////////////////////////
@@ -277,6 +360,16 @@ namespace QuickFAST
       /// scoped_lock parameter means a mutex must be locked
       void startReceive(boost::mutex::scoped_lock& lock)
       {
+        if(handoff_)
+        {
+          // collect the buffers the decoding thread is finished with.
+          LinkedBuffer * returned = handoff_->reclaim();
+          while(returned != 0)
+          {
+            idleBufferPool_.push(returned);
+            returned = handoff_->reclaim();
+          }
+        }
         bool more = canStartRead();
         while( more && !stopping_)
         {
@@ -425,6 +518,246 @@ namespace QuickFAST
       // Statistics
       /////////////
 
+    protected:
+      /// @brief Queue a full buffer for the assembler.
+      ///
+      /// With a lock-free handoff the buffer goes to the decoding thread.
+      /// Otherwise it goes on the SingleServerBufferQueue.
+      /// @param buffer the full buffer
+      /// @param lock confirms that bufferMutex_ is locked.
+      /// @returns true if the calling thread should service the queue.
+      bool queueBuffer(LinkedBuffer * buffer, boost::mutex::scoped_lock & lock)
+      {
+        if(handoff_)
+        {
+          handoff_->deliver(buffer);
+          return false;
+        }
+        return queue_.push(buffer, lock);
+      }
+
+      /// @brief Decode buffers delivered through the lock-free handoff until stopped.
+      ///
+      /// This is the body of the decoding thread.
+      void serviceHandoff()
+      {
+        while(!stopping_)
+        {
+          if(handoff_->wait(stopping_))
+          {
+            ++batchesProcessed_;
+            if(!assembler_->serviceQueue(*this))
+            {
+              stop();
+            }
+          }
+          restartStalledReceive();
+        }
+      }
+
+      /// @brief Decode the buffers that are waiting in the handoff, if any.
+      /// @returns the number of buffers decoded.
+      size_t pollHandoff()
+      {
+        size_t processed = packetsProcessed_;
+        if(!stopping_ && handoff_->peek(0) != 0)
+        {
+          ++batchesProcessed_;
+          if(!assembler_->serviceQueue(*this))
+          {
+            stop();
+          }
+        }
+        restartStalledReceive();
+        return packetsProcessed_ - processed;
+      }
+
+      /// @brief Wait (spin then park) until a full buffer is available from the handoff.
+      /// @param index wait for this many buffers plus one.
+      /// @returns true if the buffer is available; false if stopping.
+      bool waitHandoff(size_t index = 0)
+      {
+        while(!stopping_)
+        {
+          if(handoff_->wait(stopping_, index))
+          {
+            return true;
+          }
+          restartStalledReceive();
+        }
+        return false;
+      }
+
+      /// @brief take idle buffers to be filled by a batched read.
+      /// @param buffers receives the buffers
+      /// @param count is the maximum number of buffers wanted
+      /// @returns the number of buffers actually provided
+      size_t borrowIdleBuffers(LinkedBuffer ** buffers, size_t count)
+      {
+        boost::mutex::scoped_lock lock(bufferMutex_);
+        size_t borrowed = 0;
+        while(borrowed < count)
+        {
+          LinkedBuffer * buffer = idleBufferPool_.pop();
+          if(buffer == 0)
+          {
+            break;
+          }
+          buffers[borrowed++] = buffer;
+        }
+        return borrowed;
+      }
+
+#if defined(__linux__)
+      /// @brief Ask the kernel to timestamp incoming packets on a socket.
+      /// @param socket the native socket handle
+      /// @returns true if the kernel agreed.
+      static bool enableKernelTimestamps(int socket)
+      {
+        int on = 1;
+        return ::setsockopt(socket, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) == 0;
+      }
+
+      /// @brief Find the kernel receive time in the control data from recvmsg().
+      /// @param header the header passed to recvmsg().
+      /// @returns nanoseconds since the epoch or zero if no timestamp is present.
+      static uint64 kernelReceiveTime(msghdr & header)
+      {
+        for(cmsghdr * control = CMSG_FIRSTHDR(&header);
+          control != 0;
+          control = CMSG_NXTHDR(&header, control))
+        {
+          if(control->cmsg_level == SOL_SOCKET && control->cmsg_type == SCM_TIMESTAMPNS)
+          {
+            timespec stamp;
+            std::memcpy(&stamp, CMSG_DATA(control), sizeof(stamp));
+            return uint64(stamp.tv_sec) * 1000000000 + uint64(stamp.tv_nsec);
+          }
+        }
+        return 0;
+      }
+
+      /// @brief Read from a socket without blocking and record the kernel receive time.
+      /// @param socket the native socket handle
+      /// @param buffer receives the data and the receive time.
+      /// @returns the number of bytes received or -1 with errno set.
+      static ssize_t receiveTimestamped(int socket, LinkedBuffer * buffer)
+      {
+        iovec data;
+        data.iov_base = buffer->get();
+        data.iov_len = buffer->capacity();
+        union
+        {
+          cmsghdr align;
+          char data[CMSG_SPACE(sizeof(timespec))];
+        } control;
+        msghdr header;
+        std::memset(&header, 0, sizeof(header));
+        header.msg_iov = &data;
+        header.msg_iovlen = 1;
+        header.msg_control = control.data;
+        header.msg_controllen = sizeof(control.data);
+        ssize_t result = ::recvmsg(socket, &header, MSG_DONTWAIT);
+        if(result >= 0)
+        {
+          buffer->setReceiveTime(kernelReceiveTime(header));
+        }
+        return result;
+      }
+#endif
+
+    private:
+      /// @brief Allocate buffers and add them to the idle pool
+      void allocateBuffers(size_t bufferCount, boost::mutex::scoped_lock &)
+      {
+        if(slabBuffers_)
+        {
+          BufferPoolPtr pool(new BufferPool(bufferCount, bufferSize_, hugePages_));
+          if(numaNode_ >= 0)
+          {
+            pool->placeOnNode(numaNode_);
+          }
+          bufferPools_.push_back(pool);
+          for(size_t nBuffer = 0; nBuffer < bufferCount; ++nBuffer)
+          {
+            idleBufferPool_.push((*pool)[nBuffer]);
+          }
+          return;
+        }
+        for(size_t nBuffer = 0; nBuffer < bufferCount; ++nBuffer)
+        {
+          BufferLifetime buffer(new LinkedBuffer(bufferSize_));
+          if(numaNode_ >= 0)
+          {
+            Common::ThreadPlacement::placeOnNode(buffer->get(), buffer->capacity(), numaNode_);
+          }
+          /// bufferLifetimes_ is used only to clean up on object destruction
+          bufferLifetimes_.push_back(buffer);
+          idleBufferPool_.push(buffer.get());
+        }
+      }
+
+      /// @brief How many buffers have been allocated?
+      size_t buffersAllocated() const
+      {
+        size_t count = bufferLifetimes_.size();
+        for(size_t nPool = 0; nPool < bufferPools_.size(); ++nPool)
+        {
+          count += bufferPools_[nPool]->size();
+        }
+        return count;
+      }
+
+      /// @brief Restart reading if every buffer was busy the last time a read could start.
+      ///
+      /// Without this the receiving thread would have no reason to look
+      /// for the buffers returned by the decoding thread.
+      /// The check is made under the buffer mutex: a completing read on the
+      /// receiving thread may be starting the next one at the same time.
+      void restartStalledReceive()
+      {
+        boost::mutex::scoped_lock lock(bufferMutex_);
+        if(readsInProgress_ == 0 && !stopping_)
+        {
+          startReceive(lock);
+        }
+      }
+
+      LinkedBuffer * getHandoffBuffer(bool wait)
+      {
+        LinkedBuffer * next = handoff_->next();
+        while(next == 0 && wait && waitHandoff())
+        {
+          next = handoff_->next();
+        }
+        if(next != 0)
+        {
+          ++packetsProcessed_;
+          bytesProcessed_ += next->used();
+        }
+        return next;
+      }
+
+      bool needHandoffBytes(size_t needed, bool wait)
+      {
+        size_t available = 0;
+        size_t index = 0;
+        while(available < needed)
+        {
+          const LinkedBuffer * next = handoff_->peek(index);
+          if(next != 0)
+          {
+            available += next->used();
+            ++index;
+          }
+          else if(!wait || !waitHandoff(index))
+          {
+            break;
+          }
+        }
+        return available >= needed;
+      }
+
     protected:
 
       /// @brief Service the queeue of full buffers
@@ -520,6 +853,26 @@ namespace QuickFAST
       size_t bytesProcessed_;
       /// Largest single packet received
       size_t largestPacket_;
+
+      /// @brief Spin count for the lock-free handoff. Zero means don't use one.
+      size_t handoffSpinCount_;
+      /// @brief What the decoding thread does after spinning.
+      BufferHandoff::WaitStrategy handoffStrategy_;
+      /// @brief Measure how long buffers wait in the handoff.
+      bool handoffLatency_;
+      /// @brief Pass buffers to a separate decoding thread without locks (optional).
+      boost::scoped_ptr<BufferHandoff> handoff_;
+      /// @brief Allocate buffers from BufferPools
+      bool slabBuffers_;
+      /// @brief Back BufferPools with huge pages
+      bool hugePages_;
+      /// @brief Manage the lifetimes of the BufferPools
+      std::vector<BufferPoolPtr> bufferPools_;
+      /// @brief Place buffers on this NUMA node (if not negative)
+      int numaNode_;
+    protected:
+      /// @brief Record the time each buffer was received.
+      bool receiveTimestamps_;
     };
   }
 }
@@ -0,0 +1,157 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef SPSCBUFFERRING_H
+#define SPSCBUFFERRING_H
+// All inline, do not export.
+//#include <Common/QuickFAST_Export.h>
+#include "SpscBufferRing_fwd.h"
+#include <Communication/LinkedBuffer.h>
+#include <Common/AtomicOps.h>
+
+namespace QuickFAST
+{
+  namespace Communication
+  {
+    /// @brief A fixed size, lock-free ring of buffer pointers.
+    ///
+    /// Exactly one thread may push() and exactly one (other) thread may
+    /// pop() or peek().  No locks are used; the two threads communicate
+    /// only through the head and tail indexes, which are kept on separate
+    /// cache lines so the producer and consumer don't invalidate each
+    /// other's cache lines on every operation.
+    ///
+    /// The ring does not use the buffers' link fields, so a buffer may be
+    /// on a BufferQueue or linked to its neighbors while it is in the ring.
+    ///
+    /// This object does not manage buffer lifetimes.  It assumes
+    /// that buffers outlive the ring.
+    class SpscBufferRing
+    {
+    public:
+      /// @brief Construct a ring that can hold at least capacity buffers.
+      /// @param capacity the minimum number of buffers the ring can hold.
+      explicit SpscBufferRing(size_t capacity)
+        : mask_(0)
+        , head_(0)
+        , cachedTail_(0)
+        , tail_(0)
+        , cachedHead_(0)
+      {
+        // One slot is always empty to distinguish full from empty.
+        size_t size = 2;
+        while(size < capacity + 1)
+        {
+          size <<= 1;
+        }
+        slots_.resize(size, 0);
+        mask_ = long(size - 1);
+      }
+
+      /// @brief How many buffers can the ring hold?
+      size_t capacity() const
+      {
+        return slots_.size() - 1;
+      }
+
+      /// @brief Add a buffer to the ring (producer thread only)
+      /// @param buffer the buffer to be added
+      /// @returns false if the ring is full.
+      bool push(LinkedBuffer * buffer)
+      {
+        long tail = tail_;
+        long next = (tail + 1) & mask_;
+        if(next == cachedHead_)
+        {
+          cachedHead_ = atomic_load_acquire_long(&head_);
+          if(next == cachedHead_)
+          {
+            return false;
+          }
+        }
+        slots_[tail] = buffer;
+        atomic_store_release_long(&tail_, next);
+        return true;
+      }
+
+      /// @brief Remove the oldest buffer from the ring (consumer thread only)
+      /// @returns the buffer, or zero if the ring is empty.
+      LinkedBuffer * pop()
+      {
+        long head = head_;
+        if(head == cachedTail_)
+        {
+          cachedTail_ = atomic_load_acquire_long(&tail_);
+          if(head == cachedTail_)
+          {
+            return 0;
+          }
+        }
+        LinkedBuffer * buffer = slots_[head];
+        atomic_store_release_long(&head_, (head + 1) & mask_);
+        return buffer;
+      }
+
+      /// @brief Look at a buffer without removing it (consumer thread only)
+      /// @param index zero for the oldest buffer, one for the next, etc.
+      /// @returns the buffer, or zero if there are not that many in the ring.
+      const LinkedBuffer * peek(size_t index)
+      {
+        long head = head_;
+        if(long(index) >= ((cachedTail_ - head) & mask_))
+        {
+          cachedTail_ = atomic_load_acquire_long(&tail_);
+          if(long(index) >= ((cachedTail_ - head) & mask_))
+          {
+            return 0;
+          }
+        }
+        return slots_[(head + long(index)) & mask_];
+      }
+
+      /// @brief Approximately how many buffers are in the ring?
+      ///
+      /// Exact when called by the producer or consumer between operations,
+      /// except that the other thread may have changed it since.
+      size_t size() const
+      {
+        return size_t((atomic_load_acquire_long(&tail_) - atomic_load_acquire_long(&head_)) & mask_);
+      }
+
+      /// @brief Is the ring empty?
+      ///
+      /// The answer may be out of date by the time it is returned
+      /// unless it is called by the consumer and the answer is false.
+      bool isEmpty() const
+      {
+        return atomic_load_acquire_long(&head_) == atomic_load_acquire_long(&tail_);
+      }
+
+    private:
+      SpscBufferRing(const SpscBufferRing &);
+      SpscBufferRing & operator=(const SpscBufferRing &);
+
+    private:
+      // Keep the consumer's and producer's variables on separate cache lines.
+      enum {cacheLine = 64};
+      std::vector<LinkedBuffer *> slots_;
+      long mask_;
+      char pad0_[cacheLine];
+      /// next slot to pop.  Written only by the consumer.
+      volatile long head_;
+      /// the consumer's most recent view of tail_
+      long cachedTail_;
+      char pad1_[cacheLine];
+      /// next slot to push.  Written only by the producer.
+      volatile long tail_;
+      /// the producer's most recent view of head_
+      long cachedHead_;
+      char pad2_[cacheLine];
+    };
+  }
+}
+#endif // SPSCBUFFERRING_H
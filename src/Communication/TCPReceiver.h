@@ -11,11 +11,21 @@
 //#include <Common/QuickFAST_Export.h>
 #include "TCPReceiver_fwd.h"
 #include <Communication/AsynchReceiver.h>
+#if defined(__linux__)
+#include <errno.h>
+#include <sys/uio.h>
+#include <cstring>
+#endif
 namespace QuickFAST
 {
   namespace Communication
   {
     /// @brief Receive TCP Packets and pass them to a packet handler
+    ///
+    /// A TCP stream has no packet boundaries, so each read should fill as much
+    /// of a large buffer as possible (see Receiver::start).  On Linux a single
+    /// read can fill several idle buffers (setReadBuffers()) to reduce system
+    /// calls further when the stream is busy.
     class TCPReceiver
       : public AsynchReceiver
     {
@@ -31,6 +41,15 @@ namespace QuickFAST
         , hostName_(hostName)
         , port_(port)
         , socket_(ioService_)
+        , noDelay_(false)
+        , receiveBufferSize_(0)
+        , receiveLowWater_(0)
+        , moreWaiting_(false)
+        , batch_(1)
+        , sizes_(1)
+#if defined(__linux__)
+        , iovecs_(1)
+#endif
       {
       }
 
@@ -47,7 +66,58 @@ namespace QuickFAST
         , hostName_(hostName)
         , port_(port)
         , socket_(ioService_)
+        , noDelay_(false)
+        , receiveBufferSize_(0)
+        , receiveLowWater_(0)
+        , moreWaiting_(false)
+        , batch_(1)
+        , sizes_(1)
+#if defined(__linux__)
+        , iovecs_(1)
+#endif
+      {
+      }
+
+      /// @brief Disable the Nagle algorithm (TCP_NODELAY) so requests sent on this connection go out immediately.
+      /// Must be called before start().
+      /// @param noDelay true to disable Nagle.
+      void setNoDelay(bool noDelay = true)
+      {
+        noDelay_ = noDelay;
+      }
+
+      /// @brief Set the kernel receive buffer size (SO_RCVBUF).
+      ///
+      /// Set before the connection is made so the TCP window can scale to match.
+      /// Must be called before start().
+      /// @param bytes requested size.  Zero means use the system default.
+      void setReceiveBufferSize(int bytes)
       {
+        receiveBufferSize_ = bytes;
+      }
+
+      /// @brief Don't complete a read until at least this many bytes are available (SO_RCVLOWAT).
+      /// Must be called before start().
+      /// @param bytes minimum read size.  Zero means use the system default.
+      void setReceiveLowWater(int bytes)
+      {
+        receiveLowWater_ = bytes;
+      }
+
+      /// @brief Fill up to readBuffers buffers per system call (Linux only).
+      ///
+      /// The data is scattered across idle buffers with a single readv-style call,
+      /// so allocate more buffers than this (see Receiver::start).
+      /// Must be called before start().
+      /// @param readBuffers the maximum number of buffers per read. 0 or 1 means one.
+      void setReadBuffers(size_t readBuffers)
+      {
+        readBuffers = readBuffers > 1 ? readBuffers : 1;
+        batch_.resize(readBuffers);
+        sizes_.resize(readBuffers);
+#if defined(__linux__)
+        iovecs_.resize(readBuffers);
+#endif
       }
 
       ~TCPReceiver()
@@ -69,7 +139,15 @@ namespace QuickFAST
         bool connected = false;
         while(!connected && iterator != endIterator)
         {
-          socket_.connect(*iterator, error);
+          // Open the socket first so the options apply to the handshake.
+          boost::system::error_code ignored;
+          socket_.close(ignored);
+          socket_.open(iterator->endpoint().protocol(), error);
+          if(!error)
+          {
+            setSocketOptions();
+            socket_.connect(*iterator, error);
+          }
           connected = !error;
           ++iterator;
         }
@@ -88,6 +166,12 @@ namespace QuickFAST
             msg << "Connected to: " << hostName_ << ':' << port_;
             assembler_->logMessage(Common::Logger::QF_LOG_INFO, msg.str());
           }
+#if defined(__linux__)
+          if(receiveTimestamps_ && !enableKernelTimestamps(socket_.native_handle()))
+          {
+            assembler_->logMessage(Common::Logger::QF_LOG_WARNING, "TCPReceiver: Kernel receive timestamps are not available.");
+          }
+#endif
         }
         return ok;
       }
@@ -181,9 +265,60 @@ namespace QuickFAST
       }
 
     private:
+      void setSocketOptions()
+      {
+        boost::system::error_code error;
+        if(receiveBufferSize_ > 0)
+        {
+          socket_.set_option(boost::asio::socket_base::receive_buffer_size(receiveBufferSize_), error);
+          reportOptionError("SO_RCVBUF", error);
+        }
+        if(receiveLowWater_ > 0)
+        {
+          socket_.set_option(boost::asio::socket_base::receive_low_watermark(receiveLowWater_), error);
+          reportOptionError("SO_RCVLOWAT", error);
+        }
+        if(noDelay_)
+        {
+          socket_.set_option(boost::asio::ip::tcp::no_delay(true), error);
+          reportOptionError("TCP_NODELAY", error);
+        }
+      }
+
+      void reportOptionError(const char * option, const boost::system::error_code & error)
+      {
+        if(error && assembler_->wantLog(Common::Logger::QF_LOG_WARNING))
+        {
+          std::stringstream msg;
+          msg << "TCPReceiver: Cannot set " << option << ": " << error.message();
+          assembler_->logMessage(Common::Logger::QF_LOG_WARNING, msg.str());
+        }
+      }
 
       bool fillBuffer(LinkedBuffer * buffer, boost::mutex::scoped_lock& lock)
       {
+#if defined(__linux__)
+        if(receiveTimestamps_ || batch_.size() > 1)
+        {
+          // The timestamp arrives as control data, and scattered reads
+          // need idle buffers, neither of which asio handles.
+          // Wait for the socket to be readable then read it with recvmsg.
+          if(moreWaiting_)
+          {
+            // The last read filled every buffer so the socket may not have been drained.
+            // Don't wait for readiness; it may never be reported again.
+            post(boost::bind(&TCPReceiver::handleReadable,
+              this,
+              boost::system::error_code(),
+              buffer));
+          }
+          else
+          {
+            waitReadable(buffer);
+          }
+          return true;
+        }
+#endif
         socket_.async_receive(
           boost::asio::buffer(buffer->get(), buffer->capacity()),
           boost::bind(&TCPReceiver::handleReceive,
@@ -195,10 +330,105 @@ namespace QuickFAST
         return true;
       }
 
+#if defined(__linux__)
+      void waitReadable(LinkedBuffer * buffer)
+      {
+        socket_.async_receive(
+          boost::asio::null_buffers(),
+          boost::bind(&TCPReceiver::handleReadable,
+            this,
+            boost::asio::placeholders::error,
+            buffer)
+          );
+      }
+
+      /// @brief The socket is readable: scatter the available data across up to batch_.size() buffers.
+      void handleReadable(
+        const boost::system::error_code& error,
+        LinkedBuffer * buffer)
+      {
+        moreWaiting_ = false;
+        if(error)
+        {
+          handleReceive(error, buffer, 0);
+          return;
+        }
+        if(!socket_.is_open())
+        {
+          handleReceive(boost::asio::error::operation_aborted, buffer, 0);
+          return;
+        }
+        batch_[0] = buffer;
+        size_t count = 1 + borrowIdleBuffers(&batch_[1], batch_.size() - 1);
+        size_t capacity = 0;
+        for(size_t nBuffer = 0; nBuffer < count; ++nBuffer)
+        {
+          iovecs_[nBuffer].iov_base = batch_[nBuffer]->get();
+          iovecs_[nBuffer].iov_len = batch_[nBuffer]->capacity();
+          capacity += batch_[nBuffer]->capacity();
+        }
+        union
+        {
+          cmsghdr align;
+          char data[CMSG_SPACE(sizeof(timespec))];
+        } control;
+        msghdr header;
+        std::memset(&header, 0, sizeof(header));
+        header.msg_iov = &iovecs_[0];
+        header.msg_iovlen = count;
+        if(receiveTimestamps_)
+        {
+          header.msg_control = control.data;
+          header.msg_controllen = sizeof(control.data);
+        }
+
+        boost::system::error_code receiveError;
+        size_t received = 0;
+        ssize_t result = ::recvmsg(socket_.native_handle(), &header, MSG_DONTWAIT);
+        if(result < 0)
+        {
+          // EAGAIN et al. are spurious wakeups: the buffers go back to the
+          // idle pool and a new read will be started.
+          if(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+          {
+            receiveError = boost::system::error_code(errno, boost::asio::error::get_system_category());
+          }
+        }
+        else if(result == 0)
+        {
+          receiveError = boost::asio::error::eof;
+        }
+        else
+        {
+          uint64 receiveTime = receiveTimestamps_ ? kernelReceiveTime(header) : 0;
+          size_t remaining = size_t(result);
+          while(remaining > 0)
+          {
+            sizes_[received] = std::min(remaining, batch_[received]->capacity());
+            batch_[received]->setReceiveTime(receiveTime);
+            remaining -= sizes_[received];
+            ++received;
+          }
+          moreWaiting_ = size_t(result) == capacity;
+        }
+        handleReceiveBatch(receiveError, &batch_[0], &sizes_[0], received, count);
+      }
+#endif
+
     private:
       std::string hostName_;
       std::string port_;
       boost::asio::ip::tcp::socket socket_;
+      bool noDelay_;
+      int receiveBufferSize_;
+      int receiveLowWater_;
+      // the last read filled every buffer.
+      bool moreWaiting_;
+      std::vector<LinkedBuffer *> batch_;
+      std::vector<size_t> sizes_;
+#if defined(__linux__)
+      std::vector<iovec> iovecs_;
+#endif
     };
   }
 }
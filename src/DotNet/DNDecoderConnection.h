@@ -198,7 +198,8 @@ namespace QuickFAST
       enum class DNAssemblerType{
         MESSAGE_PER_PACKET_ASSEMBLER = Application::DecoderConfigurationEnums::MESSAGE_PER_PACKET_ASSEMBLER,
         STREAMING_ASSEMBLER = Application::DecoderConfigurationEnums::STREAMING_ASSEMBLER,
-        UNSPECIFIED_ASSEMBLER = Application::DecoderConfigurationEnums::UNSPECIFIED_ASSEMBLER
+        UNSPECIFIED_ASSEMBLER = Application::DecoderConfigurationEnums::UNSPECIFIED_ASSEMBLER,
+        SEQUENCING_ASSEMBLER = Application::DecoderConfigurationEnums::SEQUENCING_ASSEMBLER
       };
 
       property
@@ -222,7 +223,11 @@ namespace QuickFAST
         RAWFILE_RECEIVER = Application::DecoderConfigurationEnums::RAWFILE_RECEIVER,
         PCAPFILE_RECEIVER = Application::DecoderConfigurationEnums::PCAPFILE_RECEIVER,
         BUFFER_RECEIVER = Application::DecoderConfigurationEnums::BUFFER_RECEIVER,
-        UNSPECIFIED_RECEIVER = Application::DecoderConfigurationEnums::UNSPECIFIED_RECEIVER
+        UNSPECIFIED_RECEIVER = Application::DecoderConfigurationEnums::UNSPECIFIED_RECEIVER,
+        BUSYPOLL_RECEIVER = Application::DecoderConfigurationEnums::BUSYPOLL_RECEIVER,
+        MMAPFILE_RECEIVER = Application::DecoderConfigurationEnums::MMAPFILE_RECEIVER,
+        EPOLL_RECEIVER = Application::DecoderConfigurationEnums::EPOLL_RECEIVER,
+        PACKET_RING_RECEIVER = Application::DecoderConfigurationEnums::PACKET_RING_RECEIVER
       };
 
       property
@@ -276,9 +281,6 @@ namespace QuickFAST
       }
 
       /// @brief How many buffers should be allocated for the receiver
-      ///
-      /// For STREAMING_ASSEMBLER with  WaitForCompleteMessage set:
-      ///  BufferSize * BufferCount must equal or exceed the size of the largest expected message
       property
       unsigned int BufferCount
       {
@@ -0,0 +1,231 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef REPLAYCLOCK_H
+#define REPLAYCLOCK_H
+#include <Common/MonotonicClock.h>
+
+namespace QuickFAST{
+  namespace Examples{
+    /// @brief Release packets at the times they were captured, scaled by a speed factor.
+    ///
+    /// The first packet after start (or restart()) is sent immediately and anchors
+    /// the schedule.  Every later packet is held until the same interval has elapsed
+    /// on the wall clock as elapsed between the capture times (divided by the speed).
+    ///
+    /// Long gaps are slept through; the last part of every wait is a spin on a
+    /// monotonic nanosecond clock so the spacing within a microburst is preserved.
+    /// Packets whose capture times go backwards are sent immediately.
+    ///
+    /// The clock also measures how well it kept the schedule: the rate that was
+    /// achieved versus the rate that was requested, and how late each packet was.
+    class ReplayClock
+    {
+    public:
+      /// @brief Construct
+      /// @param speed multiplier applied to the capture rate. 0 means as fast as possible.
+      /// @param spinNanoseconds sleep through waits longer than this then spin for the rest.
+      explicit ReplayClock(double speed = 1.0, uint64 spinNanoseconds = 200000)
+        : speed_(speed)
+        , spinNanoseconds_(spinNanoseconds)
+        , anchored_(false)
+        , captureStart_(0)
+        , wallStart_(0)
+        , lastCapture_(0)
+        , firstSend_(0)
+        , lastSend_(0)
+        , scheduledNanoseconds_(0)
+        , packets_(0)
+        , latePackets_(0)
+        , totalLag_(0)
+        , maxLag_(0)
+      {
+      }
+
+      /// @brief Change the speed multiplier.
+      ///
+      /// Packets already released keep the schedule they were released on;
+      /// the new speed applies from the last packet released.
+      /// @param speed 0.5 = half speed; 10 = ten times faster; 0 = as fast as possible.
+      void setSpeed(double speed)
+      {
+        uint64 schedule = currentSchedule();
+        scheduledNanoseconds_ += schedule;
+        if(anchored_)
+        {
+          wallStart_ = unlimited() ? lastSend_ : wallStart_ + schedule;
+          captureStart_ = lastCapture_;
+        }
+        speed_ = speed;
+      }
+
+      /// @brief Change how long before each send the clock stops sleeping and starts spinning.
+      /// @param spinNanoseconds larger values cost CPU; smaller values risk oversleeping.
+      void setSpinNanoseconds(uint64 spinNanoseconds)
+      {
+        spinNanoseconds_ = spinNanoseconds;
+      }
+
+      /// @brief Is pacing disabled?
+      bool unlimited()const
+      {
+        return speed_ <= 0.0;
+      }
+
+      /// @brief Start a new schedule.  The next packet will be sent immediately.
+      ///
+      /// Use this when the capture times start over, for example at the start of each pass.
+      void restart()
+      {
+        scheduledNanoseconds_ += currentSchedule();
+        anchored_ = false;
+      }
+
+      /// @brief Wait until it is time to send a packet.
+      /// @param captureTime when the packet was captured (nanoseconds; any epoch).
+      void waitFor(uint64 captureTime)
+      {
+        uint64 current = Common::monotonicNanoseconds();
+        if(firstSend_ == 0)
+        {
+          firstSend_ = current;
+        }
+        if(!anchored_)
+        {
+          anchored_ = true;
+          captureStart_ = captureTime;
+          lastCapture_ = captureTime;
+          wallStart_ = current;
+        }
+        else if(captureTime > lastCapture_)
+        {
+          lastCapture_ = captureTime;
+        }
+
+        if(!unlimited())
+        {
+          uint64 target = wallStart_ + uint64(double(lastCapture_ - captureStart_) / speed_);
+          if(current + spinNanoseconds_ < target)
+          {
+            boost::this_thread::sleep(boost::posix_time::microseconds(
+              long((target - current - spinNanoseconds_) / 1000)));
+          }
+          while((current = Common::monotonicNanoseconds()) < target)
+          {
+            // spin
+          }
+          uint64 lag = current - target;
+          totalLag_ += lag;
+          if(lag > maxLag_)
+          {
+            maxLag_ = lag;
+          }
+          if(lag > spinNanoseconds_)
+          {
+            ++latePackets_;
+          }
+        }
+        lastSend_ = current;
+        ++packets_;
+      }
+
+      /// @brief How many packets have been released?
+      size_t packets()const
+      {
+        return packets_;
+      }
+
+      /// @brief How long (nanoseconds) the packets released so far should have taken.
+      uint64 scheduledNanoseconds()const
+      {
+        return scheduledNanoseconds_ + currentSchedule();
+      }
+
+      /// @brief How long (nanoseconds) the packets released so far actually took.
+      uint64 elapsedNanoseconds()const
+      {
+        return lastSend_ - firstSend_;
+      }
+
+      /// @brief The largest difference between a packet's scheduled and actual release time.
+      uint64 maxLag()const
+      {
+        return maxLag_;
+      }
+
+      /// @brief The average difference between a packet's scheduled and actual release time.
+      uint64 meanLag()const
+      {
+        return packets_ == 0 ? 0 : totalLag_ / packets_;
+      }
+
+      /// @brief How many packets were released more than the spin interval late?
+      size_t latePackets()const
+      {
+        return latePackets_;
+      }
+
+      /// @brief Write the achieved versus target rate and the send lag.
+      /// @param out is the destination
+      /// @param unit what waitFor() released: "packets", "bursts", etc.
+      void report(std::ostream & out, const char * unit = "packets")const
+      {
+        out << "Replay: " << packets_ << ' ' << unit;
+        if(unlimited())
+        {
+          out << " as fast as possible";
+        }
+        else
+        {
+          out << " at " << speed_ << "x";
+        }
+        out << " in " << std::fixed << std::setprecision(3)
+          << double(elapsedNanoseconds()) / 1e6 << " msec." << std::endl;
+        if(!unlimited() && packets_ > 1)
+        {
+          out << "  target rate:   " << std::setprecision(0) << rate(scheduledNanoseconds()) << ' ' << unit << "/second" << std::endl;
+          out << "  achieved rate: " << std::setprecision(0) << rate(elapsedNanoseconds()) << ' ' << unit << "/second" << std::endl;
+          out << "  send lag: mean " << std::setprecision(3) << double(meanLag()) / 1000.0
+            << " usec; max " << double(maxLag_) / 1000.0
+            << " usec; " << latePackets_ << ' ' << unit << " more than "
+            << double(spinNanoseconds_) / 1000.0 << " usec late." << std::endl;
+        }
+      }
+
+    private:
+      uint64 currentSchedule()const
+      {
+        if(!anchored_ || unlimited())
+        {
+          return 0;
+        }
+        return uint64(double(lastCapture_ - captureStart_) / speed_);
+      }
+
+      double rate(uint64 nanoseconds)const
+      {
+        // the first packet of the run does not need any time
+        return nanoseconds == 0 ? 0.0 : double(packets_ - 1) * 1e9 / double(nanoseconds);
+      }
+
+    private:
+      double speed_;
+      uint64 spinNanoseconds_;
+      bool anchored_;
+      uint64 captureStart_;
+      uint64 wallStart_;
+      uint64 lastCapture_;
+      uint64 firstSend_;
+      uint64 lastSend_;
+      uint64 scheduledNanoseconds_;
+      size_t packets_;
+      size_t latePackets_;
+      uint64 totalLag_;
+      uint64 maxLag_;
+    };
+  }
+}
+#endif // REPLAYCLOCK_H
@@ -0,0 +1,610 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+
+#include <Examples/ExamplesPch.h>
+#include "TemplateAnalyzer.h"
+#include <Codecs/Template.h>
+#include <Codecs/FieldInstruction.h>
+#include <Messages/FieldIdentity.h>
+#include <iomanip>
+
+using namespace QuickFAST;
+using namespace Examples;
+
+namespace
+{
+  // the costs below are in sevenths of a byte so a presence map bit costs one.
+  const size_t bitsPerByte = 7;
+
+  size_t unsignedLength(uint64 value)
+  {
+    size_t length = 1;
+    while(value >= 0x80)
+    {
+      value >>= 7;
+      ++length;
+    }
+    return length;
+  }
+
+  size_t signedLength(int64 value)
+  {
+    size_t length = 1;
+    while(value < -64 || value > 63)
+    {
+      value >>= 7;
+      ++length;
+    }
+    return length;
+  }
+
+  size_t stringLength(ValueType::Type type, size_t length)
+  {
+    if(type == ValueType::ASCII)
+    {
+      return length == 0 ? 1 : length;
+    }
+    return unsignedLength(length) + length;
+  }
+
+  double perMessage(size_t sevenths, size_t messages)
+  {
+    if(messages == 0)
+    {
+      return 0.0;
+    }
+    return double(sevenths) / double(bitsPerByte) / double(messages);
+  }
+
+  bool isCompound(ValueType::Type type)
+  {
+    return type == ValueType::SEQUENCE
+      || type == ValueType::GROUP
+      || type == ValueType::TEMPLATEREF;
+  }
+}
+
+TemplateAnalyzer::Value::Value()
+  : kind_(ABSENT)
+  , unsigned_(0)
+  , signed_(0)
+{
+}
+
+void
+TemplateAnalyzer::Value::clear()
+{
+  kind_ = ABSENT;
+}
+
+TemplateAnalyzer::FieldStatistics::FieldStatistics()
+  : type_(ValueType::UNDEFINED)
+  , opType_(Codecs::FieldOp::UNKNOWN)
+  , mandatory_(true)
+  , compound_(false)
+  , count_(0)
+  , present_(0)
+  , bytes_(0)
+  , pmapBitsUsed_(0)
+  , pmapBitsSet_(0)
+{
+  for(size_t alt = 0; alt < ALT_COUNT; ++alt)
+  {
+    alternativeCost_[alt] = 0;
+  }
+}
+
+TemplateAnalyzer::TemplateStatistics::TemplateStatistics()
+  : id_(0)
+  , messages_(0)
+  , bytes_(0)
+  , headerBytes_(0)
+{
+}
+
+TemplateAnalyzer::TemplateAnalyzer()
+  : current_(0)
+{
+}
+
+TemplateAnalyzer::~TemplateAnalyzer()
+{
+}
+
+void
+TemplateAnalyzer::beginMessage(const Codecs::Template & templ, size_t headerBytes)
+{
+  TemplateStatistics & stats = templates_[templ.getId()];
+  if(stats.messages_ == 0)
+  {
+    stats.id_ = templ.getId();
+    stats.name_ = templ.getTemplateName();
+  }
+  stats.headerBytes_ += headerBytes;
+  current_ = &stats;
+  value_.clear();
+}
+
+void
+TemplateAnalyzer::fieldDecoded(
+  const Codecs::FieldInstruction & instruction,
+  size_t bytes,
+  bool pmapBitUsed,
+  bool pmapBitSet)
+{
+  if(current_ == 0)
+  {
+    return;
+  }
+  FieldIndex::const_iterator it = current_->index_.find(&instruction);
+  size_t index = 0;
+  if(it == current_->index_.end())
+  {
+    index = current_->fields_.size();
+    current_->index_[&instruction] = index;
+    current_->fields_.push_back(FieldStatistics());
+    FieldStatistics & field = current_->fields_.back();
+    field.name_ = instruction.getName();
+    field.type_ = instruction.fieldInstructionType();
+    field.opType_ = instruction.getFieldOp()->opType();
+    field.mandatory_ = instruction.isMandatory();
+    field.compound_ = isCompound(field.type_);
+  }
+  else
+  {
+    index = it->second;
+  }
+  FieldStatistics & field = current_->fields_[index];
+  field.count_ += 1;
+  field.bytes_ += bytes;
+  if(pmapBitUsed)
+  {
+    field.pmapBitsUsed_ += 1;
+  }
+  if(pmapBitSet)
+  {
+    field.pmapBitsSet_ += 1;
+  }
+  if(!field.compound_)
+  {
+    if(value_.kind_ != Value::ABSENT)
+    {
+      field.present_ += 1;
+    }
+    estimateAlternatives(field);
+    field.previous_ = value_;
+  }
+  value_.clear();
+}
+
+void
+TemplateAnalyzer::endMessage(const Codecs::Template & templ, size_t messageBytes)
+{
+  if(current_ != 0)
+  {
+    current_->messages_ += 1;
+    current_->bytes_ += messageBytes;
+  }
+  current_ = 0;
+}
+
+void
+TemplateAnalyzer::estimateAlternatives(FieldStatistics & field)
+{
+  const Value & value = value_;
+  const Value & previous = field.previous_;
+  bool sameKind = value.kind_ == previous.kind_;
+
+  size_t explicitCost = 1; // a null
+  bool equal = sameKind;
+  bool incremented = false;
+  size_t deltaCost = 1;
+  size_t tailCost = 0;
+  switch(value.kind_)
+  {
+  case Value::UNSIGNED:
+    {
+      explicitCost = unsignedLength(value.unsigned_);
+      uint64 base = sameKind ? previous.unsigned_ : 0;
+      equal = sameKind && value.unsigned_ == base;
+      incremented = sameKind && value.unsigned_ == base + 1;
+      deltaCost = signedLength(int64(value.unsigned_ - base));
+      break;
+    }
+  case Value::SIGNED:
+    {
+      explicitCost = signedLength(value.signed_);
+      int64 base = sameKind ? previous.signed_ : 0;
+      equal = sameKind && value.signed_ == base;
+      incremented = sameKind && value.signed_ == base + 1;
+      deltaCost = signedLength(value.signed_ - base);
+      break;
+    }
+  case Value::DECIMAL:
+    {
+      explicitCost = signedLength(value.decimal_.getExponent())
+        + signedLength(value.decimal_.getMantissa());
+      Decimal base;
+      if(sameKind)
+      {
+        base = previous.decimal_;
+      }
+      equal = sameKind
+        && value.decimal_.getExponent() == base.getExponent()
+        && value.decimal_.getMantissa() == base.getMantissa();
+      deltaCost = signedLength(int64(value.decimal_.getExponent()) - base.getExponent())
+        + signedLength(value.decimal_.getMantissa() - base.getMantissa());
+      break;
+    }
+  case Value::STRING:
+    {
+      const std::string & current = value.string_;
+      explicitCost = stringLength(field.type_, current.size());
+      std::string base;
+      if(sameKind)
+      {
+        base = previous.string_;
+      }
+      equal = sameKind && current == base;
+      size_t prefix = Codecs::FieldInstruction::longestMatchingPrefix(base, current);
+      size_t suffix = Codecs::FieldInstruction::longestMatchingSuffix(base, current);
+      size_t prefixCost = signedLength(int64(base.size() - prefix))
+        + stringLength(field.type_, current.size() - prefix);
+      // removing from the front is encoded as a negative count offset by one.
+      size_t suffixCost = signedLength(-int64(base.size() - suffix) - 1)
+        + stringLength(field.type_, current.size() - suffix);
+      deltaCost = prefixCost < suffixCost ? prefixCost : suffixCost;
+      if(equal)
+      {
+        tailCost = 0;
+      }
+      else if(sameKind && current.size() == base.size())
+      {
+        tailCost = stringLength(field.type_, current.size() - prefix);
+      }
+      else
+      {
+        tailCost = explicitCost;
+      }
+      break;
+    }
+  case Value::ABSENT:
+  default:
+    break;
+  }
+
+  field.alternativeCost_[ALT_NONE] += explicitCost * bitsPerByte;
+  field.alternativeCost_[ALT_COPY] += 1 + (equal ? 0 : explicitCost * bitsPerByte);
+  bool incrementHit = incremented || (equal && value.kind_ == Value::ABSENT);
+  field.alternativeCost_[ALT_INCREMENT] += 1 + (incrementHit ? 0 : explicitCost * bitsPerByte);
+  field.alternativeCost_[ALT_DELTA] += deltaCost * bitsPerByte;
+  field.alternativeCost_[ALT_TAIL] += 1 + tailCost * bitsPerByte;
+}
+
+TemplateAnalyzer::Alternative
+TemplateAnalyzer::currentAlternative(Codecs::FieldOp::OpType opType)
+{
+  switch(opType)
+  {
+  case Codecs::FieldOp::NOP:
+    return ALT_NONE;
+  case Codecs::FieldOp::COPY:
+    return ALT_COPY;
+  case Codecs::FieldOp::INCREMENT:
+    return ALT_INCREMENT;
+  case Codecs::FieldOp::DELTA:
+    return ALT_DELTA;
+  case Codecs::FieldOp::TAIL:
+    return ALT_TAIL;
+  default:
+    return ALT_COUNT;
+  }
+}
+
+const char *
+TemplateAnalyzer::alternativeName(Alternative alternative)
+{
+  switch(alternative)
+  {
+  case ALT_NONE:
+    return "none";
+  case ALT_COPY:
+    return "copy";
+  case ALT_INCREMENT:
+    return "increment";
+  case ALT_DELTA:
+    return "delta";
+  case ALT_TAIL:
+    return "tail";
+  default:
+    return "?";
+  }
+}
+
+void
+TemplateAnalyzer::report(std::ostream & out) const
+{
+  for(TemplateStatisticsMap::const_iterator it = templates_.begin();
+    it != templates_.end();
+    ++it)
+  {
+    const TemplateStatistics & stats = it->second;
+    out << "Template " << stats.name_ << " [" << stats.id_ << "]: "
+      << stats.messages_ << " messages; "
+      << stats.bytes_ << " bytes" << std::endl;
+    if(stats.messages_ == 0)
+    {
+      continue;
+    }
+    out << std::fixed << std::setprecision(2)
+      << "  " << perMessage(stats.bytes_ * bitsPerByte, stats.messages_) << " bytes per message, including "
+      << perMessage(stats.headerBytes_ * bitsPerByte, stats.messages_) << " for PMAP and template ID" << std::endl;
+    out << "  " << std::left
+      << std::setw(24) << "Field"
+      << std::setw(11) << "Type"
+      << std::setw(11) << "Operator"
+      << std::right
+      << std::setw(9) << "Present%"
+      << std::setw(11) << "Avg bytes"
+      << std::setw(16) << "PMAP set/used"
+      << std::setw(7) << "Hit%"
+      << "  Suggestion" << std::endl;
+    for(FieldStatisticsVector::const_iterator field = stats.fields_.begin();
+      field != stats.fields_.end();
+      ++field)
+    {
+      reportField(out, *field);
+    }
+    out << std::endl;
+  }
+  out.unsetf(std::ios::floatfield);
+}
+
+void
+TemplateAnalyzer::reportField(std::ostream & out, const FieldStatistics & field)const
+{
+  out << "  " << std::left
+    << std::setw(24) << field.name_
+    << std::setw(11) << ValueType::typeName(field.type_)
+    << std::setw(11) << Codecs::FieldOp::opName(field.opType_)
+    << std::right;
+  if(field.compound_)
+  {
+    out << std::setw(9) << "-"
+      << std::setw(11) << perMessage(field.bytes_ * bitsPerByte, field.count_)
+      << "  (includes nested fields)" << std::endl;
+    return;
+  }
+  std::ostringstream pmap;
+  pmap << field.pmapBitsSet_ << '/' << field.pmapBitsUsed_;
+  out << std::setw(9) << 100.0 * double(field.present_) / double(field.count_)
+    << std::setw(11) << perMessage(field.bytes_ * bitsPerByte, field.count_)
+    << std::setw(16) << pmap.str();
+  if(field.pmapBitsUsed_ != 0)
+  {
+    out << std::setw(7) << 100.0 * double(field.pmapBitsUsed_ - field.pmapBitsSet_) / double(field.pmapBitsUsed_);
+  }
+  else
+  {
+    out << std::setw(7) << "-";
+  }
+
+  // constant and default values are fixed by the template, so only compare
+  // against alternatives for fields whose values are actually on the wire.
+  if(field.opType_ == Codecs::FieldOp::CONSTANT)
+  {
+    out << std::endl;
+    return;
+  }
+  size_t actual = field.bytes_ * bitsPerByte + field.pmapBitsUsed_;
+  bool isString = field.type_ == ValueType::ASCII
+    || field.type_ == ValueType::UTF8
+    || field.type_ == ValueType::BYTEVECTOR;
+  bool isInteger = !isString && field.type_ != ValueType::DECIMAL;
+  Alternative best = ALT_COUNT;
+  size_t bestCost = actual;
+  for(size_t alt = 0; alt < ALT_COUNT; ++alt)
+  {
+    if(alt == ALT_INCREMENT && !isInteger)
+    {
+      continue;
+    }
+    if(alt == ALT_TAIL && !isString)
+    {
+      continue;
+    }
+    if(alt == currentAlternative(field.opType_))
+    {
+      continue;
+    }
+    if(field.alternativeCost_[alt] < bestCost)
+    {
+      bestCost = field.alternativeCost_[alt];
+      best = Alternative(alt);
+    }
+  }
+  if(best != ALT_COUNT)
+  {
+    out << "  " << alternativeName(best) << " saves "
+      << perMessage(actual - bestCost, field.count_) << " bytes each";
+  }
+  out << std::endl;
+}
+
+const std::string &
+TemplateAnalyzer::getApplicationType()const
+{
+  return applicationType_;
+}
+
+const std::string &
+TemplateAnalyzer::getApplicationTypeNs()const
+{
+  return applicationTypeNamespace_;
+}
+
+void
+TemplateAnalyzer::addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const int64 value)
+{
+  value_.kind_ = Value::SIGNED;
+  value_.signed_ = value;
+}
+
+void
+TemplateAnalyzer::addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const uint64 value)
+{
+  value_.kind_ = Value::UNSIGNED;
+  value_.unsigned_ = value;
+}
+
+void
+TemplateAnalyzer::addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const int32 value)
+{
+  addValue(identity, type, int64(value));
+}
+
+void
+TemplateAnalyzer::addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const uint32 value)
+{
+  addValue(identity, type, uint64(value));
+}
+
+void
+TemplateAnalyzer::addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const int16 value)
+{
+  addValue(identity, type, int64(value));
+}
+
+void
+TemplateAnalyzer::addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const uint16 value)
+{
+  addValue(identity, type, uint64(value));
+}
+
+void
+TemplateAnalyzer::addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const int8 value)
+{
+  addValue(identity, type, int64(value));
+}
+
+void
+TemplateAnalyzer::addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const uchar value)
+{
+  addValue(identity, type, uint64(value));
+}
+
+void
+TemplateAnalyzer::addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const Decimal& value)
+{
+  value_.kind_ = Value::DECIMAL;
+  value_.decimal_ = value;
+}
+
+void
+TemplateAnalyzer::addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const unsigned char * value, size_t length)
+{
+  value_.kind_ = Value::STRING;
+  value_.string_.assign(reinterpret_cast<const char *>(value), length);
+}
+
+Messages::ValueMessageBuilder &
+TemplateAnalyzer::startMessage(
+  const std::string & applicationType,
+  const std::string & applicationTypeNamespace,
+  size_t size)
+{
+  applicationType_ = applicationType;
+  applicationTypeNamespace_ = applicationTypeNamespace;
+  return *this;
+}
+
+bool
+TemplateAnalyzer::endMessage(Messages::ValueMessageBuilder & messageBuilder)
+{
+  return true;
+}
+
+bool
+TemplateAnalyzer::ignoreMessage(Messages::ValueMessageBuilder & messageBuilder)
+{
+  return true;
+}
+
+Messages::ValueMessageBuilder &
+TemplateAnalyzer::startSequence(
+  const Messages::FieldIdentity & identity,
+  const std::string & applicationType,
+  const std::string & applicationTypeNamespace,
+  size_t fieldCount,
+  const Messages::FieldIdentity & lengthIdentity,
+  size_t length)
+{
+  return *this;
+}
+
+void
+TemplateAnalyzer::endSequence(
+  const Messages::FieldIdentity & identity,
+  Messages::ValueMessageBuilder & sequenceBuilder)
+{
+}
+
+Messages::ValueMessageBuilder &
+TemplateAnalyzer::startSequenceEntry(
+  const std::string & applicationType,
+  const std::string & applicationTypeNamespace,
+  size_t size)
+{
+  return *this;
+}
+
+void
+TemplateAnalyzer::endSequenceEntry(Messages::ValueMessageBuilder & entry)
+{
+}
+
+Messages::ValueMessageBuilder &
+TemplateAnalyzer::startGroup(
+  const Messages::FieldIdentity & identity,
+  const std::string & applicationType,
+  const std::string & applicationTypeNamespace,
+  size_t size)
+{
+  return *this;
+}
+
+void
+TemplateAnalyzer::endGroup(
+  const Messages::FieldIdentity & identity,
+  Messages::ValueMessageBuilder & groupBuilder)
+{
+}
+
+bool
+TemplateAnalyzer::wantLog(unsigned short level)
+{
+  return level <= Common::Logger::QF_LOG_WARNING;
+}
+
+bool
+TemplateAnalyzer::logMessage(unsigned short level, const std::string & logMessage)
+{
+  std::cerr << logMessage << std::endl;
+  return true;
+}
+
+bool
+TemplateAnalyzer::reportDecodingError(const std::string & errorMessage)
+{
+  std::cerr << "Decoding error: " << errorMessage << std::endl;
+  return false;
+}
+
+bool
+TemplateAnalyzer::reportCommunicationError(const std::string & errorMessage)
+{
+  std::cerr << "Communication error: " << errorMessage << std::endl;
+  return false;
+}
@@ -0,0 +1,181 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef TEMPLATEANALYZER_H
+#define TEMPLATEANALYZER_H
+#include <Messages/ValueMessageBuilder.h>
+#include <Codecs/DecoderObserver.h>
+#include <Codecs/FieldOp.h>
+#include <Common/Decimal.h>
+
+namespace QuickFAST{
+  namespace Examples{
+
+    /// @brief Measure how well a set of templates fits the traffic being decoded.
+    ///
+    /// Install an instance as both the ValueMessageBuilder and the Decoder's
+    /// DecoderObserver.  For every template it counts messages and bytes.  For every
+    /// field it counts bytes, presence map bits used and set, and how often the field
+    /// operator supplied the value without sending it explicitly.  It also estimates
+    /// what the field would have cost with each of the other operators that apply to
+    /// its type, so report() can suggest operator changes that would shrink the data.
+    ///
+    /// Estimates count a presence map bit as 1/7 of a byte and ignore the extra
+    /// byte occasionally needed for nullable values.
+    class TemplateAnalyzer
+      : public Messages::ValueMessageBuilder
+      , public Codecs::DecoderObserver
+    {
+    public:
+      TemplateAnalyzer();
+      virtual ~TemplateAnalyzer();
+
+      /// @brief Write the statistics gathered so far.
+      /// @param out is the stream to which the report will be written.
+      void report(std::ostream & out) const;
+
+      ////////////////////////////
+      // Implement DecoderObserver
+      virtual void beginMessage(const Codecs::Template & templ, size_t headerBytes);
+      virtual void fieldDecoded(
+        const Codecs::FieldInstruction & instruction,
+        size_t bytes,
+        bool pmapBitUsed,
+        bool pmapBitSet);
+      virtual void endMessage(const Codecs::Template & templ, size_t messageBytes);
+
+      ////////////////////////////
+      // Implement ValueMessageBuilder
+      virtual const std::string & getApplicationType()const;
+      virtual const std::string & getApplicationTypeNs()const;
+      virtual void addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const int64 value);
+      virtual void addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const uint64 value);
+      virtual void addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const int32 value);
+      virtual void addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const uint32 value);
+      virtual void addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const int16 value);
+      virtual void addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const uint16 value);
+      virtual void addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const int8 value);
+      virtual void addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const uchar value);
+      virtual void addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const Decimal& value);
+      virtual void addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const unsigned char * value, size_t length);
+      virtual Messages::ValueMessageBuilder & startMessage(
+        const std::string & applicationType,
+        const std::string & applicationTypeNamespace,
+        size_t size);
+      virtual bool endMessage(Messages::ValueMessageBuilder & messageBuilder);
+      virtual bool ignoreMessage(Messages::ValueMessageBuilder & messageBuilder);
+      virtual Messages::ValueMessageBuilder & startSequence(
+        const Messages::FieldIdentity & identity,
+        const std::string & applicationType,
+        const std::string & applicationTypeNamespace,
+        size_t fieldCount,
+        const Messages::FieldIdentity & lengthIdentity,
+        size_t length);
+      virtual void endSequence(
+        const Messages::FieldIdentity & identity,
+        Messages::ValueMessageBuilder & sequenceBuilder);
+      virtual Messages::ValueMessageBuilder & startSequenceEntry(
+        const std::string & applicationType,
+        const std::string & applicationTypeNamespace,
+        size_t size) ;
+      virtual void endSequenceEntry(Messages::ValueMessageBuilder & entry);
+      virtual Messages::ValueMessageBuilder & startGroup(
+        const Messages::FieldIdentity & identity,
+        const std::string & applicationType,
+        const std::string & applicationTypeNamespace,
+        size_t size);
+      virtual void endGroup(
+        const Messages::FieldIdentity & identity,
+        Messages::ValueMessageBuilder & groupBuilder);
+
+      ///////////////////
+      // Implement Logger
+      virtual bool wantLog(unsigned short level);
+      virtual bool logMessage(unsigned short level, const std::string & logMessage);
+      virtual bool reportDecodingError(const std::string & errorMessage);
+      virtual bool reportCommunicationError(const std::string & errorMessage);
+
+    private:
+      /// Operators for which an alternative cost is estimated.
+      enum Alternative
+      {
+        ALT_NONE,
+        ALT_COPY,
+        ALT_INCREMENT,
+        ALT_DELTA,
+        ALT_TAIL,
+        ALT_COUNT
+      };
+
+      /// The most recent value decoded for a field.
+      struct Value
+      {
+        enum Kind
+        {
+          ABSENT,
+          UNSIGNED,
+          SIGNED,
+          DECIMAL,
+          STRING
+        };
+        Value();
+        void clear();
+        Kind kind_;
+        uint64 unsigned_;
+        int64 signed_;
+        Decimal decimal_;
+        std::string string_;
+      };
+
+      struct FieldStatistics
+      {
+        FieldStatistics();
+        std::string name_;
+        ValueType::Type type_;
+        Codecs::FieldOp::OpType opType_;
+        bool mandatory_;
+        bool compound_;
+        size_t count_;
+        size_t present_;
+        size_t bytes_;
+        size_t pmapBitsUsed_;
+        size_t pmapBitsSet_;
+        /// estimated costs in sevenths of a byte (one presence map bit == 1)
+        size_t alternativeCost_[ALT_COUNT];
+        Value previous_;
+      };
+      typedef std::vector<FieldStatistics> FieldStatisticsVector;
+      typedef std::map<const Codecs::FieldInstruction *, size_t> FieldIndex;
+
+      struct TemplateStatistics
+      {
+        TemplateStatistics();
+        std::string name_;
+        template_id_t id_;
+        size_t messages_;
+        size_t bytes_;
+        size_t headerBytes_;
+        FieldStatisticsVector fields_;
+        FieldIndex index_;
+      };
+      typedef std::map<template_id_t, TemplateStatistics> TemplateStatisticsMap;
+
+    private:
+      void estimateAlternatives(FieldStatistics & field);
+      void reportField(std::ostream & out, const FieldStatistics & field)const;
+      static Alternative currentAlternative(Codecs::FieldOp::OpType opType);
+      static const char * alternativeName(Alternative alternative);
+
+    private:
+      std::string applicationType_;
+      std::string applicationTypeNamespace_;
+      TemplateStatisticsMap templates_;
+      TemplateStatistics * current_;
+      Value value_;
+    };
+  }
+}
+#endif /* TEMPLATEANALYZER_H */
@@ -5,8 +5,6 @@
 
 #include <Examples/ExamplesPch.h>
 #include "ValueToFix.h"
-#include <Messages/FieldIdentity.h>
-#include <Common/Decimal.h>
 
 using namespace QuickFAST;
 using namespace Examples;
@@ -54,152 +52,10 @@ ValueToFix::reportCommunicationError(const std::string & errorMessage)
   return false;
 }
 
-const std::string &
-ValueToFix::getApplicationType()const
-{
-  return applicationType_;
-}
-
-const std::string &
-ValueToFix::getApplicationTypeNs()const
-{
-  return applicationTypeNamespace_;
-}
-
-void
-ValueToFix::addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const int64 value)
-{
-  out_ << identity.id() << '=' << value << '\x01';
-}
-
-void
-ValueToFix::addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const uint64 value)
-{
-  out_ << identity.id() << '=' << value << '\x01';
-}
-
-void
-ValueToFix::addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const int32 value)
-{
-  out_ << identity.id() << '=' << value << '\x01';
-}
-
-void
-ValueToFix::addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const uint32 value)
-{
-  out_ << identity.id() << '=' << value << '\x01';
-}
-
-void
-ValueToFix::addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const int16 value)
-{
-  out_ << identity.id() << '=' << value << '\x01';
-}
-
-void
-ValueToFix::addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const uint16 value)
-{
-  out_ << identity.id() << '=' << value << '\x01';
-}
-
-void
-ValueToFix::addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const int8 value)
-{
-  out_ << identity.id() << '=' << (short)(value) << '\x01';
-}
-
-void
-ValueToFix::addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const uchar value)
-{
-  out_ << identity.id() << '=' << (unsigned short)(value) << '\x01';
-}
-
-void
-ValueToFix::addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const Decimal& value)
-{
-  std::string v;
-  value.toString(v);
-  out_ << identity.id() << '=' << v << '\x01';
-}
-
-void
-ValueToFix::addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const unsigned char * value, size_t length)
-{
-  out_ << identity.id() << '=' << std::string(reinterpret_cast<const char *>(value), length) << '\x01';
-}
-
-Messages::ValueMessageBuilder &
-ValueToFix::startMessage(
-  const std::string & applicationType,
-  const std::string & applicationTypeNamespace,
-  size_t size)
-{
-  applicationType_ = applicationType;
-  applicationTypeNamespace_ = applicationTypeNamespace;
-  return *this;
-}
-
 bool
-ValueToFix::endMessage(Messages::ValueMessageBuilder & messageBuilder)
+ValueToFix::deliverMessage(const char * message, size_t length)
 {
+  out_.write(message, length);
   out_ << recordSeparator_;
   return true;
 }
-
-bool
-ValueToFix::ignoreMessage(Messages::ValueMessageBuilder & messageBuilder)
-{
-  return true;
-}
-
-Messages::ValueMessageBuilder &
-ValueToFix::startSequence(
-  const Messages::FieldIdentity & identity,
-  const std::string & applicationType,
-  const std::string & applicationTypeNamespace,
-  size_t fieldCount,
-  const Messages::FieldIdentity & lengthIdentity,
-  size_t length)
-{
-  return *this;
-}
-
-void
-ValueToFix::endSequence(
-  const Messages::FieldIdentity & identity,
-  Messages::ValueMessageBuilder & sequenceBuilder)
-{
-}
-
-Messages::ValueMessageBuilder &
-ValueToFix::startSequenceEntry(
-  const std::string & applicationType,
-  const std::string & applicationTypeNamespace,
-  size_t size)
-{
-  return *this;
-}
-
-void
-ValueToFix::endSequenceEntry(Messages::ValueMessageBuilder & entry)
-{
-}
-
-Messages::ValueMessageBuilder &
-ValueToFix::startGroup(
-  const Messages::FieldIdentity & identity,
-  const std::string & applicationType,
-  const std::string & applicationTypeNamespace,
-  size_t size)
-{
-  return *this;
-}
-
-void
-ValueToFix::endGroup(
-  const Messages::FieldIdentity & identity,
-  Messages::ValueMessageBuilder & groupBuilder)
-{
-}
-
-
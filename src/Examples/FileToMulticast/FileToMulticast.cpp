@@ -26,6 +26,7 @@ FileToMulticast::FileToMulticast()
 , pauseEveryPass_(false)
 , pauseEveryMessage_(false)
 , verbose_(false)
+, paced_(false)
 , dataFile_(0)
 , strand_(ioService_)
 , timer_(ioService_)
@@ -109,6 +110,12 @@ FileToMulticast::parseSingleArg(int argc, char * argv[])
       pauseEveryPass_ = true;
       consumed = 1;
     }
+    else if(opt == "-spin" && argc > 1)
+    {
+      replayClock_.setSpinNanoseconds(boost::lexical_cast<uint64>(argv[1]) * 1000);
+      paced_ = true;
+      consumed = 2;
+    }
     else if(opt == "-v")
     {
       verbose_ = !verbose_;
@@ -136,6 +143,9 @@ FileToMulticast::usage(std::ostream & out) const
   out << "  -r burst/sec  : Rate at which to send bursts of messages expressed as bursts per second (default = 2000)" << std::endl;
   out << "                : zero means send continuously." << std::endl;
   out << "  -b msg/burst  : Messages per burst(default = 1)" << std::endl;
+  out << "  -spin usec    : Pace bursts with a spinning clock rather than a timer." << std::endl;
+  out << "                  Spin for the last usec before each burst is due (200 is typical)." << std::endl;
+  out << "                  Reports achieved vs. target rate and send lag." << std::endl;
   out << "  -c count      : How many times to send the file (passes)" << std::endl;
   out << "                  (default 1; 0 means forever.)" << std::endl;
   out << "  -pausemessage : Wait for 'Enter' before every message." << std::endl;
@@ -263,10 +273,17 @@ FileToMulticast::run()
         << "Largest is " << bufferSize_ << " bytes." << std::endl;
     }
 
-    strand_.dispatch(
-        strand_.wrap(boost::bind(&FileToMulticast::sendBurst, this)));
     StopWatch lapse;
-    this->ioService_.run();
+    if(paced_)
+    {
+      pacedSend();
+    }
+    else
+    {
+      strand_.dispatch(
+          strand_.wrap(boost::bind(&FileToMulticast::sendBurst, this)));
+      this->ioService_.run();
+    }
     unsigned long sendLapse = lapse.freeze();
     std::cout << "sent "
       << totalMessageCount_
@@ -279,6 +296,10 @@ FileToMulticast::run()
       << std::fixed << std::setprecision(0)
       << 1000. * double(totalMessageCount_)/double(sendLapse) << " message/second.]"
       << std::endl;
+    if(paced_)
+    {
+      replayClock_.report(std::cout, "bursts");
+    }
 
 #ifdef _WIN32
     // On WIN32 if sender closes the socket before a localhost receiver
@@ -330,33 +351,88 @@ FileToMulticast::sendBurst()
         nMsg_ = 0;
       }
 
-      if(verbose_)
-      {
-        std::cout << "Send message #" << nMsg_ + 1 << " of " << messageIndex_.size() << std::endl;
-      }
-      if(pauseEveryMessage_)
+      sendMessage();
+    }
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << e.what() << std::endl;
+    ioService_.stopService();
+  }
+}
+
+void
+FileToMulticast::sendMessage()
+{
+  if(verbose_)
+  {
+    std::cout << "Send message #" << nMsg_ + 1 << " of " << messageIndex_.size() << std::endl;
+  }
+  if(pauseEveryMessage_)
+  {
+    waitForEnter();
+    // don't try to catch up after a pause.
+    replayClock_.restart();
+  }
+
+  // then send this message
+  const MessagePosition & position = messageIndex_[nMsg_];
+  nMsg_ += 1;
+  totalMessageCount_ += 1;
+  size_t messageStart = position.first;
+  size_t messageLength = position.second;
+  fseek(dataFile_,  long(messageStart), SEEK_SET);
+  assert(messageLength <= bufferSize_);
+  size_t bytesRead = fread(buffer_.get(), 1, messageLength, dataFile_);
+  if(bytesRead == 0){} // avoid "Unused local" warning
+  assert (bytesRead == messageLength);
+  sender_->send(boost::asio::buffer(buffer_.get(), messageLength));
+}
+
+void
+FileToMulticast::pacedSend()
+{
+  // Burst n is due n * sendMicroseconds_ after the first one.
+  // The schedule is absolute, so time lost on one burst is made up on the next.
+  uint64 burstTime = 0;
+  try
+  {
+    bool more = !messageIndex_.empty();
+    while(more)
+    {
+      replayClock_.waitFor(burstTime);
+      burstTime += uint64(sendMicroseconds_) * 1000;
+      for(size_t nBurstMsg = 0; more && nBurstMsg < burst_; ++nBurstMsg)
       {
-        waitForEnter();
+        if(nMsg_ >= messageIndex_.size())
+        {
+          // completed a pass;  count it and see if we should stop or pause
+          nPass_ += 1;
+          more = nPass_ < sendCount_ || sendCount_ == 0;
+          if(more)
+          {
+            if(verbose_)
+            {
+              std::cout << "Begin pass #" << nPass_ << " of " << sendCount_ << std::endl;
+            }
+            if(pauseEveryPass_)
+            {
+              waitForEnter();
+              replayClock_.restart();
+            }
+            nMsg_ = 0;
+          }
+        }
+        if(more)
+        {
+          sendMessage();
+        }
       }
-
-      // then send this message
-      const MessagePosition & position = messageIndex_[nMsg_];
-      nMsg_ += 1;
-      totalMessageCount_ += 1;
-      size_t messageStart = position.first;
-      size_t messageLength = position.second;
-      fseek(dataFile_,  long(messageStart), SEEK_SET);
-      assert(messageLength <= bufferSize_);
-      size_t bytesRead = fread(buffer_.get(), 1, messageLength, dataFile_);
-      if(bytesRead == 0){} // avoid "Unused local" warning
-      assert (bytesRead == messageLength);
-      sender_->send(boost::asio::buffer(buffer_.get(), messageLength));
     }
   }
   catch (std::exception& e)
   {
     std::cerr << e.what() << std::endl;
-    ioService_.stopService();
   }
 }
 
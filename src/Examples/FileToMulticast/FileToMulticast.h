@@ -8,6 +8,7 @@
 #include <Communication/AsioService.h>
 #include <Communication/MulticastSender_fwd.h>
 #include <Communication/BufferRecycler.h>
+#include <Examples/ReplayClock.h>
 #include <stdio.h>
 
 namespace QuickFAST{
@@ -21,6 +22,11 @@ namespace QuickFAST{
     ///
     /// Use the -? command line option for more information.
     ///
+    /// Bursts are normally scheduled with an asio timer.  With the -spin option
+    /// they are released on an absolute schedule by a spinning clock instead,
+    /// which holds the requested rate much more closely, and the achieved rate
+    /// and send lag are reported.
+    ///
     /// This program is not really FAST-aware. It is just part of a testing
     /// framework for other programs.
     class FileToMulticast : public Application::CommandArgHandler, public Communication::BufferRecycler
@@ -46,6 +52,8 @@ namespace QuickFAST{
     private:
       bool parseIndexFile();
       void sendBurst();
+      void sendMessage();
+      void pacedSend();
 
     private:
       virtual int parseSingleArg(int argc, char * argv[]);
@@ -62,6 +70,8 @@ namespace QuickFAST{
       bool pauseEveryPass_;
       bool pauseEveryMessage_;
       bool verbose_;
+      bool paced_;
+      ReplayClock replayClock_;
 
       Communication::AsioService ioService_;
       boost::asio::strand strand_;
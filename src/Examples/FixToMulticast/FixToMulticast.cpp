@@ -0,0 +1,520 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#include <Examples/ExamplesPch.h>
+#include "FixToMulticast.h"
+#include <Communication/MulticastSender.h>
+#include <Communication/LinkedBuffer.h>
+#include <Codecs/XMLTemplateParser.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/Encoder.h>
+#include <Codecs/FixMessageAccessor.h>
+#include <Examples/StopWatch.h>
+using namespace QuickFAST;
+using namespace Examples;
+
+namespace {
+  const uint32 msgTypeTag = 35;
+  // datagrams the queued sender may hold before encoding waits
+  const size_t queuedBufferLimit = 1024;
+}
+
+FixToMulticast::FixToMulticast()
+: portNumber_(13014)
+, sendAddress_("224.1.2.133")
+, defaultTemplateId_(0)
+, haveDefaultTemplate_(false)
+, delimiter_('\x01')
+, sendCount_(1)
+, messagesPerDatagram_(1)
+, resetEachDatagram_(false)
+, noSend_(false)
+, verbose_(false)
+, sendBatch_(1)
+, packetRate_(0.0)
+, bitRate_(0.0)
+, burst_(1)
+, queued_(false)
+, pendingMessages_(0)
+, messageCount_(0)
+, skippedCount_(0)
+, datagramCount_(0)
+, fastBytes_(0)
+{
+}
+
+FixToMulticast::~FixToMulticast()
+{
+}
+
+bool
+FixToMulticast::init(int argc, char * argv[])
+{
+  commandArgParser_.addHandler(this);
+  return commandArgParser_.parse(argc, argv);
+}
+
+int
+FixToMulticast::parseSingleArg(int argc, char * argv[])
+{
+  int consumed = 0;
+  std::string opt(argv[0]);
+  try
+  {
+    if(opt == "-t" && argc > 1)
+    {
+      templateFileName_ = argv[1];
+      consumed = 2;
+    }
+    else if(opt == "-f" && argc > 1)
+    {
+      fixFileName_ = argv[1];
+      consumed = 2;
+    }
+    else if(opt == "-m" && argc > 1)
+    {
+      std::string mapping(argv[1]);
+      size_t equal = mapping.find('=');
+      if(equal != std::string::npos && equal > 0)
+      {
+        msgTypes_[mapping.substr(0, equal)] =
+          boost::lexical_cast<template_id_t>(mapping.substr(equal + 1));
+        consumed = 2;
+      }
+    }
+    else if(opt == "-tid" && argc > 1)
+    {
+      defaultTemplateId_ = boost::lexical_cast<template_id_t>(argv[1]);
+      haveDefaultTemplate_ = true;
+      consumed = 2;
+    }
+    else if(opt == "-d" && argc > 1)
+    {
+      std::string delimiter(argv[1]);
+      if(delimiter == "soh" || delimiter == "SOH")
+      {
+        delimiter_ = '\x01';
+        consumed = 2;
+      }
+      else if(delimiter.size() == 1)
+      {
+        delimiter_ = delimiter[0];
+        consumed = 2;
+      }
+    }
+    else if(opt == "-p" && argc > 1)
+    {
+      portNumber_ = boost::lexical_cast<unsigned short>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-a" && argc > 1)
+    {
+      sendAddress_ = argv[1];
+      consumed = 2;
+    }
+    else if(opt == "-c" && argc > 1)
+    {
+      sendCount_ = boost::lexical_cast<size_t>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-b" && argc > 1)
+    {
+      messagesPerDatagram_ = boost::lexical_cast<size_t>(argv[1]);
+      if(messagesPerDatagram_ > 0)
+      {
+        consumed = 2;
+      }
+    }
+    else if(opt == "-sendbatch" && argc > 1)
+    {
+      sendBatch_ = boost::lexical_cast<size_t>(argv[1]);
+      queued_ = true;
+      consumed = 2;
+    }
+    else if(opt == "-pps" && argc > 1)
+    {
+      packetRate_ = boost::lexical_cast<double>(argv[1]);
+      queued_ = true;
+      consumed = 2;
+    }
+    else if(opt == "-bps" && argc > 1)
+    {
+      bitRate_ = boost::lexical_cast<double>(argv[1]);
+      queued_ = true;
+      consumed = 2;
+    }
+    else if(opt == "-burst" && argc > 1)
+    {
+      burst_ = boost::lexical_cast<size_t>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-reset")
+    {
+      resetEachDatagram_ = true;
+      consumed = 1;
+    }
+    else if(opt == "-nosend")
+    {
+      noSend_ = true;
+      consumed = 1;
+    }
+    else if(opt == "-v")
+    {
+      verbose_ = !verbose_;
+      consumed = 1;
+    }
+  }
+  catch (std::exception & ex)
+  {
+    std::cerr << ex.what() << " while interpreting " << opt << std::endl;
+    consumed = 0;
+  }
+  return consumed;
+}
+
+void
+FixToMulticast::usage(std::ostream & out) const
+{
+  out << "  -t file       : Template file (required)" << std::endl;
+  out << "  -f file       : FIX log containing the messages to send (required)" << std::endl;
+  out << "  -m type=tid   : Encode messages with MsgType(35) = type using template tid." << std::endl;
+  out << "                  May be repeated." << std::endl;
+  out << "  -tid tid      : Template for messages with no -m mapping." << std::endl;
+  out << "                  Unmapped messages are skipped if this is not given." << std::endl;
+  out << "  -d delimiter  : FIX field delimiter: a single character or soh (default soh)" << std::endl;
+  out << "  -a dotted_ip  : Multicast send address (default is " << sendAddress_ << ")" << std::endl;
+  out << "  -p port       : Multicast port number (default " << portNumber_ << ")" << std::endl;
+  out << "  -b msg/packet : FAST messages per datagram (default 1)" << std::endl;
+  out << "  -reset        : Reset the encoder at the start of each datagram." << std::endl;
+  out << "  -sendbatch n  : Queue datagrams and send up to n per system call (Linux sendmmsg)." << std::endl;
+  out << "  -pps rate     : Queue datagrams and pace them to rate packets per second." << std::endl;
+  out << "  -bps rate     : Queue datagrams and pace them to rate bits per second of payload." << std::endl;
+  out << "  -burst n      : With -pps, packets (with -bps, datagrams of 1500 bytes)" << std::endl;
+  out << "                  that may go back to back (default 1)" << std::endl;
+  out << "  -c count      : How many times to send the file (passes) (default 1)" << std::endl;
+  out << "  -nosend       : Parse and encode only; measures the translation rate." << std::endl;
+  out << "  -v            : Noise to the console while it runs" << std::endl;
+}
+
+bool
+FixToMulticast::applyArgs()
+{
+  bool ok = true;
+  try
+  {
+    if(templateFileName_.empty())
+    {
+      ok = false;
+      std::cerr << "ERROR: -t [templatefile] option is required." << std::endl;
+    }
+    if(fixFileName_.empty())
+    {
+      ok = false;
+      std::cerr << "ERROR: -f [fixfile] option is required." << std::endl;
+    }
+    if(!ok)
+    {
+      commandArgParser_.usage(std::cerr);
+      return false;
+    }
+
+    std::ifstream templateFile(templateFileName_.c_str(), std::ios::in
+#ifdef _WIN32
+      | std::ios::binary
+#endif
+      );
+    if(!templateFile.good())
+    {
+      std::cerr << "ERROR: Can't open template file: "
+        << templateFileName_
+        << std::endl;
+      return false;
+    }
+    Codecs::XMLTemplateParser parser;
+    Codecs::TemplateRegistryPtr registry = parser.parse(templateFile);
+    encoder_.reset(new Codecs::Encoder(registry));
+    accessor_.reset(new Codecs::FixMessageAccessor(registry, delimiter_));
+
+    ok = loadFixFile();
+
+    if(ok && !noSend_)
+    {
+      sender_.reset(new Communication::MulticastSender(
+        ioService_,
+        *this,
+        sendAddress_, portNumber_));
+      sender_->setSendBatch(sendBatch_);
+      if(bitRate_ > 0.0)
+      {
+        sender_->setBitRate(bitRate_, burst_ * 1500);
+      }
+      else
+      {
+        sender_->setPacketRate(packetRate_, burst_);
+      }
+    }
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << "Exception: " << e.what() << "\n";
+    ok = false;
+  }
+  return ok;
+}
+
+bool
+FixToMulticast::loadFixFile()
+{
+  std::ifstream fixFile(fixFileName_.c_str(), std::ios::in | std::ios::binary);
+  if(!fixFile.good())
+  {
+    std::cerr << "ERROR: Can't open FIX file: "
+      << fixFileName_
+      << std::endl;
+    return false;
+  }
+  fixFile.seekg(0, std::ios::end);
+  size_t fileSize = size_t(fixFile.tellg());
+  fixFile.seekg(0, std::ios::beg);
+  fixData_.resize(fileSize);
+  if(fileSize > 0)
+  {
+    fixFile.read(&fixData_[0], fileSize);
+  }
+
+  // A message runs from "8=" through the delimiter that ends the CheckSum(10) field.
+  // Anything else in the log (timestamps, line breaks, etc.) is ignored.
+  const std::string checksum = std::string(1, delimiter_) + "10=";
+  size_t pos = 0;
+  while((pos = fixData_.find("8=FIX", pos)) != std::string::npos)
+  {
+    if(pos > 0 && isdigit(static_cast<unsigned char>(fixData_[pos - 1])))
+    {
+      pos += 1;
+      continue;
+    }
+    size_t end = fixData_.find(checksum, pos);
+    if(end != std::string::npos)
+    {
+      end = fixData_.find(delimiter_, end + checksum.size());
+    }
+    if(end == std::string::npos)
+    {
+      // no checksum: the message ends at the end of the line
+      end = fixData_.find_first_of("\r\n", pos);
+      if(end == std::string::npos)
+      {
+        end = fixData_.size();
+      }
+    }
+    else
+    {
+      end += 1;
+    }
+    messageIndex_.push_back(MessagePosition(pos, end - pos));
+    pos = end;
+  }
+  if(messageIndex_.empty())
+  {
+    std::cerr << "ERROR: No FIX messages found in " << fixFileName_ << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool
+FixToMulticast::chooseTemplate(template_id_t & templateId)
+{
+  const char * msgType;
+  size_t length;
+  if(!msgTypes_.empty() && accessor_->getTagValue(msgTypeTag, msgType, length))
+  {
+    MsgTypeMap::const_iterator it = msgTypes_.find(std::string(msgType, length));
+    if(it != msgTypes_.end())
+    {
+      templateId = it->second;
+      return true;
+    }
+  }
+  templateId = defaultTemplateId_;
+  return haveDefaultTemplate_;
+}
+
+void
+FixToMulticast::flush()
+{
+  if(pendingMessages_ == 0)
+  {
+    return;
+  }
+  size_t size = boost::asio::buffer_size(destination_);
+  fastBytes_ += size;
+  if(!noSend_ && queued_)
+  {
+    Communication::LinkedBuffer * buffer = getBuffer(size);
+    size_t used = 0;
+    for(size_t nPart = 0; nPart < destination_.size(); ++nPart)
+    {
+      const WorkingBuffer & part = destination_[nPart];
+      std::memcpy(buffer->get() + used, part.begin(), part.size());
+      used += part.size();
+    }
+    buffer->setUsed(used);
+    sender_->send(buffer);
+  }
+  else if(!noSend_)
+  {
+    sender_->send(destination_);
+  }
+  destination_.clear();
+  pendingMessages_ = 0;
+  datagramCount_ += 1;
+  if(resetEachDatagram_)
+  {
+    encoder_->reset();
+  }
+}
+
+int
+FixToMulticast::run()
+{
+  try
+  {
+    if(!noSend_)
+    {
+      sender_->initializeSender();
+      if(queued_)
+      {
+        sender_->open();
+        sender_->runThreads(1, false);
+      }
+    }
+    if(verbose_)
+    {
+      std::cout << "Translating " << messageIndex_.size() << " FIX messages." << std::endl;
+    }
+
+    size_t fixBytes = 0;
+    StopWatch lapse;
+    for(size_t nPass = 0; nPass < sendCount_; ++nPass)
+    {
+      for(size_t nMsg = 0; nMsg < messageIndex_.size(); ++nMsg)
+      {
+        const MessagePosition & position = messageIndex_[nMsg];
+        template_id_t templateId;
+        if(!accessor_->parse(fixData_.data() + position.first, position.second)
+          || !chooseTemplate(templateId))
+        {
+          skippedCount_ += 1;
+          continue;
+        }
+        try
+        {
+          encoder_->encodeMessage(destination_, templateId, *accessor_);
+        }
+        catch (std::exception & ex)
+        {
+          if(verbose_)
+          {
+            std::cerr << "Message #" << nMsg + 1 << ": " << ex.what() << std::endl;
+          }
+          // discard whatever was encoded for this datagram; the dictionary may be suspect.
+          destination_.clear();
+          pendingMessages_ = 0;
+          encoder_->reset();
+          skippedCount_ += 1;
+          continue;
+        }
+        messageCount_ += 1;
+        fixBytes += position.second;
+        if(++pendingMessages_ >= messagesPerDatagram_)
+        {
+          flush();
+        }
+      }
+    }
+    flush();
+    if(!noSend_ && queued_)
+    {
+      // Let the queue drain.
+      sender_->stop();
+      sender_->joinThreads();
+    }
+    unsigned long sendLapse = lapse.freeze();
+    if(sendLapse == 0)
+    {
+      sendLapse = 1;
+    }
+    std::cout << (noSend_ ? "translated " : "sent ")
+      << messageCount_
+      << " messages in "
+      << datagramCount_
+      << " datagrams in "
+      << sendLapse
+      << " milliseconds. ["
+      << std::fixed << std::setprecision(0)
+      << 1000. * double(messageCount_)/double(sendLapse) << " message/second. "
+      << std::setprecision(1)
+      << double(fixBytes)/1000./double(sendLapse) << " FIX MB/second in. "
+      << double(fastBytes_)/1000./double(sendLapse) << " FAST MB/second out.]"
+      << std::endl;
+    if(skippedCount_ != 0)
+    {
+      std::cout << "Skipped " << skippedCount_ << " messages." << std::endl;
+    }
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << e.what() << std::endl;
+  }
+  return 0;
+}
+
+void
+FixToMulticast::fini()
+{
+}
+
+Communication::LinkedBuffer *
+FixToMulticast::getBuffer(size_t size)
+{
+  boost::mutex::scoped_lock lock(bufferMutex_);
+  while(idleBuffers_.empty() && bufferLifetimes_.size() >= queuedBufferLimit)
+  {
+    // The pacer is holding them; wait for one to be sent.
+    bufferAvailable_.wait(lock);
+  }
+  if(!idleBuffers_.empty() && idleBuffers_.back()->capacity() >= size)
+  {
+    Communication::LinkedBuffer * buffer = idleBuffers_.back();
+    idleBuffers_.pop_back();
+    return buffer;
+  }
+  if(!idleBuffers_.empty())
+  {
+    // too small: replace it
+    Communication::LinkedBuffer * small = idleBuffers_.back();
+    idleBuffers_.pop_back();
+    for(size_t nBuffer = 0; nBuffer < bufferLifetimes_.size(); ++nBuffer)
+    {
+      if(bufferLifetimes_[nBuffer].get() == small)
+      {
+        bufferLifetimes_.erase(bufferLifetimes_.begin() + nBuffer);
+        break;
+      }
+    }
+  }
+  boost::shared_ptr<Communication::LinkedBuffer> buffer(
+    new Communication::LinkedBuffer(std::max(size, size_t(1500))));
+  bufferLifetimes_.push_back(buffer);
+  return buffer.get();
+}
+
+void
+FixToMulticast::recycle(Communication::LinkedBuffer * emptyBuffer)
+{
+  boost::mutex::scoped_lock lock(bufferMutex_);
+  idleBuffers_.push_back(emptyBuffer);
+  bufferAvailable_.notify_one();
+}
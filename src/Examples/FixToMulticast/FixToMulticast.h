@@ -0,0 +1,112 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifndef FIXTOMULTICAST_H
+#define FIXTOMULTICAST_H
+#include <Application/CommandArgParser.h>
+#include <Communication/AsioService.h>
+#include <Communication/MulticastSender_fwd.h>
+#include <Communication/BufferRecycler.h>
+#include <Codecs/FixMessageAccessor_fwd.h>
+#include <Codecs/Encoder_fwd.h>
+#include <Codecs/DataDestination.h>
+
+namespace QuickFAST{
+  namespace Examples{
+
+    /// @brief Translate a FIX log into FAST and multicast the result.
+    ///
+    /// The FIX log is read into memory.  Each FIX message (from "8=" through the
+    /// CheckSum field) is indexed by a FixMessageAccessor, encoded directly from
+    /// the raw FIX text, and sent as one or more FAST messages per datagram.
+    ///
+    /// The template for each message is chosen by MsgType(35) using -m options,
+    /// falling back to the template given with -tid.
+    ///
+    /// At the end of the run it reports messages per second.  Use -nosend to
+    /// measure the parse and encode rate by itself.
+    ///
+    /// With -sendbatch, -pps or -bps each datagram is copied to a LinkedBuffer
+    /// and queued to the sender, which sends batches and paces them.  Otherwise
+    /// each datagram is sent synchronously as soon as it is encoded.
+    ///
+    /// Use the -? command line option for more information.
+    class FixToMulticast : public Application::CommandArgHandler, public Communication::BufferRecycler
+    {
+    public:
+      FixToMulticast();
+      ~FixToMulticast();
+
+      /// @brief parse command line arguments, and initialize.
+      /// @param argc from main
+      /// @param argv from main
+      /// @returns true if everything is ok.
+      bool init(int argc, char * argv[]);
+      /// @brief run the program
+      /// @returns a value to be used as an exit code of the program (0 means all is well)
+      int run();
+      /// @brief do final cleanup after a run.
+      void fini();
+
+    private:
+      void recycle(Communication::LinkedBuffer * emptyBuffer);
+
+    private:
+      bool loadFixFile();
+      bool chooseTemplate(template_id_t & templateId);
+      void flush();
+      Communication::LinkedBuffer * getBuffer(size_t size);
+
+    private:
+      virtual int parseSingleArg(int argc, char * argv[]);
+      virtual void usage(std::ostream & out) const;
+      virtual bool applyArgs();
+    private:
+      unsigned short portNumber_;
+      std::string sendAddress_;
+      std::string templateFileName_;
+      std::string fixFileName_;
+      typedef std::map<std::string, template_id_t> MsgTypeMap;
+      MsgTypeMap msgTypes_;
+      template_id_t defaultTemplateId_;
+      bool haveDefaultTemplate_;
+      char delimiter_;
+      size_t sendCount_;
+      size_t messagesPerDatagram_;
+      bool resetEachDatagram_;
+      bool noSend_;
+      bool verbose_;
+      size_t sendBatch_;
+      double packetRate_;
+      double bitRate_;
+      size_t burst_;
+      bool queued_;
+
+      Communication::AsioService ioService_;
+      Application::CommandArgParser commandArgParser_;
+
+      std::string fixData_;
+      typedef std::pair<size_t, size_t> MessagePosition; // position in file: start, length
+      typedef std::vector<MessagePosition> MessageIndex;
+      MessageIndex messageIndex_;
+
+      boost::scoped_ptr<Codecs::Encoder> encoder_;
+      boost::scoped_ptr<Codecs::FixMessageAccessor> accessor_;
+      Codecs::DataDestination destination_;
+      size_t pendingMessages_;
+      size_t messageCount_;
+      size_t skippedCount_;
+      size_t datagramCount_;
+      size_t fastBytes_;
+      Communication::MulticastSenderPtr sender_;
+
+      /// Buffers for the queued sender; recycled by the sender's thread.
+      boost::mutex bufferMutex_;
+      boost::condition_variable bufferAvailable_;
+      std::vector<Communication::LinkedBuffer *> idleBuffers_;
+      std::vector<boost::shared_ptr<Communication::LinkedBuffer> > bufferLifetimes_;
+    };
+  }
+}
+#endif // FIXTOMULTICAST_H
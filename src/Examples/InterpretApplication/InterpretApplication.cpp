@@ -27,7 +27,10 @@ InterpretApplication::InterpretApplication()
 : configuration_(new Application::DecoderConfiguration)
 , console_(false)
 , fixOutput_(false)
+, analyze_(false)
 , threads_(1)
+, workers_(0)
+, rebalance_(0)
 , silent_(false)
 {
 }
@@ -61,11 +64,26 @@ InterpretApplication::parseSingleArg(int argc, char * argv[])
       threads_ = boost::lexical_cast<size_t>(argv[1]);
       consumed = 2;
     }
+    else if(opt == "-workers" && argc > 1)
+    {
+      workers_ = boost::lexical_cast<size_t>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-rebalance" && argc > 1)
+    {
+      rebalance_ = boost::lexical_cast<size_t>(argv[1]);
+      consumed = 2;
+    }
     else if(opt == "-ofix")
     {
       fixOutput_ = true;
       consumed = 1;
     }
+    else if(opt == "-analyze")
+    {
+      analyze_ = true;
+      consumed = 1;
+    }
     else if(opt == "-connection" && argc > 1)
     {
       if(!defaultConfiguration_)
@@ -124,7 +142,13 @@ InterpretApplication::usage(std::ostream & out) const
   out << "                          <r>esume.  : resubscribe after a pause." << std::endl;
   out << "                         Note that you must hit ENTER before the command will be recognized." << std::endl;
   out << std::endl;
+  out << "  -workers n           : Decode all connections with a pool of n worker threads." << std::endl;
+  out << "                         Each connection is decoded by one worker at a time." << std::endl;
+  out << "                         -threads sets the number of I/O threads.  Requires -multicast or -tcp." << std::endl;
+  out << "  -rebalance ms        : With -workers, even out the workers' loads every ms milliseconds." << std::endl;
   out << "  -ofix                : Write the output as newline separated FIX records." << std::endl;
+  out << "  -analyze             : Instead of interpreting messages, measure how efficiently the templates" << std::endl;
+  out << "                         encode the data and report per template and per field statistics." << std::endl;
   out << "  -buffer file         : Input from raw FAST message file into a buffer; decode from buffer." << std::endl;
   out << std::endl;
 }
@@ -163,13 +187,26 @@ InterpretApplication::run()
   try
   {
     MessageInterpreter handler(std::cout, silent_);
+    if(workers_ > 0)
+    {
+      channelManager_.reset(new Application::ChannelManager(workers_));
+      channelManager_->setIoThreads(threads_);
+      channelManager_->setRebalanceInterval(rebalance_);
+    }
     for(Configurations::const_iterator pConfig = configurations_.begin();
       pConfig != configurations_.end();
       ++pConfig)
     {
       Messages::ValueMessageBuilderPtr builder;
+      AnalyzerPtr analyzer;
 
-      if(fixOutput_)
+      if(analyze_)
+      {
+        analyzer.reset(new TemplateAnalyzer);
+        analyzers_.push_back(analyzer);
+        builder = analyzer;
+      }
+      else if(fixOutput_)
       {
         builder.reset(new ValueToFix(std::cout));
       }
@@ -179,20 +216,42 @@ InterpretApplication::run()
       }
       builders_.push_back(builder);
 
+      if(channelManager_)
+      {
+        std::string name;
+        (*pConfig)->getExtra("Name", name);
+        size_t channel = channelManager_->addChannel(name, *builder, **pConfig);
+        if(analyzer)
+        {
+          channelManager_->connection(channel).decoder().setObserver(analyzer.get());
+        }
+        continue;
+      }
+
       ConnectionPtr pConnection(new Application::DecoderConnection);
 
       pConnection->configure(*builder, **pConfig);
+      if(analyzer)
+      {
+        pConnection->decoder().setObserver(analyzer.get());
+      }
       connections_.push_back(pConnection);
     }
 
-    if(console_)
+    if(channelManager_)
+    {
+      // Runs until every connection stops.
+      channelManager_->run();
+      channelManager_->report(std::cout);
+    }
+    else if(console_)
     {
       // start threads to receive data, but reserve this thread for console input
       for(Connections::const_iterator pConnection = connections_.begin();
         pConnection != connections_.end();
         ++pConnection)
       {
-        (*pConnection)->receiver().runThreads(threads_, false);
+        (*pConnection)->runThreads(threads_, false);
       }
       bool more = true;
       while(more)
@@ -210,7 +269,7 @@ InterpretApplication::run()
               ++pConnection)
             {
               (*pConnection)->receiver().stop();
-              (*pConnection)->receiver().joinThreads();
+              (*pConnection)->joinThreads();
             }
           }
           else if (c == 'p')
@@ -275,21 +334,35 @@ InterpretApplication::run()
       {
         if(pConnection != connections_.end()-1)
         {
-          (*pConnection)->receiver().runThreads(threads_,  false);
+          (*pConnection)->runThreads(threads_,  false);
         }
         else
         {
-          (*pConnection)->receiver().runThreads(threads_ - 1, true);
+          (*pConnection)->runThreads(threads_ - 1, true);
         }
       }
-      connections_.pop_back(); // discard the last connection.  We've already joind it in runThreads
+      // The last connection has already been joined in runThreads
       for(Connections::const_iterator pConnection = connections_.begin();
-        pConnection != connections_.end();
+        pConnection != connections_.end() - 1;
         ++pConnection)
       {
-        (*pConnection)->receiver().joinThreads();
+        (*pConnection)->joinThreads();
       }
     }
+
+    for(Connections::const_iterator pConnection = connections_.begin();
+      pConnection != connections_.end();
+      ++pConnection)
+    {
+      (*pConnection)->reportPipeline(std::cout);
+    }
+
+    for(Analyzers::const_iterator pAnalyzer = analyzers_.begin();
+      pAnalyzer != analyzers_.end();
+      ++pAnalyzer)
+    {
+      (*pAnalyzer)->report(std::cout);
+    }
   }
 
   catch (std::exception & e)
@@ -9,6 +9,8 @@
 #include <Communication/Receiver_fwd.h>
 #include <Application/CommandArgParser.h>
 #include <Application/DecoderConnection.h>
+#include <Application/ChannelManager.h>
+#include <Examples/TemplateAnalyzer.h>
 
 namespace QuickFAST{
   namespace Examples{
@@ -46,6 +48,8 @@ namespace QuickFAST{
       typedef boost::shared_ptr<Application::DecoderConnection> ConnectionPtr;
       typedef std::vector<ConnectionPtr> Connections;
       typedef std::vector<Messages::ValueMessageBuilderPtr> Builders;
+      typedef boost::shared_ptr<TemplateAnalyzer> AnalyzerPtr;
+      typedef std::vector<AnalyzerPtr> Analyzers;
 
       // the currently active configuration
       ConfigurationPtr configuration_;
@@ -62,10 +66,18 @@ namespace QuickFAST{
       // the builders attached to the connections
       Builders builders_;
 
+      // the template analyzers (if -analyze) attached to the connections
+      Analyzers analyzers_;
+      // decodes all the connections (if -workers)
+      boost::scoped_ptr<Application::ChannelManager> channelManager_;
+
       std::string bufferFilename_;
       bool console_;
       bool fixOutput_;
+      bool analyze_;
       size_t threads_;
+      size_t workers_;
+      size_t rebalance_;
       bool silent_;
     };
   }
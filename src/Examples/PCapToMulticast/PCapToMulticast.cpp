@@ -30,6 +30,7 @@ PCapToMulticast::PCapToMulticast()
 , pauseEveryPass_(false)
 , pauseEveryMessage_(false)
 , verbose_(false)
+, timed_(false)
 , socket_(ioService_)
 , strand_(ioService_)
 , timer_(ioService_)
@@ -119,6 +120,18 @@ PCapToMulticast::parseSingleArg(int argc, char * argv[])
       pcapReader_.set64bit(true);
       consumed = 1;
     }
+    else if(opt == "-speed" && argc > 1)
+    {
+      std::string speed(argv[1]);
+      replayClock_.setSpeed(speed == "max" ? 0.0 : boost::lexical_cast<double>(speed));
+      timed_ = true;
+      consumed = 2;
+    }
+    else if(opt == "-spin" && argc > 1)
+    {
+      replayClock_.setSpinNanoseconds(boost::lexical_cast<uint64>(argv[1]) * 1000);
+      consumed = 2;
+    }
     else if(opt == "-v")
     {
       verbose_ = !verbose_;
@@ -142,6 +155,11 @@ PCapToMulticast::usage(std::ostream & out) const
   out << "  -r burst/sec       : Rate at which to send bursts of messages expressed as bursts per second (default = 2000)" << std::endl;
   out << "                     : zero means send continuously." << std::endl;
   out << "  -b msg/burst       : Messages per burst(default = 1)" << std::endl;
+  out << "  -speed x|max       : Send packets at their capture times; x is a speed multiplier" << std::endl;
+  out << "                       (0.5 = half speed, 10 = ten times faster, max = no delay)." << std::endl;
+  out << "                       Overrides -r and -b." << std::endl;
+  out << "  -spin usec         : With -speed: spin rather than sleep for the last usec" << std::endl;
+  out << "                       before each packet is due (default 200)." << std::endl;
   out << "  -c count           : How many times to send the file (passes)" << std::endl;
   out << "                       (default 1; 0 means forever.)" << std::endl;
   out << "  -pausemessage      : Wait for 'Enter' before every message." << std::endl;
@@ -189,10 +207,17 @@ PCapToMulticast::run()
       std::cout << " Configuring multicast: " << multicastAddress_ << '|' << sendAddress_ << ':' << portNumber_ << std::endl;
     }
 
-    strand_.dispatch(
-        strand_.wrap(boost::bind(&PCapToMulticast::sendBurst, this)));
     StopWatch lapse;
-    this->ioService_.run();
+    if(timed_)
+    {
+      replay();
+    }
+    else
+    {
+      strand_.dispatch(
+          strand_.wrap(boost::bind(&PCapToMulticast::sendBurst, this)));
+      this->ioService_.run();
+    }
     unsigned long sendLapse = lapse.freeze();
     std::cout << "sent "
       << totalMessageCount_
@@ -205,6 +230,10 @@ PCapToMulticast::run()
       << std::fixed << std::setprecision(0)
       << 1000. * double(totalMessageCount_)/double(sendLapse) << " message/second.]"
       << std::endl;
+    if(timed_)
+    {
+      replayClock_.report(std::cout);
+    }
 
 #ifdef _WIN32
     // On WIN32 if sender closes the socket before a localhost receiver
@@ -298,6 +327,65 @@ PCapToMulticast::sendBurst()
   }
 }
 
+void
+PCapToMulticast::replay()
+{
+  try
+  {
+    bool sentThisPass = false;
+    bool more = true;
+    while(more)
+    {
+      const unsigned char * msgBuffer = 0;
+      size_t bytesRead = 0;
+      if(!pcapReader_.read(msgBuffer, bytesRead))
+      {
+        // completed a pass;  count it and see if we should stop or pause
+        nPass_ += 1;
+        more = sentThisPass && (nPass_ < sendCount_ || sendCount_ == 0);
+        if(more)
+        {
+          if(verbose_)
+          {
+            std::cout << "Begin pass #" << nPass_ << " of " << sendCount_ << std::endl;
+          }
+          if(pauseEveryPass_)
+          {
+            waitForEnter();
+          }
+          nMsg_ = 0;
+          sentThisPass = false;
+          more = pcapReader_.rewind();
+          // capture times start over.
+          replayClock_.restart();
+        }
+      }
+      else
+      {
+        nMsg_ += 1;
+        totalMessageCount_ += 1;
+        sentThisPass = true;
+        if(verbose_)
+        {
+          std::cout << "Send message #" << nMsg_ << " (" << bytesRead << " bytes) captured at "
+            << pcapReader_.packetTime() << std::endl;
+        }
+        if(pauseEveryMessage_)
+        {
+          waitForEnter();
+          // don't try to catch up after a pause.
+          replayClock_.restart();
+        }
+        replayClock_.waitFor(pcapReader_.packetTime());
+        socket_.send_to(boost::asio::buffer(msgBuffer, bytesRead), endpoint_);
+      }
+    }
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << e.what() << std::endl;
+  }
+}
 
 void
 PCapToMulticast::fini()
@@ -8,6 +8,7 @@
 #define PCAP_SUPPORT_IS_HEREx
 #include <Application/CommandArgParser.h>
 #include <Communication/PCapReader.h>
+#include <Examples/ReplayClock.h>
 #include <boost/asio.hpp>
 #include <stdio.h>
 
@@ -22,6 +23,10 @@ namespace QuickFAST{
     ///
     /// Use the -? command line option for more information.
     ///
+    /// By default packets are sent in bursts at a fixed rate.  With the -speed
+    /// option they are sent at the times they were captured (scaled by the
+    /// speed factor) so the bursts in the original feed are reproduced.
+    ///
     /// This program is not really FAST-aware. It is just part of a testing
     /// framework for other programs.
     class PCapToMulticast : public Application::CommandArgHandler
@@ -43,6 +48,7 @@ namespace QuickFAST{
 
     private:
       void sendBurst();
+      void replay();
 
     private:
       virtual int parseSingleArg(int argc, char * argv[]);
@@ -61,6 +67,8 @@ namespace QuickFAST{
       bool force64_;
       size_t packetChecksumSize_;
       bool verbose_;
+      bool timed_;
+      ReplayClock replayClock_;
 
       boost::asio::io_service ioService_;
       boost::asio::ip::address multicastAddress_;
@@ -7,6 +7,7 @@
 #include "PerformanceTest.h"
 #include <Codecs/DataSourceStream.h>
 #include <Codecs/DataSourceBufferedStream.h>
+#include <Codecs/DataSourceBuffer.h>
 #include <Codecs/SynchronousDecoder.h>
 #include <Codecs/TemplateRegistry.h>
 #include <Codecs/GenericMessageBuilder.h>
@@ -24,6 +25,7 @@ PerformanceTest::PerformanceTest()
   : resetOnMessage_(false)
   , strict_(true)
   , useNullMessage_(false)
+  , mapFile_(false)
   , performanceFile_(0)
   , profileFile_(0)
   , head_(0)
@@ -72,6 +74,11 @@ PerformanceTest::parseSingleArg(int argc, char * argv[])
       fastFileName_ = argv[1];
       consumed = 2;
     }
+    else if(opt == "-m")
+    {
+      mapFile_ = true;
+      consumed = 1;
+    }
     else if(opt == "-profiler" && argc > 1)
     {
       profileFileName_ = argv[1];
@@ -126,6 +133,7 @@ PerformanceTest::usage(std::ostream & out) const
 {
   out << "  -t file     : Template file (required)" << std::endl;
   out << "  -f file     : FAST Message file (required)" << std::endl;
+  out << "  -m          : Map the FAST Message file into memory rather than reading it." << std::endl;
   out << "  -p file     : File to which performance measurements are written. (default standard output)" << std::endl;
   out << "  -profiler file : File to which profiler statistics are written (very optional)" << std::endl;
   out << "  -head n     : process only the first 'n' messages" << std::endl;
@@ -187,6 +195,17 @@ PerformanceTest::applyArgs()
           << std::endl;
       }
     }
+    if(ok && mapFile_)
+    {
+      if(!mappedFile_.open(fastFileName_))
+      {
+        ok = false;
+        std::cerr << "ERROR: Can't map FAST Message file: "
+          << fastFileName_
+          << std::endl;
+      }
+      mappedFile_.adviseSequential();
+    }
     if(ok && !performanceFileName_.empty())
     {
       performanceFile_ = new std::ofstream(performanceFileName_.c_str());
@@ -256,8 +275,17 @@ PerformanceTest::run()
       {
         std::cout << "Decoding input; pass " << nPass + 1 << " of " << count_ << std::endl;
       }
-      fastFile_.seekg(0, std::ios::beg);
-      Codecs::DataSourceBufferedStream source(fastFile_);
+      boost::scoped_ptr<Codecs::DataSource> sourcePtr;
+      if(mapFile_)
+      {
+        sourcePtr.reset(new Codecs::DataSourceBuffer(mappedFile_.data(), mappedFile_.size()));
+      }
+      else
+      {
+        fastFile_.seekg(0, std::ios::beg);
+        sourcePtr.reset(new Codecs::DataSourceBufferedStream(fastFile_));
+      }
+      Codecs::DataSource & source = *sourcePtr;
       if(echo_)
       {
         source.setEcho(std::cout, Codecs::DataSource::HEX, true, true);
@@ -7,6 +7,7 @@
 
 #include <Codecs/XMLTemplateParser.h>
 #include <Codecs/DataSource.h>
+#include <Communication/MemoryMappedFile.h>
 #include <Application/CommandArgParser.h>
 
 namespace QuickFAST{
@@ -45,6 +46,8 @@ namespace QuickFAST{
       std::ifstream templateFile_;
       std::string fastFileName_;
       std::ifstream fastFile_;
+      bool mapFile_;
+      Communication::MemoryMappedFile mappedFile_;
       std::string performanceFileName_;
       std::ostream * performanceFile_;
       std::string profileFileName_;
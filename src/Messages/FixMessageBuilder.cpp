@@ -0,0 +1,374 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+#include "FixMessageBuilder.h"
+#include <Messages/FieldIdentity.h>
+#include <Common/Decimal.h>
+
+using namespace ::QuickFAST;
+using namespace ::QuickFAST::Messages;
+
+namespace
+{
+  /// Identities beyond this are formatted but not cached (protects against transient identities)
+  const size_t maxCachedTags = 4096;
+  /// Enough for any 64 bit integer
+  const size_t maxDigits = 20;
+  /// Enough for "9=" plus the digits of the length and a delimiter
+  const size_t bodyLengthReserve = 2 + maxDigits + 1;
+
+  /// @brief Format an unsigned value right-aligned ending at end.
+  /// @returns a pointer to the first digit
+  char * formatUnsigned(uint64 value, char * end)
+  {
+    char * pos = end;
+    do
+    {
+      *--pos = char('0' + value % 10);
+      value /= 10;
+    } while(value != 0);
+    return pos;
+  }
+}
+
+FixMessageBuilder::FixMessageBuilder(const std::string & beginString)
+  : messageStart_(0)
+  , headerReserve_(0)
+  , delimiter_('\x01')
+{
+  setBeginString(beginString);
+}
+
+FixMessageBuilder::~FixMessageBuilder()
+{
+}
+
+void
+FixMessageBuilder::setBeginString(const std::string & beginString)
+{
+  beginString_ = beginString;
+  if(beginString_.empty())
+  {
+    headerReserve_ = 0;
+  }
+  else
+  {
+    // "8=" BeginString <delim> followed by BodyLength
+    headerReserve_ = 2 + beginString_.size() + 1 + bodyLengthReserve;
+  }
+}
+
+void
+FixMessageBuilder::setDelimiter(char delimiter)
+{
+  delimiter_ = delimiter;
+}
+
+const std::string &
+FixMessageBuilder::getApplicationType()const
+{
+  return applicationType_;
+}
+
+const std::string &
+FixMessageBuilder::getApplicationTypeNs()const
+{
+  return applicationTypeNamespace_;
+}
+
+bool
+FixMessageBuilder::appendTag(const FieldIdentity & identity)
+{
+  TagCache::const_iterator it = tags_.find(&identity);
+  if(it != tags_.end())
+  {
+    if(it->second.empty())
+    {
+      return false;
+    }
+    buffer_ += it->second;
+    return true;
+  }
+  std::string tag;
+  if(!identity.id().empty())
+  {
+    tag = identity.id();
+    tag += '=';
+  }
+  if(tags_.size() < maxCachedTags)
+  {
+    tags_[&identity] = tag;
+  }
+  if(tag.empty())
+  {
+    return false;
+  }
+  buffer_ += tag;
+  return true;
+}
+
+void
+FixMessageBuilder::appendUnsigned(uint64 value)
+{
+  char digits[maxDigits];
+  char * end = digits + maxDigits;
+  char * first = formatUnsigned(value, end);
+  buffer_.append(first, end - first);
+}
+
+void
+FixMessageBuilder::appendSigned(int64 value)
+{
+  if(value < 0)
+  {
+    buffer_ += '-';
+    appendUnsigned(uint64(0) - uint64(value));
+  }
+  else
+  {
+    appendUnsigned(uint64(value));
+  }
+}
+
+void
+FixMessageBuilder::appendDecimal(const Decimal & value)
+{
+  int64 mantissa = value.getMantissa();
+  int exponent = value.getExponent();
+  uint64 magnitude = uint64(mantissa);
+  if(mantissa < 0)
+  {
+    buffer_ += '-';
+    magnitude = uint64(0) - magnitude;
+  }
+  char digits[maxDigits];
+  char * end = digits + maxDigits;
+  char * first = formatUnsigned(magnitude, end);
+  size_t digitCount = end - first;
+  if(exponent >= 0)
+  {
+    buffer_.append(first, digitCount);
+    if(magnitude != 0)
+    {
+      buffer_.append(size_t(exponent), '0');
+    }
+  }
+  else
+  {
+    size_t places = size_t(-exponent);
+    if(digitCount <= places)
+    {
+      buffer_ += "0.";
+      buffer_.append(places - digitCount, '0');
+      buffer_.append(first, digitCount);
+    }
+    else
+    {
+      size_t whole = digitCount - places;
+      buffer_.append(first, whole);
+      buffer_ += '.';
+      buffer_.append(first + whole, places);
+    }
+  }
+}
+
+void
+FixMessageBuilder::addValue(const FieldIdentity & identity, ValueType::Type type, const int64 value)
+{
+  if(appendTag(identity))
+  {
+    appendSigned(value);
+    appendDelimiter();
+  }
+}
+
+void
+FixMessageBuilder::addValue(const FieldIdentity & identity, ValueType::Type type, const uint64 value)
+{
+  if(appendTag(identity))
+  {
+    appendUnsigned(value);
+    appendDelimiter();
+  }
+}
+
+void
+FixMessageBuilder::addValue(const FieldIdentity & identity, ValueType::Type type, const int32 value)
+{
+  addValue(identity, type, int64(value));
+}
+
+void
+FixMessageBuilder::addValue(const FieldIdentity & identity, ValueType::Type type, const uint32 value)
+{
+  addValue(identity, type, uint64(value));
+}
+
+void
+FixMessageBuilder::addValue(const FieldIdentity & identity, ValueType::Type type, const int16 value)
+{
+  addValue(identity, type, int64(value));
+}
+
+void
+FixMessageBuilder::addValue(const FieldIdentity & identity, ValueType::Type type, const uint16 value)
+{
+  addValue(identity, type, uint64(value));
+}
+
+void
+FixMessageBuilder::addValue(const FieldIdentity & identity, ValueType::Type type, const int8 value)
+{
+  addValue(identity, type, int64(value));
+}
+
+void
+FixMessageBuilder::addValue(const FieldIdentity & identity, ValueType::Type type, const uchar value)
+{
+  addValue(identity, type, uint64(value));
+}
+
+void
+FixMessageBuilder::addValue(const FieldIdentity & identity, ValueType::Type type, const Decimal& value)
+{
+  if(appendTag(identity))
+  {
+    appendDecimal(value);
+    appendDelimiter();
+  }
+}
+
+void
+FixMessageBuilder::addValue(const FieldIdentity & identity, ValueType::Type type, const unsigned char * value, size_t length)
+{
+  if(appendTag(identity))
+  {
+    buffer_.append(reinterpret_cast<const char *>(value), length);
+    appendDelimiter();
+  }
+}
+
+ValueMessageBuilder &
+FixMessageBuilder::startMessage(
+  const std::string & applicationType,
+  const std::string & applicationTypeNamespace,
+  size_t size)
+{
+  applicationType_ = applicationType;
+  applicationTypeNamespace_ = applicationTypeNamespace;
+  // leave room to insert the header in front of the body once its length is known
+  buffer_.clear();
+  buffer_.resize(headerReserve_);
+  messageStart_ = headerReserve_;
+  return *this;
+}
+
+void
+FixMessageBuilder::frameMessage()
+{
+  size_t bodyLength = buffer_.size() - headerReserve_;
+  char digits[maxDigits];
+  char * end = digits + maxDigits;
+  char * first = formatUnsigned(bodyLength, end);
+  size_t digitCount = end - first;
+
+  size_t headerLength = 2 + beginString_.size() + 1 + 2 + digitCount + 1;
+  messageStart_ = headerReserve_ - headerLength;
+  char * header = &buffer_[messageStart_];
+  *header++ = '8';
+  *header++ = '=';
+  memcpy(header, beginString_.data(), beginString_.size());
+  header += beginString_.size();
+  *header++ = delimiter_;
+  *header++ = '9';
+  *header++ = '=';
+  memcpy(header, first, digitCount);
+  header += digitCount;
+  *header++ = delimiter_;
+
+  unsigned int checksum = 0;
+  const unsigned char * pos = reinterpret_cast<const unsigned char *>(buffer_.data()) + messageStart_;
+  const unsigned char * stop = reinterpret_cast<const unsigned char *>(buffer_.data()) + buffer_.size();
+  while(pos < stop)
+  {
+    checksum += *pos++;
+  }
+  checksum %= 256;
+  buffer_ += "10=";
+  buffer_ += char('0' + checksum / 100);
+  buffer_ += char('0' + (checksum / 10) % 10);
+  buffer_ += char('0' + checksum % 10);
+  appendDelimiter();
+}
+
+bool
+FixMessageBuilder::endMessage(ValueMessageBuilder & messageBuilder)
+{
+  if(!beginString_.empty())
+  {
+    frameMessage();
+  }
+  return deliverMessage(buffer_.data() + messageStart_, buffer_.size() - messageStart_);
+}
+
+bool
+FixMessageBuilder::ignoreMessage(ValueMessageBuilder & messageBuilder)
+{
+  return true;
+}
+
+ValueMessageBuilder &
+FixMessageBuilder::startSequence(
+  const FieldIdentity & identity,
+  const std::string & applicationType,
+  const std::string & applicationTypeNamespace,
+  size_t fieldCount,
+  const FieldIdentity & lengthIdentity,
+  size_t length)
+{
+  if(appendTag(lengthIdentity))
+  {
+    appendUnsigned(length);
+    appendDelimiter();
+  }
+  return *this;
+}
+
+void
+FixMessageBuilder::endSequence(
+  const FieldIdentity & identity,
+  ValueMessageBuilder & sequenceBuilder)
+{
+}
+
+ValueMessageBuilder &
+FixMessageBuilder::startSequenceEntry(
+  const std::string & applicationType,
+  const std::string & applicationTypeNamespace,
+  size_t size)
+{
+  return *this;
+}
+
+void
+FixMessageBuilder::endSequenceEntry(ValueMessageBuilder & entry)
+{
+}
+
+ValueMessageBuilder &
+FixMessageBuilder::startGroup(
+  const FieldIdentity & identity,
+  const std::string & applicationType,
+  const std::string & applicationTypeNamespace,
+  size_t size)
+{
+  return *this;
+}
+
+void
+FixMessageBuilder::endGroup(
+  const FieldIdentity & identity,
+  ValueMessageBuilder & groupBuilder)
+{
+}
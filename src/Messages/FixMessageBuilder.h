@@ -0,0 +1,143 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef FIXMESSAGEBUILDER_H
+#define FIXMESSAGEBUILDER_H
+#include "FixMessageBuilder_fwd.h"
+#include <Common/QuickFAST_Export.h>
+#include <Messages/ValueMessageBuilder.h>
+#include <Messages/FieldIdentity_fwd.h>
+#include <boost/unordered_map.hpp>
+
+namespace QuickFAST{
+  namespace Messages{
+    /// @brief Render decoded messages as FIX tag=value records.
+    ///
+    /// Each message is formatted into a buffer that is reused from message to message.
+    /// The "tag=" prefix for each field identity is computed once and cached, and
+    /// integers and decimals are formatted without using streams.
+    ///
+    /// Fields with no id are skipped.  A sequence produces its length field
+    /// followed by the fields of each entry.
+    ///
+    /// If a BeginString is supplied the message is framed as a complete FIX message:
+    /// BeginString(8) and BodyLength(9) are placed before the fields and
+    /// CheckSum(10) is appended.
+    ///
+    /// Derive from this class, implement deliverMessage() to dispose of the formatted
+    /// message, and implement the Logger methods.
+    ///
+    /// The cache is keyed by the address of the FieldIdentity, so the identities
+    /// must outlive the builder.  This is true of identities supplied by the Decoder.
+    class QuickFAST_Export FixMessageBuilder : public ValueMessageBuilder
+    {
+    public:
+      /// @brief Construct
+      /// @param beginString if not empty, frame each message with BeginString, BodyLength and CheckSum.
+      explicit FixMessageBuilder(const std::string & beginString = "");
+
+      virtual ~FixMessageBuilder();
+
+      /// @brief Set or clear the FIX BeginString (i.e. "FIX.4.4")
+      /// @param beginString if not empty, frame each message with BeginString, BodyLength and CheckSum.
+      void setBeginString(const std::string & beginString);
+
+      /// @brief Set the field delimiter.
+      /// @param delimiter normally SOH (0x01); '|' is handy for human readers.
+      void setDelimiter(char delimiter);
+
+      /// @brief Dispose of a completely formatted message.
+      ///
+      /// The message is valid only until this method returns.
+      /// @param message points to the first byte of the message
+      /// @param length is the number of bytes in the message
+      /// @returns true if decoding should continue
+      virtual bool deliverMessage(const char * message, size_t length) = 0;
+
+      /// @brief Access the most recently formatted message.
+      /// @param[out] length receives the number of bytes in the message.
+      /// @returns a pointer to the first byte of the message
+      const char * message(size_t & length)const
+      {
+        length = buffer_.size() - messageStart_;
+        return buffer_.data() + messageStart_;
+      }
+
+      //////////////////////////////////
+      // Implement ValueMessageBuilder
+      virtual const std::string & getApplicationType()const;
+      virtual const std::string & getApplicationTypeNs()const;
+      virtual void addValue(const FieldIdentity & identity, ValueType::Type type, const int64 value);
+      virtual void addValue(const FieldIdentity & identity, ValueType::Type type, const uint64 value);
+      virtual void addValue(const FieldIdentity & identity, ValueType::Type type, const int32 value);
+      virtual void addValue(const FieldIdentity & identity, ValueType::Type type, const uint32 value);
+      virtual void addValue(const FieldIdentity & identity, ValueType::Type type, const int16 value);
+      virtual void addValue(const FieldIdentity & identity, ValueType::Type type, const uint16 value);
+      virtual void addValue(const FieldIdentity & identity, ValueType::Type type, const int8 value);
+      virtual void addValue(const FieldIdentity & identity, ValueType::Type type, const uchar value);
+      virtual void addValue(const FieldIdentity & identity, ValueType::Type type, const Decimal& value);
+      virtual void addValue(const FieldIdentity & identity, ValueType::Type type, const unsigned char * value, size_t length);
+      virtual ValueMessageBuilder & startMessage(
+        const std::string & applicationType,
+        const std::string & applicationTypeNamespace,
+        size_t size);
+      virtual bool endMessage(ValueMessageBuilder & messageBuilder);
+      virtual bool ignoreMessage(ValueMessageBuilder & messageBuilder);
+      virtual ValueMessageBuilder & startSequence(
+        const FieldIdentity & identity,
+        const std::string & applicationType,
+        const std::string & applicationTypeNamespace,
+        size_t fieldCount,
+        const FieldIdentity & lengthIdentity,
+        size_t length);
+      virtual void endSequence(
+        const FieldIdentity & identity,
+        ValueMessageBuilder & sequenceBuilder);
+      virtual ValueMessageBuilder & startSequenceEntry(
+        const std::string & applicationType,
+        const std::string & applicationTypeNamespace,
+        size_t size);
+      virtual void endSequenceEntry(ValueMessageBuilder & entry);
+      virtual ValueMessageBuilder & startGroup(
+        const FieldIdentity & identity,
+        const std::string & applicationType,
+        const std::string & applicationTypeNamespace,
+        size_t size);
+      virtual void endGroup(
+        const FieldIdentity & identity,
+        ValueMessageBuilder & groupBuilder);
+
+    private:
+      /// @brief Append the "tag=" prefix for a field.
+      /// @returns false if the field has no tag and should be skipped.
+      bool appendTag(const FieldIdentity & identity);
+      void appendUnsigned(uint64 value);
+      void appendSigned(int64 value);
+      void appendDecimal(const Decimal & value);
+      void appendDelimiter()
+      {
+        buffer_ += delimiter_;
+      }
+      void frameMessage();
+
+    private:
+      FixMessageBuilder(const FixMessageBuilder &);
+      FixMessageBuilder & operator=(const FixMessageBuilder &);
+
+    private:
+      typedef boost::unordered_map<const FieldIdentity *, std::string> TagCache;
+      TagCache tags_;
+      std::string buffer_;
+      size_t messageStart_;
+      std::string beginString_;
+      size_t headerReserve_;
+      char delimiter_;
+      std::string applicationType_;
+      std::string applicationTypeNamespace_;
+    };
+  }
+}
+#endif // FIXMESSAGEBUILDER_H
@@ -0,0 +1,448 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+#include "MessageRecorder.h"
+#include <Messages/FieldIdentity.h>
+#include <Common/Decimal.h>
+
+using namespace ::QuickFAST;
+using namespace ::QuickFAST::Messages;
+
+namespace
+{
+  const std::string noApplicationType;
+}
+
+MessageRecorder::MessageRecorder(Common::Logger & logger)
+  : logger_(logger)
+  , applicationType_(&noApplicationType)
+  , applicationTypeNamespace_(&noApplicationType)
+  , messageStart_(0)
+  , arenaStart_(0)
+  , messageCount_(0)
+{
+}
+
+MessageRecorder::~MessageRecorder()
+{
+}
+
+MessageRecorder::Event &
+MessageRecorder::record(EventType event, const FieldIdentity * identity, ValueType::Type type)
+{
+  events_.resize(events_.size() + 1);
+  Event & result = events_.back();
+  result.event_ = event;
+  result.type_ = type;
+  result.identity_ = identity;
+  result.applicationType_ = 0;
+  result.applicationTypeNamespace_ = 0;
+  result.lengthIdentity_ = 0;
+  result.value_ = 0;
+  result.extra_ = 0;
+  return result;
+}
+
+void
+MessageRecorder::recordText(EventType event, unsigned short level, const std::string & text)
+{
+  Event & result = record(event);
+  result.value_ = arena_.size();
+  result.extra_ = (uint64(level) << 32) | uint64(text.size());
+  arena_.insert(arena_.end(), text.begin(), text.end());
+}
+
+std::string
+MessageRecorder::textOf(const Event & event)const
+{
+  size_t length = size_t(event.extra_ & 0xFFFFFFFF);
+  if(length == 0)
+  {
+    return std::string();
+  }
+  return std::string(reinterpret_cast<const char *>(&arena_[size_t(event.value_)]), length);
+}
+
+void
+MessageRecorder::clear()
+{
+  events_.clear();
+  arena_.clear();
+  messageStart_ = 0;
+  arenaStart_ = 0;
+  messageCount_ = 0;
+  applicationType_ = &noApplicationType;
+  applicationTypeNamespace_ = &noApplicationType;
+}
+
+bool
+MessageRecorder::replay(ValueMessageBuilder & target)
+{
+  bool result = true;
+  std::vector<ValueMessageBuilder *> & builders = builders_;
+  builders.clear();
+  builders.push_back(&target);
+  for(std::vector<Event>::const_iterator it = events_.begin(); it != events_.end(); ++it)
+  {
+    const Event & event = *it;
+    ValueMessageBuilder & builder = *builders.back();
+    switch(event.event_)
+    {
+    case INT64_VALUE:
+      builder.addValue(*event.identity_, event.type_, int64(event.value_));
+      break;
+    case UINT64_VALUE:
+      builder.addValue(*event.identity_, event.type_, uint64(event.value_));
+      break;
+    case INT32_VALUE:
+      builder.addValue(*event.identity_, event.type_, int32(event.value_));
+      break;
+    case UINT32_VALUE:
+      builder.addValue(*event.identity_, event.type_, uint32(event.value_));
+      break;
+    case INT16_VALUE:
+      builder.addValue(*event.identity_, event.type_, int16(event.value_));
+      break;
+    case UINT16_VALUE:
+      builder.addValue(*event.identity_, event.type_, uint16(event.value_));
+      break;
+    case INT8_VALUE:
+      builder.addValue(*event.identity_, event.type_, int8(event.value_));
+      break;
+    case UCHAR_VALUE:
+      builder.addValue(*event.identity_, event.type_, uchar(event.value_));
+      break;
+    case DECIMAL_VALUE:
+      builder.addValue(*event.identity_, event.type_,
+        Decimal(mantissa_t(event.value_), exponent_t(int64(event.extra_)), false));
+      break;
+    case BYTES_VALUE:
+      builder.addValue(*event.identity_, event.type_,
+        event.extra_ == 0 ? 0 : &arena_[size_t(event.value_)],
+        size_t(event.extra_));
+      break;
+    case START_MESSAGE:
+      builders.push_back(&builder.startMessage(
+        *event.applicationType_,
+        *event.applicationTypeNamespace_,
+        size_t(event.value_)));
+      break;
+    case END_MESSAGE:
+      builders.pop_back();
+      if(!builders.back()->endMessage(builder))
+      {
+        result = false;
+      }
+      break;
+    case START_SEQUENCE:
+      builders.push_back(&builder.startSequence(
+        *event.identity_,
+        *event.applicationType_,
+        *event.applicationTypeNamespace_,
+        size_t(event.value_),
+        *event.lengthIdentity_,
+        size_t(event.extra_)));
+      break;
+    case END_SEQUENCE:
+      builders.pop_back();
+      builders.back()->endSequence(*event.identity_, builder);
+      break;
+    case START_SEQUENCE_ENTRY:
+      builders.push_back(&builder.startSequenceEntry(
+        *event.applicationType_,
+        *event.applicationTypeNamespace_,
+        size_t(event.value_)));
+      break;
+    case END_SEQUENCE_ENTRY:
+      builders.pop_back();
+      builders.back()->endSequenceEntry(builder);
+      break;
+    case START_GROUP:
+      builders.push_back(&builder.startGroup(
+        *event.identity_,
+        *event.applicationType_,
+        *event.applicationTypeNamespace_,
+        size_t(event.value_)));
+      break;
+    case END_GROUP:
+      builders.pop_back();
+      builders.back()->endGroup(*event.identity_, builder);
+      break;
+    case GAP:
+      builder.reportGap(sequence_t(event.value_), sequence_t(event.extra_));
+      break;
+    case RECEIVE_TIME:
+      builder.reportReceiveTime(event.value_);
+      break;
+    case SOURCE:
+      builder.reportSource(size_t(event.value_));
+      break;
+    case LOG_MESSAGE:
+    case DECODING_ERROR:
+    case COMMUNICATION_ERROR:
+    {
+      std::string text(textOf(event));
+      bool more = true;
+      if(event.event_ == LOG_MESSAGE)
+      {
+        more = target.logMessage((unsigned short)(event.extra_ >> 32), text);
+      }
+      else if(event.event_ == DECODING_ERROR)
+      {
+        more = target.reportDecodingError(text);
+      }
+      else
+      {
+        more = target.reportCommunicationError(text);
+      }
+      if(!more)
+      {
+        result = false;
+      }
+      break;
+    }
+    }
+  }
+  return result;
+}
+
+const std::string &
+MessageRecorder::getApplicationType()const
+{
+  return *applicationType_;
+}
+
+const std::string &
+MessageRecorder::getApplicationTypeNs()const
+{
+  return *applicationTypeNamespace_;
+}
+
+void
+MessageRecorder::addValue(const FieldIdentity & identity, ValueType::Type type, const int64 value)
+{
+  record(INT64_VALUE, &identity, type).value_ = uint64(value);
+}
+
+void
+MessageRecorder::addValue(const FieldIdentity & identity, ValueType::Type type, const uint64 value)
+{
+  record(UINT64_VALUE, &identity, type).value_ = value;
+}
+
+void
+MessageRecorder::addValue(const FieldIdentity & identity, ValueType::Type type, const int32 value)
+{
+  record(INT32_VALUE, &identity, type).value_ = uint64(int64(value));
+}
+
+void
+MessageRecorder::addValue(const FieldIdentity & identity, ValueType::Type type, const uint32 value)
+{
+  record(UINT32_VALUE, &identity, type).value_ = value;
+}
+
+void
+MessageRecorder::addValue(const FieldIdentity & identity, ValueType::Type type, const int16 value)
+{
+  record(INT16_VALUE, &identity, type).value_ = uint64(int64(value));
+}
+
+void
+MessageRecorder::addValue(const FieldIdentity & identity, ValueType::Type type, const uint16 value)
+{
+  record(UINT16_VALUE, &identity, type).value_ = value;
+}
+
+void
+MessageRecorder::addValue(const FieldIdentity & identity, ValueType::Type type, const int8 value)
+{
+  record(INT8_VALUE, &identity, type).value_ = uint64(int64(value));
+}
+
+void
+MessageRecorder::addValue(const FieldIdentity & identity, ValueType::Type type, const uchar value)
+{
+  record(UCHAR_VALUE, &identity, type).value_ = value;
+}
+
+void
+MessageRecorder::addValue(const FieldIdentity & identity, ValueType::Type type, const Decimal& value)
+{
+  Event & event = record(DECIMAL_VALUE, &identity, type);
+  event.value_ = uint64(value.getMantissa());
+  event.extra_ = uint64(int64(value.getExponent()));
+}
+
+void
+MessageRecorder::addValue(const FieldIdentity & identity, ValueType::Type type, const unsigned char * value, size_t length)
+{
+  Event & event = record(BYTES_VALUE, &identity, type);
+  event.value_ = arena_.size();
+  event.extra_ = length;
+  arena_.insert(arena_.end(), value, value + length);
+}
+
+ValueMessageBuilder &
+MessageRecorder::startMessage(
+  const std::string & applicationType,
+  const std::string & applicationTypeNamespace,
+  size_t size)
+{
+  messageStart_ = events_.size();
+  arenaStart_ = arena_.size();
+  applicationType_ = &applicationType;
+  applicationTypeNamespace_ = &applicationTypeNamespace;
+  Event & event = record(START_MESSAGE);
+  event.applicationType_ = &applicationType;
+  event.applicationTypeNamespace_ = &applicationTypeNamespace;
+  event.value_ = size;
+  return *this;
+}
+
+bool
+MessageRecorder::endMessage(ValueMessageBuilder & /*messageBuilder*/)
+{
+  record(END_MESSAGE);
+  ++messageCount_;
+  return true;
+}
+
+bool
+MessageRecorder::ignoreMessage(ValueMessageBuilder & /*messageBuilder*/)
+{
+  // Keep anything logged while the message was being built.
+  std::vector<Event> logged;
+  std::vector<std::string> texts;
+  for(size_t nEvent = messageStart_; nEvent < events_.size(); ++nEvent)
+  {
+    const Event & event = events_[nEvent];
+    if(isLogEvent(event.event_))
+    {
+      logged.push_back(event);
+      texts.push_back(textOf(event));
+    }
+  }
+  events_.resize(messageStart_);
+  arena_.resize(arenaStart_);
+  for(size_t nLogged = 0; nLogged < logged.size(); ++nLogged)
+  {
+    recordText(logged[nLogged].event_, (unsigned short)(logged[nLogged].extra_ >> 32), texts[nLogged]);
+  }
+  return true;
+}
+
+ValueMessageBuilder &
+MessageRecorder::startSequence(
+  const FieldIdentity & identity,
+  const std::string & applicationType,
+  const std::string & applicationTypeNamespace,
+  size_t fieldCount,
+  const FieldIdentity & lengthIdentity,
+  size_t length)
+{
+  Event & event = record(START_SEQUENCE, &identity);
+  event.applicationType_ = &applicationType;
+  event.applicationTypeNamespace_ = &applicationTypeNamespace;
+  event.lengthIdentity_ = &lengthIdentity;
+  event.value_ = fieldCount;
+  event.extra_ = length;
+  return *this;
+}
+
+void
+MessageRecorder::endSequence(
+  const FieldIdentity & identity,
+  ValueMessageBuilder & /*sequenceBuilder*/)
+{
+  record(END_SEQUENCE, &identity);
+}
+
+ValueMessageBuilder &
+MessageRecorder::startSequenceEntry(
+  const std::string & applicationType,
+  const std::string & applicationTypeNamespace,
+  size_t size)
+{
+  Event & event = record(START_SEQUENCE_ENTRY);
+  event.applicationType_ = &applicationType;
+  event.applicationTypeNamespace_ = &applicationTypeNamespace;
+  event.value_ = size;
+  return *this;
+}
+
+void
+MessageRecorder::endSequenceEntry(ValueMessageBuilder & /*entry*/)
+{
+  record(END_SEQUENCE_ENTRY);
+}
+
+ValueMessageBuilder &
+MessageRecorder::startGroup(
+  const FieldIdentity & identity,
+  const std::string & applicationType,
+  const std::string & applicationTypeNamespace,
+  size_t size)
+{
+  Event & event = record(START_GROUP, &identity);
+  event.applicationType_ = &applicationType;
+  event.applicationTypeNamespace_ = &applicationTypeNamespace;
+  event.value_ = size;
+  return *this;
+}
+
+void
+MessageRecorder::endGroup(
+  const FieldIdentity & identity,
+  ValueMessageBuilder & /*groupBuilder*/)
+{
+  record(END_GROUP, &identity);
+}
+
+void
+MessageRecorder::reportGap(sequence_t startGap, sequence_t endGap)
+{
+  Event & event = record(GAP);
+  event.value_ = startGap;
+  event.extra_ = endGap;
+}
+
+void
+MessageRecorder::reportReceiveTime(uint64 receiveTime)
+{
+  record(RECEIVE_TIME).value_ = receiveTime;
+}
+
+void
+MessageRecorder::reportSource(size_t source)
+{
+  record(SOURCE).value_ = source;
+}
+
+bool
+MessageRecorder::wantLog(unsigned short level)
+{
+  return logger_.wantLog(level);
+}
+
+bool
+MessageRecorder::logMessage(unsigned short level, const std::string & logMessage)
+{
+  recordText(LOG_MESSAGE, level, logMessage);
+  return true;
+}
+
+bool
+MessageRecorder::reportDecodingError(const std::string & errorMessage)
+{
+  recordText(DECODING_ERROR, 0, errorMessage);
+  return true;
+}
+
+bool
+MessageRecorder::reportCommunicationError(const std::string & errorMessage)
+{
+  recordText(COMMUNICATION_ERROR, 0, errorMessage);
+  return true;
+}
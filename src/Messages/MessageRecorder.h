@@ -0,0 +1,191 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef MESSAGERECORDER_H
+#define MESSAGERECORDER_H
+#include "MessageRecorder_fwd.h"
+#include <Common/QuickFAST_Export.h>
+#include <Messages/ValueMessageBuilder.h>
+#include <Messages/FieldIdentity_fwd.h>
+
+namespace QuickFAST{
+  namespace Messages{
+    /// @brief Record the calls made to a ValueMessageBuilder so they can be replayed later.
+    ///
+    /// Decoded messages are recorded on one thread and replayed into the
+    /// application's builder on another.  Each call becomes a fixed size event;
+    /// byte vector and string values are copied into one arena.  clear() keeps the
+    /// storage so a recorder that is reused allocates nothing once it has grown
+    /// to fit the largest message.
+    ///
+    /// Nested builders (sequences, sequence entries and groups) are all
+    /// recorded by this object.  Replay recreates the nesting using the builders
+    /// returned by the target.
+    ///
+    /// Field identities and application type strings are recorded by address,
+    /// so they must outlive the recording.  This is true of those supplied by the
+    /// Decoder, which belong to the template registry.
+    ///
+    /// Log messages and error reports are recorded in order with the messages and
+    /// replayed into the target's Logger methods, so they reach the target on the
+    /// replaying thread.  A log message reported while a message is being built
+    /// survives ignoreMessage().  Only wantLog() is answered immediately, by the
+    /// logger supplied at construction.
+    class QuickFAST_Export MessageRecorder : public ValueMessageBuilder
+    {
+    public:
+      /// @brief Construct
+      /// @param logger answers wantLog() as the calls are recorded.
+      explicit MessageRecorder(Common::Logger & logger);
+
+      virtual ~MessageRecorder();
+
+      /// @brief Replay the recorded calls.
+      /// @param target receives the calls.
+      /// @returns false if the target's endMessage() or one of its Logger methods returned false.
+      bool replay(ValueMessageBuilder & target);
+
+      /// @brief Forget the recorded calls.  The storage is kept for reuse.
+      void clear();
+
+      /// @brief Has anything been recorded?
+      bool empty()const
+      {
+        return events_.empty();
+      }
+
+      /// @brief How many complete messages have been recorded?
+      size_t messageCount()const
+      {
+        return messageCount_;
+      }
+
+      //////////////////////////////////
+      // Implement ValueMessageBuilder
+      virtual const std::string & getApplicationType()const;
+      virtual const std::string & getApplicationTypeNs()const;
+      virtual void addValue(const FieldIdentity & identity, ValueType::Type type, const int64 value);
+      virtual void addValue(const FieldIdentity & identity, ValueType::Type type, const uint64 value);
+      virtual void addValue(const FieldIdentity & identity, ValueType::Type type, const int32 value);
+      virtual void addValue(const FieldIdentity & identity, ValueType::Type type, const uint32 value);
+      virtual void addValue(const FieldIdentity & identity, ValueType::Type type, const int16 value);
+      virtual void addValue(const FieldIdentity & identity, ValueType::Type type, const uint16 value);
+      virtual void addValue(const FieldIdentity & identity, ValueType::Type type, const int8 value);
+      virtual void addValue(const FieldIdentity & identity, ValueType::Type type, const uchar value);
+      virtual void addValue(const FieldIdentity & identity, ValueType::Type type, const Decimal& value);
+      virtual void addValue(const FieldIdentity & identity, ValueType::Type type, const unsigned char * value, size_t length);
+      virtual ValueMessageBuilder & startMessage(
+        const std::string & applicationType,
+        const std::string & applicationTypeNamespace,
+        size_t size);
+      virtual bool endMessage(ValueMessageBuilder & messageBuilder);
+      virtual bool ignoreMessage(ValueMessageBuilder & messageBuilder);
+      virtual ValueMessageBuilder & startSequence(
+        const FieldIdentity & identity,
+        const std::string & applicationType,
+        const std::string & applicationTypeNamespace,
+        size_t fieldCount,
+        const FieldIdentity & lengthIdentity,
+        size_t length);
+      virtual void endSequence(
+        const FieldIdentity & identity,
+        ValueMessageBuilder & sequenceBuilder);
+      virtual ValueMessageBuilder & startSequenceEntry(
+        const std::string & applicationType,
+        const std::string & applicationTypeNamespace,
+        size_t size);
+      virtual void endSequenceEntry(ValueMessageBuilder & entry);
+      virtual ValueMessageBuilder & startGroup(
+        const FieldIdentity & identity,
+        const std::string & applicationType,
+        const std::string & applicationTypeNamespace,
+        size_t size);
+      virtual void endGroup(
+        const FieldIdentity & identity,
+        ValueMessageBuilder & groupBuilder);
+      virtual void reportGap(sequence_t startGap, sequence_t endGap);
+      virtual void reportReceiveTime(uint64 receiveTime);
+      virtual void reportSource(size_t source);
+
+      ///////////////////
+      // Implement Logger
+      virtual bool wantLog(unsigned short level);
+      virtual bool logMessage(unsigned short level, const std::string & logMessage);
+      virtual bool reportDecodingError(const std::string & errorMessage);
+      virtual bool reportCommunicationError(const std::string & errorMessage);
+
+    private:
+      enum EventType
+      {
+        INT64_VALUE,
+        UINT64_VALUE,
+        INT32_VALUE,
+        UINT32_VALUE,
+        INT16_VALUE,
+        UINT16_VALUE,
+        INT8_VALUE,
+        UCHAR_VALUE,
+        DECIMAL_VALUE,
+        BYTES_VALUE,
+        START_MESSAGE,
+        END_MESSAGE,
+        START_SEQUENCE,
+        END_SEQUENCE,
+        START_SEQUENCE_ENTRY,
+        END_SEQUENCE_ENTRY,
+        START_GROUP,
+        END_GROUP,
+        GAP,
+        RECEIVE_TIME,
+        SOURCE,
+        LOG_MESSAGE,
+        DECODING_ERROR,
+        COMMUNICATION_ERROR
+      };
+
+      struct Event
+      {
+        EventType event_;
+        ValueType::Type type_;
+        const FieldIdentity * identity_;
+        const std::string * applicationType_;
+        const std::string * applicationTypeNamespace_;
+        const FieldIdentity * lengthIdentity_;
+        /// integer value, mantissa, arena offset, field count, or gap start
+        uint64 value_;
+        /// exponent, byte count, sequence length, or gap end.
+        /// For a log message: the level in the upper 32 bits, the byte count in the lower.
+        uint64 extra_;
+      };
+
+      Event & record(EventType event, const FieldIdentity * identity = 0, ValueType::Type type = ValueType::UNDEFINED);
+      void recordText(EventType event, unsigned short level, const std::string & text);
+      std::string textOf(const Event & event)const;
+      static bool isLogEvent(EventType event)
+      {
+        return event == LOG_MESSAGE || event == DECODING_ERROR || event == COMMUNICATION_ERROR;
+      }
+
+    private:
+      MessageRecorder(const MessageRecorder &);
+      MessageRecorder & operator=(const MessageRecorder &);
+
+    private:
+      Common::Logger & logger_;
+      const std::string * applicationType_;
+      const std::string * applicationTypeNamespace_;
+      std::vector<Event> events_;
+      std::vector<unsigned char> arena_;
+      /// during replay: the builders returned by the target for the message, sequences, entries and groups.
+      std::vector<ValueMessageBuilder *> builders_;
+      /// where the current message started (for ignoreMessage)
+      size_t messageStart_;
+      size_t arenaStart_;
+      size_t messageCount_;
+    };
+  }
+}
+#endif // MESSAGERECORDER_H
@@ -0,0 +1,20 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef MESSAGERECORDER_FWD_H
+#define MESSAGERECORDER_FWD_H
+#ifndef QUICKFAST_HEADERS
+#error Please include <Application/QuickFAST.h> preferably as a precompiled header file.
+#endif //QUICKFAST_HEADERS
+
+namespace QuickFAST{
+  namespace Messages{
+    class MessageRecorder;
+    /// @brief smart pointer to a MessageRecorder
+    typedef boost::shared_ptr<MessageRecorder> MessageRecorderPtr;
+  }
+}
+#endif // MESSAGERECORDER_FWD_H
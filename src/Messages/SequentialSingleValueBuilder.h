@@ -26,6 +26,8 @@ namespace QuickFAST
         : error_(false)
         , logged_(false)
         , gapDetected_(false)
+        , receiveTime_(0)
+        , source_(0)
         , messageCount_(0)
         {
         }
@@ -140,6 +142,30 @@ namespace QuickFAST
           gapDetected_ = true;
         }
 
+        virtual void reportReceiveTime(uint64 receiveTime)
+        {
+          receiveTime_ = receiveTime;
+        }
+
+        /// @brief The most recent receive time reported
+        ///
+        /// @returns nanoseconds since the epoch or zero if none was reported.
+        uint64 receiveTime()const
+        {
+          return receiveTime_;
+        }
+
+        virtual void reportSource(size_t source)
+        {
+          source_ = source;
+        }
+
+        /// @brief The most recent source (feed index) reported
+        size_t source()const
+        {
+          return source_;
+        }
+
 
         /// @brief How many values have been collected
         ///
@@ -205,6 +231,8 @@ namespace QuickFAST
           error_ = false;
           logged_ = false;
           gapDetected_ = false;
+          receiveTime_ = 0;
+          source_ = 0;
           message_.clear();
           messageCount_ = 0;
           values_.clear();
@@ -323,6 +351,8 @@ namespace QuickFAST
         bool error_;
         bool logged_;
         bool gapDetected_;
+        uint64 receiveTime_;
+        size_t source_;
         std::string message_;
         size_t messageCount_;
 
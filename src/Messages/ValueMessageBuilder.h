@@ -200,6 +200,38 @@ namespace QuickFAST{
       {
       }
 
+      /// @brief Notify builder when the data for the following message(s) arrived.
+      ///
+      /// Called before the messages from each packet are decoded if the
+      /// receiver recorded a receive time (see Receiver::setReceiveTimestamps()).
+      /// For streaming input it is called as each buffer is consumed, so
+      /// a message that spans buffers sees the time the last part arrived.
+      /// Comparing this with the time endMessage() is called measures queueing
+      /// plus decoding delay.
+      ///
+      /// New method added to the interface.  It's not pure virtual to avoid
+      /// breaking existing implementations.
+      ///
+      /// @param receiveTime nanoseconds since the epoch.
+      virtual void reportReceiveTime(uint64 receiveTime)
+      {
+      }
+
+      /// @brief Report which input feed the following messages came from.
+      ///
+      /// A receiver that reads several feeds (see EpollMulticastReceiver)
+      /// marks each buffer with the index of its feed.  This is called
+      /// before decoding a packet whose feed differs from the previous packet's.
+      /// Messages come from feed zero until this is called.
+      ///
+      /// New method added to the interface.  It's not pure virtual to avoid
+      /// breaking existing implementations.
+      ///
+      /// @param source the feed index.
+      virtual void reportSource(size_t source)
+      {
+      }
+
     };
   }
 }
@@ -0,0 +1,144 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef RECEIVERTESTFIXTURES_H
+#define RECEIVERTESTFIXTURES_H
+#include <Communication/Receiver.h>
+#include <Communication/Assembler.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Common/Logger.h>
+
+namespace QuickFAST{
+  namespace Tests{
+    /// Quiet logger that counts communication errors.
+    class TestLogger : public Common::Logger
+    {
+    public:
+      /// @param continueOnError the answer to reportCommunicationError().
+      ///        false stops the receiver, at the end of a TCP stream for example.
+      explicit TestLogger(bool continueOnError = true)
+        : continueOnError_(continueOnError)
+        , communicationErrors_(0)
+      {
+      }
+      virtual bool wantLog(LogLevel /*level*/)
+      {
+        return false;
+      }
+      virtual bool logMessage(LogLevel /*level*/, const std::string & /*message*/)
+      {
+        return true;
+      }
+      virtual bool reportDecodingError(const std::string & /*message*/)
+      {
+        return true;
+      }
+      virtual bool reportCommunicationError(const std::string & message)
+      {
+        ++communicationErrors_;
+        lastError_ = message;
+        return continueOnError_;
+      }
+
+      bool continueOnError_;
+      size_t communicationErrors_;
+      std::string lastError_;
+    };
+
+    /// Assembler that hands each buffer the receiver delivers to receiveBuffer() then releases it.
+    class BufferAssembler : public Communication::Assembler
+    {
+    public:
+      BufferAssembler(Common::Logger & logger)
+        : Assembler(Codecs::TemplateRegistryPtr(new Codecs::TemplateRegistry), logger)
+      {
+      }
+
+      virtual void receiverStarted(Communication::Receiver & /*receiver*/)
+      {
+      }
+
+      virtual void receiverStopped(Communication::Receiver & /*receiver*/)
+      {
+      }
+
+      virtual bool serviceQueue(Communication::Receiver & receiver)
+      {
+        Communication::LinkedBuffer * buffer = receiver.getBuffer(false);
+        while(buffer != 0)
+        {
+          receiveBuffer(*buffer);
+          receiver.releaseBuffer(buffer);
+          buffer = receiver.getBuffer(false);
+        }
+        return true;
+      }
+
+    protected:
+      /// @brief Examine one buffer.  It is released on return.
+      virtual void receiveBuffer(const Communication::LinkedBuffer & buffer) = 0;
+    };
+
+    /// Collect everything the receiver delivers.
+    class CollectingAssembler : public BufferAssembler
+    {
+    public:
+      CollectingAssembler(Common::Logger & logger)
+        : BufferAssembler(logger)
+        , bufferCount_(0)
+        , largestBuffer_(0)
+      {
+      }
+
+      std::string data_;
+      size_t bufferCount_;
+      size_t largestBuffer_;
+
+    protected:
+      virtual void receiveBuffer(const Communication::LinkedBuffer & buffer)
+      {
+        ++bufferCount_;
+        largestBuffer_ = std::max(largestBuffer_, buffer.used());
+        data_.append(reinterpret_cast<const char *>(buffer.get()), buffer.used());
+      }
+    };
+
+    /// Count the buffers from each source and check each was tagged with the feed it was sent to.
+    /// Each datagram carries the decimal number of the feed it was sent to.
+    class SourceCountingAssembler : public BufferAssembler
+    {
+    public:
+      SourceCountingAssembler(Common::Logger & logger, size_t sources)
+        : BufferAssembler(logger)
+        , counts_(sources, 0)
+        , total_(0)
+        , mislabeled_(0)
+      {
+      }
+
+      std::vector<size_t> counts_;
+      size_t total_;
+      size_t mislabeled_;
+
+    protected:
+      virtual void receiveBuffer(const Communication::LinkedBuffer & buffer)
+      {
+        size_t sentTo = boost::lexical_cast<size_t>(
+          std::string(reinterpret_cast<const char *>(buffer.get()), buffer.used()));
+        if(sentTo != buffer.source() || sentTo >= counts_.size())
+        {
+          ++mislabeled_;
+        }
+        else
+        {
+          ++counts_[sentTo];
+        }
+        ++total_;
+      }
+    };
+  }
+}
+#endif // RECEIVERTESTFIXTURES_H
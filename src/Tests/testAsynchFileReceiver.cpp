@@ -0,0 +1,85 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+#if defined(__linux__) // The Windows receiver is not tested here.
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Communication/AsynchFileReceiver.h>
+#include <Common/IoUring.h>
+#include <Tests/ReceiverTestFixtures.h>
+
+using namespace QuickFAST;
+using namespace QuickFAST::Tests;
+
+namespace
+{
+  std::string writeTestFile(const char * fileName, size_t size)
+  {
+    std::string contents;
+    for(size_t nByte = 0; nByte < size; ++nByte)
+    {
+      contents += char(nByte * 7 + nByte / 251);
+    }
+    std::ofstream file(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+    file.write(contents.data(), contents.size());
+    return contents;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testAsynchFileReceiver)
+{
+  if(!Common::IoUring::supported())
+  {
+    BOOST_TEST_MESSAGE("testAsynchFileReceiver: io_uring is not available here. Skipped.");
+    return;
+  }
+  const char * fileName = "testAsynchFileReceiver.dat";
+  // Not a multiple of the buffer size, so the last read is short.
+  std::string contents = writeTestFile(fileName, 1000 * 1000 + 123);
+  const size_t bufferSize = 16 * 1024;
+
+  TestLogger logger;
+  {
+    CollectingAssembler assembler(logger);
+    Communication::AsynchFileReceiver receiver(fileName);
+    receiver.setSlabBuffers();
+    receiver.setReadsInFlight(4);
+    BOOST_REQUIRE(receiver.start(assembler, bufferSize, 8));
+    receiver.run();
+    // The io_service is shared, so leave it ready for the next test.
+    receiver.resetService();
+    BOOST_CHECK_EQUAL(assembler.bufferCount_, contents.size() / bufferSize + 1);
+    BOOST_CHECK(assembler.data_ == contents);
+    // One system call can submit several reads.
+    BOOST_CHECK(receiver.submitCalls() < assembler.bufferCount_);
+    BOOST_TEST_MESSAGE("testAsynchFileReceiver: " << receiver.registeredReads() << " registered reads; "
+      << receiver.submitCalls() << " submit calls");
+  }
+  {
+    // O_DIRECT, or the page cache if this file system refuses.
+    CollectingAssembler assembler(logger);
+    Communication::AsynchFileReceiver receiver(fileName);
+    receiver.setSlabBuffers();
+    receiver.setReadsInFlight(3);
+    receiver.setDirectIO();
+    BOOST_REQUIRE(receiver.start(assembler, bufferSize, 6));
+    receiver.runThreads(1, true);
+    receiver.joinThreads();
+    receiver.resetService();
+    BOOST_CHECK(assembler.data_ == contents);
+  }
+  std::remove(fileName);
+}
+
+BOOST_AUTO_TEST_CASE(testAsynchFileReceiverMissingFile)
+{
+  TestLogger logger;
+  CollectingAssembler assembler(logger);
+  Communication::AsynchFileReceiver receiver("no/such/file.dat");
+  BOOST_CHECK(!receiver.start(assembler, 100, 2));
+}
+
+#endif // __linux__
@@ -2,7 +2,7 @@
 // All rights reserved.
 // See the file license.txt for licensing information.
 #include <Common/QuickFASTPch.h>
-#ifdef _WIN32 // Asynchronous file writer only works on Win32 so disable this entire test on other platforms
+#if defined(_WIN32) || defined(__linux__) // Asynchronous file writer only works on Win32 and Linux so disable this entire test on other platforms
 
 #define BOOST_TEST_NO_MAIN QuickFASTTest
 #include <boost/test/unit_test.hpp>
@@ -21,8 +21,10 @@ namespace
   class AsynchronousFileCopier : public Communication::BufferRecycler
   {
     public:
-#pragma warning(push) // we're on windows so don't worry about #ifdeffing around the pragmas
+#ifdef _MSC_VER
+#pragma warning(push)
 #pragma warning(disable:4355)//warning C4355: 'this' : used in base member initializer list
+#endif
 
       AsynchronousFileCopier(
         const std::string & inputFilename,
@@ -36,7 +38,9 @@ namespace
         , in_(0)
       {
       }
+#ifdef _MSC_VER
 #pragma warning(pop)
+#endif
 
       ~AsynchronousFileCopier()
       {
@@ -72,6 +76,8 @@ namespace
         }
         sender_.runThreads(threadCount, true);
         sender_.close();
+        // The io_service is shared, so leave it ready for the next test.
+        sender_.resetService();
       }
 
       void startWrite(Communication::LinkedBuffer * buffer)
@@ -165,4 +171,4 @@ BOOST_AUTO_TEST_CASE(TestAsynchFileWriter)
   boost::filesystem::remove(outputFile);
 }
 
-#endif // _WIN32
+#endif // _WIN32 || __linux__
@@ -0,0 +1,198 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Communication/BufferHandoff.h>
+#include <Communication/SingleServerBufferQueue.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  const size_t bufferCount = 64;
+  const size_t handoffCount = 200000;
+
+  /// The receiving and decoding sides of the existing mutex-protected path:
+  /// a SingleServerBufferQueue for full buffers and a BufferCollection for empty ones.
+  class MutexHandoff
+  {
+  public:
+    MutexHandoff()
+      : serving_(false)
+    {
+    }
+
+    void start(Communication::LinkedBuffer * buffers, size_t count)
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      for(size_t nBuffer = 0; nBuffer < count; ++nBuffer)
+      {
+        idle_.push(&buffers[nBuffer]);
+      }
+    }
+
+    Communication::LinkedBuffer * reclaim()
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      return idle_.pop();
+    }
+
+    void deliver(Communication::LinkedBuffer * buffer)
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      if(queue_.push(buffer, lock))
+      {
+        condition_.notify_one();
+      }
+    }
+
+    /// Like Receiver::getBuffer(true) for a thread that does nothing but decode.
+    Communication::LinkedBuffer * next()
+    {
+      if(!serving_)
+      {
+        boost::mutex::scoped_lock lock(mutex_);
+        while(!queue_.startService(lock))
+        {
+          condition_.wait(lock);
+        }
+        serving_ = true;
+      }
+      Communication::LinkedBuffer * buffer = queue_.serviceNext();
+      while(buffer == 0)
+      {
+        {
+          boost::mutex::scoped_lock lock(mutex_);
+          queue_.refresh(lock, true);
+        }
+        buffer = queue_.serviceNext();
+      }
+      return buffer;
+    }
+
+    void recycle(Communication::LinkedBuffer * buffer)
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      idle_.push(buffer);
+    }
+
+  private:
+    boost::mutex mutex_;
+    boost::condition_variable condition_;
+    Communication::SingleServerBufferQueue queue_;
+    Communication::BufferCollection idle_;
+    bool serving_;
+  };
+
+  template<typename Handoff>
+  void produce(Handoff * handoff)
+  {
+    for(size_t sequence = 1; sequence <= handoffCount; ++sequence)
+    {
+      Communication::LinkedBuffer * buffer = handoff->reclaim();
+      while(buffer == 0)
+      {
+        boost::thread::yield();
+        buffer = handoff->reclaim();
+      }
+      buffer->setUsed(sequence);
+      handoff->deliver(buffer);
+    }
+  }
+
+  double nanosecondsPerBuffer(const boost::posix_time::ptime & start)
+  {
+    boost::posix_time::time_duration lapse = boost::posix_time::microsec_clock::universal_time() - start;
+    return double(lapse.total_microseconds()) * 1000.0 / double(handoffCount);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testSpscBufferRing)
+{
+  Communication::SpscBufferRing ring(5);
+  BOOST_CHECK_EQUAL(ring.capacity(), 7u);
+  BOOST_CHECK(ring.isEmpty());
+  BOOST_CHECK(ring.pop() == 0);
+
+  Communication::LinkedBuffer buffers[8];
+  for(size_t nBuffer = 0; nBuffer < 7; ++nBuffer)
+  {
+    BOOST_CHECK(ring.push(&buffers[nBuffer]));
+  }
+  BOOST_CHECK(!ring.push(&buffers[7]));
+  BOOST_CHECK(ring.peek(0) == &buffers[0]);
+  BOOST_CHECK(ring.peek(6) == &buffers[6]);
+  BOOST_CHECK(ring.peek(7) == 0);
+
+  // wrap around several times
+  for(size_t nPass = 0; nPass < 20; ++nPass)
+  {
+    Communication::LinkedBuffer * buffer = ring.pop();
+    BOOST_REQUIRE(buffer != 0);
+    BOOST_CHECK(ring.push(buffer));
+  }
+  for(size_t nBuffer = 0; nBuffer < 7; ++nBuffer)
+  {
+    BOOST_CHECK(ring.pop() == &buffers[(nBuffer + 20) % 7]);
+  }
+  BOOST_CHECK(ring.pop() == 0);
+  BOOST_CHECK(ring.isEmpty());
+}
+
+BOOST_AUTO_TEST_CASE(testBufferHandoffContention)
+{
+  // Lock-free handoff
+  Communication::LinkedBuffer buffers[bufferCount];
+  Communication::BufferHandoff handoff(bufferCount, 1000);
+  for(size_t nBuffer = 0; nBuffer < bufferCount; ++nBuffer)
+  {
+    handoff.recycle(&buffers[nBuffer]);
+  }
+  bool stopping = false;
+  size_t errors = 0;
+  boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+  boost::thread producer(boost::bind(&produce<Communication::BufferHandoff>, &handoff));
+  for(size_t sequence = 1; sequence <= handoffCount; ++sequence)
+  {
+    Communication::LinkedBuffer * buffer = handoff.next();
+    while(buffer == 0)
+    {
+      handoff.wait(stopping);
+      buffer = handoff.next();
+    }
+    if(buffer->used() != sequence)
+    {
+      ++errors;
+    }
+    handoff.recycle(buffer);
+  }
+  producer.join();
+  double lockFree = nanosecondsPerBuffer(start);
+  BOOST_CHECK_EQUAL(errors, 0u);
+
+  // Mutex and condition variable
+  Communication::LinkedBuffer mutexBuffers[bufferCount];
+  MutexHandoff mutexHandoff;
+  mutexHandoff.start(mutexBuffers, bufferCount);
+  start = boost::posix_time::microsec_clock::universal_time();
+  boost::thread mutexProducer(boost::bind(&produce<MutexHandoff>, &mutexHandoff));
+  for(size_t sequence = 1; sequence <= handoffCount; ++sequence)
+  {
+    Communication::LinkedBuffer * buffer = mutexHandoff.next();
+    if(buffer->used() != sequence)
+    {
+      ++errors;
+    }
+    mutexHandoff.recycle(buffer);
+  }
+  mutexProducer.join();
+  double locked = nanosecondsPerBuffer(start);
+  BOOST_CHECK_EQUAL(errors, 0u);
+
+  std::cout << "Buffer handoff: lock-free " << std::fixed << std::setprecision(1) << lockFree
+    << " ns/buffer (" << handoff.parks() << " parks); mutex " << locked << " ns/buffer." << std::endl;
+}
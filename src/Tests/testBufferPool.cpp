@@ -0,0 +1,57 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Communication/BufferPool.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  void checkPool(Communication::BufferPool & pool, size_t bufferCount, size_t bufferSize)
+  {
+    BOOST_REQUIRE_EQUAL(pool.size(), bufferCount);
+    BOOST_CHECK(pool.footprint() >= bufferCount * bufferSize);
+    for(size_t nBuffer = 0; nBuffer < bufferCount; ++nBuffer)
+    {
+      Communication::LinkedBuffer * buffer = pool[nBuffer];
+      BOOST_CHECK_EQUAL(size_t(buffer) % 64, 0u);
+      BOOST_CHECK_EQUAL(size_t(buffer->get()) % 64, 0u);
+      BOOST_CHECK_EQUAL(buffer->capacity(), bufferSize);
+      BOOST_CHECK_EQUAL(buffer->used(), 0u);
+      BOOST_CHECK(buffer->link() == 0);
+      // fill every byte with a pattern unique to the buffer
+      std::memset(buffer->get(), int(nBuffer & 0xFF), bufferSize);
+      buffer->setUsed(bufferSize);
+    }
+    // No buffer overwrote its neighbor's data or header
+    for(size_t nBuffer = 0; nBuffer < bufferCount; ++nBuffer)
+    {
+      const Communication::LinkedBuffer * buffer = pool[nBuffer];
+      BOOST_CHECK_EQUAL(buffer->used(), bufferSize);
+      BOOST_CHECK_EQUAL(buffer->capacity(), bufferSize);
+      const unsigned char * data = buffer->get();
+      BOOST_CHECK_EQUAL(size_t(data[0]), nBuffer & 0xFF);
+      BOOST_CHECK_EQUAL(size_t(data[bufferSize - 1]), nBuffer & 0xFF);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testBufferPool)
+{
+  // a size that is not a multiple of the cache line
+  Communication::BufferPool pool(100, 1500);
+  checkPool(pool, 100, 1500);
+  BOOST_CHECK(!pool.usingHugePages());
+}
+
+BOOST_AUTO_TEST_CASE(testBufferPoolHugePages)
+{
+  // Huge pages may not be available. Either way the pool must work.
+  Communication::BufferPool pool(1000, 9000, true);
+  checkPool(pool, 1000, 9000);
+}
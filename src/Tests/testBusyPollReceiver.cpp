@@ -0,0 +1,218 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Communication/BusyPollReceiver.h>
+#include <Communication/MulticastReceiver.h>
+#include <Common/MonotonicClock.h>
+#include <Tests/ReceiverTestFixtures.h>
+
+using namespace QuickFAST;
+using namespace QuickFAST::Tests;
+
+#if defined(__linux__)
+namespace
+{
+  /// Each packet carries a sequence number and the time it was sent.
+  struct Stamp
+  {
+    uint32 sequence_;
+    uint64 sent_;
+  };
+
+  /// Record the order of the packets, the thread that decoded them,
+  /// and how long each took from send() to serviceQueue().
+  class LatencyAssembler : public BufferAssembler
+  {
+  public:
+    LatencyAssembler(Common::Logger & logger)
+      : BufferAssembler(logger)
+      , count_(0)
+    {
+    }
+
+    size_t count()
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      return count_;
+    }
+
+    /// @brief the latency at a fraction (0.5 = median) of the sorted samples in microseconds.
+    double percentile(double fraction)
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      if(latencies_.empty())
+      {
+        return 0.0;
+      }
+      std::vector<uint64> sorted(latencies_);
+      std::sort(sorted.begin(), sorted.end());
+      size_t index = std::min(sorted.size() - 1, size_t(fraction * sorted.size()));
+      return double(sorted[index]) / 1000.0;
+    }
+
+    boost::mutex mutex_;
+    size_t count_;
+    std::vector<uint32> sequences_;
+    std::vector<uint64> latencies_;
+    boost::thread::id thread_;
+
+  protected:
+    virtual void receiveBuffer(const Communication::LinkedBuffer & buffer)
+    {
+      uint64 now = Common::monotonicNanoseconds();
+      Stamp stamp;
+      if(buffer.used() == sizeof(stamp))
+      {
+        std::memcpy(&stamp, buffer.get(), sizeof(stamp));
+        boost::mutex::scoped_lock lock(mutex_);
+        sequences_.push_back(stamp.sequence_);
+        latencies_.push_back(now - stamp.sent_);
+        thread_ = boost::this_thread::get_id();
+        ++count_;
+      }
+    }
+  };
+
+  /// Send stamped packets to a multicast group on the loopback interface.
+  class LoopbackSender
+  {
+  public:
+    LoopbackSender(const std::string & group, unsigned short port)
+      : socket_(ioService_)
+      , destination_(boost::asio::ip::address::from_string(group), port)
+    {
+      socket_.open(boost::asio::ip::udp::v4());
+      socket_.set_option(boost::asio::ip::multicast::outbound_interface(
+        boost::asio::ip::address_v4::from_string("127.0.0.1")));
+      socket_.set_option(boost::asio::ip::multicast::enable_loopback(true));
+    }
+
+    /// @brief send count packets, pausing between them so each is measured on its own.
+    void send(size_t count, size_t pauseMicroseconds)
+    {
+      for(size_t nPacket = 0; nPacket < count; ++nPacket)
+      {
+        Stamp stamp;
+        stamp.sequence_ = uint32(nPacket);
+        stamp.sent_ = Common::monotonicNanoseconds();
+        socket_.send_to(boost::asio::buffer(&stamp, sizeof(stamp)), destination_);
+        if(pauseMicroseconds > 0)
+        {
+          boost::this_thread::sleep(boost::posix_time::microseconds(pauseMicroseconds));
+        }
+      }
+    }
+
+  private:
+    boost::asio::io_service ioService_;
+    boost::asio::ip::udp::socket socket_;
+    boost::asio::ip::udp::endpoint destination_;
+  };
+
+  /// @brief wait (up to about two seconds) for the assembler to see count packets.
+  bool awaitPackets(LatencyAssembler & assembler, size_t count)
+  {
+    for(size_t tries = 0; assembler.count() < count && tries < 200; ++tries)
+    {
+      boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    }
+    return assembler.count() >= count;
+  }
+
+  /// @brief Run the receiver in its own thread and measure packet-to-callback latency.
+  /// @returns false if the receiver cannot join the group here.
+  bool measureLatency(
+    const char * name,
+    Communication::Receiver & receiver,
+    const std::string & group,
+    unsigned short port,
+    size_t packets)
+  {
+    TestLogger logger;
+    LatencyAssembler assembler(logger);
+    if(!receiver.start(assembler, 1400, 16))
+    {
+      return false;
+    }
+    receiver.runThreads(1, false);
+    LoopbackSender sender(group, port);
+    // let the receiving thread settle before measuring.
+    boost::this_thread::sleep(boost::posix_time::milliseconds(20));
+    sender.send(packets, 100);
+    BOOST_CHECK(awaitPackets(assembler, packets));
+    receiver.stop();
+    receiver.joinThreads();
+
+    std::stringstream report;
+    report << name << ": " << assembler.count() << " of " << packets
+      << " packets. Packet to callback latency median " << assembler.percentile(0.5)
+      << " us; 99th percentile " << assembler.percentile(0.99) << " us.";
+    BOOST_TEST_MESSAGE(report.str());
+    return true;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testBusyPollReceiver)
+{
+  const std::string group("239.255.46.1");
+  const unsigned short port = 43200;
+  const size_t packets = 20;
+  Communication::BusyPollReceiver receiver(group, "127.0.0.1", "0.0.0.0", port);
+  TestLogger logger;
+  LatencyAssembler assembler(logger);
+  if(!receiver.start(assembler, 1400, 4))
+  {
+    BOOST_TEST_MESSAGE("testBusyPollReceiver: cannot join the multicast group here. Skipped.");
+    return;
+  }
+  LoopbackSender sender(group, port);
+  sender.send(packets, 0);
+
+  // poll() decodes in this thread: no other thread is involved.
+  for(size_t tries = 0; assembler.count() < packets && tries < 200; ++tries)
+  {
+    if(receiver.poll() == 0)
+    {
+      boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    }
+  }
+  receiver.stop();
+
+  BOOST_REQUIRE_EQUAL(assembler.count(), packets);
+  for(size_t nPacket = 0; nPacket < packets; ++nPacket)
+  {
+    BOOST_CHECK_EQUAL(assembler.sequences_[nPacket], nPacket);
+  }
+  BOOST_CHECK(assembler.thread_ == boost::this_thread::get_id());
+  BOOST_CHECK_EQUAL(receiver.packetsReceived(), packets);
+  BOOST_CHECK_EQUAL(receiver.packetsProcessed(), packets);
+  BOOST_CHECK_EQUAL(receiver.bytesProcessed(), packets * sizeof(Stamp));
+  // Four buffers were enough: each one is reused as soon as its packet is decoded.
+  BOOST_CHECK_EQUAL(receiver.noBufferAvailable(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(testBusyPollLatency)
+{
+  // Not a benchmark: it reports the numbers, but only checks that every packet arrives.
+  const std::string group("239.255.46.2");
+  const size_t packets = 1000;
+  {
+    Communication::BusyPollReceiver receiver(group, "127.0.0.1", "0.0.0.0", 43201);
+    if(!measureLatency("BusyPollReceiver", receiver, group, 43201, packets))
+    {
+      BOOST_TEST_MESSAGE("testBusyPollLatency: cannot join the multicast group here. Skipped.");
+      return;
+    }
+  }
+  {
+    boost::asio::io_service ioService;
+    Communication::MulticastReceiver receiver(ioService, group, "127.0.0.1", "0.0.0.0", 43202);
+    measureLatency("MulticastReceiver", receiver, group, 43202, packets);
+  }
+}
+#endif // __linux__
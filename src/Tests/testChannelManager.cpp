@@ -0,0 +1,351 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+#include <Application/ChannelManager.h>
+#include <Application/DecoderConnection.h>
+#include <Communication/Receiver.h>
+#include <Codecs/FieldInstructionUInt32.h>
+#include <Codecs/Template.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/Encoder.h>
+#include <Codecs/DataDestination.h>
+#include <Messages/FixMessageBuilder.h>
+#include <Messages/FieldSet.h>
+#include <Messages/FieldUInt32.h>
+#include <Messages/FieldIdentity.h>
+#include <boost/asio.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+
+using namespace QuickFAST;
+
+namespace
+{
+  /// Collect the sequence numbers of a channel's messages and the threads that delivered them.
+  class SequenceCollector : public Messages::FixMessageBuilder
+  {
+  public:
+    explicit SequenceCollector(size_t delay = 0)
+      : delay_(delay)
+      , messages_(0)
+    {
+      setDelimiter('|');
+    }
+
+    using Messages::FixMessageBuilder::addValue;
+    virtual void addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const uint64 value)
+    {
+      if(identity.name() == "SeqNum")
+      {
+        sequence_ = uint32(value);
+      }
+      Messages::FixMessageBuilder::addValue(identity, type, value);
+    }
+
+    virtual bool deliverMessage(const char * /*message*/, size_t /*length*/)
+    {
+      if(delay_ != 0)
+      {
+        // a channel that is expensive to decode.
+        boost::this_thread::sleep(boost::posix_time::milliseconds(delay_));
+      }
+      boost::mutex::scoped_lock lock(mutex_);
+      sequences_.push_back(sequence_);
+      threads_.push_back(boost::this_thread::get_id());
+      ++messages_;
+      return true;
+    }
+
+    virtual bool wantLog(unsigned short /*level*/)
+    {
+      return false;
+    }
+    virtual bool logMessage(unsigned short /*level*/, const std::string & /*logMessage*/)
+    {
+      return true;
+    }
+    virtual bool reportDecodingError(const std::string & /*errorMessage*/)
+    {
+      return false;
+    }
+    virtual bool reportCommunicationError(const std::string & /*errorMessage*/)
+    {
+      return false;
+    }
+
+    size_t messages()
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      return messages_;
+    }
+
+    size_t delay_;
+    uint32 sequence_;
+    boost::mutex mutex_;
+    size_t messages_;
+    std::vector<uint32> sequences_;
+    std::vector<boost::thread::id> threads_;
+  };
+
+  const Messages::FieldIdentity id_SeqNum("SeqNum");
+  const std::string group("239.255.45.1");
+  const unsigned short basePort = 43100;
+
+  Codecs::TemplateRegistryPtr createRegistry()
+  {
+    Codecs::TemplatePtr templ(new Codecs::Template);
+    templ->setId(1);
+    templ->setTemplateName("Sequenced");
+    Codecs::FieldInstructionPtr seqNum(new Codecs::FieldInstructionUInt32("SeqNum", ""));
+    templ->addInstruction(seqNum);
+    Codecs::TemplateRegistryPtr registry(new Codecs::TemplateRegistry);
+    registry->addTemplate(templ);
+    registry->finalize();
+    return registry;
+  }
+
+  Application::DecoderConfiguration channelConfiguration(unsigned short port)
+  {
+    Application::DecoderConfiguration configuration;
+    configuration.setReceiverType(Application::DecoderConfiguration::MULTICAST_RECEIVER);
+    configuration.setAssemblerType(Application::DecoderConfiguration::MESSAGE_PER_PACKET_ASSEMBLER);
+    configuration.setMulticastGroupIP(group);
+    configuration.setPortNumber(port);
+    configuration.setListenInterfaceIP("127.0.0.1");
+    configuration.setMulticastBindIP("0.0.0.0");
+    // Reads still pending on a stopped service would outlive their channels.
+    configuration.setPrivateIOService(true);
+    return configuration;
+  }
+
+  /// Send FAST encoded messages, one per packet, to the channels' multicast group on the loopback interface.
+  class ChannelSender
+  {
+  public:
+    explicit ChannelSender(Codecs::TemplateRegistryPtr registry)
+      : registry_(registry)
+      , socket_(ioService_)
+    {
+      socket_.open(boost::asio::ip::udp::v4());
+      socket_.set_option(boost::asio::ip::multicast::outbound_interface(
+        boost::asio::ip::address_v4::from_string("127.0.0.1")));
+      socket_.set_option(boost::asio::ip::multicast::enable_loopback(true));
+    }
+
+    void send(size_t channel, uint32 sequence)
+    {
+      Messages::FieldSet message(1);
+      message.addField(id_SeqNum, Messages::FieldUInt32::create(sequence));
+      // A fresh encoder for each packet so every packet carries its template ID.
+      Codecs::Encoder encoder(registry_);
+      Codecs::DataDestination destination;
+      encoder.encodeMessage(destination, 1, message);
+      std::string packet;
+      destination.toString(packet);
+      socket_.send_to(boost::asio::buffer(packet), boost::asio::ip::udp::endpoint(
+        boost::asio::ip::address::from_string(group), (unsigned short)(basePort + channel)));
+    }
+
+  private:
+    Codecs::TemplateRegistryPtr registry_;
+    boost::asio::io_service ioService_;
+    boost::asio::ip::udp::socket socket_;
+  };
+
+  /// @returns true if every collector has at least count messages within a few seconds.
+  bool waitForMessages(boost::ptr_vector<SequenceCollector> & collectors, size_t count)
+  {
+    for(size_t tries = 0; tries < 500; ++tries)
+    {
+      bool done = true;
+      for(size_t nCollector = 0; nCollector < collectors.size(); ++nCollector)
+      {
+        done = done && collectors[nCollector].messages() >= count;
+      }
+      if(done)
+      {
+        return true;
+      }
+      boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    }
+    return false;
+  }
+
+  bool inOrder(const std::vector<uint32> & sequences)
+  {
+    for(size_t pos = 0; pos < sequences.size(); ++pos)
+    {
+      if(sequences[pos] != pos)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testChannelManagerOneWorker)
+{
+  const size_t channels = 3;
+  const uint32 messageCount = 200;
+  Codecs::TemplateRegistryPtr registry = createRegistry();
+  Application::ChannelManager manager(1);
+  manager.setTemplateRegistry(registry);
+  manager.setWaitStrategy(Application::DecoderConfiguration::YIELD_WAIT, 100);
+  boost::ptr_vector<SequenceCollector> collectors;
+  for(size_t nChannel = 0; nChannel < channels; ++nChannel)
+  {
+    collectors.push_back(new SequenceCollector);
+    manager.addChannel(
+      "ch" + boost::lexical_cast<std::string>(nChannel),
+      collectors.back(),
+      channelConfiguration((unsigned short)(basePort + nChannel)));
+    BOOST_CHECK_EQUAL(manager.workerOf(nChannel), 0u);
+  }
+  manager.start();
+
+  ChannelSender sender(registry);
+  for(uint32 sequence = 0; sequence < messageCount; ++sequence)
+  {
+    for(size_t nChannel = 0; nChannel < channels; ++nChannel)
+    {
+      sender.send(nChannel, sequence);
+    }
+    if(sequence % 20 == 19)
+    {
+      // don't overrun the receive buffers.
+      boost::this_thread::sleep(boost::posix_time::milliseconds(2));
+    }
+  }
+  BOOST_CHECK(waitForMessages(collectors, messageCount));
+  manager.stop();
+  manager.join();
+
+  // The one worker decoded every channel's messages, in order.
+  boost::thread::id worker = collectors[0].threads_.empty() ? boost::thread::id() : collectors[0].threads_[0];
+  for(size_t nChannel = 0; nChannel < channels; ++nChannel)
+  {
+    SequenceCollector & collector = collectors[nChannel];
+    BOOST_CHECK_EQUAL(collector.sequences_.size(), size_t(messageCount));
+    BOOST_CHECK(inOrder(collector.sequences_));
+    BOOST_CHECK(std::count(collector.threads_.begin(), collector.threads_.end(), worker) == int(collector.threads_.size()));
+  }
+  BOOST_CHECK(worker != boost::this_thread::get_id());
+
+  std::stringstream report;
+  manager.report(report);
+  BOOST_CHECK(report.str().find("3 channels on 1 workers") != std::string::npos);
+  BOOST_CHECK(report.str().find("Channel ch2: worker 0; 200 buffers") != std::string::npos);
+  BOOST_TEST_MESSAGE(report.str());
+}
+
+BOOST_AUTO_TEST_CASE(testChannelManagerRebalance)
+{
+  const size_t channels = 3;
+  const uint32 messageCount = 20;
+  Codecs::TemplateRegistryPtr registry = createRegistry();
+  Application::ChannelManager manager(2);
+  manager.setTemplateRegistry(registry);
+  manager.setWaitStrategy(Application::DecoderConfiguration::YIELD_WAIT, 100);
+  boost::ptr_vector<SequenceCollector> collectors;
+  for(size_t nChannel = 0; nChannel < channels; ++nChannel)
+  {
+    // Channel 0 is much more expensive to decode than the others.
+    collectors.push_back(new SequenceCollector(nChannel == 0 ? 5 : 0));
+    manager.addChannel(
+      "ch" + boost::lexical_cast<std::string>(nChannel),
+      collectors.back(),
+      channelConfiguration((unsigned short)(basePort + 10 + nChannel)));
+  }
+  // round robin: the heavy channel shares worker 0 with channel 2.
+  BOOST_CHECK_EQUAL(manager.workerOf(0), 0u);
+  BOOST_CHECK_EQUAL(manager.workerOf(1), 1u);
+  BOOST_CHECK_EQUAL(manager.workerOf(2), 0u);
+  manager.start();
+
+  ChannelSender sender(registry);
+  for(uint32 sequence = 0; sequence < messageCount; ++sequence)
+  {
+    for(size_t nChannel = 0; nChannel < channels; ++nChannel)
+    {
+      sender.send(10 + nChannel, sequence);
+    }
+  }
+  BOOST_CHECK(waitForMessages(collectors, messageCount));
+
+  manager.rebalance();
+  BOOST_CHECK_EQUAL(manager.migrations(), 1u);
+  BOOST_CHECK_EQUAL(manager.workerOf(0), 0u);
+  BOOST_CHECK_EQUAL(manager.workerOf(1), 1u);
+  BOOST_CHECK_EQUAL(manager.workerOf(2), 1u);
+
+  // Channel 2's messages are now decoded by worker 1, still in order.
+  for(uint32 sequence = messageCount; sequence < 2 * messageCount; ++sequence)
+  {
+    for(size_t nChannel = 1; nChannel < channels; ++nChannel)
+    {
+      sender.send(10 + nChannel, sequence);
+    }
+  }
+  for(size_t tries = 0; tries < 500 && collectors[2].messages() < 2 * messageCount; ++tries)
+  {
+    boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+  }
+  manager.stop();
+  manager.join();
+
+  SequenceCollector & moved = collectors[2];
+  BOOST_REQUIRE_EQUAL(moved.sequences_.size(), size_t(2 * messageCount));
+  BOOST_CHECK(inOrder(moved.sequences_));
+  BOOST_REQUIRE(!collectors[0].threads_.empty());
+  BOOST_REQUIRE(!collectors[1].threads_.empty());
+  BOOST_CHECK(moved.threads_.front() == collectors[0].threads_.front());
+  BOOST_CHECK(moved.threads_.back() == collectors[1].threads_.front());
+  BOOST_CHECK(collectors[0].threads_.front() != collectors[1].threads_.front());
+}
+
+BOOST_AUTO_TEST_CASE(testChannelManagerStops)
+{
+  Codecs::TemplateRegistryPtr registry = createRegistry();
+  {
+    // stop() and join() end an idle manager.
+    Application::ChannelManager manager(2);
+    manager.setTemplateRegistry(registry);
+    SequenceCollector collector;
+    manager.addChannel("idle", collector, channelConfiguration(basePort + 20));
+    manager.start();
+    boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+    manager.stop();
+    manager.join();
+      BOOST_CHECK_EQUAL(collector.messages(), 0u);
+  }
+
+  // A channel that reaches its message limit stops, and when every channel
+  // has stopped the manager stops without a call to stop().
+  Application::ChannelManager manager(2);
+  manager.setTemplateRegistry(registry);
+  SequenceCollector limited;
+  Application::DecoderConfiguration configuration = channelConfiguration(basePort + 21);
+  configuration.setHead(5);
+  manager.addChannel("limited", limited, configuration);
+  manager.start();
+  ChannelSender sender(registry);
+  for(uint32 sequence = 0; sequence < 10; ++sequence)
+  {
+    sender.send(21, sequence);
+  }
+  boost::thread joiner(boost::bind(&Application::ChannelManager::join, &manager));
+  bool joined = joiner.timed_join(boost::posix_time::seconds(10));
+  BOOST_CHECK(joined);
+  if(!joined)
+  {
+    manager.stop();
+    joiner.join();
+  }
+  BOOST_CHECK(limited.messages() >= 5u);
+  BOOST_CHECK(limited.messages() < 10u);
+  BOOST_CHECK(manager.connection(0).receiver().stopping());
+}
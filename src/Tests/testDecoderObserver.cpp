@@ -0,0 +1,144 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+#include <Codecs/FieldInstructionAscii.h>
+#include <Codecs/FieldInstructionUInt32.h>
+#include <Codecs/FieldOpCopy.h>
+#include <Codecs/FieldOpDelta.h>
+#include <Codecs/FieldOpIncrement.h>
+#include <Codecs/Template.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/Encoder.h>
+#include <Codecs/Decoder.h>
+#include <Codecs/DecoderObserver.h>
+#include <Codecs/DataDestination.h>
+#include <Codecs/DataSourceString.h>
+#include <Codecs/SingleMessageConsumer.h>
+#include <Codecs/GenericMessageBuilder.h>
+#include <Messages/FieldSet.h>
+#include <Messages/FieldUInt32.h>
+#include <Messages/FieldAscii.h>
+#include <Messages/FieldIdentity.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  class CountingObserver : public Codecs::DecoderObserver
+  {
+  public:
+    CountingObserver()
+      : messages_(0)
+      , messageBytes_(0)
+      , headerBytes_(0)
+      , fieldBytes_(0)
+      , pmapBitsUsed_(0)
+      , pmapBitsSet_(0)
+    {
+    }
+
+    virtual void beginMessage(const Codecs::Template & templ, size_t headerBytes)
+    {
+      headerBytes_ += headerBytes;
+    }
+
+    virtual void fieldDecoded(
+      const Codecs::FieldInstruction & instruction,
+      size_t bytes,
+      bool pmapBitUsed,
+      bool pmapBitSet)
+    {
+      fieldBytes_ += bytes;
+      pmapBitsUsed_ += pmapBitUsed ? 1 : 0;
+      pmapBitsSet_ += pmapBitSet ? 1 : 0;
+      fields_.push_back(instruction.getName());
+    }
+
+    virtual void endMessage(const Codecs::Template & templ, size_t messageBytes)
+    {
+      ++messages_;
+      messageBytes_ += messageBytes;
+    }
+
+    size_t messages_;
+    size_t messageBytes_;
+    size_t headerBytes_;
+    size_t fieldBytes_;
+    size_t pmapBitsUsed_;
+    size_t pmapBitsSet_;
+    std::vector<std::string> fields_;
+  };
+
+  const Messages::FieldIdentity id_SeqNum("SeqNum");
+  const Messages::FieldIdentity id_Symbol("Symbol");
+  const Messages::FieldIdentity id_Price("Price");
+
+  Codecs::TemplateRegistryPtr createRegistry()
+  {
+    Codecs::TemplatePtr templ(new Codecs::Template);
+    templ->setId(5);
+    templ->setTemplateName("Trade");
+
+    Codecs::FieldInstructionPtr seqNum(new Codecs::FieldInstructionUInt32("SeqNum", ""));
+    seqNum->setFieldOp(Codecs::FieldOpPtr(new Codecs::FieldOpIncrement));
+    templ->addInstruction(seqNum);
+
+    Codecs::FieldInstructionPtr symbol(new Codecs::FieldInstructionAscii("Symbol", ""));
+    symbol->setFieldOp(Codecs::FieldOpPtr(new Codecs::FieldOpCopy));
+    templ->addInstruction(symbol);
+
+    Codecs::FieldInstructionPtr price(new Codecs::FieldInstructionUInt32("Price", ""));
+    price->setFieldOp(Codecs::FieldOpPtr(new Codecs::FieldOpDelta));
+    templ->addInstruction(price);
+
+    Codecs::TemplateRegistryPtr registry(new Codecs::TemplateRegistry);
+    registry->addTemplate(templ);
+    registry->finalize();
+    return registry;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testDecoderObserver)
+{
+  Codecs::TemplateRegistryPtr registry = createRegistry();
+
+  Codecs::Encoder encoder(registry);
+  Codecs::DataDestination destination;
+  for(uint32 pos = 0; pos < 3; ++pos)
+  {
+    Messages::FieldSet msg(3);
+    msg.addField(id_SeqNum, Messages::FieldUInt32::create(100 + pos));
+    msg.addField(id_Symbol, Messages::FieldAscii::create("ACME"));
+    msg.addField(id_Price, Messages::FieldUInt32::create(5000 + pos * 300));
+    encoder.encodeMessage(destination, 5, msg);
+  }
+  std::string fastString;
+  destination.toString(fastString);
+
+  Codecs::Decoder decoder(registry);
+  CountingObserver observer;
+  decoder.setObserver(&observer);
+  Codecs::DataSourceString source(fastString);
+  Codecs::SingleMessageConsumer consumer;
+  Codecs::GenericMessageBuilder builder(consumer);
+  for(size_t pos = 0; pos < 3; ++pos)
+  {
+    decoder.decodeMessage(source, builder);
+  }
+
+  BOOST_CHECK_EQUAL(observer.messages_, 3u);
+  BOOST_CHECK_EQUAL(observer.messageBytes_, fastString.size());
+  BOOST_CHECK_EQUAL(observer.headerBytes_ + observer.fieldBytes_, fastString.size());
+  BOOST_REQUIRE_EQUAL(observer.fields_.size(), 9u);
+  BOOST_CHECK_EQUAL(observer.fields_[0], "SeqNum");
+  BOOST_CHECK_EQUAL(observer.fields_[2], "Price");
+
+  // SeqNum and Symbol use a pmap bit in each message; Price (delta) does not.
+  BOOST_CHECK_EQUAL(observer.pmapBitsUsed_, 6u);
+  // Only the first message needs explicit values for SeqNum and Symbol.
+  BOOST_CHECK_EQUAL(observer.pmapBitsSet_, 2u);
+}
@@ -0,0 +1,87 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Codecs/Dictionary.h>
+#include <Codecs/Decoder.h>
+#include <Codecs/TemplateRegistry.h>
+
+using namespace QuickFAST;
+
+BOOST_AUTO_TEST_CASE(testDictionaryPages)
+{
+  Codecs::Dictionary dictionary(1000);
+  BOOST_CHECK_EQUAL(dictionary.size(), 1000u);
+  BOOST_CHECK_EQUAL(dictionary.allocatedEntries(), 0u);
+  size_t emptySize = dictionary.memoryUsed();
+  BOOST_CHECK(dictionary.find(999) == 0);
+
+  // Setting one entry allocates only its page.
+  dictionary.entry(3).setValue(int64(42));
+  BOOST_CHECK(dictionary.allocatedEntries() > 0);
+  BOOST_CHECK(dictionary.allocatedEntries() < 100);
+  BOOST_CHECK(dictionary.memoryUsed() > emptySize);
+  BOOST_CHECK(dictionary.find(999) == 0);
+  BOOST_REQUIRE(dictionary.find(3) != 0);
+  int64 value = 0;
+  BOOST_CHECK(dictionary.find(3)->getValue(value));
+  BOOST_CHECK_EQUAL(value, 42);
+  // Its neighbors on the same page are undefined.
+  BOOST_REQUIRE(dictionary.find(4) != 0);
+  BOOST_CHECK(!dictionary.find(4)->isDefined());
+
+  // A copy is independent of the original.
+  Codecs::Dictionary copy(dictionary);
+  BOOST_CHECK_EQUAL(copy.allocatedEntries(), dictionary.allocatedEntries());
+  copy.entry(3).setValue(int64(7));
+  BOOST_CHECK(dictionary.find(3)->getValue(value));
+  BOOST_CHECK_EQUAL(value, 42);
+
+  // Reset keeps the pages; release frees them.
+  dictionary.reset();
+  BOOST_CHECK(!dictionary.find(3)->isDefined());
+  BOOST_CHECK(dictionary.allocatedEntries() > 0);
+  dictionary.release();
+  BOOST_CHECK(dictionary.find(3) == 0);
+  BOOST_CHECK_EQUAL(dictionary.memoryUsed(), emptySize);
+
+  dictionary.swap(copy);
+  BOOST_CHECK(dictionary.find(3)->getValue(value));
+  BOOST_CHECK_EQUAL(value, 7);
+  BOOST_CHECK(copy.find(3) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(testContextSwapDictionary)
+{
+  Codecs::TemplateRegistryPtr registry(new Codecs::TemplateRegistry(1, 1, 100));
+  Codecs::Decoder decoder(registry);
+  int64 value = 0;
+  BOOST_CHECK_EQUAL(decoder.getDictionaryValue(5, value), Codecs::Context::UNDEFINED_VALUE);
+  decoder.setDictionaryValue(5, int64(11));
+  BOOST_CHECK_EQUAL(decoder.getDictionaryValue(5, value), Codecs::Context::OK_VALUE);
+  BOOST_CHECK_EQUAL(value, 11);
+  BOOST_CHECK(decoder.memoryUsed() >= decoder.dictionary().memoryUsed());
+
+  // Checkpoint the channel, then run another channel's state through the same decoder.
+  Codecs::Dictionary saved(decoder.dictionary());
+  Codecs::Dictionary other(registry->dictionarySize());
+  decoder.swapDictionary(other);
+  BOOST_CHECK_EQUAL(decoder.getDictionaryValue(5, value), Codecs::Context::UNDEFINED_VALUE);
+  decoder.setDictionaryValueNull(5);
+  BOOST_CHECK_EQUAL(decoder.getDictionaryValue(5, value), Codecs::Context::NULL_VALUE);
+
+  decoder.swapDictionary(saved);
+  BOOST_CHECK_EQUAL(decoder.getDictionaryValue(5, value), Codecs::Context::OK_VALUE);
+  BOOST_CHECK_EQUAL(value, 11);
+
+  decoder.reset();
+  BOOST_CHECK_EQUAL(decoder.getDictionaryValue(5, value), Codecs::Context::UNDEFINED_VALUE);
+
+  Codecs::Dictionary wrongSize(10);
+  BOOST_CHECK_THROW(decoder.swapDictionary(wrongSize), UsageError);
+  BOOST_CHECK_THROW(decoder.setDictionaryValue(100, int64(1)), TemplateDefinitionError);
+}
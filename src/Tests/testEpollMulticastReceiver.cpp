@@ -0,0 +1,102 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Communication/EpollMulticastReceiver.h>
+#include <Application/DecoderConfiguration.h>
+#include <Tests/ReceiverTestFixtures.h>
+
+using namespace QuickFAST;
+using namespace QuickFAST::Tests;
+
+BOOST_AUTO_TEST_CASE(testEpollConfiguration)
+{
+  Application::DecoderConfiguration configuration;
+  configuration.setListenInterfaceIP("127.0.0.1");
+  char option[] = "-epoll";
+  char groups[] = "239.1.1.254:30001/3,239.2.0.1:30002";
+  char * argv[] = {option, groups};
+  BOOST_CHECK_EQUAL(configuration.parseSingleArg(2, argv), 2);
+  BOOST_CHECK_EQUAL(configuration.receiverType(), Application::DecoderConfiguration::EPOLL_RECEIVER);
+  BOOST_REQUIRE_EQUAL(configuration.multicastCount(), 4u);
+  BOOST_CHECK_EQUAL(configuration.multicastGroupIP(0), "239.1.1.254");
+  BOOST_CHECK_EQUAL(configuration.multicastGroupIP(2), "239.1.2.0");
+  BOOST_CHECK_EQUAL(configuration.multicastName(2), "239.1.2.0:30001");
+  BOOST_CHECK_EQUAL(configuration.portNumber(2), 30001);
+  BOOST_CHECK_EQUAL(configuration.multicastGroupIP(3), "239.2.0.1");
+  BOOST_CHECK_EQUAL(configuration.portNumber(3), 30002);
+  // later feeds share the first feed's interface
+  BOOST_CHECK_EQUAL(configuration.listenInterfaceIP(3), "127.0.0.1");
+  BOOST_CHECK_EQUAL(configuration.multicastBindIP(3), configuration.multicastBindIP(0));
+}
+
+#if defined(__linux__)
+BOOST_AUTO_TEST_CASE(testEpollMulticastReceiver)
+{
+  const size_t feeds = 200;
+  const unsigned short basePort = 41000;
+  Communication::EpollMulticastReceiver receiver;
+  for(size_t nFeed = 0; nFeed < feeds; ++nFeed)
+  {
+    std::stringstream group;
+    group << "239.255." << (nFeed / 250) << '.' << (nFeed % 250 + 1);
+    receiver.addFeed(group.str(), group.str(), "0.0.0.0", "0.0.0.0", (unsigned short)(basePort + nFeed));
+  }
+  receiver.setReceiveBatch(8);
+
+  TestLogger logger;
+  SourceCountingAssembler assembler(logger, feeds);
+  if(!receiver.start(assembler, 64, 64))
+  {
+    BOOST_TEST_MESSAGE("testEpollMulticastReceiver: cannot join the multicast groups here. Skipped.");
+    return;
+  }
+  BOOST_CHECK_EQUAL(receiver.feedCount(), feeds);
+
+  // Unicast to the local port reaches the socket bound to 0.0.0.0.
+  // Feed n gets (n % 4) + 1 packets, each carrying n.
+  boost::asio::io_service ioService;
+  boost::asio::ip::udp::socket sender(ioService);
+  sender.open(boost::asio::ip::udp::v4());
+  size_t sent = 0;
+  for(size_t nFeed = 0; nFeed < feeds; ++nFeed)
+  {
+    boost::asio::ip::udp::endpoint destination(
+      boost::asio::ip::address::from_string("127.0.0.1"),
+      (unsigned short)(basePort + nFeed));
+    std::string payload = boost::lexical_cast<std::string>(nFeed);
+    for(size_t nPacket = 0; nPacket <= nFeed % 4; ++nPacket)
+    {
+      sender.send_to(boost::asio::buffer(payload), destination);
+      ++sent;
+    }
+  }
+
+  for(size_t tries = 0; assembler.total_ < sent && tries < 100; ++tries)
+  {
+    receiver.poll();
+    if(assembler.total_ < sent)
+    {
+      boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    }
+  }
+  receiver.stop();
+
+  BOOST_CHECK_EQUAL(assembler.total_, sent);
+  BOOST_CHECK_EQUAL(assembler.mislabeled_, 0u);
+  for(size_t nFeed = 0; nFeed < feeds; ++nFeed)
+  {
+    BOOST_CHECK_EQUAL(assembler.counts_[nFeed], nFeed % 4 + 1);
+    BOOST_CHECK_EQUAL(receiver.feedPackets(nFeed), nFeed % 4 + 1);
+  }
+
+  std::stringstream report;
+  receiver.report(report);
+  BOOST_CHECK(report.str().find("200 groups") != std::string::npos);
+  BOOST_TEST_MESSAGE(report.str());
+}
+#endif // __linux__
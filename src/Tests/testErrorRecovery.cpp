@@ -11,6 +11,7 @@
 #include <Codecs/FixedSizeHeaderAnalyzer.h>
 #include <Codecs/NoHeaderAnalyzer.h>
 #include <Codecs/PacketSequencingAssembler.h>
+#include <Codecs/StreamingAssembler.h>
 #include <Messages/FieldIdentity.h>
 #include <Messages/SequentialSingleValueBuilder.h>
 #include <Communication/RecoveryFeed.h>
@@ -37,14 +38,28 @@ namespace
     uchar data;
     static const size_t byteCount = sizeof(sequence_t) + sizeof(uchar) + sizeof(uchar) + sizeof(uchar);
 
-    Packet(uchar value)
+    Packet(sequence_t value)
       : sequenceNumber(value)
       , pmap('\xC0')
       , tid('\x81')
-      , data('\x80' | value)
+      , data(uchar('\x80' | (value & 0x7F)))
     {
     }
   };
+
+  typedef boost::shared_ptr<Communication::LinkedBuffer> LinkedBufferPtr;
+
+  // A packet with any sequence number in a buffer of its own.
+  // The decoded value is the low seven bits of the sequence number.
+  Communication::LinkedBuffer * makePacket(std::vector<LinkedBufferPtr> & owner, sequence_t sequenceNumber)
+  {
+    Packet packet(sequenceNumber);
+    LinkedBufferPtr buffer(new Communication::LinkedBuffer(Packet::byteCount));
+    std::memcpy(buffer->get(), &packet, Packet::byteCount);
+    buffer->setUsed(Packet::byteCount);
+    owner.push_back(buffer);
+    return buffer.get();
+  }
 #define PACKET(num) \
   Packet packet##num(num);\
   Communication::LinkedBuffer buffer##num(reinterpret_cast<unsigned char *>(&packet##num), Packet::byteCount, (void *)num);\
@@ -323,6 +338,165 @@ BOOST_AUTO_TEST_CASE(TestPacketSequencingAssemblerReorderAndGapDetect)
   BOOST_CHECK(!builder.hasError());
 }
 
+BOOST_AUTO_TEST_CASE(TestPacketSequencingAssemblerReportsReceiveTime)
+{
+  std::stringstream templateStream(template_xml);
+  Codecs::XMLTemplateParser parser;
+  Codecs::TemplateRegistryPtr templateRegistry =
+    parser.parse(templateStream);
+
+  bool bigEndian = ByteSwapper::isBigEndian();
+  Codecs::FixedSizeHeaderAnalyzer packetHeaderAnalyzer(0, bigEndian, 4, 0, 0, 4);
+  Codecs::NoHeaderAnalyzer messageHeaderAnalyzer;
+
+  Messages::SequentialSingleValueBuilder<uint32> builder;
+  Communication::RecoveryFeedPtr recoveryFeed; // no recovery feed
+  Codecs::PacketSequencingAssembler assembler(
+      templateRegistry,
+      packetHeaderAnalyzer,
+      messageHeaderAnalyzer,
+      builder,
+      4,
+      recoveryFeed);
+  TestReceiver receiver;
+
+  // A buffer with no receive time reports nothing
+  Communication::LinkedBuffer first(reinterpret_cast<unsigned char *>(&packet0), Packet::byteCount, (void *)0);
+  receiver.acceptBuffer(&first);
+  assembler.serviceQueue(receiver);
+  BOOST_REQUIRE_EQUAL(builder.valueCount(), 1);
+  BOOST_CHECK_EQUAL(builder.receiveTime(), 0u);
+
+  // The receive time reaches the builder with the packet.
+  const uint64 arrived = uint64(1300000000) * 1000000000 + 123456789;
+  Communication::LinkedBuffer second(reinterpret_cast<unsigned char *>(&packet1), Packet::byteCount, (void *)1);
+  second.setReceiveTime(arrived);
+  receiver.acceptBuffer(&second);
+  assembler.serviceQueue(receiver);
+  BOOST_REQUIRE_EQUAL(builder.valueCount(), 2);
+  BOOST_CHECK_EQUAL(builder.receiveTime(), arrived);
+}
+
+BOOST_AUTO_TEST_CASE(TestPacketSequencingAssemblerArbitratesLines)
+{
+  std::stringstream templateStream(template_xml);
+  Codecs::XMLTemplateParser parser;
+  Codecs::TemplateRegistryPtr templateRegistry =
+    parser.parse(templateStream);
+
+  bool bigEndian = ByteSwapper::isBigEndian();
+  Codecs::FixedSizeHeaderAnalyzer packetHeaderAnalyzer(0, bigEndian, 4, 0, 0, 4);
+  Codecs::NoHeaderAnalyzer messageHeaderAnalyzer;
+
+  Messages::SequentialSingleValueBuilder<uint32> builder;
+  Communication::RecoveryFeedPtr recoveryFeed; // no recovery feed
+  Codecs::PacketSequencingAssembler assembler(
+      templateRegistry,
+      packetHeaderAnalyzer,
+      messageHeaderAnalyzer,
+      builder,
+      4,
+      recoveryFeed);
+  TestReceiver receiver;
+
+  // Line A delivers 0, 1, and 3.  Line B delivers 0, 1, 2, and 3
+  Communication::LinkedBuffer a0(reinterpret_cast<unsigned char *>(&packet0), Packet::byteCount, (void *)0);
+  Communication::LinkedBuffer a1(reinterpret_cast<unsigned char *>(&packet1), Packet::byteCount, (void *)1);
+  Communication::LinkedBuffer a3(reinterpret_cast<unsigned char *>(&packet3), Packet::byteCount, (void *)3);
+  Communication::LinkedBuffer b0(reinterpret_cast<unsigned char *>(&packet0), Packet::byteCount, (void *)0);
+  Communication::LinkedBuffer b1(reinterpret_cast<unsigned char *>(&packet1), Packet::byteCount, (void *)1);
+  Communication::LinkedBuffer b2(reinterpret_cast<unsigned char *>(&packet2), Packet::byteCount, (void *)2);
+  Communication::LinkedBuffer b3(reinterpret_cast<unsigned char *>(&packet3), Packet::byteCount, (void *)3);
+  b0.setSource(1);
+  b1.setSource(1);
+  b2.setSource(1);
+  b3.setSource(1);
+
+  receiver.acceptBuffer(&a0);
+  receiver.acceptBuffer(&b0);
+  receiver.acceptBuffer(&b1);
+  receiver.acceptBuffer(&a1);
+  receiver.acceptBuffer(&a3);
+  receiver.acceptBuffer(&b2);
+  receiver.acceptBuffer(&b3);
+  assembler.serviceQueue(receiver);
+
+  // Each packet is decoded exactly once, in order.
+  BOOST_REQUIRE_EQUAL(builder.valueCount(), 4);
+  BOOST_CHECK(builder.value(0) == 0);
+  BOOST_CHECK(builder.value(1) == 1);
+  BOOST_CHECK(builder.value(2) == 2);
+  BOOST_CHECK(builder.value(3) == 3);
+  BOOST_CHECK(!builder.hasGap());
+  BOOST_CHECK(!builder.hasError());
+
+  const Codecs::LineArbitrator & arbitrator = assembler.arbitrator();
+  BOOST_REQUIRE_EQUAL(arbitrator.lineCount(), 2u);
+  BOOST_CHECK_EQUAL(arbitrator.wins(0), 2u);
+  BOOST_CHECK_EQUAL(arbitrator.duplicates(0), 1u);
+  BOOST_CHECK_EQUAL(arbitrator.missing(0), 1u);
+  BOOST_CHECK_EQUAL(arbitrator.wins(1), 2u);
+  BOOST_CHECK_EQUAL(arbitrator.duplicates(1), 2u);
+  BOOST_CHECK_EQUAL(arbitrator.missing(1), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(TestPacketSequencingAssemblerDeepReorder)
+{
+  std::stringstream templateStream(template_xml);
+  Codecs::XMLTemplateParser parser;
+  Codecs::TemplateRegistryPtr templateRegistry =
+    parser.parse(templateStream);
+
+  bool bigEndian = ByteSwapper::isBigEndian();
+  Codecs::FixedSizeHeaderAnalyzer packetHeaderAnalyzer(0, bigEndian, 4, 0, 0, 4);
+  Codecs::NoHeaderAnalyzer messageHeaderAnalyzer;
+
+  Messages::SequentialSingleValueBuilder<uint32> builder;
+  Communication::RecoveryFeedPtr recoveryFeed; // no recovery feed
+  Codecs::PacketSequencingAssembler assembler(
+      templateRegistry,
+      packetHeaderAnalyzer,
+      messageHeaderAnalyzer,
+      builder,
+      100,
+      recoveryFeed);
+  BOOST_CHECK_EQUAL(assembler.lookAheadCount(), 128u);
+  TestReceiver receiver;
+  std::vector<LinkedBufferPtr> packets;
+
+  // 1 through 99 arrive in reverse order.
+  receiver.acceptBuffer(makePacket(packets, 0));
+  for(sequence_t seq = 99; seq > 0; --seq)
+  {
+    receiver.acceptBuffer(makePacket(packets, seq));
+  }
+  assembler.serviceQueue(receiver);
+  BOOST_REQUIRE_EQUAL(builder.valueCount(), 100);
+  for(size_t nValue = 0; nValue < 100; ++nValue)
+  {
+    BOOST_CHECK_EQUAL(builder.value(nValue), nValue & 0x7F);
+  }
+  BOOST_CHECK(!builder.hasGap());
+  BOOST_CHECK_EQUAL(assembler.reorderedPackets(), 98u);
+  BOOST_CHECK_EQUAL(assembler.maxReorderDepth(), 98u);
+  BOOST_CHECK_EQUAL(assembler.deferredPackets(), 0u);
+
+  // Gaps end at packets found in the look-ahead ring (across word boundaries)
+  // and finally at a packet beyond it.
+  builder.reset();
+  receiver.acceptBuffer(makePacket(packets, 170));
+  receiver.acceptBuffer(makePacket(packets, 140));
+  receiver.acceptBuffer(makePacket(packets, 300));
+  assembler.serviceQueue(receiver);
+  BOOST_CHECK(builder.hasGap());
+  BOOST_REQUIRE_EQUAL(builder.valueCount(), 3);
+  BOOST_CHECK_EQUAL(builder.value(0), 140u & 0x7F);
+  BOOST_CHECK_EQUAL(builder.value(1), 170u & 0x7F);
+  BOOST_CHECK_EQUAL(builder.value(2), 300u & 0x7F);
+  BOOST_CHECK_EQUAL(assembler.maxReorderDepth(), 200u);
+  BOOST_CHECK_EQUAL(assembler.deferredPackets(), 1u);
+}
+
 void faultyHeader()
 {
   std::stringstream templateStream(template_xml);
@@ -342,6 +516,78 @@ void faultyHeader()
       recoveryFeed);
 }
 
+BOOST_AUTO_TEST_CASE(TestStreamingAssemblerFramesMessages)
+{
+  std::stringstream templateStream(template_xml);
+  Codecs::XMLTemplateParser parser;
+  Codecs::TemplateRegistryPtr templateRegistry =
+    parser.parse(templateStream);
+
+  // Each message has a one byte length header.
+  Codecs::FixedSizeHeaderAnalyzer messageHeaderAnalyzer(1);
+  Messages::SequentialSingleValueBuilder<uint32> builder;
+  Codecs::StreamingAssembler assembler(
+      templateRegistry,
+      messageHeaderAnalyzer,
+      builder);
+  TestReceiver receiver;
+
+  // A stream of messages whose values take 1 to 5 bytes.
+  const uint32 values[] = {1, 300, 70000, 10000000, 4000000000u, 2, 129, 65536};
+  const size_t valueCount = sizeof(values)/sizeof(values[0]);
+  std::string stream;
+  for(size_t nValue = 0; nValue < valueCount; ++nValue)
+  {
+    std::string field;
+    uint32 value = values[nValue];
+    field.insert(field.begin(), char(0x80 | (value & 0x7F)));
+    while((value >>= 7) != 0)
+    {
+      field.insert(field.begin(), char(value & 0x7F));
+    }
+    stream += char(2 + field.size()); // header: message length
+    stream += '\xC0';                 // pmap
+    stream += '\x81';                 // template id
+    stream += field;
+  }
+
+  // Deliver the stream three bytes at a time so most messages span buffers.
+  // The receiver never waits, so the decoder must never be asked to decode
+  // a message that has not completely arrived.
+  const size_t chunk = 3;
+  std::vector<LinkedBufferPtr> chunks;
+  size_t expected = 0;
+  size_t messageEnd = 1 + uchar(stream[0]);
+  for(size_t position = 0; position < stream.size(); position += chunk)
+  {
+    size_t size = std::min(chunk, stream.size() - position);
+    LinkedBufferPtr buffer(new Communication::LinkedBuffer(chunk));
+    std::memcpy(buffer->get(), stream.data() + position, size);
+    buffer->setUsed(size);
+    buffer->setReceiveTime(position + 1);
+    chunks.push_back(buffer);
+    receiver.acceptBuffer(buffer.get());
+    BOOST_REQUIRE(assembler.serviceQueue(receiver));
+
+    while(expected < valueCount && messageEnd <= position + size)
+    {
+      ++expected;
+      if(messageEnd < stream.size())
+      {
+        messageEnd += 1 + uchar(stream[messageEnd]);
+      }
+    }
+    BOOST_REQUIRE_EQUAL(builder.valueCount(), expected);
+  }
+  BOOST_CHECK_EQUAL(builder.valueCount(), valueCount);
+  for(size_t nValue = 0; nValue < valueCount && nValue < builder.valueCount(); ++nValue)
+  {
+    BOOST_CHECK_EQUAL(builder.value(nValue), values[nValue]);
+  }
+  BOOST_CHECK(assembler.stitchedMessages() > 0);
+  BOOST_CHECK_EQUAL(builder.receiveTime(), uint64(stream.size() - (stream.size() - 1) % chunk));
+}
+
 BOOST_AUTO_TEST_CASE(TestPacketSequencingAssemblerDetectConfigError)
 {
   BOOST_CHECK_THROW(faultyHeader(), UsageError);
@@ -119,6 +119,37 @@ BOOST_AUTO_TEST_CASE(testFieldInstructionByteVector)
   testFieldInstructionBaseClass(instruction, 1);
 }
 
+BOOST_AUTO_TEST_CASE(testLongestMatchingPrefixAndSuffix)
+{
+  // lengths chosen to exercise both the vector loop and the byte-by-byte tail
+  const std::string base("Option on ACME Corp. common stock, expiring third Friday, strike 125.00 USD");
+  for(size_t mismatch = 0; mismatch < base.size(); ++mismatch)
+  {
+    std::string changed(base);
+    changed[mismatch] = '#';
+    BOOST_CHECK_EQUAL(Codecs::FieldInstruction::longestMatchingPrefix(base, changed), mismatch);
+    BOOST_CHECK_EQUAL(Codecs::FieldInstruction::longestMatchingSuffix(base, changed), base.size() - mismatch - 1);
+    StringBuffer changedBuffer(changed);
+    BOOST_CHECK_EQUAL(Codecs::FieldInstruction::longestMatchingPrefix(base, changedBuffer), mismatch);
+    BOOST_CHECK_EQUAL(Codecs::FieldInstruction::longestMatchingSuffix(base, changedBuffer), base.size() - mismatch - 1);
+  }
+  BOOST_CHECK_EQUAL(Codecs::FieldInstruction::longestMatchingPrefix(base, base), base.size());
+  BOOST_CHECK_EQUAL(Codecs::FieldInstruction::longestMatchingSuffix(base, base), base.size());
+  BOOST_CHECK_EQUAL(Codecs::FieldInstruction::longestMatchingPrefix(base, base.substr(0, 40)), 40u);
+  BOOST_CHECK_EQUAL(Codecs::FieldInstruction::longestMatchingSuffix(base, base.substr(35)), base.size() - 35);
+  BOOST_CHECK_EQUAL(Codecs::FieldInstruction::longestMatchingPrefix(base, std::string()), 0u);
+  BOOST_CHECK_EQUAL(Codecs::FieldInstruction::longestMatchingSuffix(std::string(), base), 0u);
+
+  std::string result;
+  const uchar * delta = reinterpret_cast<const uchar *>("XYZ");
+  Codecs::FieldInstruction::applyStringDelta(base, 10, true, delta, 3, result);
+  BOOST_CHECK_EQUAL(result, "XYZ" + base.substr(10));
+  Codecs::FieldInstruction::applyStringDelta(base, 10, false, delta, 3, result);
+  BOOST_CHECK_EQUAL(result, base.substr(0, base.size() - 10) + "XYZ");
+  Codecs::FieldInstruction::applyStringDelta(base, base.size(), false, delta, 0, result);
+  BOOST_CHECK(result.empty());
+}
+
 BOOST_AUTO_TEST_CASE(testFieldInstructionInt8)
 {
   Codecs::FieldInstructionInt8 instruction("Name", "NS");
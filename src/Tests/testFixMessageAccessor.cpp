@@ -0,0 +1,196 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+#include <Codecs/FixMessageAccessor.h>
+#include <Codecs/FieldInstructionAscii.h>
+#include <Codecs/FieldInstructionUInt32.h>
+#include <Codecs/FieldInstructionInt32.h>
+#include <Codecs/FieldInstructionDecimal.h>
+#include <Codecs/FieldInstructionSequence.h>
+#include <Codecs/FieldOpCopy.h>
+#include <Codecs/FieldOpIncrement.h>
+#include <Codecs/Template.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/Encoder.h>
+#include <Codecs/Decoder.h>
+#include <Codecs/DataDestination.h>
+#include <Codecs/DataSourceString.h>
+#include <Messages/FixMessageBuilder.h>
+#include <Common/Exceptions.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  class FixCollector : public Messages::FixMessageBuilder
+  {
+  public:
+    FixCollector()
+    {
+      setDelimiter('|');
+    }
+
+    virtual bool deliverMessage(const char * message, size_t length)
+    {
+      messages_.push_back(std::string(message, length));
+      return true;
+    }
+
+    virtual bool wantLog(unsigned short level)
+    {
+      return false;
+    }
+    virtual bool logMessage(unsigned short level, const std::string & logMessage)
+    {
+      return true;
+    }
+    virtual bool reportDecodingError(const std::string & errorMessage)
+    {
+      return false;
+    }
+    virtual bool reportCommunicationError(const std::string & errorMessage)
+    {
+      return false;
+    }
+
+    std::vector<std::string> messages_;
+  };
+
+  Codecs::FieldInstructionPtr field(Codecs::FieldInstruction * instruction, const std::string & id, bool mandatory)
+  {
+    Codecs::FieldInstructionPtr result(instruction);
+    result->setId(id);
+    result->setPresence(mandatory);
+    return result;
+  }
+
+  /// MsgSeqNum, Symbol and a sequence of MDEntries (MDUpdateAction, MDEntryPx, optional MDEntrySize)
+  Codecs::TemplateRegistryPtr createRegistry()
+  {
+    Codecs::TemplatePtr templ(new Codecs::Template);
+    templ->setId(7);
+    templ->setTemplateName("MDIncRefresh");
+
+    Codecs::FieldInstructionPtr seqNum = field(new Codecs::FieldInstructionUInt32("MsgSeqNum", ""), "34", true);
+    seqNum->setFieldOp(Codecs::FieldOpPtr(new Codecs::FieldOpIncrement));
+    templ->addInstruction(seqNum);
+
+    Codecs::FieldInstructionPtr symbol = field(new Codecs::FieldInstructionAscii("Symbol", ""), "55", true);
+    symbol->setFieldOp(Codecs::FieldOpPtr(new Codecs::FieldOpCopy));
+    templ->addInstruction(symbol);
+
+    Codecs::SegmentBodyPtr entry(new Codecs::SegmentBody);
+    entry->allowLengthField();
+    Codecs::FieldInstructionPtr length = field(new Codecs::FieldInstructionUInt32("NoMDEntries", ""), "268", true);
+    entry->addLengthInstruction(length);
+    Codecs::FieldInstructionPtr action = field(new Codecs::FieldInstructionUInt32("MDUpdateAction", ""), "279", true);
+    entry->addInstruction(action);
+    Codecs::FieldInstructionPtr price = field(new Codecs::FieldInstructionDecimal("MDEntryPx", ""), "270", true);
+    entry->addInstruction(price);
+    Codecs::FieldInstructionPtr size = field(new Codecs::FieldInstructionInt32("MDEntrySize", ""), "271", false);
+    entry->addInstruction(size);
+
+    Codecs::FieldInstructionPtr entries(new Codecs::FieldInstructionSequence("MDEntries", ""));
+    entries->setSegmentBody(entry);
+    templ->addInstruction(entries);
+
+    Codecs::TemplateRegistryPtr registry(new Codecs::TemplateRegistry);
+    registry->addTemplate(templ);
+    registry->finalize();
+    return registry;
+  }
+
+  std::string fix(const std::string & text)
+  {
+    std::string result(text);
+    std::replace(result.begin(), result.end(), '|', '\x01');
+    return result;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testFixMessageAccessor)
+{
+  Codecs::TemplateRegistryPtr registry = createRegistry();
+  Codecs::FixMessageAccessor accessor(registry);
+  Codecs::Encoder encoder(registry);
+  Codecs::DataDestination destination;
+
+  const std::string messages[2] = {
+    fix("8=FIX.4.4|9=999|35=X|34=12|55=ACME|268=2|279=0|270=123.45|271=100|279=1|270=-0.5|10=000|"),
+    fix("8=FIX.4.4|9=999|35=X|34=13|55=ACME|268=1|279=2|270=7|271=-3|10=000|")
+  };
+  for(size_t pos = 0; pos < 2; ++pos)
+  {
+    BOOST_REQUIRE(accessor.parse(messages[pos].data(), messages[pos].size()));
+    const char * msgType;
+    size_t msgTypeLength;
+    BOOST_REQUIRE(accessor.getTagValue(35, msgType, msgTypeLength));
+    BOOST_CHECK_EQUAL(std::string(msgType, msgTypeLength), "X");
+    encoder.encodeMessage(destination, 7, accessor);
+  }
+  std::string fastString;
+  destination.toString(fastString);
+
+  Codecs::Decoder decoder(registry);
+  Codecs::DataSourceString source(fastString);
+  FixCollector collector;
+  decoder.decodeMessage(source, collector);
+  decoder.decodeMessage(source, collector);
+  BOOST_REQUIRE_EQUAL(collector.messages_.size(), 2u);
+  BOOST_CHECK_EQUAL(collector.messages_[0], "34=12|55=ACME|268=2|279=0|270=123.45|271=100|279=1|270=-0.5|");
+  BOOST_CHECK_EQUAL(collector.messages_[1], "34=13|55=ACME|268=1|279=2|270=7|271=-3|");
+}
+
+BOOST_AUTO_TEST_CASE(testFixMessageAccessorErrors)
+{
+  Codecs::TemplateRegistryPtr registry = createRegistry();
+  Codecs::FixMessageAccessor accessor(registry);
+
+  const std::string badTag = fix("8=FIX.4.4|3x=1|");
+  BOOST_CHECK(!accessor.parse(badTag.data(), badTag.size()));
+
+  const std::string badValue = fix("35=X|34=twelve|55=ACME|268=0|");
+  BOOST_REQUIRE(accessor.parse(badValue.data(), badValue.size()));
+  BOOST_CHECK_EQUAL(accessor.fieldCount(), 4u);
+  Codecs::Encoder encoder(registry);
+  Codecs::DataDestination destination;
+  BOOST_CHECK_THROW(encoder.encodeMessage(destination, 7, accessor), EncodingError);
+}
+
+BOOST_AUTO_TEST_CASE(testFixMessageAccessorGroupMembers)
+{
+  Codecs::TemplateRegistryPtr registry = createRegistry();
+  Codecs::FixMessageAccessor accessor(registry);
+  const char * value;
+  size_t length;
+
+  // 270 appears in the entry first, then at the top level after the group has ended.
+  const std::string message = fix("35=X|268=1|279=0|270=1.5|58=text|270=99|");
+  BOOST_REQUIRE(accessor.parse(message.data(), message.size()));
+  BOOST_REQUIRE(accessor.getTagValue(270, value, length));
+  BOOST_CHECK_EQUAL(std::string(value, length), "99");
+  // a tag that only appears within the group is not a top-level field.
+  BOOST_CHECK(!accessor.getTagValue(279, value, length));
+  BOOST_REQUIRE(accessor.getTagValue(268, value, length));
+  BOOST_CHECK_EQUAL(std::string(value, length), "1");
+
+  // Top-level fields that follow the group are still found when encoding.
+  const std::string trailing = fix("35=X|268=1|279=2|270=7|271=-3|34=14|55=ACME|");
+  BOOST_REQUIRE(accessor.parse(trailing.data(), trailing.size()));
+  Codecs::Encoder encoder(registry);
+  Codecs::DataDestination destination;
+  encoder.encodeMessage(destination, 7, accessor);
+  std::string fastString;
+  destination.toString(fastString);
+
+  Codecs::Decoder decoder(registry);
+  Codecs::DataSourceString source(fastString);
+  FixCollector collector;
+  decoder.decodeMessage(source, collector);
+  BOOST_REQUIRE_EQUAL(collector.messages_.size(), 1u);
+  BOOST_CHECK_EQUAL(collector.messages_[0], "34=14|55=ACME|268=1|279=2|270=7|271=-3|");
+}
@@ -0,0 +1,110 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+#include <Messages/FixMessageBuilder.h>
+#include <Messages/FieldIdentity.h>
+#include <Common/Decimal.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  class FixCollector : public Messages::FixMessageBuilder
+  {
+  public:
+    explicit FixCollector(const std::string & beginString = "")
+      : Messages::FixMessageBuilder(beginString)
+    {
+      setDelimiter('|');
+    }
+
+    virtual bool deliverMessage(const char * message, size_t length)
+    {
+      messages_.push_back(std::string(message, length));
+      return true;
+    }
+
+    virtual bool wantLog(unsigned short level)
+    {
+      return false;
+    }
+    virtual bool logMessage(unsigned short level, const std::string & logMessage)
+    {
+      return true;
+    }
+    virtual bool reportDecodingError(const std::string & errorMessage)
+    {
+      return false;
+    }
+    virtual bool reportCommunicationError(const std::string & errorMessage)
+    {
+      return false;
+    }
+
+    std::vector<std::string> messages_;
+  };
+
+  const Messages::FieldIdentity id_MsgType("MessageType", "", "35");
+  const Messages::FieldIdentity id_SeqNum("MsgSeqNum", "", "34");
+  const Messages::FieldIdentity id_NetChg("NetChgPrevDay", "", "451");
+  const Messages::FieldIdentity id_NoTag("Internal");
+  const Messages::FieldIdentity id_Entries("MDEntries");
+  const Messages::FieldIdentity id_NoEntries("NoMDEntries", "", "268");
+  const Messages::FieldIdentity id_Px("MDEntryPx", "", "270");
+
+  void buildMessage(Messages::ValueMessageBuilder & builder)
+  {
+    Messages::ValueMessageBuilder & body = builder.startMessage("", "", 10);
+    static const unsigned char msgType[] = "X";
+    body.addValue(id_MsgType, ValueType::ASCII, msgType, 1);
+    body.addValue(id_SeqNum, ValueType::UINT32, uint32(1234567));
+    body.addValue(id_NetChg, ValueType::INT32, int32(-42));
+    body.addValue(id_NoTag, ValueType::UINT32, uint32(99));
+    Messages::ValueMessageBuilder & entries = body.startSequence(id_Entries, "", "", 1, id_NoEntries, 3);
+    Decimal prices[3] = {Decimal(12345, -2), Decimal(5, -3), Decimal(-15, 1)};
+    for(size_t pos = 0; pos < 3; ++pos)
+    {
+      Messages::ValueMessageBuilder & entry = entries.startSequenceEntry("", "", 1);
+      entry.addValue(id_Px, ValueType::DECIMAL, prices[pos]);
+      entries.endSequenceEntry(entry);
+    }
+    body.endSequence(id_Entries, entries);
+    builder.endMessage(body);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testFixMessageBuilder)
+{
+  FixCollector collector;
+  buildMessage(collector);
+  buildMessage(collector);
+  BOOST_REQUIRE_EQUAL(collector.messages_.size(), 2u);
+  const std::string expected = "35=X|34=1234567|451=-42|268=3|270=123.45|270=0.005|270=-150|";
+  BOOST_CHECK_EQUAL(collector.messages_[0], expected);
+  BOOST_CHECK_EQUAL(collector.messages_[1], expected);
+}
+
+BOOST_AUTO_TEST_CASE(testFixMessageBuilderFraming)
+{
+  FixCollector collector("FIX.4.4");
+  buildMessage(collector);
+  BOOST_REQUIRE_EQUAL(collector.messages_.size(), 1u);
+  const std::string & message = collector.messages_[0];
+
+  const std::string body = "35=X|34=1234567|451=-42|268=3|270=123.45|270=0.005|270=-150|";
+  std::string header = "8=FIX.4.4|9=" + boost::lexical_cast<std::string>(body.size()) + "|";
+  BOOST_CHECK_EQUAL(message.substr(0, header.size() + body.size()), header + body);
+
+  unsigned int checksum = 0;
+  for(size_t pos = 0; pos < header.size() + body.size(); ++pos)
+  {
+    checksum += static_cast<unsigned char>(message[pos]);
+  }
+  std::ostringstream trailer;
+  trailer << "10=" << std::setw(3) << std::setfill('0') << (checksum % 256) << '|';
+  BOOST_CHECK_EQUAL(message.substr(header.size() + body.size()), trailer.str());
+}
@@ -0,0 +1,293 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Codecs/LineArbitrator.h>
+#include <Codecs/PacketSequencingAssembler.h>
+#include <Codecs/FixedSizeHeaderAnalyzer.h>
+#include <Codecs/NoHeaderAnalyzer.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Messages/SequentialSingleValueBuilder.h>
+#include <Messages/FieldSet.h>
+#include <Messages/FieldUInt32.h>
+#include <Messages/FieldIdentity.h>
+#include <Codecs/FieldInstructionUInt32.h>
+#include <Codecs/Template.h>
+#include <Codecs/Encoder.h>
+#include <Codecs/DataDestination.h>
+#include <Communication/RecoveryFeed.h>
+#include <Communication/SynchReceiver.h>
+#include <Application/DecoderConfiguration.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  /// Deliver prepared packets, each tagged with the line it "arrived" on.
+  class PacketListReceiver : public Communication::SynchReceiver
+  {
+  public:
+    PacketListReceiver()
+      : next_(0)
+    {
+    }
+
+    void add(size_t line, const std::string & packet)
+    {
+      packets_.push_back(std::make_pair(line, packet));
+    }
+
+    virtual void resetService()
+    {
+    }
+
+  private:
+    virtual bool initializeReceiver()
+    {
+      return true;
+    }
+
+    virtual bool fillBuffer(Communication::LinkedBuffer * buffer, boost::mutex::scoped_lock& lock)
+    {
+      if(next_ < packets_.size())
+      {
+        const std::string & packet = packets_[next_].second;
+        std::memcpy(buffer->get(), packet.data(), packet.size());
+        buffer->setSource(packets_[next_].first);
+        ++next_;
+        acceptFullBuffer(buffer, packet.size(), lock);
+      }
+      // else the read stays in progress: there is nothing more to receive.
+      return true;
+    }
+
+    std::vector<std::pair<size_t, std::string> > packets_;
+    size_t next_;
+  };
+
+  /// Keep the warnings: verbose logging would overwrite them.
+  class WarningBuilder : public Messages::SequentialSingleValueBuilder<uint32>
+  {
+  public:
+    virtual bool logMessage(unsigned short level, const std::string & logMessage)
+    {
+      if(level <= Common::Logger::QF_LOG_WARNING)
+      {
+        warnings_.push_back(logMessage);
+      }
+      return true;
+    }
+    std::vector<std::string> warnings_;
+  };
+
+  const Messages::FieldIdentity id_Value("Value");
+
+  Codecs::TemplateRegistryPtr createRegistry()
+  {
+    Codecs::TemplatePtr templ(new Codecs::Template);
+    templ->setId(1);
+    templ->setTemplateName("Value");
+    Codecs::FieldInstructionPtr value(new Codecs::FieldInstructionUInt32("Value", ""));
+    templ->addInstruction(value);
+    Codecs::TemplateRegistryPtr registry(new Codecs::TemplateRegistry);
+    registry->addTemplate(templ);
+    registry->finalize();
+    return registry;
+  }
+
+  /// @brief A packet: a four byte little-endian sequence number then one message carrying the same number.
+  std::string makePacket(Codecs::TemplateRegistryPtr registry, uint32 sequence)
+  {
+    std::string packet;
+    for(size_t nByte = 0; nByte < 4; ++nByte)
+    {
+      packet += char((sequence >> (8 * nByte)) & 0xFF);
+    }
+    Messages::FieldSet message(1);
+    message.addField(id_Value, Messages::FieldUInt32::create(sequence));
+    Codecs::Encoder encoder(registry);
+    Codecs::DataDestination destination;
+    encoder.encodeMessage(destination, 1, message);
+    std::string body;
+    destination.toString(body);
+    return packet + body;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testLineArbitrator)
+{
+  Codecs::LineArbitrator arbitrator(128);
+  // A leads for 1..3
+  BOOST_CHECK(arbitrator.accept(0, 1));
+  BOOST_CHECK(arbitrator.accept(0, 2));
+  BOOST_CHECK(!arbitrator.accept(1, 1));
+  BOOST_CHECK(arbitrator.accept(0, 3));
+  BOOST_CHECK(!arbitrator.accept(1, 2));
+  BOOST_CHECK(!arbitrator.accept(1, 3));
+  // A loses 4 and 5; B fills in
+  BOOST_CHECK(arbitrator.accept(1, 4));
+  BOOST_CHECK(arbitrator.accept(1, 5));
+  BOOST_CHECK(arbitrator.accept(0, 6));
+  BOOST_CHECK(!arbitrator.accept(1, 6));
+  // a late duplicate on the same line
+  BOOST_CHECK(!arbitrator.accept(0, 2));
+
+  BOOST_CHECK_EQUAL(arbitrator.lineCount(), 2u);
+  BOOST_CHECK_EQUAL(arbitrator.accepted(), 6u);
+  BOOST_CHECK_EQUAL(arbitrator.packets(0), 5u);
+  BOOST_CHECK_EQUAL(arbitrator.wins(0), 4u);
+  BOOST_CHECK_EQUAL(arbitrator.duplicates(0), 1u);
+  BOOST_CHECK_EQUAL(arbitrator.missing(0), 2u);
+  BOOST_CHECK_EQUAL(arbitrator.packets(1), 6u);
+  BOOST_CHECK_EQUAL(arbitrator.wins(1), 2u);
+  BOOST_CHECK_EQUAL(arbitrator.duplicates(1), 4u);
+  BOOST_CHECK_EQUAL(arbitrator.missing(1), 0u);
+  BOOST_CHECK_CLOSE(arbitrator.winRate(0), 4.0 / 6.0, 0.001);
+  BOOST_CHECK_CLOSE(arbitrator.winRate(1), 2.0 / 6.0, 0.001);
+  // a line that never delivered anything
+  BOOST_CHECK_EQUAL(arbitrator.packets(2), 0u);
+
+  std::stringstream report;
+  arbitrator.report(report);
+  BOOST_CHECK(report.str().find("Line 1: packets 6 first 2") != std::string::npos);
+
+  arbitrator.reset();
+  BOOST_CHECK_EQUAL(arbitrator.lineCount(), 0u);
+  BOOST_CHECK(arbitrator.accept(0, 2));
+}
+
+BOOST_AUTO_TEST_CASE(testLineArbitratorWindow)
+{
+  Codecs::LineArbitrator arbitrator(128);
+  BOOST_CHECK(arbitrator.accept(0, 1000));
+  // B is behind but inside the window: sequence numbers A skipped are still accepted
+  BOOST_CHECK(arbitrator.accept(1, 990));
+  BOOST_CHECK(!arbitrator.accept(0, 990));
+  // Slide the window one step at a time past the wrap point.
+  for(sequence_t seq = 1001; seq < 1300; ++seq)
+  {
+    BOOST_CHECK(arbitrator.accept(0, seq));
+    BOOST_CHECK(!arbitrator.accept(1, seq));
+  }
+  // Behind the window: rejected as too late
+  BOOST_CHECK(!arbitrator.accept(1, 1000));
+  // A big jump clears the window without accepting stale bits
+  BOOST_CHECK(arbitrator.accept(0, 100000));
+  BOOST_CHECK(arbitrator.accept(1, 99999));
+  BOOST_CHECK(!arbitrator.accept(1, 100000));
+}
+
+BOOST_AUTO_TEST_CASE(testLineArbitratorReset)
+{
+  Codecs::LineArbitrator arbitrator(128);
+  BOOST_CHECK_EQUAL(arbitrator.window(), 128u);
+  for(sequence_t seq = 5000; seq < 5010; ++seq)
+  {
+    BOOST_CHECK(arbitrator.accept(0, seq));
+    BOOST_CHECK(!arbitrator.accept(1, seq));
+  }
+  // Just behind the window is late, not a reset.
+  BOOST_CHECK(!arbitrator.accept(1, 5009 - 200));
+  BOOST_CHECK_EQUAL(arbitrator.resets(), 0u);
+
+  // The exchange starts again at 1.  A sees it first.
+  BOOST_CHECK(arbitrator.accept(0, 1));
+  BOOST_CHECK_EQUAL(arbitrator.resets(), 1u);
+  // B still has a copy from before the reset in flight.
+  BOOST_CHECK(!arbitrator.accept(1, 5009));
+  BOOST_CHECK(!arbitrator.accept(1, 1));
+  for(sequence_t seq = 2; seq < 10; ++seq)
+  {
+    BOOST_CHECK(arbitrator.accept(1, seq));
+    BOOST_CHECK(!arbitrator.accept(0, seq));
+  }
+  BOOST_CHECK_EQUAL(arbitrator.resets(), 1u);
+  // Crossing the reset is not counted as missing packets.
+  BOOST_CHECK_EQUAL(arbitrator.missing(0), 0u);
+  BOOST_CHECK_EQUAL(arbitrator.missing(1), 0u);
+
+  std::stringstream report;
+  arbitrator.report(report);
+  BOOST_CHECK(report.str().find("Sequence resets: 1") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(testArbitrationWindowConfiguration)
+{
+  Application::DecoderConfiguration configuration;
+  char option[] = "-arbwindow";
+  char window[] = "256";
+  char * argv[] = {option, window};
+  BOOST_CHECK_EQUAL(configuration.parseSingleArg(2, argv), 2);
+  BOOST_CHECK_EQUAL(configuration.arbitrationWindow(), 256u);
+
+  Codecs::FixedSizeHeaderAnalyzer packetHeaderAnalyzer(0, false, 4, 0, 0, 4);
+  Codecs::NoHeaderAnalyzer messageHeaderAnalyzer;
+  Messages::SequentialSingleValueBuilder<uint32> builder;
+  Codecs::PacketSequencingAssembler assembler(
+      Codecs::TemplateRegistryPtr(new Codecs::TemplateRegistry),
+      packetHeaderAnalyzer,
+      messageHeaderAnalyzer,
+      builder,
+      16,
+      Communication::RecoveryFeedPtr(),
+      configuration.arbitrationWindow());
+  BOOST_CHECK_EQUAL(assembler.arbitrator().window(), 256u);
+}
+
+BOOST_AUTO_TEST_CASE(testPacketSequencingAssemblerReset)
+{
+  Codecs::TemplateRegistryPtr registry = createRegistry();
+  PacketListReceiver receiver;
+  // Both lines carry 5000 through 5009.  A is ahead.
+  for(uint32 seq = 5000; seq < 5010; ++seq)
+  {
+    receiver.add(0, makePacket(registry, seq));
+    receiver.add(1, makePacket(registry, seq));
+  }
+  // 5011 arrives early on A and is held waiting for 5010...
+  receiver.add(0, makePacket(registry, 5011));
+  // ...which never comes: the exchange starts again at 1.
+  receiver.add(0, makePacket(registry, 1));
+  // B's copy of 5011 is still on its way.
+  receiver.add(1, makePacket(registry, 5011));
+  for(uint32 seq = 1; seq <= 10; ++seq)
+  {
+    if(seq != 1)
+    {
+      receiver.add(seq % 2, makePacket(registry, seq));
+    }
+    receiver.add(1 - seq % 2, makePacket(registry, seq));
+  }
+
+  Codecs::FixedSizeHeaderAnalyzer packetHeaderAnalyzer(0, false, 4, 0, 0, 4);
+  Codecs::NoHeaderAnalyzer messageHeaderAnalyzer;
+  WarningBuilder builder;
+  Codecs::PacketSequencingAssembler assembler(
+      registry,
+      packetHeaderAnalyzer,
+      messageHeaderAnalyzer,
+      builder,
+      16,
+      Communication::RecoveryFeedPtr(),
+      64);
+  BOOST_REQUIRE(receiver.start(assembler, 64, 64));
+  receiver.poll();
+  receiver.stop();
+
+  BOOST_CHECK_EQUAL(assembler.arbitrator().resets(), 1u);
+  // Every message from both sides of the reset, and nothing from the abandoned sequence.
+  BOOST_REQUIRE_EQUAL(builder.valueCount(), 20u);
+  for(size_t nValue = 0; nValue < 10; ++nValue)
+  {
+    BOOST_CHECK_EQUAL(builder.value(nValue), uint32(5000 + nValue));
+    BOOST_CHECK_EQUAL(builder.value(nValue + 10), uint32(1 + nValue));
+  }
+  BOOST_CHECK(!builder.hasGap());
+  // but the discontinuity is logged.
+  BOOST_REQUIRE_EQUAL(builder.warnings_.size(), 1u);
+  BOOST_CHECK(builder.warnings_[0].find("reset") != std::string::npos);
+}
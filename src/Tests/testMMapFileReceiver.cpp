@@ -0,0 +1,48 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Communication/MMapFileReceiver.h>
+#include <Tests/ReceiverTestFixtures.h>
+
+using namespace QuickFAST;
+using namespace QuickFAST::Tests;
+
+BOOST_AUTO_TEST_CASE(testMMapFileReceiver)
+{
+  const char * fileName = "testMMapFileReceiver.dat";
+  std::string contents;
+  for(size_t nByte = 0; nByte < 3500; ++nByte)
+  {
+    contents += char(nByte * 7 + nByte / 256);
+  }
+  {
+    std::ofstream file(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+    file.write(contents.data(), contents.size());
+  }
+
+  TestLogger logger;
+  CollectingAssembler assembler(logger);
+  {
+    Communication::MMapFileReceiver receiver(fileName, 1000, 2);
+    BOOST_REQUIRE(receiver.start(assembler, 100, 2));
+    receiver.run();
+  }
+  std::remove(fileName);
+
+  BOOST_CHECK_EQUAL(assembler.bufferCount_, 4u);
+  BOOST_CHECK_EQUAL(assembler.largestBuffer_, 1000u);
+  BOOST_CHECK(assembler.data_ == contents);
+}
+
+BOOST_AUTO_TEST_CASE(testMMapFileReceiverMissingFile)
+{
+  TestLogger logger;
+  CollectingAssembler assembler(logger);
+  Communication::MMapFileReceiver receiver("no/such/file.dat");
+  BOOST_CHECK(!receiver.start(assembler, 100, 2));
+}
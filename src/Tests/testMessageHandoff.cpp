@@ -0,0 +1,273 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+#include <Application/MessageHandoff.h>
+#include <Messages/MessageRecorder.h>
+#include <Messages/FixMessageBuilder.h>
+#include <Messages/FieldIdentity.h>
+#include <Common/Decimal.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  class FixCollector : public Messages::FixMessageBuilder
+  {
+  public:
+    explicit FixCollector(size_t limit = 0)
+      : limit_(limit)
+      , gaps_(0)
+      , receiveTime_(0)
+      , continueAfterError_(true)
+    {
+      setDelimiter('|');
+    }
+
+    virtual bool deliverMessage(const char * message, size_t length)
+    {
+      messages_.push_back(std::string(message, length));
+      return limit_ == 0 || messages_.size() < limit_;
+    }
+
+    virtual void reportGap(sequence_t startGap, sequence_t endGap)
+    {
+      gaps_ += endGap - startGap + 1;
+    }
+
+    virtual void reportReceiveTime(uint64 receiveTime)
+    {
+      receiveTime_ = receiveTime;
+    }
+
+    virtual bool wantLog(unsigned short /*level*/)
+    {
+      return true;
+    }
+    virtual bool logMessage(unsigned short level, const std::string & logMessage)
+    {
+      logged(boost::lexical_cast<std::string>(level) + ':' + logMessage);
+      return true;
+    }
+    virtual bool reportDecodingError(const std::string & errorMessage)
+    {
+      logged("decoding:" + errorMessage);
+      return continueAfterError_;
+    }
+    virtual bool reportCommunicationError(const std::string & errorMessage)
+    {
+      logged("communication:" + errorMessage);
+      return continueAfterError_;
+    }
+
+    /// Remember what was logged, how many messages preceded it and which thread reported it.
+    void logged(const std::string & text)
+    {
+      logged_.push_back(text + '@' + boost::lexical_cast<std::string>(messages_.size()));
+      logThread_ = boost::this_thread::get_id();
+    }
+
+    size_t limit_;
+    sequence_t gaps_;
+    uint64 receiveTime_;
+    bool continueAfterError_;
+    std::vector<std::string> messages_;
+    std::vector<std::string> logged_;
+    boost::thread::id logThread_;
+  };
+
+  // Recorded by address, so these must outlive the recording (as templates do.)
+  const std::string applicationType("MarketData");
+  const std::string applicationTypeNamespace("");
+  const Messages::FieldIdentity id_MsgType("MessageType", "", "35");
+  const Messages::FieldIdentity id_SeqNum("MsgSeqNum", "", "34");
+  const Messages::FieldIdentity id_NetChg("NetChgPrevDay", "", "451");
+  const Messages::FieldIdentity id_Entries("MDEntries");
+  const Messages::FieldIdentity id_NoEntries("NoMDEntries", "", "268");
+  const Messages::FieldIdentity id_Px("MDEntryPx", "", "270");
+  const Messages::FieldIdentity id_Instrument("Instrument");
+  const Messages::FieldIdentity id_Symbol("Symbol", "", "55");
+
+  /// @returns the builder's endMessage() result
+  bool buildMessage(Messages::ValueMessageBuilder & builder, uint32 sequence)
+  {
+    Messages::ValueMessageBuilder & body = builder.startMessage(applicationType, applicationTypeNamespace, 10);
+    static const unsigned char msgType[] = "X";
+    body.addValue(id_MsgType, ValueType::ASCII, msgType, 1);
+    body.addValue(id_SeqNum, ValueType::UINT32, sequence);
+    body.addValue(id_NetChg, ValueType::INT64, int64(-42) - int64(sequence));
+    Messages::ValueMessageBuilder & group = body.startGroup(id_Instrument, applicationType, applicationTypeNamespace, 1);
+    static const unsigned char symbol[] = "QF";
+    group.addValue(id_Symbol, ValueType::ASCII, symbol, 2);
+    body.endGroup(id_Instrument, group);
+    Messages::ValueMessageBuilder & entries = body.startSequence(
+      id_Entries, applicationType, applicationTypeNamespace, 1, id_NoEntries, 3);
+    // not normalized: replay must not change the representation.
+    Decimal prices[3] = {Decimal(12300, -4, false), Decimal(5, -3), Decimal(-15, 1)};
+    for(size_t pos = 0; pos < 3; ++pos)
+    {
+      Messages::ValueMessageBuilder & entry = entries.startSequenceEntry(applicationType, applicationTypeNamespace, 1);
+      entry.addValue(id_Px, ValueType::DECIMAL, prices[pos]);
+      entries.endSequenceEntry(entry);
+    }
+    body.endSequence(id_Entries, entries);
+    return builder.endMessage(body);
+  }
+
+  void ignoreMessage(Messages::ValueMessageBuilder & builder)
+  {
+    Messages::ValueMessageBuilder & body = builder.startMessage(applicationType, applicationTypeNamespace, 10);
+    body.addValue(id_SeqNum, ValueType::UINT32, uint32(999));
+    builder.ignoreMessage(body);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testMessageRecorder)
+{
+  FixCollector direct;
+  buildMessage(direct, 1);
+  buildMessage(direct, 2);
+
+  FixCollector replayed;
+  Messages::MessageRecorder recorder(replayed);
+  BOOST_CHECK(recorder.empty());
+  buildMessage(recorder, 1);
+  ignoreMessage(recorder);
+  recorder.reportGap(5, 7);
+  recorder.logMessage(Common::Logger::QF_LOG_INFO, "between");
+  // a message that is abandoned after an error keeps the error.
+  Messages::ValueMessageBuilder & body = recorder.startMessage(applicationType, applicationTypeNamespace, 10);
+  body.addValue(id_SeqNum, ValueType::UINT32, uint32(998));
+  BOOST_CHECK(recorder.reportDecodingError("bad field"));
+  recorder.ignoreMessage(body);
+  buildMessage(recorder, 2);
+  BOOST_CHECK_EQUAL(recorder.messageCount(), 2u);
+  BOOST_CHECK(replayed.messages_.empty());
+  BOOST_CHECK(replayed.logged_.empty());
+
+  BOOST_CHECK(recorder.replay(replayed));
+  BOOST_REQUIRE_EQUAL(replayed.messages_.size(), 2u);
+  BOOST_CHECK_EQUAL(replayed.messages_[0], direct.messages_[0]);
+  BOOST_CHECK_EQUAL(replayed.messages_[1], direct.messages_[1]);
+  BOOST_CHECK_EQUAL(replayed.gaps_, 3u);
+  BOOST_REQUIRE_EQUAL(replayed.logged_.size(), 2u);
+  BOOST_CHECK_EQUAL(replayed.logged_[0], "3:between@1");
+  BOOST_CHECK_EQUAL(replayed.logged_[1], "decoding:bad field@1");
+
+  // reuse
+  recorder.clear();
+  BOOST_CHECK(recorder.empty());
+  buildMessage(recorder, 2);
+  BOOST_CHECK(recorder.replay(replayed));
+  BOOST_REQUIRE_EQUAL(replayed.messages_.size(), 3u);
+  BOOST_CHECK_EQUAL(replayed.messages_[2], direct.messages_[1]);
+}
+
+BOOST_AUTO_TEST_CASE(testMessageHandoff)
+{
+  const uint32 messageCount = 5000;
+  FixCollector direct;
+  for(uint32 sequence = 0; sequence < messageCount; ++sequence)
+  {
+    buildMessage(direct, sequence);
+  }
+
+  FixCollector consumer;
+  // a small queue so the decoding side has to wait for the consumer.
+  Application::MessageHandoff handoff(consumer, 4, 100, Communication::BufferHandoff::PARK_WAIT, true);
+  boost::thread deliverThread(boost::bind(&Application::MessageHandoff::run, &handoff));
+  for(uint32 sequence = 0; sequence < messageCount; ++sequence)
+  {
+    if(sequence == 10)
+    {
+      handoff.reportReceiveTime(123456789);
+      ignoreMessage(handoff);
+    }
+    BOOST_REQUIRE(buildMessage(handoff, sequence));
+  }
+  handoff.reportGap(messageCount, messageCount + 1);
+  handoff.finish();
+  deliverThread.join();
+
+  BOOST_REQUIRE_EQUAL(consumer.messages_.size(), size_t(messageCount));
+  BOOST_CHECK(consumer.messages_ == direct.messages_);
+  BOOST_CHECK_EQUAL(consumer.gaps_, 2u);
+  BOOST_CHECK_EQUAL(consumer.receiveTime_, 123456789u);
+  BOOST_CHECK_EQUAL(handoff.handoff().deliveries(), size_t(messageCount + 1));
+  BOOST_CHECK(handoff.handoff().maxDepth() <= 4u);
+}
+
+BOOST_AUTO_TEST_CASE(testMessageHandoffConsumerStops)
+{
+  FixCollector consumer(10);
+  Application::MessageHandoff handoff(consumer, 4, 100, Communication::BufferHandoff::YIELD_WAIT);
+  boost::thread deliverThread(boost::bind(&Application::MessageHandoff::run, &handoff));
+  // Once the consumer stops, endMessage() tells the decoder to stop, too.
+  size_t sent = 0;
+  while(sent < 1000 && buildMessage(handoff, uint32(sent)))
+  {
+    ++sent;
+  }
+  deliverThread.join();
+  BOOST_CHECK(sent < 1000);
+  BOOST_CHECK_EQUAL(consumer.messages_.size(), 10u);
+}
+
+BOOST_AUTO_TEST_CASE(testMessageHandoffLogging)
+{
+  FixCollector consumer;
+  Application::MessageHandoff handoff(consumer, 4, 100, Communication::BufferHandoff::YIELD_WAIT);
+  boost::thread deliverThread(boost::bind(&Application::MessageHandoff::run, &handoff));
+
+  BOOST_CHECK(handoff.wantLog(Common::Logger::QF_LOG_VERBOSE));
+  BOOST_REQUIRE(buildMessage(handoff, 0));
+  // between messages: handed off at once.
+  BOOST_CHECK(handoff.logMessage(Common::Logger::QF_LOG_WARNING, "first"));
+  // during a message that is abandoned: kept, and handed off with nothing else.
+  Messages::ValueMessageBuilder & ignored = handoff.startMessage(applicationType, applicationTypeNamespace, 10);
+  ignored.addValue(id_SeqNum, ValueType::UINT32, uint32(999));
+  BOOST_CHECK(handoff.reportDecodingError("second"));
+  handoff.ignoreMessage(ignored);
+  // during a message that completes: delivered just ahead of it.
+  Messages::ValueMessageBuilder & body = handoff.startMessage(applicationType, applicationTypeNamespace, 10);
+  BOOST_CHECK(handoff.reportCommunicationError("third"));
+  body.addValue(id_SeqNum, ValueType::UINT32, uint32(1));
+  BOOST_REQUIRE(handoff.endMessage(body));
+  BOOST_REQUIRE(buildMessage(handoff, 2));
+  boost::thread::id consumerThread = deliverThread.get_id();
+  handoff.finish();
+  deliverThread.join();
+
+  BOOST_CHECK_EQUAL(consumer.messages_.size(), 3u);
+  BOOST_REQUIRE_EQUAL(consumer.logged_.size(), 3u);
+  BOOST_CHECK_EQUAL(consumer.logged_[0], "2:first@1");
+  BOOST_CHECK_EQUAL(consumer.logged_[1], "decoding:second@1");
+  BOOST_CHECK_EQUAL(consumer.logged_[2], "communication:third@1");
+  // the consumer saw the reports on its own thread, not the decoding thread.
+  BOOST_CHECK(consumer.logThread_ == consumerThread);
+  BOOST_CHECK(consumer.logThread_ != boost::this_thread::get_id());
+}
+
+BOOST_AUTO_TEST_CASE(testMessageHandoffErrorStops)
+{
+  FixCollector consumer;
+  consumer.continueAfterError_ = false;
+  Application::MessageHandoff handoff(consumer, 4, 100, Communication::BufferHandoff::YIELD_WAIT);
+  boost::thread deliverThread(boost::bind(&Application::MessageHandoff::run, &handoff));
+  BOOST_REQUIRE(buildMessage(handoff, 0));
+  handoff.reportDecodingError("fatal");
+  // The consumer's answer arrives later; decoding stops at a following message.
+  size_t sent = 0;
+  while(sent < 1000 && buildMessage(handoff, uint32(sent + 1)))
+  {
+    ++sent;
+  }
+  deliverThread.join();
+  BOOST_CHECK(sent < 1000);
+  BOOST_CHECK_EQUAL(consumer.messages_.size(), 1u);
+  BOOST_REQUIRE_EQUAL(consumer.logged_.size(), 1u);
+  BOOST_CHECK_EQUAL(consumer.logged_[0], "decoding:fatal@1");
+}
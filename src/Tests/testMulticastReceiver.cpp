@@ -0,0 +1,134 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Communication/MulticastReceiver.h>
+#include <Tests/ReceiverTestFixtures.h>
+
+using namespace QuickFAST;
+using namespace QuickFAST::Tests;
+
+#if defined(__linux__)
+namespace
+{
+  /// Record the sequence number carried by each datagram in the order they are decoded.
+  class SequenceAssembler : public BufferAssembler
+  {
+  public:
+    SequenceAssembler(Common::Logger & logger)
+      : BufferAssembler(logger)
+    {
+    }
+
+    std::vector<uint32> sequences_;
+
+  protected:
+    virtual void receiveBuffer(const Communication::LinkedBuffer & buffer)
+    {
+      uint32 sequence = 0;
+      if(buffer.used() == sizeof(sequence))
+      {
+        std::memcpy(&sequence, buffer.get(), sizeof(sequence));
+        sequences_.push_back(sequence);
+      }
+    }
+  };
+
+  /// Send numbered datagrams to a multicast group on the loopback interface.
+  class SequenceSender
+  {
+  public:
+    SequenceSender(const std::string & group, unsigned short port)
+      : socket_(ioService_)
+      , destination_(boost::asio::ip::address::from_string(group), port)
+      , next_(0)
+    {
+      socket_.open(boost::asio::ip::udp::v4());
+      socket_.set_option(boost::asio::ip::multicast::outbound_interface(
+        boost::asio::ip::address_v4::from_string("127.0.0.1")));
+      socket_.set_option(boost::asio::ip::multicast::enable_loopback(true));
+    }
+
+    void send(size_t count)
+    {
+      for(size_t nPacket = 0; nPacket < count; ++nPacket)
+      {
+        socket_.send_to(boost::asio::buffer(&next_, sizeof(next_)), destination_);
+        ++next_;
+      }
+    }
+
+    size_t sent()const
+    {
+      return next_;
+    }
+
+  private:
+    boost::asio::io_service ioService_;
+    boost::asio::ip::udp::socket socket_;
+    boost::asio::ip::udp::endpoint destination_;
+    uint32 next_;
+  };
+
+  /// @brief poll the receiver until the assembler has seen count datagrams (or about two seconds pass.)
+  void pollFor(Communication::Receiver & receiver, SequenceAssembler & assembler, size_t count)
+  {
+    for(size_t tries = 0; assembler.sequences_.size() < count && tries < 200; ++tries)
+    {
+      if(receiver.poll() == 0)
+      {
+        boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testMulticastReceiverBatch)
+{
+  const std::string group("239.255.47.1");
+  const unsigned short port = 43300;
+  const size_t batchSize = 8;
+  const size_t bufferCount = 2 * batchSize;
+
+  boost::asio::io_service ioService;
+  Communication::MulticastReceiver receiver(ioService, group, "127.0.0.1", "0.0.0.0", port);
+  receiver.setReceiveBatch(batchSize);
+  TestLogger logger;
+  SequenceAssembler assembler(logger);
+  if(!receiver.start(assembler, 1400, bufferCount))
+  {
+    BOOST_TEST_MESSAGE("testMulticastReceiverBatch: cannot join the multicast group here. Skipped.");
+    return;
+  }
+  SequenceSender sender(group, port);
+
+  // More datagrams than one batch (and than there are buffers) wait in the socket.
+  // Full batches are read back to back and each batch is queued as a unit.
+  sender.send(5 * batchSize + 3);
+  pollFor(receiver, assembler, sender.sent());
+  BOOST_CHECK_EQUAL(assembler.sequences_.size(), sender.sent());
+  BOOST_CHECK(receiver.batchesProcessed() < receiver.packetsProcessed());
+
+  // Short bursts leave most of the borrowed buffers unused.
+  // Were they not returned to the idle pool the receiver would run dry long before the end.
+  for(size_t nBurst = 0; nBurst < 10 * bufferCount && assembler.sequences_.size() == sender.sent(); ++nBurst)
+  {
+    sender.send(3);
+    pollFor(receiver, assembler, sender.sent());
+  }
+  receiver.stop();
+
+  BOOST_REQUIRE_EQUAL(assembler.sequences_.size(), sender.sent());
+  for(size_t nPacket = 0; nPacket < sender.sent(); ++nPacket)
+  {
+    BOOST_CHECK_EQUAL(assembler.sequences_[nPacket], nPacket);
+  }
+  BOOST_CHECK_EQUAL(receiver.packetsReceived(), sender.sent());
+  BOOST_CHECK_EQUAL(receiver.packetsProcessed(), sender.sent());
+  BOOST_CHECK_EQUAL(receiver.noBufferAvailable(), 0u);
+}
+#endif // __linux__
@@ -0,0 +1,159 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Communication/MulticastSender.h>
+#include <Communication/BufferRecycler.h>
+#include <Common/TokenBucket.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  class CountingRecycler : public Communication::BufferRecycler
+  {
+  public:
+    CountingRecycler()
+      : recycled_(0)
+    {
+    }
+
+    ~CountingRecycler()
+    {
+      for(size_t nBuffer = 0; nBuffer < buffers_.size(); ++nBuffer)
+      {
+        delete buffers_[nBuffer];
+      }
+    }
+
+    Communication::LinkedBuffer * allocate(size_t number)
+    {
+      std::string payload = boost::lexical_cast<std::string>(number);
+      Communication::LinkedBuffer * buffer = new Communication::LinkedBuffer(100);
+      std::memcpy(buffer->get(), payload.data(), payload.size());
+      buffer->setUsed(payload.size());
+      buffers_.push_back(buffer);
+      return buffer;
+    }
+
+    virtual void recycle(Communication::LinkedBuffer * emptyBuffer)
+    {
+      ++recycled_;
+    }
+
+    size_t recycled_;
+    std::vector<Communication::LinkedBuffer *> buffers_;
+  };
+
+  /// Send count datagrams to a local port.  Returns how many arrived, in order.
+  size_t sendAndReceive(Communication::MulticastSender & sender, CountingRecycler & recycler, size_t count, unsigned short port)
+  {
+    boost::asio::io_service ioService;
+    boost::asio::ip::udp::socket receiver(ioService,
+      boost::asio::ip::udp::endpoint(boost::asio::ip::address::from_string("127.0.0.1"), port));
+    receiver.set_option(boost::asio::socket_base::receive_buffer_size(1024 * 1024));
+
+    sender.open();
+    for(size_t nPacket = 0; nPacket < count; ++nPacket)
+    {
+      sender.send(recycler.allocate(nPacket));
+    }
+    sender.stop();
+    sender.run();
+    sender.resetService();
+
+    receiver.non_blocking(true);
+    size_t received = 0;
+    char data[100];
+    boost::system::error_code error;
+    size_t bytes = receiver.receive(boost::asio::buffer(data), 0, error);
+    while(!error)
+    {
+      if(std::string(data, bytes) == boost::lexical_cast<std::string>(received))
+      {
+        ++received;
+      }
+      bytes = receiver.receive(boost::asio::buffer(data), 0, error);
+    }
+    return received;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testTokenBucket)
+{
+  Common::TokenBucket bucket;
+  BOOST_CHECK(!bucket.limited());
+  BOOST_CHECK_EQUAL(bucket.take(1000.0, 0), 0u);
+
+  // 1000 per second, bursts of 3
+  bucket.setRate(1000.0, 3.0);
+  uint64 now = 5000000000ULL;
+  BOOST_CHECK_EQUAL(bucket.take(1.0, now), 0u);
+  BOOST_CHECK_EQUAL(bucket.take(1.0, now), 0u);
+  BOOST_CHECK_EQUAL(bucket.take(1.0, now), 0u);
+  uint64 wait = bucket.take(1.0, now);
+  BOOST_CHECK(wait > 999000u && wait <= 1000001u);
+  BOOST_CHECK_EQUAL(bucket.waits(), 1u);
+  BOOST_CHECK_EQUAL(bucket.take(1.0, now + wait), 0u);
+
+  // A long idle period saves no more than the depth.
+  now += 1000000000ULL;
+  for(size_t nToken = 0; nToken < 3; ++nToken)
+  {
+    BOOST_CHECK_EQUAL(bucket.take(1.0, now), 0u);
+  }
+  BOOST_CHECK(bucket.take(1.0, now) != 0u);
+
+  // More than the depth goes when the bucket is full and is paid back later.
+  now += 1000000000ULL;
+  BOOST_CHECK_EQUAL(bucket.take(10.0, now), 0u);
+  wait = bucket.take(1.0, now);
+  BOOST_CHECK(wait > 7000000u);
+}
+
+BOOST_AUTO_TEST_CASE(testMulticastSenderBatch)
+{
+  const size_t count = 100;
+  CountingRecycler recycler;
+  Communication::MulticastSender sender(recycler, "127.0.0.1", 41800);
+  sender.setSendBatch(16);
+  BOOST_CHECK_EQUAL(sendAndReceive(sender, recycler, count, 41800), count);
+  BOOST_CHECK_EQUAL(sender.packetsSent(), count);
+  BOOST_CHECK_EQUAL(recycler.recycled_, count);
+  BOOST_CHECK(sender.sendCalls() <= count);
+#if defined(__linux__)
+  // Everything was queued before the sender ran.
+  BOOST_CHECK_EQUAL(sender.sendCalls(), (count + 15) / 16);
+#endif
+  sender.close();
+}
+
+BOOST_AUTO_TEST_CASE(testMulticastSenderPacing)
+{
+  const size_t count = 40;
+  CountingRecycler recycler;
+  Communication::MulticastSender sender(recycler, "127.0.0.1", 41801);
+  // 2000 packets per second: the last packet is due 15ms after the first four.
+  sender.setPacketRate(2000.0, 4);
+  uint64 start = Common::monotonicNanoseconds();
+  BOOST_CHECK_EQUAL(sendAndReceive(sender, recycler, count, 41801), count);
+  uint64 elapsed = Common::monotonicNanoseconds() - start;
+  BOOST_CHECK(elapsed >= 15000000u);
+  BOOST_CHECK(sender.pacingWaits() > 0);
+  BOOST_CHECK_EQUAL(recycler.recycled_, count);
+
+  // Bits: the payloads "0" to "4" are 8 bits each, so 800 bits per second is 100 packets per second.
+  CountingRecycler bitRecycler;
+  Communication::MulticastSender bitSender(bitRecycler, "127.0.0.1", 41802);
+  bitSender.setBitRate(800.0, 1);
+  start = Common::monotonicNanoseconds();
+  BOOST_CHECK_EQUAL(sendAndReceive(bitSender, bitRecycler, 5, 41802), 5u);
+  elapsed = Common::monotonicNanoseconds() - start;
+  // The first goes at once; each of the other four waits 10ms.
+  BOOST_CHECK(elapsed >= 35000000u);
+  BOOST_CHECK(bitSender.pacingWaits() >= 4);
+}
@@ -0,0 +1,307 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Communication/PCapReader.h>
+#include <Common/Exceptions.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  /// Build a capture file image one field at a time.
+  class Image
+  {
+  public:
+    explicit Image(bool bigEndian = false)
+      : bigEndian_(bigEndian)
+    {
+    }
+
+    void put8(unsigned int value)
+    {
+      data_.push_back(char(value & 0xFF));
+    }
+
+    void put16(unsigned int value)
+    {
+      putInteger(value, 2);
+    }
+
+    void put32(uint64 value)
+    {
+      putInteger(value, 4);
+    }
+
+    void put64(uint64 value)
+    {
+      putInteger(value, 8);
+    }
+
+    void putBytes(const std::string & bytes)
+    {
+      data_ += bytes;
+    }
+
+    void pad4()
+    {
+      while(data_.size() % 4 != 0)
+      {
+        data_.push_back('\0');
+      }
+    }
+
+    size_t size()const
+    {
+      return data_.size();
+    }
+
+    const std::string & data()const
+    {
+      return data_;
+    }
+
+    /// Fill in a 32 bit value that was written earlier as a place holder.
+    void patch32(size_t position, uint64 value)
+    {
+      Image field(bigEndian_);
+      field.put32(value);
+      data_.replace(position, 4, field.data_);
+    }
+
+    void write(const std::string & fileName)const
+    {
+      std::ofstream file(fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+      file.write(data_.data(), data_.size());
+    }
+
+  private:
+    void putInteger(uint64 value, size_t bytes)
+    {
+      for(size_t nByte = 0; nByte < bytes; ++nByte)
+      {
+        size_t shift = 8 * (bigEndian_ ? bytes - 1 - nByte : nByte);
+        data_.push_back(char((value >> shift) & 0xFF));
+      }
+    }
+
+  private:
+    bool bigEndian_;
+    std::string data_;
+  };
+
+  /// An ethernet/IPv4/UDP frame.  Network headers are always big endian.
+  std::string udpFrame(
+    unsigned int address,
+    unsigned short port,
+    const std::string & payload,
+    bool vlan = false)
+  {
+    Image frame(true);
+    frame.putBytes(std::string(12, '\x11')); // mac addresses
+    if(vlan)
+    {
+      frame.put16(0x8100);
+      frame.put16(42);
+    }
+    frame.put16(0x0800);
+    frame.put8(0x45); // IPv4, 20 byte header
+    frame.put8(0);
+    frame.put16(20 + 8 + payload.size());
+    frame.put32(0);
+    frame.put8(64);
+    frame.put8(17); // UDP
+    frame.put16(0);
+    frame.put32(0x0A000001); // source
+    frame.put32(address);
+    frame.put16(12345);
+    frame.put16(port);
+    frame.put16(8 + payload.size());
+    frame.put16(0);
+    frame.putBytes(payload);
+    return frame.data();
+  }
+
+  void classicHeader(Image & image, uint32 magic, uint32 linktype)
+  {
+    image.put32(magic);
+    image.put16(2);
+    image.put16(4);
+    image.put32(0);
+    image.put32(0);
+    image.put32(65535);
+    image.put32(linktype);
+  }
+
+  void classicRecord(Image & image, uint32 seconds, uint32 fraction, const std::string & frame)
+  {
+    image.put32(seconds);
+    image.put32(fraction);
+    image.put32(frame.size());
+    image.put32(frame.size());
+    image.putBytes(frame);
+  }
+
+  void ngSection(Image & image)
+  {
+    image.put32(0x0A0D0D0A);
+    image.put32(28);
+    image.put32(0x1A2B3C4D);
+    image.put16(1);
+    image.put16(0);
+    image.put64(uint64(-1)); // section length unknown
+    image.put32(28);
+  }
+
+  void ngInterface(Image & image, int tsresol)
+  {
+    size_t start = image.size();
+    image.put32(1);
+    image.put32(0); // length patched below
+    image.put16(1); // ethernet
+    image.put16(0);
+    image.put32(65535);
+    if(tsresol >= 0)
+    {
+      image.put16(9); // if_tsresol
+      image.put16(1);
+      image.put8(tsresol);
+      image.pad4();
+      image.put16(0); // opt_endofopt
+      image.put16(0);
+    }
+    image.put32(image.size() - start + 4);
+    image.patch32(start + 4, image.size() - start);
+  }
+
+  void ngEnhancedPacket(Image & image, uint32 interfaceId, uint64 timestamp, const std::string & frame)
+  {
+    size_t start = image.size();
+    image.put32(6);
+    image.put32(0);
+    image.put32(interfaceId);
+    image.put32(timestamp >> 32);
+    image.put32(timestamp & 0xFFFFFFFF);
+    image.put32(frame.size());
+    image.put32(frame.size());
+    image.putBytes(frame);
+    image.pad4();
+    image.put32(image.size() - start + 4);
+    image.patch32(start + 4, image.size() - start);
+  }
+
+  void ngSimplePacket(Image & image, const std::string & frame)
+  {
+    size_t start = image.size();
+    image.put32(3);
+    image.put32(0);
+    image.put32(frame.size());
+    image.putBytes(frame);
+    image.pad4();
+    image.put32(image.size() - start + 4);
+    image.patch32(start + 4, image.size() - start);
+  }
+
+  void checkPacket(
+    Communication::PCapReader & reader,
+    const std::string & expected,
+    uint64 expectedTime)
+  {
+    const unsigned char * buffer = 0;
+    size_t size = 0;
+    BOOST_REQUIRE(reader.read(buffer, size));
+    BOOST_CHECK_EQUAL(std::string(reinterpret_cast<const char *>(buffer), size), expected);
+    BOOST_CHECK_EQUAL(reader.packetTime(), expectedTime);
+  }
+
+  const std::string fileName("testPCapReader.pcap");
+  const unsigned int groupA = 0xE0010203; // 224.1.2.3
+  const unsigned int groupB = 0xE0010204; // 224.1.2.4
+}
+
+BOOST_AUTO_TEST_CASE(testPCapReaderClassic)
+{
+  // Microsecond resolution, written on a big endian machine
+  Image image(true);
+  classicHeader(image, 0xa1b2c3d4, 1);
+  classicRecord(image, 10, 500000, udpFrame(groupA, 30001, "first"));
+  classicRecord(image, 11, 1, udpFrame(groupB, 30001, "second", true));
+  image.write(fileName);
+
+  Communication::PCapReader reader;
+  BOOST_REQUIRE(reader.open(fileName.c_str()));
+  BOOST_CHECK(!reader.isPcapNg());
+  checkPacket(reader, "first", 10500000000ULL);
+  checkPacket(reader, "second", 11000001000ULL);
+  const unsigned char * buffer = 0;
+  size_t size = 0;
+  BOOST_CHECK(!reader.read(buffer, size));
+
+  // Nanosecond resolution, native byte order
+  Image nano;
+  classicHeader(nano, 0xa1b23c4d, 1);
+  classicRecord(nano, 10, 123456789, udpFrame(groupA, 30001, "nano"));
+  nano.write(fileName);
+  BOOST_REQUIRE(reader.open(fileName.c_str()));
+  checkPacket(reader, "nano", 10123456789ULL);
+  BOOST_REQUIRE(reader.rewind());
+  checkPacket(reader, "nano", 10123456789ULL);
+}
+
+BOOST_AUTO_TEST_CASE(testPCapReaderFilter)
+{
+  Image image;
+  classicHeader(image, 0xa1b2c3d4, 1);
+  classicRecord(image, 1, 0, udpFrame(groupA, 30001, "A1"));
+  classicRecord(image, 2, 0, udpFrame(groupB, 30001, "B1"));
+  classicRecord(image, 3, 0, udpFrame(groupA, 30002, "A2"));
+  classicRecord(image, 4, 0, udpFrame(groupB, 30002, "B2"));
+  image.write(fileName);
+
+  Communication::PCapReader reader;
+  reader.setFilter("224.1.2.4", 0);
+  BOOST_REQUIRE(reader.open(fileName.c_str()));
+  checkPacket(reader, "B1", 2000000000ULL);
+  checkPacket(reader, "B2", 4000000000ULL);
+
+  reader.setFilter("", 30002);
+  BOOST_REQUIRE(reader.rewind());
+  checkPacket(reader, "A2", 3000000000ULL);
+  checkPacket(reader, "B2", 4000000000ULL);
+
+  reader.setFilter("224.1.2.3", 30002);
+  BOOST_REQUIRE(reader.rewind());
+  checkPacket(reader, "A2", 3000000000ULL);
+  const unsigned char * buffer = 0;
+  size_t size = 0;
+  BOOST_CHECK(!reader.read(buffer, size));
+
+  BOOST_CHECK_THROW(reader.setFilter("224.1.2", 0), UsageError);
+}
+
+BOOST_AUTO_TEST_CASE(testPCapReaderPcapNg)
+{
+  Image image;
+  ngSection(image);
+  ngInterface(image, -1); // default: microseconds
+  ngInterface(image, 9);  // nanoseconds
+  ngEnhancedPacket(image, 0, 1000000, udpFrame(groupA, 30001, "usec"));
+  ngEnhancedPacket(image, 1, 1000000, udpFrame(groupA, 30001, "nsec"));
+  ngSimplePacket(image, udpFrame(groupA, 30001, "simple"));
+  image.write(fileName);
+
+  Communication::PCapReader reader;
+  BOOST_REQUIRE(reader.open(fileName.c_str()));
+  BOOST_CHECK(reader.isPcapNg());
+  checkPacket(reader, "usec", 1000000000ULL);
+  checkPacket(reader, "nsec", 1000000ULL);
+  checkPacket(reader, "simple", 0);
+  const unsigned char * buffer = 0;
+  size_t size = 0;
+  BOOST_CHECK(!reader.read(buffer, size));
+  std::remove(fileName.c_str());
+}
@@ -0,0 +1,118 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Communication/PacketRingReceiver.h>
+#include <Application/DecoderConfiguration.h>
+#include <Tests/ReceiverTestFixtures.h>
+
+using namespace QuickFAST;
+using namespace QuickFAST::Tests;
+
+BOOST_AUTO_TEST_CASE(testPacketRingConfiguration)
+{
+  Application::DecoderConfiguration configuration;
+  char option[] = "-ring";
+  char groups[] = "239.1.1.254:30001/2,127.0.0.1:30002";
+  char * argv[] = {option, groups};
+  BOOST_CHECK_EQUAL(configuration.parseSingleArg(2, argv), 2);
+  BOOST_CHECK_EQUAL(configuration.receiverType(), Application::DecoderConfiguration::PACKET_RING_RECEIVER);
+  BOOST_REQUIRE_EQUAL(configuration.multicastCount(), 3u);
+  BOOST_CHECK_EQUAL(configuration.multicastGroupIP(1), "239.1.1.255");
+  BOOST_CHECK_EQUAL(configuration.portNumber(1), 30001);
+  BOOST_CHECK_EQUAL(configuration.multicastGroupIP(2), "127.0.0.1");
+  BOOST_CHECK_EQUAL(configuration.portNumber(2), 30002);
+
+  char interfaceOption[] = "-ringif";
+  char interfaceName[] = "lo";
+  char * interfaceArgv[] = {interfaceOption, interfaceName};
+  BOOST_CHECK_EQUAL(configuration.parseSingleArg(2, interfaceArgv), 2);
+  BOOST_CHECK_EQUAL(configuration.ringInterface(), "lo");
+
+  char blocksOption[] = "-ringblocks";
+  char blocks[] = "8";
+  char * blocksArgv[] = {blocksOption, blocks};
+  BOOST_CHECK_EQUAL(configuration.parseSingleArg(2, blocksArgv), 2);
+  BOOST_CHECK_EQUAL(configuration.ringBlocks(), 8u);
+}
+
+#if defined(__linux__)
+BOOST_AUTO_TEST_CASE(testPacketRingReceiver)
+{
+  const size_t feeds = 20;
+  const unsigned short basePort = 42000;
+  Communication::PacketRingReceiver receiver("lo");
+  for(size_t nFeed = 0; nFeed < feeds; ++nFeed)
+  {
+    receiver.addFeed(boost::lexical_cast<std::string>(nFeed), "127.0.0.1", "0.0.0.0",
+      (unsigned short)(basePort + nFeed));
+  }
+  // Small blocks so the test wraps around the ring.
+  receiver.setRing(4096, 4, 2);
+
+  TestLogger logger;
+  SourceCountingAssembler assembler(logger, feeds);
+  if(!receiver.start(assembler, 1, 16))
+  {
+    BOOST_TEST_MESSAGE("testPacketRingReceiver: cannot open a packet socket here. Skipped.");
+    return;
+  }
+
+  // Feed n gets (n % 4) + 1 packets, each carrying n.
+  // The port just past the feeds is not wanted and must be filtered out.
+  boost::asio::io_service ioService;
+  boost::asio::ip::udp::socket sender(ioService);
+  sender.open(boost::asio::ip::udp::v4());
+  boost::asio::ip::udp::endpoint unwanted(
+    boost::asio::ip::address::from_string("127.0.0.1"),
+    (unsigned short)(basePort + feeds));
+  size_t sent = 0;
+  for(size_t nRound = 0; nRound < 10; ++nRound)
+  {
+    for(size_t nFeed = 0; nFeed < feeds; ++nFeed)
+    {
+      boost::asio::ip::udp::endpoint destination(
+        boost::asio::ip::address::from_string("127.0.0.1"),
+        (unsigned short)(basePort + nFeed));
+      std::string payload = boost::lexical_cast<std::string>(nFeed);
+      for(size_t nPacket = 0; nPacket <= nFeed % 4; ++nPacket)
+      {
+        sender.send_to(boost::asio::buffer(payload), destination);
+        ++sent;
+      }
+      sender.send_to(boost::asio::buffer(std::string("99")), unwanted);
+    }
+    // Let the receiver keep up with the small ring.
+    for(size_t tries = 0; assembler.total_ < sent && tries < 100; ++tries)
+    {
+      receiver.poll();
+      if(assembler.total_ < sent)
+      {
+        boost::this_thread::sleep(boost::posix_time::milliseconds(5));
+      }
+    }
+  }
+  receiver.stop();
+
+  BOOST_CHECK_EQUAL(assembler.total_, sent);
+  BOOST_CHECK_EQUAL(assembler.mislabeled_, 0u);
+  for(size_t nFeed = 0; nFeed < feeds; ++nFeed)
+  {
+    BOOST_CHECK_EQUAL(assembler.counts_[nFeed], 10 * (nFeed % 4 + 1));
+    BOOST_CHECK_EQUAL(receiver.feedPackets(nFeed), 10 * (nFeed % 4 + 1));
+  }
+  // every block went back to the kernel, and more blocks were used than the ring holds.
+  BOOST_CHECK(receiver.ringBlocks() > 4);
+  BOOST_CHECK(receiver.ringBlocksReleased() + 1 >= receiver.ringBlocks());
+  BOOST_CHECK_EQUAL(receiver.ringDrops(), 0u);
+
+  std::stringstream report;
+  receiver.report(report);
+  BOOST_CHECK(report.str().find("20 feeds") != std::string::npos);
+  BOOST_TEST_MESSAGE(report.str());
+}
+#endif // __linux__
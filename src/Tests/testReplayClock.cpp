@@ -0,0 +1,115 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Examples/Examples/ReplayClock.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  const uint64 millisecond = 1000000;
+
+  /// @brief Release count packets captured interval nanoseconds apart.
+  void replay(Examples::ReplayClock & clock, uint64 firstCapture, size_t count, uint64 interval)
+  {
+    for(size_t nPacket = 0; nPacket < count; ++nPacket)
+    {
+      clock.waitFor(firstCapture + nPacket * interval);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testReplayClockSpeed)
+{
+  // 11 packets captured 8 msec apart (80 msec) replayed at twice the speed: 40 msec.
+  Examples::ReplayClock clock(2.0);
+  uint64 start = Common::monotonicNanoseconds();
+  replay(clock, 5000 * millisecond, 11, 8 * millisecond);
+  uint64 took = Common::monotonicNanoseconds() - start;
+
+  BOOST_CHECK_EQUAL(clock.packets(), 11u);
+  BOOST_CHECK_EQUAL(clock.scheduledNanoseconds(), 40 * millisecond);
+  // never early: the last packet waits for its scheduled time.
+  BOOST_CHECK(clock.elapsedNanoseconds() >= clock.scheduledNanoseconds());
+  BOOST_CHECK(took >= 40 * millisecond);
+  // and it doesn't run at the capture speed.
+  BOOST_CHECK(took < 80 * millisecond);
+
+  // The lag is measured from each packet's scheduled time.
+  BOOST_CHECK(clock.maxLag() >= clock.meanLag());
+  BOOST_CHECK(clock.elapsedNanoseconds() <= clock.scheduledNanoseconds() + clock.maxLag());
+  BOOST_CHECK(clock.latePackets() <= clock.packets());
+
+  // target: 10 intervals in 40 msec.  Achieved can only be slower.
+  std::stringstream report;
+  clock.report(report);
+  BOOST_CHECK(report.str().find("11 packets at 2x") != std::string::npos);
+  BOOST_CHECK(report.str().find("target rate:   250 packets/second") != std::string::npos);
+  size_t achievedAt = report.str().find("achieved rate: ");
+  BOOST_REQUIRE(achievedAt != std::string::npos);
+  double achieved = boost::lexical_cast<double>(
+    report.str().substr(achievedAt + 15, report.str().find(' ', achievedAt + 15) - achievedAt - 15));
+  BOOST_CHECK(achieved <= 250.0);
+  BOOST_CHECK(achieved > 125.0);
+  BOOST_TEST_MESSAGE(report.str());
+}
+
+BOOST_AUTO_TEST_CASE(testReplayClockUnlimited)
+{
+  // speed 0 ignores the capture times: an hour of capture goes out at once.
+  Examples::ReplayClock clock(0.0);
+  BOOST_CHECK(clock.unlimited());
+  uint64 start = Common::monotonicNanoseconds();
+  replay(clock, 0, 100, 36000 * millisecond);
+  BOOST_CHECK(Common::monotonicNanoseconds() - start < 1000 * millisecond);
+  BOOST_CHECK_EQUAL(clock.packets(), 100u);
+  BOOST_CHECK_EQUAL(clock.scheduledNanoseconds(), 0u);
+  BOOST_CHECK_EQUAL(clock.maxLag(), 0u);
+  BOOST_CHECK_EQUAL(clock.latePackets(), 0u);
+
+  std::stringstream report;
+  clock.report(report);
+  BOOST_CHECK(report.str().find("100 packets as fast as possible") != std::string::npos);
+  BOOST_CHECK(report.str().find("target rate") == std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(testReplayClockRestart)
+{
+  // capture times that go backwards are sent at once and don't move the schedule back.
+  Examples::ReplayClock clock(1.0);
+  clock.waitFor(100 * millisecond);
+  clock.waitFor(110 * millisecond);
+  clock.waitFor(50 * millisecond);
+  BOOST_CHECK_EQUAL(clock.scheduledNanoseconds(), 10 * millisecond);
+  clock.waitFor(115 * millisecond);
+  BOOST_CHECK_EQUAL(clock.scheduledNanoseconds(), 15 * millisecond);
+
+  // A second pass over the same capture starts a new schedule and adds to the total.
+  clock.restart();
+  BOOST_CHECK_EQUAL(clock.scheduledNanoseconds(), 15 * millisecond);
+  uint64 start = Common::monotonicNanoseconds();
+  clock.waitFor(100 * millisecond);
+  // the first packet of a pass is not held.
+  BOOST_CHECK(Common::monotonicNanoseconds() - start < 5 * millisecond);
+  clock.waitFor(105 * millisecond);
+  BOOST_CHECK_EQUAL(clock.scheduledNanoseconds(), 20 * millisecond);
+  BOOST_CHECK_EQUAL(clock.packets(), 6u);
+  BOOST_CHECK(clock.elapsedNanoseconds() >= clock.scheduledNanoseconds());
+
+  // A new speed doesn't rescale the packets already released...
+  clock.setSpeed(5.0);
+  BOOST_CHECK_EQUAL(clock.scheduledNanoseconds(), 20 * millisecond);
+  // ...but shortens the rest of the schedule.
+  clock.waitFor(155 * millisecond);
+  BOOST_CHECK_EQUAL(clock.scheduledNanoseconds(), 30 * millisecond);
+  clock.restart();
+  clock.waitFor(0);
+  clock.waitFor(50 * millisecond);
+  BOOST_CHECK_EQUAL(clock.scheduledNanoseconds(), 40 * millisecond);
+  BOOST_CHECK(clock.elapsedNanoseconds() >= clock.scheduledNanoseconds());
+}
@@ -0,0 +1,169 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+#include <Codecs/XMLTemplateParser.h>
+#include <Codecs/DataDestination.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/Encoder.h>
+#include <Codecs/StructAccessor.h>
+#include <Messages/FieldSet.h>
+#include <Messages/FieldUInt32.h>
+#include <Messages/FieldInt32.h>
+#include <Messages/FieldAscii.h>
+#include <Messages/FieldDecimal.h>
+#include <Messages/FieldSequence.h>
+#include <Messages/Sequence.h>
+#include <Messages/FieldIdentity.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  const char * templates =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>"
+    "<templates xmlns=\"http://www.fixprotocol.org/ns/fast/td/1.1\">"
+    "    <template name=\"Quote\" id=\"77\">"
+    "        <uInt32 name=\"MsgSeqNum\" id=\"34\"><increment/></uInt32>"
+    "        <string name=\"Symbol\" id=\"55\"><copy/></string>"
+    "        <string name=\"SecurityDesc\" id=\"107\"><delta/></string>"
+    "        <int32 name=\"NetChange\" id=\"451\"><delta/></int32>"
+    "        <decimal name=\"LastPx\" id=\"31\" presence=\"optional\"><copy/></decimal>"
+    "        <sequence name=\"Entries\">"
+    "            <length name=\"NoEntries\" id=\"268\"/>"
+    "            <decimal name=\"Price\" id=\"270\"><copy/></decimal>"
+    "            <uInt32 name=\"Size\" id=\"271\"><delta/></uInt32>"
+    "        </sequence>"
+    "    </template>"
+    "</templates>"
+    ;
+
+  struct Entry
+  {
+    Decimal price_;
+    uint32 size_;
+  };
+
+  struct Quote
+  {
+    uint32 seqNum_;
+    std::string symbol_;
+    std::string description_;
+    int32 netChange_;
+    bool hasLastPx_;
+    Decimal lastPx_;
+    std::vector<Entry> entries_;
+  };
+
+  bool getLastPx(const Quote & quote, Decimal & value)
+  {
+    if(quote.hasLastPx_)
+    {
+      value = quote.lastPx_;
+    }
+    return quote.hasLastPx_;
+  }
+
+  // FieldSet holds references to the identities, so they must outlive the messages.
+  const Messages::FieldIdentity id_MsgSeqNum("MsgSeqNum");
+  const Messages::FieldIdentity id_Symbol("Symbol");
+  const Messages::FieldIdentity id_SecurityDesc("SecurityDesc");
+  const Messages::FieldIdentity id_NetChange("NetChange");
+  const Messages::FieldIdentity id_LastPx("LastPx");
+  const Messages::FieldIdentity id_Entries("Entries");
+  const Messages::FieldIdentity id_NoEntries("NoEntries");
+  const Messages::FieldIdentity id_Price("Price");
+  const Messages::FieldIdentity id_Size("Size");
+
+  Messages::FieldSetPtr toFieldSet(const Quote & quote)
+  {
+    Messages::FieldSetPtr msg(new Messages::FieldSet(10));
+    msg->addField(id_MsgSeqNum, Messages::FieldUInt32::create(quote.seqNum_));
+    msg->addField(id_Symbol, Messages::FieldAscii::create(quote.symbol_));
+    msg->addField(id_SecurityDesc, Messages::FieldAscii::create(quote.description_));
+    msg->addField(id_NetChange, Messages::FieldInt32::create(quote.netChange_));
+    if(quote.hasLastPx_)
+    {
+      msg->addField(id_LastPx, Messages::FieldDecimal::create(quote.lastPx_));
+    }
+    Messages::SequencePtr entries(new Messages::Sequence(id_NoEntries, quote.entries_.size()));
+    for(size_t pos = 0; pos < quote.entries_.size(); ++pos)
+    {
+      Messages::FieldSetPtr entry(new Messages::FieldSet(2));
+      entry->addField(id_Price, Messages::FieldDecimal::create(quote.entries_[pos].price_));
+      entry->addField(id_Size, Messages::FieldUInt32::create(quote.entries_[pos].size_));
+      entries->addEntry(entry);
+    }
+    msg->addField(id_Entries, Messages::FieldSequence::create(entries));
+    return msg;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testStructAccessor)
+{
+  std::stringstream templateStream(templates);
+  Codecs::XMLTemplateParser parser;
+  Codecs::TemplateRegistryPtr registry = parser.parse(templateStream);
+  Codecs::TemplateCPtr quoteTemplate;
+  BOOST_REQUIRE(registry->getTemplate(77, quoteTemplate));
+
+  Codecs::StructBinding<Quote> binding(quoteTemplate);
+  binding.bindUnsigned("MsgSeqNum", &Codecs::unsignedMember<Quote, uint32, &Quote::seqNum_>);
+  binding.bindString("Symbol", &Codecs::stringMember<Quote, &Quote::symbol_>);
+  binding.bindString("SecurityDesc", &Codecs::stringMember<Quote, &Quote::description_>);
+  binding.bindSigned("NetChange", &Codecs::signedMember<Quote, int32, &Quote::netChange_>);
+  binding.bindDecimal("LastPx", &getLastPx);
+  Codecs::StructBinding<Entry> & entryBinding = binding.bindSequence("Entries", &Quote::entries_);
+  entryBinding.bindDecimal("Price", &Codecs::decimalMember<Entry, &Entry::price_>);
+  entryBinding.bindUnsigned("Size", &Codecs::unsignedMember<Entry, uint32, &Entry::size_>);
+
+  BOOST_CHECK_THROW(binding.bindUnsigned("NoSuchField", &Codecs::unsignedMember<Quote, uint32, &Quote::seqNum_>), UsageError);
+
+  Quote quotes[2];
+  quotes[0].seqNum_ = 100;
+  quotes[0].symbol_ = "ACME";
+  quotes[0].description_ = "ACME Corp. 5.25% senior unsecured notes due 15-Mar-2031";
+  quotes[0].netChange_ = -25;
+  quotes[0].hasLastPx_ = true;
+  quotes[0].lastPx_ = Decimal(10125, -2);
+  Entry entry;
+  entry.price_ = Decimal(10100, -2);
+  entry.size_ = 500;
+  quotes[0].entries_.push_back(entry);
+  entry.price_ = Decimal(10150, -2);
+  entry.size_ = 300;
+  quotes[0].entries_.push_back(entry);
+
+  quotes[1] = quotes[0];
+  quotes[1].seqNum_ = 101;
+  quotes[1].description_ = "ACME Corp. 5.25% senior unsecured notes due 15-Sep-2031";
+  quotes[1].netChange_ = 12;
+  quotes[1].hasLastPx_ = false;
+  quotes[1].entries_.pop_back();
+
+  Codecs::Encoder structEncoder(registry);
+  Codecs::DataDestination structDestination;
+  Codecs::StructAccessor<Quote> accessor(binding);
+
+  Codecs::Encoder fieldSetEncoder(registry);
+  Codecs::DataDestination fieldSetDestination;
+
+  for(size_t pos = 0; pos < sizeof(quotes)/sizeof(quotes[0]); ++pos)
+  {
+    accessor.setRecord(quotes[pos]);
+    structEncoder.encodeMessage(structDestination, 77, accessor);
+
+    Messages::FieldSetPtr fieldSet = toFieldSet(quotes[pos]);
+    fieldSetEncoder.encodeMessage(fieldSetDestination, 77, *fieldSet);
+  }
+
+  std::string structEncoded;
+  structDestination.toString(structEncoded);
+  std::string fieldSetEncoded;
+  fieldSetDestination.toString(fieldSetEncoded);
+  BOOST_CHECK(!structEncoded.empty());
+  BOOST_CHECK(structEncoded == fieldSetEncoded);
+}
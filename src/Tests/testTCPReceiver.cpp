@@ -0,0 +1,161 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Communication/TCPReceiver.h>
+#include <Tests/ReceiverTestFixtures.h>
+
+using namespace QuickFAST;
+using namespace QuickFAST::Tests;
+
+namespace
+{
+  /// Collect the stream and the kernel receive times of its buffers.
+  class StreamCollector : public CollectingAssembler
+  {
+  public:
+    StreamCollector(Common::Logger & logger)
+      : CollectingAssembler(logger)
+      , unstamped_(0)
+      , earliest_(0)
+      , latest_(0)
+    {
+    }
+
+    size_t unstamped_;
+    /// the range of the receive times that were reported.
+    uint64 earliest_;
+    uint64 latest_;
+
+  protected:
+    virtual void receiveBuffer(const Communication::LinkedBuffer & buffer)
+    {
+      CollectingAssembler::receiveBuffer(buffer);
+      uint64 receiveTime = buffer.receiveTime();
+      if(receiveTime == 0)
+      {
+        ++unstamped_;
+      }
+      else
+      {
+        if(earliest_ == 0 || receiveTime < earliest_)
+        {
+          earliest_ = receiveTime;
+        }
+        latest_ = std::max(latest_, receiveTime);
+      }
+    }
+  };
+
+  /// @brief the wall clock in nanoseconds since the epoch, like a kernel receive time.
+  uint64 wallNanoseconds()
+  {
+    boost::posix_time::time_duration sinceEpoch =
+      boost::posix_time::microsec_clock::universal_time()
+      - boost::posix_time::ptime(boost::gregorian::date(1970, 1, 1));
+    return uint64(sinceEpoch.total_microseconds()) * 1000;
+  }
+
+  /// @brief a stream in which a misplaced or missing byte is easy to spot.
+  std::string makeStream(size_t size)
+  {
+    std::string stream(size, '\0');
+    for(size_t nByte = 0; nByte < size; ++nByte)
+    {
+      // 251 is prime so the pattern does not line up with the buffers.
+      stream[nByte] = char(nByte % 251);
+    }
+    return stream;
+  }
+
+  /// @brief Send a stream through a TCPReceiver on the loopback interface, then close the connection.
+  /// @param readBuffers how many buffers each read may fill.
+  /// @param timestamps ask for kernel receive timestamps.
+  void sendThroughReceiver(size_t readBuffers, bool timestamps)
+  {
+    const size_t bufferSize = 1024;
+    const size_t bufferCount = 16;
+    // many times more than one read can hold, so the socket is often left with data waiting.
+    const std::string sent = makeStream(bufferSize * readBuffers * 64 + 17);
+
+    uint64 before = wallNanoseconds();
+    boost::asio::io_service acceptorService;
+    boost::asio::ip::tcp::acceptor acceptor(
+      acceptorService,
+      boost::asio::ip::tcp::endpoint(boost::asio::ip::address::from_string("127.0.0.1"), 0));
+    std::string port = boost::lexical_cast<std::string>(acceptor.local_endpoint().port());
+
+    boost::asio::io_service ioService;
+    Communication::TCPReceiver receiver(ioService, "127.0.0.1", port);
+    receiver.setReadBuffers(readBuffers);
+    receiver.setReceiveTimestamps(timestamps);
+    TestLogger logger(false);
+    StreamCollector collector(logger);
+    // start() connects; the connection waits in the acceptor's backlog.
+    BOOST_REQUIRE(receiver.start(collector, bufferSize, bufferCount));
+    boost::asio::ip::tcp::socket peer(acceptorService);
+    acceptor.accept(peer);
+    receiver.runThreads(1, false);
+
+    boost::asio::write(peer, boost::asio::buffer(sent));
+    peer.shutdown(boost::asio::ip::tcp::socket::shutdown_send);
+
+    // end of stream stops the receiver: the logger says not to continue.
+    for(size_t tries = 0; !receiver.stopping() && tries < 1000; ++tries)
+    {
+      boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    }
+    BOOST_CHECK(receiver.stopping());
+    receiver.stop();
+    receiver.joinThreads();
+    uint64 after = wallNanoseconds();
+
+    BOOST_CHECK_EQUAL(collector.data_.size(), sent.size());
+    BOOST_CHECK(collector.data_ == sent);
+    BOOST_CHECK_EQUAL(logger.communicationErrors_, 1u);
+    BOOST_CHECK_EQUAL(logger.lastError_, boost::system::error_code(boost::asio::error::eof).message());
+    BOOST_CHECK_EQUAL(receiver.bytesReceived(), sent.size());
+    BOOST_CHECK_EQUAL(receiver.packetsProcessed(), collector.bufferCount_);
+    BOOST_CHECK(receiver.largestPacket() <= bufferSize);
+    if(timestamps)
+    {
+      // Whether the kernel stamps a TCP read depends on when it turned timestamping on,
+      // so a read may have no time (receiveTime() is then zero).
+      // Any time that is reported must be when the stream was sent, give or take a second for clock skew.
+      if(collector.unstamped_ < collector.bufferCount_)
+      {
+        BOOST_CHECK(collector.earliest_ + 1000000000 >= before);
+        BOOST_CHECK(collector.latest_ <= after + 1000000000);
+      }
+    }
+    else
+    {
+      BOOST_CHECK_EQUAL(collector.unstamped_, collector.bufferCount_);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testTCPReceiver)
+{
+  // one buffer per read: plain asio.
+  sendThroughReceiver(1, false);
+}
+
+#if defined(__linux__)
+BOOST_AUTO_TEST_CASE(testTCPReceiverScatterRead)
+{
+  // one recvmsg() spreads the data across borrowed idle buffers.
+  sendThroughReceiver(4, false);
+}
+
+BOOST_AUTO_TEST_CASE(testTCPReceiverTimestamps)
+{
+  // a single buffer still goes through recvmsg() to collect the timestamp.
+  sendThroughReceiver(1, true);
+  sendThroughReceiver(4, true);
+}
+#endif // __linux__
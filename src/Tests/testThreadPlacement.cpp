@@ -0,0 +1,92 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+#include <Common/ThreadPlacement.h>
+#include <Communication/AsioService.h>
+
+using namespace QuickFAST;
+
+BOOST_AUTO_TEST_CASE(testCpuList)
+{
+  std::vector<int> cpus;
+  BOOST_REQUIRE(Common::ThreadPlacement::parseCpuList("0-3,8,10-11", cpus));
+  BOOST_REQUIRE_EQUAL(cpus.size(), 7u);
+  BOOST_CHECK_EQUAL(cpus[0], 0);
+  BOOST_CHECK_EQUAL(cpus[3], 3);
+  BOOST_CHECK_EQUAL(cpus[4], 8);
+  BOOST_CHECK_EQUAL(cpus[6], 11);
+  BOOST_CHECK_EQUAL(Common::ThreadPlacement::formatCpuList(cpus), "0-3,8,10-11");
+
+  BOOST_REQUIRE(Common::ThreadPlacement::parseCpuList("5", cpus));
+  BOOST_REQUIRE_EQUAL(cpus.size(), 1u);
+  BOOST_CHECK_EQUAL(cpus[0], 5);
+
+  BOOST_CHECK(!Common::ThreadPlacement::parseCpuList("", cpus));
+  BOOST_CHECK(!Common::ThreadPlacement::parseCpuList("3-1", cpus));
+  BOOST_CHECK(!Common::ThreadPlacement::parseCpuList("1,,2", cpus));
+  BOOST_CHECK(!Common::ThreadPlacement::parseCpuList("a", cpus));
+  BOOST_CHECK(!Common::ThreadPlacement::parseCpuList("1-", cpus));
+}
+
+#if defined(__linux__)
+namespace
+{
+  void placeAndReport(int cpu, bool & pinned, int & runningOn, std::string & name)
+  {
+    pinned = Common::ThreadPlacement::pinThread(cpu);
+    runningOn = ::sched_getcpu();
+    Common::ThreadPlacement::nameThread("quickfast-test-thread");
+    char buffer[16];
+    if(::pthread_getname_np(::pthread_self(), buffer, sizeof(buffer)) == 0)
+    {
+      name = buffer;
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testPinAndNameThread)
+{
+  bool pinned = false;
+  int runningOn = -1;
+  std::string name;
+  // Every machine has a CPU 0.
+  boost::thread thread(boost::bind(placeAndReport, 0, boost::ref(pinned), boost::ref(runningOn), boost::ref(name)));
+  thread.join();
+  if(pinned)
+  {
+    BOOST_CHECK_EQUAL(runningOn, 0);
+  }
+  BOOST_CHECK_EQUAL(name, "quickfast-test-");
+
+  BOOST_CHECK(!Common::ThreadPlacement::pinThread(-1));
+  BOOST_CHECK_EQUAL(Common::ThreadPlacement::nodeOfCpu(-1), -1);
+}
+
+BOOST_AUTO_TEST_CASE(testPlaceOnNode)
+{
+  int node = Common::ThreadPlacement::nodeOfCpu(0);
+  std::vector<unsigned char> memory(100000, 0x5A);
+  // Not every kernel supports NUMA policy; when it does, the data must survive the move.
+  Common::ThreadPlacement::placeOnNode(&memory[0], memory.size(), node < 0 ? 0 : node);
+  BOOST_CHECK_EQUAL(size_t(std::count(memory.begin(), memory.end(), 0x5A)), memory.size());
+  BOOST_CHECK(!Common::ThreadPlacement::placeOnNode(&memory[0], memory.size(), -1));
+}
+#endif // __linux__
+
+BOOST_AUTO_TEST_CASE(testAsioServiceThreadPlacement)
+{
+  boost::asio::io_service ioService;
+  Communication::AsioService service(ioService);
+  std::vector<int> cpus(1, 0);
+  service.setThreadCpus(cpus);
+  service.setThreadName("asio");
+  BOOST_CHECK(service.threadCpus() == cpus);
+  // Nothing to do, so the threads exit immediately.
+  service.runThreads(2, false);
+  service.joinThreads();
+  BOOST_CHECK_EQUAL(service.runningThreadCount(), 0);
+}